@@ -603,6 +603,38 @@ ALIGN_EXTERN uint32_t CC ReferenceIteratorBasesDeleted ( const ReferenceIterator
     INSDC_coord_zero *pos, const INSDC_4na_bin **bases );
 
 
+/* Coverage
+ *  alternative to walking the window with NextPos/NextPlacement:
+ *  sweeps once over all placements of the current window and produces
+ *  depth and base-counts for every position of it, without visiting
+ *  every placement at every position
+ *
+ *  must be called right after NextWindow, consumes the window:
+ *  a following NextPos returns rcDone. counts are summed over spot-groups
+ *
+ *  "first_pos", "len" [ IN ] - the window as returned by NextWindow
+ *
+ *  "depth" [ OUT, NULL OKAY ] - array of "len" elements, receives the
+ *  same depth ReferenceIteratorPosition reports for each position
+ *
+ *  "counts" [ OUT, NULL OKAY ] - array of "len" elements, receives how
+ *  the placements look at each position. costs a walk along every
+ *  placement, while "depth" alone only touches their ends
+ */
+typedef struct ReferenceIteratorBaseCounts ReferenceIteratorBaseCounts;
+struct ReferenceIteratorBaseCounts
+{
+    uint32_t matches;           /* bases equal to the reference */
+    uint32_t mismatches[ 5 ];   /* A, C, G, T and any other 4na code not matching */
+    uint32_t deletions;         /* placements skipping this position */
+    uint32_t insertions;        /* placements with an insert following this position */
+};
+
+ALIGN_EXTERN rc_t CC ReferenceIteratorCoverage ( ReferenceIterator *self,
+    INSDC_coord_zero first_pos, INSDC_coord_len len,
+    uint32_t * depth, ReferenceIteratorBaseCounts * counts );
+
+
 #ifdef __cplusplus
 }
 #endif
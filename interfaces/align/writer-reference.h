@@ -74,6 +74,10 @@ ALIGN_EXTERN rc_t CC ReferenceMgr_Release(const ReferenceMgr *cself,
 
 ALIGN_EXTERN rc_t CC ReferenceMgr_SetCache(ReferenceMgr const *const self, size_t cache, uint32_t num_open);
 
+/* number of threads importing the sequences of a multi-sequence fasta file,
+   default is 4; 0 or 1 imports on the calling thread */
+ALIGN_EXTERN rc_t CC ReferenceMgr_SetImportThreads(ReferenceMgr const *const self, uint32_t num_threads);
+
 typedef struct ReferenceSeq ReferenceSeq;
 
 /* id: chr12 or NC_000001.3 */
@@ -163,7 +163,7 @@ void int128_add ( int128_t *self, const int128_t *i )
         "adc %%rcx, 8(%%rdi);"
         :
         : "D" ( self ), "S" ( i )
-        : "%rax", "%rcx"
+        : "%rax", "%rcx", "memory"
     );
 }
 
@@ -178,7 +178,7 @@ void int128_sub ( int128_t *self, const int128_t *i )
         "sbb %%rcx, 8(%%rdi);"
         :
         : "D" ( self ), "S" ( i )
-        : "%rax", "%rcx"
+        : "%rax", "%rcx", "memory"
     );
 }
 
@@ -194,7 +194,7 @@ void int128_sar ( int128_t *self, uint32_t i )
         "mov %%rax, 8(%%rdi);"
         :
         : "D" ( self ), "S" ( i )
-        :  "%rax", "%rcx"
+        : "%rax", "%rcx", "memory"
     );
 }
 
@@ -210,7 +210,7 @@ void int128_shl ( int128_t *self, uint32_t i )
         "mov %%rax, (%%rdi);"
         :
         : "D" ( self ), "S" ( i )
-        : "%rax", "%rcx"
+        : "%rax", "%rcx", "memory"
     );
 }
 
@@ -225,7 +225,7 @@ void uint128_and ( uint128_t *self, const uint128_t *i )
         "and %%rcx, 8(%%rdi);"
         :
         : "D" ( self ), "S" ( i )
-        :"%rax", "%rcx"
+        : "%rax", "%rcx", "memory"
     );
 }
 
@@ -240,7 +240,7 @@ void uint128_or ( uint128_t *self, const uint128_t *i )
         "or %%rcx, 8(%%rdi);"
         :
         : "D" ( self ), "S" ( i )
-        :"%rax", "%rcx"
+        : "%rax", "%rcx", "memory"
     );
 }
 
@@ -261,7 +261,7 @@ void uint128_xor ( uint128_t *self, const uint128_t *i )
         "xor %%rcx, 8(%%rdi);"
         :
         : "D" ( self ), "S" ( i )
-        :"%rax", "%rcx"
+        : "%rax", "%rcx", "memory"
     );
 }
 
@@ -278,7 +278,7 @@ void uint128_not ( uint128_t *self )
         "mov %%rcx, 8(%%rdi);"
         :
         : "D" ( self )
-        : "%rax", "%rcx"
+        : "%rax", "%rcx", "memory"
     );
 }
 
@@ -301,7 +301,7 @@ void uint128_shr ( uint128_t *self, uint32_t i )
         "mov %%rax, 8(%%rdi);"
         :
         : "D" ( self ), "S" ( i )
-        : "%rax", "%rcx"
+        : "%rax", "%rcx", "memory"
     );
 #endif
 }
@@ -318,7 +318,7 @@ void uint128_shl ( uint128_t *self, uint32_t i )
         "mov %%rax, (%%rdi);"
         :
         : "D" ( self ), "S" ( i )
-        : "%rax", "%rcx"
+        : "%rax", "%rcx", "memory"
     );
 }
 
@@ -335,7 +335,7 @@ void uint128_bswap ( uint128_t *self )
         "mov %%rcx, (%%rdi);"
         :
         : "D" ( self )
-        : "%rax", "%rcx"
+        : "%rax", "%rcx", "memory"
     );
 }
 
@@ -352,7 +352,7 @@ void uint128_bswap_copy ( uint128_t *to, const uint128_t *from )
         "mov %%rcx, (%%rdi);"
         :
         : "D" ( to ), "S" ( from )
-        : "%rax", "%rcx"
+        : "%rax", "%rcx", "memory"
     );
 }
 
@@ -57,6 +57,25 @@ struct KFile;
 KFS_EXTERN rc_t CC KFileMakeBzip2ForRead ( struct KFile const **bz, struct KFile const *src );
 
 
+/* MakeBzip2ForParallelRead
+ *  creates an adapter to bunzip2 a source file, decoding
+ *  the bzip2 blocks of the source in parallel
+ *
+ *  "bz" [ OUT ] - return parameter for decompressed file
+ *
+ *  "src" [ IN ] - compressed source file with read permission
+ *
+ *  "threads" [ IN ] - number of decoding threads, or 0 for the default
+ *
+ * NB - produces the same output as KFileMakeBzip2ForRead, and has
+ *  the same restriction: it must be consumed serially. a damaged
+ *  source may report its error after more output than the serial
+ *  adapter would have delivered.
+ */
+KFS_EXTERN rc_t CC KFileMakeBzip2ForParallelRead ( struct KFile const **bz,
+    struct KFile const *src, uint32_t threads );
+
+
 /* MakeBzip2ForWrite
  *  creates an adapter to gzip a source file
  *
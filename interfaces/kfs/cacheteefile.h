@@ -99,6 +99,11 @@ struct KDirectory;
  * this function will check if the remote-file and the local file ( if it already exists )
  * do have the same size and blocksize
  *
+ * the tee-file can be read by many threads at the same time: cached blocks are
+ * found without locking, a block that is missing is downloaded by only one of the
+ * readers while the others wait for it. "remote" has to support concurrent reads
+ * of different positions for the readers to scale.
+ *
  */
 KFS_EXTERN rc_t CC KDirectoryMakeCacheTee ( struct KDirectory *self,
     struct KFile const **tee, struct KFile const *remote,
@@ -52,7 +52,8 @@ struct KFile;
  *  "src" [ IN ] - compressed source file with read permission
  *
  * NB - creates a read-only file that does NOT support random access
- *  i.e. must be consumed serially starting from offset 0
+ *  i.e. must be consumed serially starting from offset 0.
+ *  use KFileMakeGzipIndexedForRead when random access is needed.
  */
 KFS_EXTERN rc_t CC KFileMakeGzipForRead ( struct KFile const **gz, struct KFile const *src );
 
@@ -70,6 +71,92 @@ KFS_EXTERN rc_t CC KFileMakeGzipForRead ( struct KFile const **gz, struct KFile
 KFS_EXTERN rc_t CC KFileMakeGzipForWrite ( struct KFile **gz, struct KFile *file );
 
 
+/*--------------------------------------------------------------------------
+ * KGzipIndex
+ *  a table of access points into a gzip file
+ *
+ *  every "span" bytes of decompressed output, at a deflate block
+ *  boundary, the index remembers where in the compressed file the
+ *  next block starts together with the preceding 32K of output.
+ *  decompression can resume from any access point, so a read at
+ *  an arbitrary offset costs at most "span" bytes of inflation.
+ *
+ *  each access point costs 32K of memory ( and of disk when saved ).
+ *  multi-member files such as those written by bgzip are supported.
+ */
+typedef struct KGzipIndex KGzipIndex;
+
+
+/* AddRef
+ * Release
+ */
+KFS_EXTERN rc_t CC KGzipIndexAddRef ( const KGzipIndex *self );
+KFS_EXTERN rc_t CC KGzipIndexRelease ( const KGzipIndex *self );
+
+
+/* Make
+ *  build an index by decompressing the whole of "gz" once
+ *
+ *  "idx" [ OUT ] - return parameter for new index
+ *
+ *  "gz" [ IN ] - compressed source file with read permission
+ *
+ *  "span" [ IN ] - distance in decompressed bytes between access
+ *   points, or 0 for the default of 1M
+ */
+KFS_EXTERN rc_t CC KGzipIndexMake ( const KGzipIndex **idx,
+    struct KFile const *gz, uint64_t span );
+
+
+/* Save
+ *  write a complete index to "dst", normally a file kept beside
+ *  the compressed one. the format is in host byte order.
+ *
+ *  fails with rcIncomplete if the index does not yet cover the file
+ */
+KFS_EXTERN rc_t CC KGzipIndexSave ( const KGzipIndex *self, struct KFile *dst );
+
+
+/* Load
+ *  read an index written by KGzipIndexSave
+ */
+KFS_EXTERN rc_t CC KGzipIndexLoad ( const KGzipIndex **idx, struct KFile const *src );
+
+
+/* MakeGzipIndexedForRead
+ *  creates a random access adapter to gunzip a source file
+ *
+ *  "gz" [ OUT ] - return parameter for decompressed file
+ *
+ *  "src" [ IN ] - compressed source file with read permission
+ *
+ *  "idx" [ IN, NULL OKAY ] - index previously built for "src". when
+ *   NULL, the file builds its own index as it is read, so the first
+ *   serial pass pays for later random reads.
+ *
+ *  "span" [ IN ] - distance between access points when building,
+ *   or 0 for the default. ignored when "idx" is given.
+ *
+ * NB - reads may start at any offset. the file keeps decoding state
+ *  and must not be read by more than one thread at a time.
+ *  fails with rcIncorrect if "idx" was built for a file of another size.
+ */
+KFS_EXTERN rc_t CC KFileMakeGzipIndexedForRead ( struct KFile const **gz,
+    struct KFile const *src, const KGzipIndex *idx, uint64_t span );
+
+
+/* GzipIndex
+ *  get the index of a file made by KFileMakeGzipIndexedForRead
+ *
+ *  "idx" [ OUT ] - return parameter for a new reference to the index
+ *
+ *  fails with rcIncomplete while a self-built index does not yet
+ *  reach the end of the file, and with rcType, rcIncorrect if "self"
+ *  is not an indexed gzip file
+ */
+KFS_EXTERN rc_t CC KFileGzipIndex ( struct KFile const *self, const KGzipIndex **idx );
+
+
 #ifdef __cplusplus
 }
 #endif
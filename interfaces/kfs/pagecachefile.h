@@ -0,0 +1,91 @@
+/*===========================================================================
+*
+*                            PUBLIC DOMAIN NOTICE
+*               National Center for Biotechnology Information
+*
+*  This software/database is a "United States Government Work" under the
+*  terms of the United States Copyright Act.  It was written as part of
+*  the author's official duties as a United States Government employee and
+*  thus cannot be copyrighted.  This software/database is freely available
+*  to the public for use. The National Library of Medicine and the U.S.
+*  Government have not placed any restriction on its use or reproduction.
+*
+*  Although all reasonable efforts have been taken to ensure the accuracy
+*  and reliability of the software and data, the NLM and the U.S.
+*  Government do not and cannot warrant the performance or results that
+*  may be obtained by using this software or data. The NLM and the U.S.
+*  Government disclaim all warranties, express or implied, including
+*  warranties of performance, merchantability or fitness for any particular
+*  purpose.
+*
+*  Please cite the author in any work or product based on this material.
+*
+* ===========================================================================
+*
+*/
+
+#ifndef _h_kfs_pagecachefile_
+#define _h_kfs_pagecachefile_
+
+#ifndef _h_kfs_extern_
+#include <kfs/extern.h>
+#endif
+
+#ifndef _h_klib_defs_
+#include <klib/defs.h>
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+/*--------------------------------------------------------------------------
+ * forwards
+ */
+struct KFile;
+
+
+/*--------------------------------------------------------------------------
+ * KPageCacheFile
+ *  a read-only, memory-only cache in front of a costly to read file
+ *  keeps the most recently used pages of the original file in a KPageFile
+ *  and evicts the least recently used ones once the size limit is reached
+ */
+
+/* MakeRead
+ *  make a read-only cached file
+ *
+ *  "cache" [ OUT ] - return parameter for new cached file
+ *
+ *  "original" [ IN ] - source file to be cached. must have read access
+ *   and must report its size
+ *
+ *  "climit" [ IN ] - upper limit for the memory used by cached pages
+ *
+ * the cached file may be read by multiple threads at the same time
+ */
+KFS_EXTERN rc_t CC KPageCacheFileMakeRead ( struct KFile const ** cache,
+    struct KFile const * original, size_t climit );
+
+
+/* Stats
+ *  report how effective the cache has been so far
+ *
+ *  "hits" [ OUT, NULL OKAY ] - number of pages found in memory
+ *
+ *  "misses" [ OUT, NULL OKAY ] - number of pages read from the original file
+ *
+ *  "cached" [ OUT, NULL OKAY ] - bytes of memory currently held by pages
+ *
+ * fails with rcType, rcIncorrect if "self" is not a KPageCacheFile
+ */
+KFS_EXTERN rc_t CC KPageCacheFileStats ( struct KFile const * self,
+    uint64_t * hits, uint64_t * misses, size_t * cached );
+
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _h_kfs_pagecachefile_ */
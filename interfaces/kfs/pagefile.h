@@ -136,6 +136,18 @@ KFS_EXTERN rc_t CC KPageFileSize ( const KPageFile *self,
     uint64_t *lsize, uint64_t *fsize, size_t *csize );
 
 
+/* Stats
+ *  returns how often KPageFileGet found a page in the cache
+ *  and how often it had to go to the backing file
+ *
+ *  "hits" [ OUT, NULL OKAY ] - return parameter for cache hits
+ *
+ *  "misses" [ OUT, NULL OKAY ] - return parameter for cache misses
+ */
+KFS_EXTERN rc_t CC KPageFileStats ( const KPageFile *self,
+    uint64_t *hits, uint64_t *misses );
+
+
 /* SetSize
  *  extends or truncates underlying file
  *  may affect cache contents
@@ -176,6 +188,41 @@ KFS_EXTERN rc_t CC KPageFileGet ( KPageFile *self, KPage **page, uint32_t page_i
 KFS_EXTERN rc_t CC KPageFilePosGet ( KPageFile *self, KPage **page, uint64_t offset );
 
 
+/* PosFind
+ *  returns the page corresponding to position if it is cached,
+ *  without reading from the backing file
+ *
+ *  "page" [ OUT ] - return parameter for page object,
+ *  NULL if the page is not cached
+ *
+ *  "offset" [ IN ] - offset to a byte within file
+ */
+KFS_EXTERN rc_t CC KPageFilePosFind ( KPageFile *self, KPage **page, uint64_t offset );
+
+
+/* PosLoad
+ *  reads the page corresponding to position from the backing file
+ *  without entering it into the cache. for read-only page files only.
+ *  touches no state of the page file itself, so it may run while
+ *  other threads are using it
+ *
+ *  "page" [ OUT ] - return parameter for page object
+ *
+ *  "offset" [ IN ] - offset to a byte within file
+ */
+KFS_EXTERN rc_t CC KPageFilePosLoad ( const KPageFile *self, KPage **page, uint64_t offset );
+
+
+/* Insert
+ *  enters a page returned by PosLoad into the cache
+ *
+ *  "page" [ IN, OUT ] - the page to insert. if the same page has
+ *  been cached meanwhile, the reference passed in is released and
+ *  replaced by one to the cached page
+ */
+KFS_EXTERN rc_t CC KPageFileInsert ( KPageFile *self, KPage **page );
+
+
 /* DropBacking
  *  used immediately prior to releasing
  *  prevents modified pages from being flushed to disk
@@ -82,6 +82,14 @@ KLIB_EXTERN void CC MD5StateInit ( MD5State *md5 );
  */
 KLIB_EXTERN void CC MD5StateAppend ( MD5State *md5, const void *data, size_t size );
 
+/* AppendMulti
+ *  run MD5StateAppend on "count" independent streams,
+ *  i.e. MD5StateAppend ( md5 [ i ], data [ i ], size [ i ] ) for each i
+ *  hashing several streams side by side where the processor allows
+ */
+KLIB_EXTERN void CC MD5StateAppendMulti ( MD5State *md5 [],
+    const void *const data [], const size_t size [], uint32_t count );
+
 /* Finish
  *  processes any remaining data in "md5"
  *  returns 16 bytes of digest
@@ -199,6 +199,52 @@ KLIB_EXTERN bool CC KDataBufferWritable ( const KDataBuffer *self );
 KLIB_EXTERN rc_t CC KDataBufferCheckIntegrity ( const KDataBuffer *self );
 
 
+/*--------------------------------------------------------------------------
+ * KDataBufferPool
+ *  storage for buffers of up to 1MB is recycled in size classes through
+ *  per-thread caches and shared free lists. storage of 4MB and more is
+ *  mapped directly from the system, on huge pages where available.
+ *  pooling is disabled by default, since rounding up to size classes and
+ *  holding freed blocks until KDataBufferPoolTrim trade memory for speed.
+ *  applications opt in with KDataBufferPoolEnable.
+ */
+typedef struct KDataBufferPoolStats KDataBufferPoolStats;
+struct KDataBufferPoolStats
+{
+    uint64_t live_bytes;        /* memory behind buffers now alive */
+    uint64_t peak_bytes;        /* high-water mark of live_bytes */
+    uint64_t cached_bytes;      /* memory held by the pool for reuse */
+    uint64_t allocations;       /* storage allocations */
+    uint64_t pool_hits;         /* allocations served from a thread cache */
+    uint64_t pool_reuses;       /* allocations served from the shared lists */
+    uint64_t resized_in_place;  /* resizes absorbed by a block's size class */
+    uint64_t huge_allocations;  /* allocations mapped from the system */
+};
+
+
+/* PoolEnable
+ *  turn recycling of buffer storage on or off
+ *  returns the prior setting
+ *
+ *  storage already allocated is released correctly either way
+ */
+KLIB_EXTERN bool CC KDataBufferPoolEnable ( bool enable );
+
+
+/* PoolTrim
+ *  return storage cached by the shared lists and by the
+ *  calling thread's cache to the system
+ */
+KLIB_EXTERN void CC KDataBufferPoolTrim ( void );
+
+
+/* PoolGetStats
+ *  a snapshot of the process-wide pool counters
+ */
+KLIB_EXTERN rc_t CC KDataBufferPoolGetStats ( KDataBufferPoolStats *stats );
+
+
+
 #ifdef __cplusplus
 }
 #endif
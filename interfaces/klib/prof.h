@@ -0,0 +1,196 @@
+/*===========================================================================
+*
+*                            PUBLIC DOMAIN NOTICE
+*               National Center for Biotechnology Information
+*
+*  This software/database is a "United States Government Work" under the
+*  terms of the United States Copyright Act.  It was written as part of
+*  the author's official duties as a United States Government employee and
+*  thus cannot be copyrighted.  This software/database is freely available
+*  to the public for use. The National Library of Medicine and the U.S.
+*  Government have not placed any restriction on its use or reproduction.
+*
+*  Although all reasonable efforts have been taken to ensure the accuracy
+*  and reliability of the software and data, the NLM and the U.S.
+*  Government do not and cannot warrant the performance or results that
+*  may be obtained by using this software or data. The NLM and the U.S.
+*  Government disclaim all warranties, express or implied, including
+*  warranties of performance, merchantability or fitness for any particular
+*  purpose.
+*
+*  Please cite the author in any work or product based on this material.
+*
+* ===========================================================================
+*
+*/
+
+
+#ifndef _h_klib_prof_
+#define _h_klib_prof_
+
+#ifndef _h_klib_extern_
+#include <klib/extern.h>
+#endif
+
+#ifndef _h_klib_defs_
+#include <klib/defs.h>
+#endif
+
+#ifndef _h_klib_writer_
+#include <klib/writer.h>
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+/*--------------------------------------------------------------------------
+ * KPROF
+ *  compile-time switch for instrumentation
+ *
+ *  instrumented code uses the KPROF_* macros below, which compile
+ *  to nothing unless KPROF is non-zero. it defaults to on for
+ *  profiling builds ( BUILD=prof ) and may be forced either way
+ *  with -DKPROF=1 or -DKPROF=0.
+ */
+#ifndef KPROF
+#if _PROFILING
+#define KPROF 1
+#else
+#define KPROF 0
+#endif
+#endif
+
+
+/*--------------------------------------------------------------------------
+ * KProfId
+ *  identifies a counter, keyed by subsystem and name
+ *  the value 0 is never a valid counter
+ */
+typedef uint32_t KProfId;
+
+/* subsystem names used by the libraries */
+#define KPROF_KFG       "kfg"
+#define KPROF_VFS       "vfs"
+#define KPROF_KDB       "kdb"
+#define KPROF_SCHEMA    "schema"
+#define KPROF_COLUMN    "column"
+#define KPROF_TRANSFORM "transform"
+#define KPROF_PAGEMAP   "pagemap"
+
+
+/* Register
+ *  return the counter for "subsystem" and "name",
+ *  creating it on first use. both strings are copied.
+ *
+ *  registration takes a lock and is meant to happen once per
+ *  site or object, with the id kept for the hot path.
+ *
+ *  returns 0 when the counter table is full or memory is exhausted;
+ *  recording against 0 is silently ignored
+ */
+KLIB_EXTERN KProfId CC KProfRegister ( const char *subsystem, const char *name );
+
+
+/* Now
+ *  a monotonic clock in nanoseconds
+ */
+KLIB_EXTERN uint64_t CC KProfNow ( void );
+
+
+/* Record
+ *  add one event of "ns" nanoseconds to a counter
+ *
+ * Count
+ *  add "count" to a counter without timing
+ *
+ *  counters are kept per thread without locking and
+ *  folded together when read
+ */
+KLIB_EXTERN void CC KProfRecord ( KProfId id, uint64_t ns );
+KLIB_EXTERN void CC KProfCount ( KProfId id, uint64_t count );
+
+
+/* WriteJSON
+ *  write the current totals of every counter as a JSON object
+ *  of the form
+ *    { "counters" : [ { "subsystem" : "...", "name" : "...",
+ *                       "count" : N, "ns" : N }, ... ] }
+ *
+ *  counters of threads still running are read without stopping
+ *  them, so totals are approximate while work is in progress
+ */
+KLIB_EXTERN rc_t CC KProfWriteJSON ( KWrtWriter writer, void *data );
+
+
+/* Reset
+ *  zero every counter, keeping registrations
+ */
+KLIB_EXTERN void CC KProfReset ( void );
+
+
+/*--------------------------------------------------------------------------
+ * KPROF_* macros
+ *
+ *  KPROF_SITE ( var, subsystem, name )
+ *   declare a function-static counter for a fixed site
+ *  KPROF_START ( var ) / KPROF_STOP ( var )
+ *   time a section against that counter
+ *  KPROF_TIMER ( var ) / KPROF_TIMER_STOP ( id, var )
+ *   time a section against a counter held elsewhere, e.g. in an object
+ *  KPROF_COUNT ( id, n )
+ *   add to a counter
+ *
+ *  example:
+ *
+ *    KPROF_SITE ( parse, KPROF_SCHEMA, "parse" );
+ *    KPROF_START ( parse );
+ *    rc = parse_it ( ... );
+ *    KPROF_STOP ( parse );
+ */
+#if KPROF
+
+#define KPROF_SITE( var, subsystem, name )                              \
+    static KProfId var ## _kprof_id;                                    \
+    uint64_t var ## _kprof_start = ( var ## _kprof_id != 0 ? 0 :        \
+        ( var ## _kprof_id = KProfRegister ( subsystem, name ), 0 ) )
+
+#define KPROF_START( var )                                              \
+    ( var ## _kprof_start = KProfNow () )
+
+#define KPROF_STOP( var )                                               \
+    KProfRecord ( var ## _kprof_id, KProfNow () - var ## _kprof_start )
+
+#define KPROF_TIMER( var )                                              \
+    uint64_t var ## _kprof_start = KProfNow ()
+
+#define KPROF_TIMER_STOP( id, var )                                     \
+    KProfRecord ( id, KProfNow () - var ## _kprof_start )
+
+#define KPROF_COUNT( id, n )                                            \
+    KProfCount ( id, n )
+
+#else
+
+#define KPROF_SITE( var, subsystem, name )  \
+    void var ## _kprof_unused ( void )
+#define KPROF_START( var )                  \
+    ( ( void ) 0 )
+#define KPROF_STOP( var )                   \
+    ( ( void ) 0 )
+#define KPROF_TIMER( var )                  \
+    void var ## _kprof_unused ( void )
+#define KPROF_TIMER_STOP( id, var )         \
+    ( ( void ) 0 )
+#define KPROF_COUNT( id, n )                \
+    ( ( void ) 0 )
+
+#endif
+
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _h_klib_prof_ */
@@ -62,6 +62,38 @@ KLIB_EXTERN void CC ksort_int64_t ( int64_t *pbase, size_t total_elems );
 KLIB_EXTERN void CC ksort_uint64_t ( uint64_t *pbase, size_t total_elems );
 
 
+/*--------------------------------------------------------------------------
+ * kradix_sort
+ *  radix sorts for integer keys
+ *
+ *  the integer variants are stable LSD sorts needing a scratch copy
+ *  of the array; they quietly fall back to ksort for short arrays or
+ *  when the scratch space cannot be allocated.
+ *
+ *  returns rcNull if "pbase" is NULL with a non-zero count
+ */
+KLIB_EXTERN rc_t CC kradix_sort_int32_t ( int32_t *pbase, size_t total_elems );
+KLIB_EXTERN rc_t CC kradix_sort_uint32_t ( uint32_t *pbase, size_t total_elems );
+KLIB_EXTERN rc_t CC kradix_sort_int64_t ( int64_t *pbase, size_t total_elems );
+KLIB_EXTERN rc_t CC kradix_sort_uint64_t ( uint64_t *pbase, size_t total_elems );
+
+
+/* kradix_sort_records
+ *  in-place MSD radix sort of fixed-size records on an integer key
+ *  stored in host byte order within each record. not stable.
+ *
+ *  "size" [ IN ] - size of each record in bytes
+ *
+ *  "key_offset" [ IN ] - byte offset of the key within a record
+ *
+ *  "key_size" [ IN ] - size of the key: 1, 2, 4 or 8 bytes
+ *
+ *  "key_signed" [ IN ] - true if the key is a signed integer
+ */
+KLIB_EXTERN rc_t CC kradix_sort_records ( void *pbase, size_t total_elems, size_t size,
+    size_t key_offset, size_t key_size, bool key_signed );
+
+
 /* KSORT
  *  macro ( see <klib/ksort-macro.h> )
  *  allows creation of a custom qsort with inlined compare and swap
@@ -0,0 +1,68 @@
+/*===========================================================================
+*
+*                            PUBLIC DOMAIN NOTICE
+*               National Center for Biotechnology Information
+*
+*  This software/database is a "United States Government Work" under the
+*  terms of the United States Copyright Act.  It was written as part of
+*  the author's official duties as a United States Government employee and
+*  thus cannot be copyrighted.  This software/database is freely available
+*  to the public for use. The National Library of Medicine and the U.S.
+*  Government have not placed any restriction on its use or reproduction.
+*
+*  Although all reasonable efforts have been taken to ensure the accuracy
+*  and reliability of the software and data, the NLM and the U.S.
+*  Government do not and cannot warrant the performance or results that
+*  may be obtained by using this software or data. The NLM and the U.S.
+*  Government disclaim all warranties, express or implied, including
+*  warranties of performance, merchantability or fitness for any particular
+*  purpose.
+*
+*  Please cite the author in any work or product based on this material.
+*
+* ===========================================================================
+*
+*/
+
+#ifndef _h_kproc_psort_
+#define _h_kproc_psort_
+
+#ifndef _h_kproc_extern_
+#include <kproc/extern.h>
+#endif
+
+#ifndef _h_klib_defs_
+#include <klib/defs.h>
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+/*--------------------------------------------------------------------------
+ * ksort_parallel
+ *  ksort spread across threads
+ *
+ *  the array is cut into one run per thread, each run is sorted with
+ *  ksort, and the runs are then merged pairwise, with every merge
+ *  divided among the threads. needs a scratch copy of the array;
+ *  when that cannot be allocated, or "num_threads" is 0 or 1, or
+ *  the array is short, it simply calls ksort. not stable.
+ *
+ *  "cmp" [ IN ] - comparison function as for ksort. it will be
+ *  called concurrently from several threads with the same "data".
+ *
+ *  "num_threads" [ IN ] - number of threads to use, including
+ *  the caller's
+ */
+KPROC_EXTERN rc_t CC ksort_parallel ( void *pbase, size_t total_elems, size_t size,
+    int ( CC * cmp ) ( const void*, const void*, void *data ), void *data,
+    uint32_t num_threads );
+
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _h_kproc_psort_ */
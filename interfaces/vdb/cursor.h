@@ -362,6 +362,55 @@ VDB_EXTERN rc_t CC VCursorCellDataDirect ( const VCursor *self, int64_t row_id,
     uint32_t *boff, uint32_t *row_len );
 
 
+/* CellDataBatch
+ *  access pointers to the cells of consecutive rows of one column
+ *  without per-row blob lookup. does not need SetRowId/OpenRow/CloseRow
+ *
+ *  rows are returned from "first_row" up to the end of the blob
+ *  that contains it, so "num_rows" may be less than "count". the
+ *  pointers stay valid under the same conditions as for CellDataDirect.
+ *  to scan a range, call repeatedly with "first_row" += "num_rows"
+ *
+ *  "first_row" [ IN ] - id of the first row to access
+ *
+ *  "col_idx" [ IN ] - index of column to be read, returned by "AddColumn"
+ *
+ *  "count" [ IN ] - capacity of the output arrays in rows
+ *
+ *  "elem_bits" [ OUT, NULL OKAY ] - optional return parameter for
+ *  element size in bits
+ *
+ *  "base" [ OUT ] and "boff" [ OUT, NULL OKAY ] - arrays of "count"
+ *  compound return parameters for pointers to row starting bits
+ *  where "boff" is in BITS
+ *
+ *  "row_len" [ OUT ] - array of "count" cell lengths in elements
+ *
+ *  "num_rows" [ OUT ] - the number of rows returned
+ */
+VDB_EXTERN rc_t CC VCursorCellDataBatch ( const VCursor *self, int64_t first_row,
+    uint32_t col_idx, uint32_t count, uint32_t *elem_bits, const void **base,
+    uint32_t *boff, uint32_t *row_len, uint32_t *num_rows );
+
+
+/* CellDataSpan
+ *  access a run of fixed-length cells stored back to back
+ *
+ *  like CellDataBatch, but succeeds only when all cells from "first_row"
+ *  have the same length and follow each other without gaps or shared
+ *  data, as is the case for fixed-width columns. "base"/"boff" address
+ *  the first cell, and cell i starts "i * row_len * elem_bits" bits
+ *  further. fails with rcUnsupported otherwise; use CellDataBatch then
+ *
+ *  "row_len" [ OUT ] - the length of every cell in the span
+ *
+ *  "num_rows" [ OUT ] - the number of rows in the span, <= "count"
+ */
+VDB_EXTERN rc_t CC VCursorCellDataSpan ( const VCursor *self, int64_t first_row,
+    uint32_t col_idx, uint32_t count, uint32_t *elem_bits, const void **base,
+    uint32_t *boff, uint32_t *row_len, uint32_t *num_rows );
+
+
 /* VCursorDataPrefetch
  * -- will prefecth rows into CursorCache (if it exists)
  * -- no OUT parameters - just primes the cache 
@@ -301,6 +301,32 @@ struct VCursor
             base, boff, row_len );
     }
 
+    /* CellDataBatch
+     *  access pointers to the cells of consecutive rows, up to
+     *  the end of the blob containing "first_row"
+     *
+     *  "base", "boff" [ NULL OKAY ] and "row_len" are arrays of "count"
+     *  "num_rows" [ OUT ] - the number of rows returned
+     */
+    inline rc_t CellDataBatch ( int64_t first_row, uint32_t col_idx, uint32_t count,
+        uint32_t *elem_bits, const void **base, uint32_t *boff, uint32_t *row_len,
+        uint32_t *num_rows ) const throw()
+    {
+        return VCursorCellDataBatch ( this, first_row, col_idx, count, elem_bits,
+            base, boff, row_len, num_rows );
+    }
+
+    /* CellDataSpan
+     *  access a run of fixed-length cells stored back to back
+     */
+    inline rc_t CellDataSpan ( int64_t first_row, uint32_t col_idx, uint32_t count,
+        uint32_t *elem_bits, const void **base, uint32_t *boff, uint32_t *row_len,
+        uint32_t *num_rows ) const throw()
+    {
+        return VCursorCellDataSpan ( this, first_row, col_idx, count, elem_bits,
+            base, boff, row_len, num_rows );
+    }
+
     /* Default
      *  give a default row value for column
      *
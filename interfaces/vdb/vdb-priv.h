@@ -98,6 +98,35 @@ VDB_EXTERN rc_t CC VDBManagerListExternalSchemaModules ( struct VDBManager const
 VDB_EXTERN rc_t CC VDBManagerDisablePagemapThread ( struct VDBManager const *self );
 
 
+/* SetSchemaCacheLimit
+ *  set the number of parsed schemas kept for sharing between
+ *  tables and databases opened read-only with identical schema text
+ *
+ *  "limit" [ IN ] - 0 disables sharing. changing the limit
+ *  empties the cache. the default is 32.
+ */
+VDB_EXTERN rc_t CC VDBManagerSetSchemaCacheLimit ( struct VDBManager const *self,
+    uint32_t limit );
+
+
+/* WriteProfile
+ *  write the instrumentation counters ( see <klib/prof.h> ) as JSON
+ *  to a file, replacing any existing one
+ *
+ *  counters are only collected by libraries built with KPROF set;
+ *  otherwise the list is empty.
+ *
+ *  when the environment variable VDB_PROFILE names a file, the
+ *  counters are also written there as the manager is destroyed.
+ *
+ *  "path" [ IN ] - NUL terminated file path
+ */
+VDB_EXTERN rc_t CC VDBManagerWriteProfile ( struct VDBManager const *self,
+    const char *path, ... );
+VDB_EXTERN rc_t CC VDBManagerVWriteProfile ( struct VDBManager const *self,
+    const char *path, va_list args );
+
+
 /* Make with custom VFSManager */
 VDB_EXTERN rc_t CC VDBManagerMakeReadWithVFSManager (
     struct VDBManager const **mgr,
@@ -245,6 +274,18 @@ VDB_EXTERN rc_t CC VCursorPermitPostOpenAdd ( struct VCursor const *self );
  */
 VDB_EXTERN rc_t CC VCursorSuspendTriggers ( struct VCursor const *self );
 
+/* PermitLazyOpen
+ *  defers resolution of each column's production chain and the
+ *  opening of its physical columns until the column is first read
+ *  may only be called on a read cursor before it is opened
+ *
+ *  the initial row id of the open cursor is taken from the first
+ *  column added, rather than from the union of all columns.
+ *  errors in resolving a column are reported by the first access
+ *  to that column instead of by VCursorOpen.
+ */
+VDB_EXTERN rc_t CC VCursorPermitLazyOpen ( struct VCursor const *self );
+
 /*  VCursorGetSchema
  *  returns current schema of the open cursor
  */
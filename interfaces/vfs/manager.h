@@ -159,6 +159,17 @@ VFS_EXTERN rc_t CC VFSManagerGetResolver ( const VFSManager * self, struct VReso
 VFS_EXTERN rc_t CC VFSManagerGetKNSMgr ( const VFSManager * self, struct KNSManager ** kns );
 
 
+/* PageCacheLimit
+ *  memory limit of the page cache used for remote files
+ *  that have no cache location on local disk
+ *
+ *  0 turns the page cache off and the remote files are buffered as before
+ *  the initial value is read from configuration node "/vfs/page-cache/limit"
+ */
+VFS_EXTERN rc_t CC VFSManagerSetPageCacheLimit ( VFSManager * self, size_t limit );
+VFS_EXTERN rc_t CC VFSManagerGetPageCacheLimit ( const VFSManager * self, size_t * limit );
+
+
 VFS_EXTERN rc_t CC VFSManagerGetKryptoPassword (const VFSManager * self, char * new_password, size_t max_size, size_t * size);
 
 /*
@@ -0,0 +1,213 @@
+/*===========================================================================
+ *
+ *                            PUBLIC DOMAIN NOTICE
+ *               National Center for Biotechnology Information
+ *
+ *  This software/database is a "United States Government Work" under the
+ *  terms of the United States Copyright Act.  It was written as part of
+ *  the author's official duties as a United States Government employee and
+ *  thus cannot be copyrighted.  This software/database is freely available
+ *  to the public for use. The National Library of Medicine and the U.S.
+ *  Government have not placed any restriction on its use or reproduction.
+ *
+ *  Although all reasonable efforts have been taken to ensure the accuracy
+ *  and reliability of the software and data, the NLM and the U.S.
+ *  Government do not and cannot warrant the performance or results that
+ *  may be obtained by using this software or data. The NLM and the U.S.
+ *  Government disclaim all warranties, express or implied, including
+ *  warranties of performance, merchantability or fitness for any particular
+ *  purpose.
+ *
+ *  Please cite the author in any work or product based on this material.
+ *
+ * ===========================================================================
+ *
+ */
+#ifndef _h_align_placement_pool_
+#define _h_align_placement_pool_
+
+#include <kproc/lock.h>
+
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+
+/*--------------------------------------------------------------------------
+ * PlacementRecordPool
+ *  recycles the memory of whacked PlacementRecords ( including their
+ *  spot-group and extension blocks ) by size class, so that iterating
+ *  over deep regions does not call malloc/free for every alignment.
+ *
+ *  every record carries a hidden slot-header in front of it, naming the
+ *  pool it goes back to. the pool is referenced by its PlacementIterator
+ *  and by every record taken from it, because records usually outlive
+ *  the iterator that made them.
+ *
+ *  the free list of a class keeps at most PLACEMENT_POOL_MAX_FREE bytes,
+ *  memory beyond that goes back to the heap. so a burst of deep coverage
+ *  does not stay allocated for the rest of the iteration.
+ *
+ *  PlacementRecordWhack may be called on any thread, so the free lists
+ *  and the refcount are guarded by a lock of the pool. it is taken once
+ *  per alloc and free and never contended by a single-threaded reader.
+ */
+#define PLACEMENT_POOL_MIN_SHIFT 7                      /* smallest class: 128 bytes */
+#define PLACEMENT_POOL_CLASSES 10                       /* largest class: 64 KB */
+#define PLACEMENT_POOL_NO_CLASS PLACEMENT_POOL_CLASSES  /* too large to be recycled */
+#define PLACEMENT_POOL_MAX_FREE ( 256U * 1024 )         /* bytes kept per class */
+#define PLACEMENT_POOL_SLOT_SIZE 32                     /* keeps the record 16-byte aligned */
+
+typedef struct PlacementRecordSlot PlacementRecordSlot;
+typedef struct PlacementRecordPool PlacementRecordPool;
+
+struct PlacementRecordSlot
+{
+    PlacementRecordPool * pool;     /* NULL if not pooled */
+    PlacementRecordSlot * next;     /* next free slot while in the pool */
+    uint32_t size_class;
+    uint8_t align_pad[ PLACEMENT_POOL_SLOT_SIZE - 2 * sizeof( void * ) - sizeof( uint32_t ) ];
+};
+
+struct PlacementRecordPool
+{
+    PlacementRecordSlot * free_list[ PLACEMENT_POOL_CLASSES ];
+    uint32_t free_count[ PLACEMENT_POOL_CLASSES ];
+    uint32_t refcount;
+    KLock * lock;
+};
+
+
+static PlacementRecordPool * PlacementRecordPoolMake( void )
+{
+    PlacementRecordPool * pool = ( PlacementRecordPool * )calloc( 1, sizeof *pool );
+    if ( pool != NULL )
+    {
+        if ( KLockMake( &pool->lock ) != 0 )
+        {
+            free( pool );
+            return NULL;
+        }
+        pool->refcount = 1;
+    }
+    return pool;
+}
+
+
+static void PlacementRecordPoolWhack( PlacementRecordPool * pool )
+{
+    uint32_t i;
+    for ( i = 0; i < PLACEMENT_POOL_CLASSES; ++i )
+    {
+        PlacementRecordSlot * slot = pool->free_list[ i ];
+        while ( slot != NULL )
+        {
+            PlacementRecordSlot * next = slot->next;
+            free( slot );
+            slot = next;
+        }
+    }
+    KLockRelease( pool->lock );
+    free( pool );
+}
+
+
+static void PlacementRecordPoolRelease( PlacementRecordPool * pool )
+{
+    if ( pool != NULL )
+    {
+        uint32_t refcount;
+
+        KLockAcquire( pool->lock );
+        refcount = --pool->refcount;
+        KLockUnlock( pool->lock );
+
+        if ( refcount == 0 )
+            PlacementRecordPoolWhack( pool );
+    }
+}
+
+
+/* returns a zeroed record of 'size' bytes, recycled from the pool if possible */
+static void * PlacementRecordAlloc( PlacementRecordPool * pool, size_t size )
+{
+    PlacementRecordSlot * slot = NULL;
+    size_t slot_size = ( sizeof *slot ) + size;
+    uint32_t size_class = 0;
+
+    while ( size_class < PLACEMENT_POOL_CLASSES &&
+            ( ( size_t )1 << ( PLACEMENT_POOL_MIN_SHIFT + size_class ) ) < slot_size )
+        ++size_class;
+
+    if ( pool == NULL )
+        size_class = PLACEMENT_POOL_NO_CLASS;
+    else if ( size_class != PLACEMENT_POOL_NO_CLASS )
+    {
+        KLockAcquire( pool->lock );
+        slot = pool->free_list[ size_class ];
+        if ( slot != NULL )
+        {
+            pool->free_list[ size_class ] = slot->next;
+            --pool->free_count[ size_class ];
+            ++pool->refcount;
+        }
+        KLockUnlock( pool->lock );
+
+        if ( slot == NULL )
+            slot_size = ( size_t )1 << ( PLACEMENT_POOL_MIN_SHIFT + size_class );
+    }
+
+    if ( slot == NULL )
+    {
+        slot = ( PlacementRecordSlot * )malloc( slot_size );
+        if ( slot == NULL )
+            return NULL;
+        if ( pool != NULL )
+        {
+            KLockAcquire( pool->lock );
+            ++pool->refcount;
+            KLockUnlock( pool->lock );
+        }
+    }
+
+    slot->pool = pool;
+    slot->next = NULL;
+    slot->size_class = size_class;
+
+    memset( slot + 1, 0, size );
+    return slot + 1;
+}
+
+
+/* hands the memory of a record back to its pool, or frees it */
+static void PlacementRecordFree( void * rec )
+{
+    PlacementRecordSlot * slot = ( ( PlacementRecordSlot * )rec ) - 1;
+    PlacementRecordPool * pool = slot->pool;
+    uint32_t size_class = slot->size_class;
+    uint32_t refcount;
+
+    if ( pool == NULL )
+    {
+        free( slot );
+        return;
+    }
+
+    KLockAcquire( pool->lock );
+    if ( size_class != PLACEMENT_POOL_NO_CLASS &&
+         pool->free_count[ size_class ] <
+            ( PLACEMENT_POOL_MAX_FREE >> ( PLACEMENT_POOL_MIN_SHIFT + size_class ) ) )
+    {
+        slot->next = pool->free_list[ size_class ];
+        pool->free_list[ size_class ] = slot;
+        ++pool->free_count[ size_class ];
+        slot = NULL;
+    }
+    refcount = --pool->refcount;
+    KLockUnlock( pool->lock );
+
+    free( slot );
+    if ( refcount == 0 )
+        PlacementRecordPoolWhack( pool );
+}
+
+#endif /* _h_align_placement_pool_ */
@@ -861,3 +861,131 @@ LIB_EXPORT uint32_t CC ReferenceIteratorBasesDeleted ( const ReferenceIterator *
     }
     return res;
 }
+
+
+/* one placement: mark its ends in the difference-array */
+static void coverage_add_depth( uint32_t * depth, const PlacementRecord *rec,
+                                INSDC_coord_zero first_pos, INSDC_coord_len len )
+{
+    int64_t start = ( int64_t )rec->pos - first_pos;
+    int64_t end = start + rec->len;
+
+    if ( start < 0 ) start = 0;
+    if ( end > len ) end = len;
+    if ( start < end )
+    {
+        /* unsigned wrap-around cancels out in the prefix-sum */
+        depth[ start ]++;
+        if ( end < len )
+            depth[ end ]--;
+    }
+}
+
+
+/* one placement: walk its alignment-iterator along the window */
+static void coverage_add_counts( ReferenceIteratorBaseCounts * counts, const PlacementRecord *rec,
+                                 INSDC_coord_zero first_pos, INSDC_coord_len len )
+{
+    AlignmentIterator * al_iter = PlacementRecordCast ( rec, placementRecordExtension0 );
+    INSDC_coord_zero pos;
+
+    if ( al_iter == NULL || AlignmentIteratorPosition ( al_iter, &pos ) != 0 )
+        return;
+
+    do
+    {
+        int32_t state;
+        ReferenceIteratorBaseCounts * c;
+
+        if ( pos >= first_pos + ( int64_t )len )
+            break;
+
+        state = AlignmentIteratorState ( al_iter, NULL );
+        if ( ( state & align_iter_invalid ) == align_iter_invalid )
+            break;
+
+        if ( pos >= first_pos )
+        {
+            c = &counts[ pos - first_pos ];
+            if ( ( state & align_iter_skip ) == align_iter_skip )
+                c->deletions++;
+            else if ( ( state & align_iter_match ) == align_iter_match )
+                c->matches++;
+            else
+            {
+                switch ( state & 0x0F )
+                {
+                    case 1  : c->mismatches[ 0 ]++; break;
+                    case 2  : c->mismatches[ 1 ]++; break;
+                    case 4  : c->mismatches[ 2 ]++; break;
+                    case 8  : c->mismatches[ 3 ]++; break;
+                    default : c->mismatches[ 4 ]++; break;
+                }
+            }
+            if ( ( state & align_iter_insert ) == align_iter_insert )
+                c->insertions++;
+        }
+        pos++;
+    } while ( AlignmentIteratorNext ( al_iter ) == 0 );
+}
+
+
+LIB_EXPORT rc_t CC ReferenceIteratorCoverage ( ReferenceIterator *self,
+    INSDC_coord_zero first_pos, INSDC_coord_len len,
+    uint32_t * depth, ReferenceIteratorBaseCounts * counts )
+{
+    rc_t rc = 0;
+    if ( self == NULL )
+        rc = RC( rcAlign, rcIterator, rcAccessing, rcSelf, rcNull );
+    else if ( len == 0 || ( depth == NULL && counts == NULL ) )
+        rc = RC( rcAlign, rcIterator, rcAccessing, rcParam, rcInvalid );
+    else if ( !self->need_init )
+        /* NextPos has already started on this window */
+        rc = RC( rcAlign, rcIterator, rcAccessing, rcSelf, rcInvalid );
+    else
+    {
+        INSDC_coord_zero pos;
+
+        if ( depth != NULL )
+            memset( depth, 0, len * sizeof *depth );
+        if ( counts != NULL )
+            memset( counts, 0, len * sizeof *counts );
+
+        /* take every placement of the window exactly once, instead of keeping
+           it in the spot-group lists for the whole of its length */
+        while ( rc == 0 &&
+                ( rc = PlacementSetIteratorNextAvailPos ( self->pl_set_iter, &pos, NULL ) ) == 0 )
+        {
+            const PlacementRecord *rec;
+            while ( ( rc = PlacementSetIteratorNextRecordAt ( self->pl_set_iter, pos, &rec ) ) == 0 )
+            {
+                if ( rec->pos == pos )
+                {
+                    if ( depth != NULL )
+                        coverage_add_depth( depth, rec, first_pos, len );
+                    if ( counts != NULL )
+                        coverage_add_counts( counts, rec, first_pos, len );
+                }
+                PlacementRecordWhack ( rec );
+            }
+            if ( GetRCState( rc ) == rcDone ) rc = 0;
+        }
+        if ( GetRCState( rc ) == rcDone ) rc = 0;
+
+        if ( rc == 0 && depth != NULL )
+        {
+            uint32_t i;
+            for ( i = 1; i < len; ++i )
+                depth[ i ] += depth[ i - 1 ];
+        }
+
+        /* the window is used up */
+        self->need_init = false;
+        self->depth = 0;
+        self->current_pos = first_pos + len - 1;
+        self->last_pos = self->current_pos;
+        self->current_spot_group = NULL;
+        self->current_rec = NULL;
+    }
+    return rc;
+}
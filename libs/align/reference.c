@@ -45,6 +45,7 @@
 
 #include "reader-cmn.h"
 #include "reference-cmn.h"
+#include "placement-pool.h"
 #include "debug.h"
 
 #include <stdlib.h>
@@ -1154,7 +1155,7 @@ LIB_EXPORT void CC PlacementRecordWhack( const PlacementRecord *cself )
             ext_info[ 0 ].destroy( obj, ext_info[ 0 ].data );
         }
         /* now deallocate ( or put back into pool ) */
-        free( self );
+        PlacementRecordFree( self );
     }
 }
 
@@ -1198,6 +1199,9 @@ struct PlacementIterator
 
     const VCursor* align_curs;
     void * placement_ctx;           /* source-specific context */
+
+    /* recycles the records handed out, may be NULL */
+    PlacementRecordPool * rec_pool;
 };
 
 
@@ -1310,6 +1314,8 @@ LIB_EXPORT rc_t CC ReferenceObj_MakePlacementIterator ( const ReferenceObj* csel
             ReferenceObj_AddRef( o->obj );
             o->min_mapq = min_mapq;
             o->placement_ctx = placement_ctx;
+            /* without a pool records are plainly allocated */
+            o->rec_pool = PlacementRecordPoolMake();
 
             if ( ext_0 != NULL )
             {
@@ -1449,6 +1455,7 @@ LIB_EXPORT rc_t CC PlacementIteratorRelease ( const PlacementIterator *cself )
         PlacementIterator* self = ( PlacementIterator* )cself;
 
         VectorWhack( &self->ids, PlacementIterator_whack_recs, NULL );
+        PlacementRecordPoolRelease( self->rec_pool );
 
         if ( self->ref_reader != self->obj->mgr->reader )
         {
@@ -1602,7 +1609,7 @@ static rc_t allocate_populate_rec( const PlacementIterator *cself,
         
         /* allocate the record ( or take it from a pool ) */
         total_size = ( sizeof **rec ) + spot_group_len + ( 2 * ( sizeof *ext_info ) ) + size0 + size1;
-        *rec = calloc( 1, total_size );
+        *rec = PlacementRecordAlloc( cself->rec_pool, total_size );
         if ( *rec == NULL )
         {
             rc = RC( rcAlign, rcType, rcAccessing, rcMemory, rcExhausted );
@@ -1691,7 +1698,7 @@ static rc_t allocate_populate_rec( const PlacementIterator *cself,
             if ( rc != 0 )
             {
                 /* free */
-                free( *rec );
+                PlacementRecordFree( *rec );
                 *rec = NULL;
             }
         }
@@ -33,6 +33,7 @@
 #include <klib/text.h>
 #include <kfs/mmap.h>
 #include <kfs/file.h>
+#include <kproc/thread.h>
 #include <kdb/manager.h>
 #include <vdb/database.h>
 #include <vdb/table.h>
@@ -52,6 +53,7 @@
 #include "debug.h"
 #include <os-native.h>
 #include <sysalloc.h>
+#include <atomic32.h>
 
 #include <stdio.h>
 #include <stdlib.h>
@@ -203,6 +205,7 @@ struct ReferenceMgr {
     uint32_t num_open_max;
     uint32_t num_open;
     uint32_t max_seq_len;
+    uint32_t import_threads;    /* for multi-sequence fasta files */
     
     KDataBuffer compress;       /* [compress_buffer_t]  */
     KDataBuffer seq;            /* [byte](max_seq_len)  */
@@ -600,8 +603,34 @@ rc_t ReferenceMgr_FastaFile_GetSeqIds(KDataBuffer *const buf, char const data[],
     return 0;
 }
 
+enum {
+    fasta_map_skip = -1,
+    fasta_map_invalid = -2
+};
+
+/* what every byte of a fasta sequence turns into:
+ * upper-cased base, X as N, whitespace dropped, anything else rejected */
+static
+void ReferenceMgr_FastaMap(int16_t map[256])
+{
+    int i;
+    
+    for (i = 0; i != 256; ++i) {
+        int const ch = toupper(i);
+        
+        if (isspace(ch))
+            map[i] = fasta_map_skip;
+        else if (strchr(INSDC_4na_map_CHARSET, ch) == NULL && ch != 'X')
+            map[i] = fasta_map_invalid;
+        else
+            map[i] = ch == 'X' ? 'N' : ch;
+    }
+}
+
+/* map is built once per file by ReferenceMgr_FastaMap */
 static
-rc_t ReferenceMgr_ImportFasta(ReferenceMgr *const self, ReferenceSeq *obj, KDataBuffer *const buf)
+rc_t ReferenceMgr_ImportFasta(ReferenceMgr *const self, ReferenceSeq *obj, KDataBuffer *const buf,
+                              int16_t const map[256])
 {
     unsigned seqId;
     unsigned seqIdLen;
@@ -648,20 +677,20 @@ rc_t ReferenceMgr_ImportFasta(ReferenceMgr *const self, ReferenceSeq *obj, KData
     if (obj->fastaSeqId == NULL)
         return RC(rcAlign, rcFile, rcReading, rcMemory, rcExhausted);
     
-    MD5StateInit(&mds);
     for (dst = src = start; src != len; ++src) {
-        int const ch = toupper(data[src]);
+        int const ch = map[(uint8_t)data[src]];
         
-        if (isspace(ch))
+        if (ch == fasta_map_skip)
             continue;
         
-        if (strchr(INSDC_4na_map_CHARSET, ch) == NULL && ch != 'X')
+        if (ch == fasta_map_invalid)
             return RC(rcAlign, rcFile, rcReading, rcData, rcInvalid);
         
-        data[dst] = ch == 'X' ? 'N' : ch;
-        MD5StateAppend(&mds, data + dst, 1);
-        ++dst;
+        data[dst++] = (char)ch;
     }
+    /* hash the cleaned up sequence in one go rather than base by base */
+    MD5StateInit(&mds);
+    MD5StateAppend(&mds, data + start, dst - start);
     MD5StateFinish(&mds, obj->md5);
     rc = KDataBufferSub(buf, &obj->u.local.buf, start, dst - start);
     if (rc == 0) {
@@ -674,6 +703,112 @@ rc_t ReferenceMgr_ImportFasta(ReferenceMgr *const self, ReferenceSeq *obj, KData
 }
 
 #define READ_CHUNK_SIZE (1024 * 1024)
+#define DEFAULT_IMPORT_THREADS 4
+#define PARALLEL_IMPORT_MIN_SIZE (4 * 1024 * 1024)
+
+/* sequences of a fasta file are cleaned up and hashed concurrently,
+ * each by one thread, then added to the manager in file order */
+typedef struct FastaImportJob {
+    ReferenceMgr *mgr;
+    KDataBuffer const *fbuf;
+    uint64_t const *seqIdOffset;
+    uint64_t file_size;
+    unsigned seqIds;
+    int16_t const *map;         /* [256] */
+    atomic32_t next;            /* next sequence to be taken */
+    ReferenceSeq *seq;          /* [seqIds] */
+    rc_t *seq_rc;               /* [seqIds] */
+} FastaImportJob;
+
+static
+rc_t CC ReferenceMgr_FastaImportWorker(KThread const *const th, void *const data)
+{
+    FastaImportJob *const job = data;
+    
+    for ( ; ; ) {
+        unsigned const i = (unsigned)atomic32_read_and_add(&job->next, 1);
+        uint64_t ofs;
+        uint64_t nxt;
+        KDataBuffer sub;
+        
+        if (i >= job->seqIds)
+            break;
+        
+        ofs = job->seqIdOffset[i];
+        nxt = (i < job->seqIds - 1) ? job->seqIdOffset[i + 1] : job->file_size;
+        memset(&sub, 0, sizeof(sub));
+        job->seq_rc[i] = KDataBufferSub(job->fbuf, &sub, ofs, nxt - ofs);
+        if (job->seq_rc[i] == 0) {
+            job->seq_rc[i] = ReferenceMgr_ImportFasta(job->mgr, &job->seq[i], &sub, job->map);
+            KDataBufferWhack(&sub);
+        }
+    }
+    return 0;
+}
+
+static
+rc_t ReferenceMgr_ImportFastaParallel(ReferenceMgr *const self, KDataBuffer const *fbuf,
+                                      uint64_t const seqIdOffset[], unsigned const seqIds,
+                                      uint64_t const file_size, int16_t const map[256])
+{
+    unsigned const nthreads = self->import_threads < seqIds ? self->import_threads : seqIds;
+    FastaImportJob job;
+    KThread **th;
+    unsigned started;
+    unsigned i;
+    rc_t rc = 0;
+    
+    memset(&job, 0, sizeof(job));
+    job.mgr = self;
+    job.fbuf = fbuf;
+    job.seqIdOffset = seqIdOffset;
+    job.file_size = file_size;
+    job.seqIds = seqIds;
+    job.map = map;
+    atomic32_set(&job.next, 0);
+    job.seq = calloc(seqIds, sizeof(job.seq[0]));
+    job.seq_rc = calloc(seqIds, sizeof(job.seq_rc[0]));
+    th = calloc(nthreads, sizeof(th[0]));
+    if (job.seq == NULL || job.seq_rc == NULL || th == NULL) {
+        free(job.seq);
+        free(job.seq_rc);
+        free(th);
+        return RC(rcAlign, rcFile, rcReading, rcMemory, rcExhausted);
+    }
+    
+    /* this thread is one of the workers; if a thread can't be started
+     * the others simply take on more of the sequences */
+    for (started = 0; started + 1 < nthreads; ++started) {
+        if (KThreadMake(&th[started], ReferenceMgr_FastaImportWorker, &job) != 0)
+            break;
+    }
+    ReferenceMgr_FastaImportWorker(NULL, &job);
+    for (i = 0; i != started; ++i) {
+        rc_t status;
+        
+        KThreadWait(th[i], &status);
+        KThreadRelease(th[i]);
+    }
+    free(th);
+    
+    /* same order and same first error as the sequential import */
+    for (i = 0; i != seqIds; ++i) {
+        if (rc == 0 && (rc = job.seq_rc[i]) == 0) {
+            ReferenceSeq *new_seq;
+            
+            rc = ReferenceMgr_NewReferenceSeq(self, &new_seq);
+            if (rc == 0) {
+                *new_seq = job.seq[i];
+                continue;
+            }
+        }
+        ReferenceSeq_Whack(&job.seq[i]);
+    }
+    free(job.seq);
+    free(job.seq_rc);
+    
+    return rc;
+}
 
 static
 rc_t ReferenceMgr_ImportFastaFile(ReferenceMgr *const self, KFile const *kf,
@@ -711,16 +846,20 @@ rc_t ReferenceMgr_ImportFastaFile(ReferenceMgr *const self, KFile const *kf,
                     unsigned const seqIds = (unsigned)seqIdBuf.elem_count;
                     unsigned i;
                     KDataBuffer sub;
+                    int16_t map[256];
                     
+                    ReferenceMgr_FastaMap(map);
                     if (rslt) {
                         if (seqIds > 1)
                             rc = RC(rcAlign, rcFile, rcReading, rcItem, rcUnexpected);
                         
                         memset(&sub, 0, sizeof(sub));
                         KDataBufferSub(&fbuf, &sub, seqIdOffset[0], file_size - seqIdOffset[0]);
-                        rc = ReferenceMgr_ImportFasta(self, rslt, &sub);
+                        rc = ReferenceMgr_ImportFasta(self, rslt, &sub, map);
                         KDataBufferWhack(&sub);
                     }
+                    else if (seqIds > 1 && self->import_threads > 1 && file_size >= PARALLEL_IMPORT_MIN_SIZE)
+                        rc = ReferenceMgr_ImportFastaParallel(self, &fbuf, seqIdOffset, seqIds, file_size, map);
                     else
                         for (i = 0; i != seqIds; ++i) {
                             uint64_t const ofs = seqIdOffset[i];
@@ -731,7 +870,7 @@ rc_t ReferenceMgr_ImportFastaFile(ReferenceMgr *const self, KFile const *kf,
                             
                             memset(&sub, 0, sizeof(sub));
                             KDataBufferSub(&fbuf, &sub, ofs, len);
-                            rc = ReferenceMgr_ImportFasta(self, &tmp, &sub);
+                            rc = ReferenceMgr_ImportFasta(self, &tmp, &sub, map);
                             KDataBufferWhack(&sub);
                             if (rc) break;
                             
@@ -1210,6 +1349,14 @@ LIB_EXPORT rc_t CC ReferenceMgr_SetCache(ReferenceMgr const *const self, size_t
     return RefSeqMgr_SetCache(self->rmgr, cache, num_open);
 }
 
+LIB_EXPORT rc_t CC ReferenceMgr_SetImportThreads(ReferenceMgr const *const self, uint32_t num_threads)
+{
+    if (self == NULL)
+        return RC(rcAlign, rcIndex, rcUpdating, rcSelf, rcNull);
+    ((ReferenceMgr *)self)->import_threads = num_threads;
+    return 0;
+}
+
 static
 rc_t OpenDataDirectory(KDirectory const **rslt, char const path[])
 {
@@ -1257,6 +1404,7 @@ LIB_EXPORT rc_t CC ReferenceMgr_Make(ReferenceMgr const **cself, VDatabase *db,
             self->cache = cache;
             self->num_open_max = num_open;
             self->max_seq_len = max_seq_len;
+            self->import_threads = DEFAULT_IMPORT_THREADS;
             if (db) VDatabaseAddRef(self->db = db);
             rc = OpenDataDirectory(&self->dir, path);
             if (rc == 0) {
@@ -28,6 +28,7 @@
 #include "colidx-priv.h"
 #include "idxblk-priv.h"
 #include <kfs/file.h>
+#include <klib/prof.h>
 #include <klib/rc.h>
 #include <sysalloc.h>
 
@@ -73,9 +74,11 @@ rc_t KColumnIdxOpenRead ( KColumnIdx *self, const KDirectory *dir,
     rc_t rc;
     uint64_t idx2_eof;
     uint32_t idx0_count;
+    KPROF_SITE ( open, KPROF_KDB, "colidx-open" );
 
     assert ( self != NULL );
 
+    KPROF_START ( open );
     rc = KColumnIdx1OpenRead ( & self -> idx1,
         dir, data_eof, & idx0_count, & idx2_eof, pgsize, checksum );
     if ( rc == 0 )
@@ -89,6 +92,7 @@ rc_t KColumnIdxOpenRead ( KColumnIdx *self, const KDirectory *dir,
             if ( rc == 0 || GetRCState ( rc ) == rcNotFound )
             {
                 KColumnIdxEstablishIdRange ( self );
+                KPROF_STOP ( open );
                 return 0;
             }
 
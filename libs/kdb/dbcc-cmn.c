@@ -29,40 +29,91 @@
 #include <kfs/directory.h>
 #include <kfs/file.h>
 #include <kfs/md5.h>
+#include <klib/checksum.h>
+#include <klib/rc.h>
 
 #include "cc-priv.h"
 #include <os-native.h>
 
 #include <stdio.h> /* for sprintf */
+#include <stdlib.h>
 #include <string.h>
 
-static
-rc_t FileCheckMD5(const KDirectory *dir, const char name[], const uint8_t digest[])
+/* files listed in one md5 file are hashed side by side,
+   MD5_BATCH at a time, reading MD5_CHUNK bytes from each in turn */
+#define MD5_BATCH 8
+#define MD5_CHUNK ( 64 * 1024 )
+
+typedef struct MD5Entry MD5Entry;
+struct MD5Entry
 {
-    rc_t rc;
     const KFile *fp;
-    const KFile *mds;
+    const char *path;
     uint64_t pos;
-    size_t nr;
-    char buf[4096];
-    
-    rc = KDirectoryOpenFileRead(dir, &fp, "%s", name);
-    if (rc)
-        return rc;
-    rc = KFileMakeMD5Read(&mds, fp, digest);
-    if (rc) {
-        KFileRelease(fp);
-        return rc;
+    rc_t rc;
+    bool done;
+    MD5State md5;
+    uint8_t digest[16];
+    char pathbuf[4096];
+};
+
+static
+void FileCheckMD5Batch(const KDirectory *dir, MD5Entry entry[], uint32_t count, uint8_t *buffer)
+{
+    uint32_t i;
+    uint32_t remaining = 0;
+
+    for (i = 0; i != count; ++i) {
+        MD5Entry *e = &entry[i];
+
+        MD5StateInit(&e->md5);
+        e->fp = NULL;
+        e->pos = 0;
+        e->rc = KDirectoryOpenFileRead(dir, &e->fp, "%s", e->path);
+        e->done = e->rc != 0;
+        if (!e->done)
+            ++remaining;
     }
-    for (pos = 0; ; ) {
-        rc = KFileRead(mds, pos, buf, sizeof(buf), &nr);
-        if (rc || nr == 0)
-            break;
-        pos += nr;
+
+    while (remaining != 0) {
+        MD5State *md5[MD5_BATCH];
+        const void *data[MD5_BATCH];
+        size_t size[MD5_BATCH];
+
+        for (i = 0; i != count; ++i) {
+            MD5Entry *e = &entry[i];
+
+            md5[i] = NULL;
+            data[i] = NULL;
+            size[i] = 0;
+            if (e->done)
+                continue;
+
+            e->rc = KFileRead(e->fp, e->pos, &buffer[i * MD5_CHUNK], MD5_CHUNK, &size[i]);
+            if (e->rc != 0 || size[i] == 0) {
+                e->done = true;
+                --remaining;
+                continue;
+            }
+            md5[i] = &e->md5;
+            data[i] = &buffer[i * MD5_CHUNK];
+            e->pos += size[i];
+        }
+        MD5StateAppendMulti(md5, data, size, count);
     }
-    KFileRelease(mds);
 
-    return rc;
+    for (i = 0; i != count; ++i) {
+        MD5Entry *e = &entry[i];
+
+        if (e->rc == 0) {
+            uint8_t digest[16];
+
+            MD5StateFinish(&e->md5, digest);
+            if (memcmp(digest, e->digest, sizeof digest) != 0)
+                e->rc = RC(rcFS, rcFile, rcReading, rcFile, rcCorrupt);
+        }
+        KFileRelease(e->fp);
+    }
 }
 
 rc_t DirectoryCheckMD5(const KDirectory *dir, const char name[],
@@ -73,10 +124,10 @@ rc_t DirectoryCheckMD5(const KDirectory *dir, const char name[],
     rc_t rc2 = 0;
     const KFile *kf;
     const KMD5SumFmt *sum;
+    MD5Entry *entry;
+    uint8_t *buffer;
     uint32_t i;
     uint32_t n;
-    uint8_t digest[16];
-    char pathbuf[4096];
     char mesg[1024];
     
     mesg[0] = '\0';
@@ -100,30 +151,52 @@ rc_t DirectoryCheckMD5(const KDirectory *dir, const char name[],
     rc = KMD5SumFmtCount(sum, &n);
     if (rc)
         return rc;
-    for (i = 0; i != n; ++i) {
-        char *path = pathbuf;
-        rc = KMD5SumFmtGet(sum, i, pathbuf, sizeof(pathbuf), digest, NULL);
-        if (rc)
-            break;
+    entry = malloc(MD5_BATCH * (sizeof(*entry) + MD5_CHUNK));
+    if (entry == NULL) {
+        KMD5SumFmtRelease(sum);
+        return RC(rcDB, rcFile, rcValidating, rcMemory, rcExhausted);
+    }
+    buffer = (uint8_t *)&entry[MD5_BATCH];
+    for (i = 0; i != n; ) {
+        uint32_t j;
+        uint32_t count = 0;
 
-        /* catch case where skey.md5 contains full path */
-        if ( path [ 0 ] == '/' )
-        {
-            size_t sz = strlen ( path );
-            if ( sz >= 5 && strcmp ( & path [ sz - 5 ], "/skey" ) == 0 )
-                path = "skey";
+        for ( ; i != n && count != MD5_BATCH; ++i) {
+            MD5Entry *e = &entry[count];
+            rc = KMD5SumFmtGet(sum, i, e->pathbuf, sizeof(e->pathbuf), e->digest, NULL);
+            if (rc)
+                break;
+
+            /* catch case where skey.md5 contains full path */
+            e->path = e->pathbuf;
+            if ( e->path [ 0 ] == '/' )
+            {
+                size_t sz = strlen ( e->path );
+                if ( sz >= 5 && strcmp ( & e->path [ sz - 5 ], "/skey" ) == 0 )
+                    e->path = "skey";
+            }
+            ++count;
         }
 
-        rc = FileCheckMD5(dir, path, digest);
-        if (rc2 == 0)
-            rc2 = rc;
-        nfo->type = ccrpt_MD5;
-        nfo->info.MD5.rc = rc;
-        nfo->info.MD5.file = path;
-        rc = report(nfo, ctx);
-        if ( rc != 0 )
+        FileCheckMD5Batch(dir, entry, count, buffer);
+
+        for (j = 0; j != count; ++j) {
+            rc_t rc3;
+            if (rc2 == 0)
+                rc2 = entry[j].rc;
+            nfo->type = ccrpt_MD5;
+            nfo->info.MD5.rc = entry[j].rc;
+            nfo->info.MD5.file = entry[j].path;
+            rc3 = report(nfo, ctx);
+            if ( rc3 != 0 ) {
+                rc = rc3;
+                break;
+            }
+        }
+        if (rc)
             break;
     }
+    free(entry);
     KMD5SumFmtRelease(sum);
     if (rc)
         return rc;
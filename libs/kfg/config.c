@@ -42,6 +42,7 @@ struct KfgConfigNamelist;
 #include <klib/log.h> 
 #include <klib/out.h> /* OUTMSG */
 #include <klib/klib-priv.h>
+#include <klib/prof.h>
 #include <kfs/directory.h>
 #include <kfs/gzip.h> /* KFileMakeGzipForRead */
 #include <kfs/subfile.h> /* KFileMakeSubRead */
@@ -2714,7 +2715,14 @@ rc_t CC KConfigMakeLocal(KConfig **cfg, const KDirectory *cfgdir)
  */
 LIB_EXPORT rc_t CC KConfigMake(KConfig **cfg, const KDirectory *cfgdir)
 {
-    return KConfigMakeImpl(cfg, cfgdir, false);
+    rc_t rc;
+    KPROF_SITE ( load, KPROF_KFG, "load" );
+
+    KPROF_START ( load );
+    rc = KConfigMakeImpl(cfg, cfgdir, false);
+    KPROF_STOP ( load );
+
+    return rc;
 }
 
 /*--------------------------------------------------------------------------
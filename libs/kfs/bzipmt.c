@@ -0,0 +1,826 @@
+/*===========================================================================
+ *
+ *                            PUBLIC DOMAIN NOTICE
+ *               National Center for Biotechnology Information
+ *
+ *  This software/database is a "United States Government Work" under the
+ *  terms of the United States Copyright Act.  It was written as part of
+ *  the author's official duties as a United States Government employee and
+ *  thus cannot be copyrighted.  This software/database is freely available
+ *  to the public for use. The National Library of Medicine and the U.S.
+ *  Government have not placed any restriction on its use or reproduction.
+ *
+ *  Although all reasonable efforts have been taken to ensure the accuracy
+ *  and reliability of the software and data, the NLM and the U.S.
+ *  Government do not and cannot warrant the performance or results that
+ *  may be obtained by using this software or data. The NLM and the U.S.
+ *  Government disclaim all warranties, express or implied, including
+ *  warranties of performance, merchantability or fitness for any particular
+ *  purpose.
+ *
+ *  Please cite the author in any work or product based on this material.
+ *
+ * ===========================================================================
+ *
+ */
+
+struct KBZipMTFile;
+#define KFILE_IMPL struct KBZipMTFile
+
+#include <kfs/extern.h>
+#include <kfs/impl.h>
+#include <kfs/bzip.h>
+#include <kproc/thread.h>
+#include <kproc/lock.h>
+#include <kproc/cond.h>
+#include <klib/rc.h>
+#include <sysalloc.h>
+
+#include <bzlib.h>
+#include <assert.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* a bzip2 stream is a 4 byte header "BZh1".."BZh9" followed by
+   blocks, each starting with a 48-bit magic number, and ends with
+   another 48-bit magic and a combined crc. blocks are bit aligned.
+
+   every block is cut out on the reading thread, given its own stream
+   header and trailer, and handed to a worker to decode on its own.
+   anything unexpected - including a block magic that turns out to be
+   an accident of the compressed data - sends the file back to the
+   serial decoder, so output and errors always match KBZipFile. */
+
+#define BZ2MT_CHUNK 0x20000             /* 128K */
+#define BZ2MT_DEFAULT_THREADS 4
+#define BZ2MT_BLOCK_MAGIC UINT64_C ( 0x314159265359 )
+#define BZ2MT_EOS_MAGIC UINT64_C ( 0x177245385090 )
+#define BZ2MT_MAGIC_BITS 48
+#define BZ2MT_CRC_BITS 32
+
+
+/*--------------------------------------------------------------------------
+ * KBZipMTBlock
+ *  one block, from cut-out to decoded output
+ */
+typedef struct KBZipMTBlock KBZipMTBlock;
+struct KBZipMTBlock
+{
+    KBZipMTBlock *next;
+    uint8_t *in;
+    uint8_t *out;
+    size_t in_size;
+    size_t out_size;
+    size_t out_cap;
+    rc_t rc;
+    bool done;
+};
+
+static
+void KBZipMTBlockWhack ( KBZipMTBlock *self )
+{
+    free ( self -> in );
+    free ( self -> out );
+    free ( self );
+}
+
+static
+rc_t KBZipMTBlockDecode ( KBZipMTBlock *self )
+{
+    rc_t rc = 0;
+    bz_stream strm;
+
+    memset ( & strm, 0, sizeof strm );
+    if ( BZ2_bzDecompressInit ( & strm, 0, 0 ) != BZ_OK )
+        return RC ( rcFS, rcFile, rcReading, rcMemory, rcExhausted );
+
+    strm . next_in = ( char* ) self -> in;
+    strm . avail_in = ( unsigned int ) self -> in_size;
+
+    while ( rc == 0 )
+    {
+        int zret;
+
+        if ( self -> out_size == self -> out_cap )
+        {
+            /* the initial run-length stage lets a block expand a lot */
+            size_t cap = self -> out_cap * 2;
+            void *p = realloc ( self -> out, cap );
+            if ( p == NULL )
+            {
+                rc = RC ( rcFS, rcFile, rcReading, rcMemory, rcExhausted );
+                break;
+            }
+            self -> out = p;
+            self -> out_cap = cap;
+        }
+
+        strm . next_out = ( char* ) self -> out + self -> out_size;
+        strm . avail_out = ( unsigned int ) ( self -> out_cap - self -> out_size );
+
+        zret = BZ2_bzDecompress ( & strm );
+        self -> out_size = self -> out_cap - strm . avail_out;
+
+        if ( zret == BZ_STREAM_END )
+            break;
+        if ( zret != BZ_OK )
+            rc = RC ( rcFS, rcFile, rcReading, rcData, rcCorrupt );
+        else if ( strm . avail_in == 0 && strm . avail_out != 0 )
+            rc = RC ( rcFS, rcFile, rcReading, rcData, rcInsufficient );
+    }
+
+    BZ2_bzDecompressEnd ( & strm );
+
+    free ( self -> in );
+    self -> in = NULL;
+
+    return rc;
+}
+
+
+/*--------------------------------------------------------------------------
+ * bit helpers - bzip2 packs bits most significant first
+ */
+static
+uint64_t get_bits ( const uint8_t *src, uint64_t bit, uint32_t count )
+{
+    uint64_t val = 0;
+    uint32_t i;
+    for ( i = 0; i < count; ++ i, ++ bit )
+        val = ( val << 1 ) | ( ( src [ bit >> 3 ] >> ( 7 - ( bit & 7 ) ) ) & 1 );
+    return val;
+}
+
+static
+void put_bits ( uint8_t *dst, uint64_t *bit, uint64_t val, uint32_t count )
+{
+    while ( count -- != 0 )
+    {
+        uint64_t b = * bit;
+        uint8_t mask = ( uint8_t ) ( 0x80 >> ( b & 7 ) );
+        if ( ( val >> count ) & 1 )
+            dst [ b >> 3 ] |= mask;
+        else
+            dst [ b >> 3 ] &= ~ mask;
+        * bit = b + 1;
+    }
+}
+
+
+/*--------------------------------------------------------------------------
+ * KBZipMTFile
+ */
+typedef struct KBZipMTFile KBZipMTFile;
+struct KBZipMTFile
+{
+    KFile dad;
+    const KFile *file;
+
+    /* serial decoder, once something did not add up */
+    const KFile *serial;
+
+    /* worker pool */
+    KThread **workers;
+    KLock *lock;
+    KCondition *work;
+    KCondition *done;
+    uint32_t nthreads;
+    bool quitting;
+
+    /* blocks in output order; "todo" is the first one not yet taken */
+    KBZipMTBlock *head;
+    KBZipMTBlock *tail;
+    KBZipMTBlock *todo;
+    uint32_t in_flight;
+    uint32_t max_in_flight;
+    size_t head_consumed;
+
+    /* compressed input not yet cut into blocks */
+    uint8_t *cbuf;
+    size_t cbuf_len;
+    size_t cbuf_cap;
+    uint64_t cbuf_pos;          /* file offset of cbuf [ 0 ] */
+    uint64_t blk_start;         /* absolute bit offset of the next block or header */
+    uint64_t search;            /* absolute bit offset where the magic search resumes */
+    uint32_t level;             /* block size of the current stream in 100K */
+    bool in_header;             /* a stream header is expected at "blk_start" */
+    bool in_eof;
+    bool out_eof;
+
+    uint64_t myPosition;
+};
+
+static
+rc_t CC KBZipMTWorker ( const KThread *t, void *data )
+{
+    KBZipMTFile *self = data;
+    rc_t rc = KLockAcquire ( self -> lock );
+    if ( rc == 0 )
+    {
+        while ( true )
+        {
+            KBZipMTBlock *blk;
+
+            while ( ! self -> quitting && self -> todo == NULL )
+                KConditionWait ( self -> work, self -> lock );
+            if ( self -> quitting )
+                break;
+
+            blk = self -> todo;
+            self -> todo = blk -> next;
+            KLockUnlock ( self -> lock );
+
+            blk -> rc = KBZipMTBlockDecode ( blk );
+
+            KLockAcquire ( self -> lock );
+            blk -> done = true;
+            KConditionBroadcast ( self -> done );
+        }
+        KLockUnlock ( self -> lock );
+    }
+    return rc;
+}
+
+/* StopWorkers
+ *  wait for the pool to finish what it is doing and drop all blocks
+ */
+static
+void KBZipMTFileStopWorkers ( KBZipMTFile *self )
+{
+    uint32_t i;
+
+    if ( self -> workers != NULL )
+    {
+        KLockAcquire ( self -> lock );
+        self -> quitting = true;
+        KConditionBroadcast ( self -> work );
+        KLockUnlock ( self -> lock );
+
+        for ( i = 0; i < self -> nthreads; ++ i )
+        {
+            if ( self -> workers [ i ] != NULL )
+            {
+                rc_t status;
+                KThreadWait ( self -> workers [ i ], & status );
+                KThreadRelease ( self -> workers [ i ] );
+            }
+        }
+        free ( self -> workers );
+        self -> workers = NULL;
+    }
+
+    while ( self -> head != NULL )
+    {
+        KBZipMTBlock *blk = self -> head;
+        self -> head = blk -> next;
+        KBZipMTBlockWhack ( blk );
+    }
+    self -> tail = self -> todo = NULL;
+    self -> in_flight = 0;
+
+    free ( self -> cbuf );
+    self -> cbuf = NULL;
+    self -> cbuf_len = self -> cbuf_cap = 0;
+}
+
+static rc_t CC KBZipMTFileDestroy ( KBZipMTFile *self )
+{
+    rc_t rc;
+
+    KBZipMTFileStopWorkers ( self );
+    KConditionRelease ( self -> done );
+    KConditionRelease ( self -> work );
+    KLockRelease ( self -> lock );
+    KFileRelease ( self -> serial );
+
+    rc = KFileRelease ( self -> file );
+    free ( self );
+    return rc;
+}
+
+/* Serial
+ *  give up on parallel decoding - the serial decoder
+ *  reproduces the same output, or the same error
+ */
+static
+rc_t KBZipMTFileSerial ( KBZipMTFile *self )
+{
+    KBZipMTFileStopWorkers ( self );
+    return KFileMakeBzip2ForRead ( & self -> serial, self -> file );
+}
+
+/* More
+ *  append the next chunk of compressed input
+ */
+static
+rc_t KBZipMTFileMore ( KBZipMTFile *self )
+{
+    rc_t rc;
+    size_t num_read;
+
+    if ( self -> in_eof )
+        return 0;
+
+    if ( self -> cbuf_cap - self -> cbuf_len < BZ2MT_CHUNK )
+    {
+        size_t cap = self -> cbuf_cap != 0 ? self -> cbuf_cap * 2 : BZ2MT_CHUNK * 8;
+        void *p;
+        while ( cap - self -> cbuf_len < BZ2MT_CHUNK )
+            cap *= 2;
+        p = realloc ( self -> cbuf, cap );
+        if ( p == NULL )
+            return RC ( rcFS, rcFile, rcReading, rcMemory, rcExhausted );
+        self -> cbuf = p;
+        self -> cbuf_cap = cap;
+    }
+
+    rc = KFileReadAll ( self -> file, self -> cbuf_pos + self -> cbuf_len,
+        self -> cbuf + self -> cbuf_len, BZ2MT_CHUNK, & num_read );
+    if ( rc == 0 )
+    {
+        self -> cbuf_len += num_read;
+        if ( num_read == 0 )
+            self -> in_eof = true;
+    }
+    return rc;
+}
+
+/* Have
+ *  make sure "bits" bits starting at absolute bit "start" are buffered
+ */
+static
+rc_t KBZipMTFileHave ( KBZipMTFile *self, uint64_t start, uint64_t bits, bool *have )
+{
+    rc_t rc = 0;
+    uint64_t end = ( start + bits + 7 ) >> 3;
+    while ( rc == 0 && self -> cbuf_pos + self -> cbuf_len < end && ! self -> in_eof )
+        rc = KBZipMTFileMore ( self );
+    * have = ( self -> cbuf_pos + self -> cbuf_len >= end );
+    return rc;
+}
+
+/* Discard
+ *  drop buffered input before byte offset "pos"
+ */
+static
+void KBZipMTFileDiscard ( KBZipMTFile *self, uint64_t pos )
+{
+    size_t drop = ( size_t ) ( pos - self -> cbuf_pos );
+    if ( drop > self -> cbuf_len )
+        drop = self -> cbuf_len;
+    if ( drop != 0 )
+    {
+        memmove ( self -> cbuf, self -> cbuf + drop, self -> cbuf_len - drop );
+        self -> cbuf_len -= drop;
+        self -> cbuf_pos += drop;
+    }
+}
+
+/* Find
+ *  search forward from "search" for either magic number.
+ *  "found" is false if the input ran out first.
+ */
+static
+rc_t KBZipMTFileFind ( KBZipMTFile *self, uint64_t *pos, bool *found )
+{
+    rc_t rc = 0;
+
+    * found = false;
+    while ( rc == 0 )
+    {
+        /* a 64-bit window at byte i covers magics starting at bits 0..15 */
+        size_t i = ( size_t ) ( ( self -> search >> 3 ) - self -> cbuf_pos );
+        while ( i + 8 <= self -> cbuf_len )
+        {
+            const uint8_t *p = self -> cbuf + i;
+            uint64_t w = ( ( uint64_t ) p [ 0 ] << 56 ) | ( ( uint64_t ) p [ 1 ] << 48 ) |
+                ( ( uint64_t ) p [ 2 ] << 40 ) | ( ( uint64_t ) p [ 3 ] << 32 ) |
+                ( ( uint64_t ) p [ 4 ] << 24 ) | ( ( uint64_t ) p [ 5 ] << 16 ) |
+                ( ( uint64_t ) p [ 6 ] << 8 ) | ( uint64_t ) p [ 7 ];
+            uint32_t k = ( uint32_t ) ( self -> search & 7 );
+            for ( ; k < 8; ++ k )
+            {
+                uint64_t m = ( w >> ( 16 - k ) ) & UINT64_C ( 0xFFFFFFFFFFFF );
+                if ( m == BZ2MT_BLOCK_MAGIC || m == BZ2MT_EOS_MAGIC )
+                {
+                    * pos = ( ( self -> cbuf_pos + i ) << 3 ) + k;
+                    self -> search = * pos + 1;
+                    * found = true;
+                    return 0;
+                }
+            }
+            ++ i;
+            self -> search = ( self -> cbuf_pos + i ) << 3;
+        }
+
+        if ( self -> in_eof )
+            break;
+        rc = KBZipMTFileMore ( self );
+    }
+    return rc;
+}
+
+/* Cut
+ *  turn bits [ start, end ) - one block - into a stream of its own
+ */
+static
+rc_t KBZipMTFileCut ( KBZipMTFile *self, uint64_t start, uint64_t end, KBZipMTBlock **blkp )
+{
+    const uint8_t *src = self -> cbuf;
+    uint64_t sbit = start - ( self -> cbuf_pos << 3 );
+    uint64_t nbits = end - start;
+    uint64_t crc = get_bits ( src, sbit + BZ2MT_MAGIC_BITS, BZ2MT_CRC_BITS );
+    size_t nbytes = ( size_t ) ( nbits >> 3 );
+    uint32_t shift = ( uint32_t ) ( sbit & 7 );
+    const uint8_t *s = src + ( sbit >> 3 );
+    uint64_t bit;
+    size_t i;
+
+    KBZipMTBlock *blk = calloc ( 1, sizeof * blk );
+    if ( blk == NULL )
+        return RC ( rcFS, rcFile, rcReading, rcMemory, rcExhausted );
+
+    blk -> in_size = 4 + ( size_t ) ( ( nbits + BZ2MT_MAGIC_BITS + BZ2MT_CRC_BITS + 7 ) >> 3 );
+    blk -> in = malloc ( blk -> in_size );
+    blk -> out_cap = ( size_t ) self -> level * 100000 + 1024;
+    blk -> out = malloc ( blk -> out_cap );
+    if ( blk -> in == NULL || blk -> out == NULL )
+    {
+        KBZipMTBlockWhack ( blk );
+        return RC ( rcFS, rcFile, rcReading, rcMemory, rcExhausted );
+    }
+
+    blk -> in [ 0 ] = 'B';
+    blk -> in [ 1 ] = 'Z';
+    blk -> in [ 2 ] = 'h';
+    blk -> in [ 3 ] = ( uint8_t ) ( '0' + self -> level );
+
+    /* whole bytes, realigned */
+    if ( shift == 0 )
+        memmove ( blk -> in + 4, s, nbytes );
+    else
+    {
+        for ( i = 0; i < nbytes; ++ i )
+            blk -> in [ 4 + i ] = ( uint8_t ) ( ( s [ i ] << shift ) | ( s [ i + 1 ] >> ( 8 - shift ) ) );
+    }
+
+    /* the odd bits, then a trailer whose combined crc is the block crc */
+    bit = ( uint64_t ) ( 4 + nbytes ) << 3;
+    put_bits ( blk -> in, & bit, get_bits ( src, sbit + ( ( uint64_t ) nbytes << 3 ), ( uint32_t ) ( nbits & 7 ) ), ( uint32_t ) ( nbits & 7 ) );
+    put_bits ( blk -> in, & bit, BZ2MT_EOS_MAGIC, BZ2MT_MAGIC_BITS );
+    put_bits ( blk -> in, & bit, crc, BZ2MT_CRC_BITS );
+    while ( ( bit & 7 ) != 0 )
+        put_bits ( blk -> in, & bit, 0, 1 );
+
+    assert ( ( bit >> 3 ) == blk -> in_size );
+
+    * blkp = blk;
+    return 0;
+}
+
+/* Scan
+ *  cut the next block from the input.
+ *  returns NULL in "blkp" at the clean end of input,
+ *  and rcUnexpected for anything the serial decoder should judge.
+ */
+static
+rc_t KBZipMTFileScan ( KBZipMTFile *self, KBZipMTBlock **blkp )
+{
+    rc_t rc = 0;
+    bool have;
+
+    * blkp = NULL;
+    while ( rc == 0 )
+    {
+        if ( self -> in_header )
+        {
+            const uint8_t *h;
+
+            KBZipMTFileDiscard ( self, self -> blk_start >> 3 );
+            rc = KBZipMTFileHave ( self, self -> blk_start, 32, & have );
+            if ( rc != 0 )
+                break;
+            if ( ! have )
+            {
+                if ( self -> cbuf_len == 0 )
+                    self -> out_eof = true;
+                else
+                    rc = RC ( rcFS, rcFile, rcReading, rcData, rcUnexpected );
+                break;
+            }
+
+            h = self -> cbuf;
+            if ( h [ 0 ] != 'B' || h [ 1 ] != 'Z' || h [ 2 ] != 'h' || h [ 3 ] < '1' || h [ 3 ] > '9' )
+            {
+                rc = RC ( rcFS, rcFile, rcReading, rcData, rcUnexpected );
+                break;
+            }
+
+            self -> level = h [ 3 ] - '0';
+            self -> blk_start += 32;
+            self -> in_header = false;
+        }
+        else
+        {
+            uint64_t magic, end;
+
+            rc = KBZipMTFileHave ( self, self -> blk_start, BZ2MT_MAGIC_BITS + BZ2MT_CRC_BITS, & have );
+            if ( rc != 0 )
+                break;
+            if ( ! have )
+            {
+                rc = RC ( rcFS, rcFile, rcReading, rcData, rcUnexpected );
+                break;
+            }
+
+            magic = get_bits ( self -> cbuf, self -> blk_start - ( self -> cbuf_pos << 3 ), BZ2MT_MAGIC_BITS );
+            if ( magic == BZ2MT_EOS_MAGIC )
+            {
+                /* next stream starts on the following byte boundary */
+                self -> blk_start = ( ( self -> blk_start + BZ2MT_MAGIC_BITS + BZ2MT_CRC_BITS + 7 ) >> 3 ) << 3;
+                self -> in_header = true;
+                continue;
+            }
+            if ( magic != BZ2MT_BLOCK_MAGIC )
+            {
+                rc = RC ( rcFS, rcFile, rcReading, rcData, rcUnexpected );
+                break;
+            }
+
+            if ( self -> search <= self -> blk_start )
+                self -> search = self -> blk_start + BZ2MT_MAGIC_BITS;
+            rc = KBZipMTFileFind ( self, & end, & have );
+            if ( rc != 0 )
+                break;
+            if ( ! have )
+            {
+                rc = RC ( rcFS, rcFile, rcReading, rcData, rcUnexpected );
+                break;
+            }
+
+            rc = KBZipMTFileCut ( self, self -> blk_start, end, blkp );
+            if ( rc == 0 )
+            {
+                self -> blk_start = end;
+                KBZipMTFileDiscard ( self, end >> 3 );
+            }
+            break;
+        }
+    }
+    return rc;
+}
+
+/* Dispatch
+ *  keep the pool busy
+ */
+static
+rc_t KBZipMTFileDispatch ( KBZipMTFile *self )
+{
+    rc_t rc = 0;
+    while ( rc == 0 && ! self -> out_eof && self -> in_flight < self -> max_in_flight )
+    {
+        KBZipMTBlock *blk;
+        rc = KBZipMTFileScan ( self, & blk );
+        if ( rc == 0 && blk != NULL )
+        {
+            rc = KLockAcquire ( self -> lock );
+            if ( rc != 0 )
+                KBZipMTBlockWhack ( blk );
+            else
+            {
+                if ( self -> tail == NULL )
+                    self -> head = blk;
+                else
+                    self -> tail -> next = blk;
+                self -> tail = blk;
+                if ( self -> todo == NULL )
+                    self -> todo = blk;
+                ++ self -> in_flight;
+                KConditionSignal ( self -> work );
+                KLockUnlock ( self -> lock );
+            }
+        }
+    }
+    return rc;
+}
+
+/* ReadInt
+ *  deliver decoded blocks in order
+ */
+static
+rc_t KBZipMTFileReadInt ( KBZipMTFile *self, void *buffer, size_t bsize, size_t *num_read )
+{
+    rc_t rc = 0;
+    size_t total = 0;
+
+    while ( rc == 0 && total < bsize )
+    {
+        KBZipMTBlock *blk;
+
+        rc = KBZipMTFileDispatch ( self );
+        if ( rc != 0 )
+            break;
+
+        blk = self -> head;
+        if ( blk == NULL )
+            break;
+
+        rc = KLockAcquire ( self -> lock );
+        if ( rc != 0 )
+            break;
+        while ( ! blk -> done )
+            KConditionWait ( self -> done, self -> lock );
+        KLockUnlock ( self -> lock );
+
+        rc = blk -> rc;
+        if ( rc == 0 )
+        {
+            size_t n = blk -> out_size - self -> head_consumed;
+            if ( n > bsize - total )
+                n = bsize - total;
+            memmove ( ( uint8_t* ) buffer + total, blk -> out + self -> head_consumed, n );
+            total += n;
+            self -> head_consumed += n;
+
+            if ( self -> head_consumed == blk -> out_size )
+            {
+                /* the workers never touch a finished block */
+                self -> head = blk -> next;
+                if ( self -> head == NULL )
+                    self -> tail = NULL;
+                -- self -> in_flight;
+                self -> head_consumed = 0;
+                KBZipMTBlockWhack ( blk );
+            }
+        }
+    }
+
+    * num_read = total;
+    return rc;
+}
+
+static rc_t CC KBZipMTFileRead ( const KBZipMTFile *cself, uint64_t pos,
+    void *buffer, size_t bsize, size_t *num_read )
+{
+    KBZipMTFile *self = ( KBZipMTFile* ) cself;
+    rc_t rc = 0;
+
+    * num_read = 0;
+
+    if ( pos < self -> myPosition )
+        return RC ( rcFS, rcFile, rcReading, rcParam, rcInvalid );
+
+    while ( self -> serial == NULL )
+    {
+        size_t n;
+        bool skipping = pos > self -> myPosition;
+
+        if ( skipping )
+        {
+            uint8_t skip [ 32 * 1024 ];
+            size_t to_skip = sizeof skip;
+            if ( pos - self -> myPosition < to_skip )
+                to_skip = ( size_t ) ( pos - self -> myPosition );
+            rc = KBZipMTFileReadInt ( self, skip, to_skip, & n );
+        }
+        else
+        {
+            rc = KBZipMTFileReadInt ( self, buffer, bsize, & n );
+        }
+
+        self -> myPosition += n;
+        if ( rc != 0 )
+        {
+            /* hand back what we have - the next read will fail over */
+            if ( ! skipping && n != 0 )
+            {
+                * num_read = n;
+                return 0;
+            }
+            rc = KBZipMTFileSerial ( self );
+            if ( rc != 0 )
+                return rc;
+        }
+        else if ( ! skipping )
+        {
+            * num_read = n;
+            return 0;
+        }
+        else if ( n == 0 )
+        {
+            /* end of file before "pos" */
+            return 0;
+        }
+    }
+
+    rc = KFileRead ( self -> serial, pos, buffer, bsize, num_read );
+    if ( rc == 0 )
+        self -> myPosition = pos + * num_read;
+    return rc;
+}
+
+static struct KSysFile *CC KBZipMTFileGetSysFile ( const KBZipMTFile *self, uint64_t *offset )
+{
+    return NULL;
+}
+
+static rc_t CC KBZipMTFileRandomAccess ( const KBZipMTFile *self )
+{
+    return RC ( rcFS, rcFile, rcAccessing, rcFunction, rcUnsupported );
+}
+
+static rc_t CC KBZipMTFileSize ( const KBZipMTFile *self, uint64_t *size )
+{
+    return RC ( rcFS, rcFile, rcAccessing, rcFunction, rcUnsupported );
+}
+
+static rc_t CC KBZipMTFileSetSize ( KBZipMTFile *self, uint64_t size )
+{
+    return RC ( rcFS, rcFile, rcUpdating, rcFunction, rcUnsupported );
+}
+
+static rc_t CC KBZipMTFileWrite ( KBZipMTFile *self, uint64_t pos,
+    const void *buffer, size_t size, size_t *num_writ )
+{
+    return RC ( rcFS, rcFile, rcWriting, rcFunction, rcUnsupported );
+}
+
+static uint32_t CC KBZipMTFileType ( const KBZipMTFile *self )
+{
+    return KFileType ( self -> file );
+}
+
+static KFile_vt_v1 vtKBZipMTFile =
+{
+    /* version */
+    1, 1,
+
+    /* 1.0 */
+    KBZipMTFileDestroy,
+    KBZipMTFileGetSysFile,
+    KBZipMTFileRandomAccess,
+    KBZipMTFileSize,
+    KBZipMTFileSetSize,
+    KBZipMTFileRead,
+    KBZipMTFileWrite,
+
+    /* 1.1 */
+    KBZipMTFileType
+};
+
+LIB_EXPORT rc_t CC KFileMakeBzip2ForParallelRead ( const KFile **bz,
+    const KFile *src, uint32_t threads )
+{
+    rc_t rc;
+    KBZipMTFile *obj;
+
+    if ( bz == NULL )
+        return RC ( rcFS, rcFile, rcConstructing, rcParam, rcNull );
+    * bz = NULL;
+    if ( src == NULL )
+        return RC ( rcFS, rcFile, rcConstructing, rcParam, rcNull );
+
+    if ( threads == 0 )
+        threads = BZ2MT_DEFAULT_THREADS;
+
+    obj = calloc ( 1, sizeof * obj );
+    if ( obj == NULL )
+        return RC ( rcFS, rcFile, rcConstructing, rcMemory, rcExhausted );
+
+    obj -> in_header = true;
+    obj -> max_in_flight = threads * 2;
+
+    rc = KFileInit ( & obj -> dad, ( const KFile_vt* ) & vtKBZipMTFile, "KBZipMTFile", "no-name", true, false );
+    if ( rc == 0 )
+        rc = KFileAddRef ( src );
+    if ( rc != 0 )
+    {
+        free ( obj );
+        return rc;
+    }
+    obj -> file = src;
+
+    rc = KLockMake ( & obj -> lock );
+    if ( rc == 0 )
+        rc = KConditionMake ( & obj -> work );
+    if ( rc == 0 )
+        rc = KConditionMake ( & obj -> done );
+    if ( rc == 0 )
+    {
+        obj -> workers = calloc ( threads, sizeof * obj -> workers );
+        if ( obj -> workers == NULL )
+            rc = RC ( rcFS, rcFile, rcConstructing, rcMemory, rcExhausted );
+        else
+        {
+            for ( obj -> nthreads = 0; rc == 0 && obj -> nthreads < threads; ++ obj -> nthreads )
+                rc = KThreadMake ( & obj -> workers [ obj -> nthreads ], KBZipMTWorker, obj );
+        }
+    }
+
+    if ( rc == 0 )
+        * bz = & obj -> dad;
+    else
+        KBZipMTFileDestroy ( obj );
+
+    return rc;
+}
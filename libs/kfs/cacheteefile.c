@@ -38,9 +38,13 @@ struct KCacheTeeFile;
 #include <klib/checksum.h>
 #include <klib/time.h>
 
+#include <kproc/lock.h>
+#include <kproc/cond.h>
+
 #include <kfs/cacheteefile.h>
 #include <kfs/defs.h>
 
+#include <atomic.h>
 #include <sysalloc.h>
 #include <stdlib.h>
 #include <string.h>
@@ -66,7 +70,9 @@ struct KCacheTeeFile;
  */
 
 #define CACHE_TEE_DEFAULT_BLOCKSIZE ( 32 * 1024 * 4 )
-#define CACHE_TEE_LOCKING 0
+
+/* how many idle scratch-buffers are kept around for concurrent readers */
+#define CACHE_TEE_SCRATCH_POOL 16
 
 #define CACHE_STAT 0
 
@@ -166,6 +172,15 @@ static void report_cache_stat( CacheStatistic * stat )
 #endif
 
 
+/* a scratch-buffer holds one block, every reader owns one for the duration of a read */
+typedef struct CacheTeeScratch
+{
+    uint64_t first_block;					/* what is the block-id of the block in the buffer */
+    size_t valid_bytes;						/* how many bytes store valid data in the buffer */
+    uint8_t buffer[ 1 ];					/* block_size bytes follow */
+} CacheTeeScratch;
+
+
 typedef struct KCacheTeeFile
 {
     KFile dad;
@@ -177,13 +192,14 @@ typedef struct KCacheTeeFile
     uint64_t local_size;					/* the size of the local cache file ( remote_size + bitmap + tail ) */
     uint64_t block_count;					/* how many blocks do we need to cache the remote file ( last block may be shorter ) */
 
-    uint8_t * bitmap;						/* the bitmap of cached blocks */
+    uint8_t * bitmap;						/* the bitmap of cached blocks ( allocated in whole atomic32_t words ) */
     uint64_t bitmap_bytes;					/* how many bytes do we need to store the bitmap */
 
-	uint8_t * scratch_buffer;
-    uint64_t first_block_in_scratch;		/* what is the block-id of the first block in the scratch-buffer */
-    uint64_t scratch_size;					/* how many bytes are allocated for the scratch-buffer */
-    uint64_t valid_scratch_bytes;			/* how many bytes store valid data in the scratch-buffer */
+    atomic32_t * busy;						/* bitmap of blocks currently downloaded by one of the readers */
+    KLock * fill_lock;						/* protects waiting for busy blocks and writing the bitmap into the local file */
+    KCondition * fill_done;					/* broadcasted every time a block leaves the busy state */
+
+    atomic_ptr_t scratch_pool[ CACHE_TEE_SCRATCH_POOL ];	/* idle scratch-buffers, taken and returned without locking */
 
     uint32_t block_size;					/* how big is a block ( aka 1 bit in the bitmap )*/
 
@@ -210,6 +226,8 @@ const uint8_t BitNr2Mask[ 8 ] =
 
 #define SIZE_2_BLOCK_COUNT( Number_Of_Bytes, Block_Size ) ( ( ( Number_Of_Bytes ) + ( Block_Size ) - 1 ) / ( Block_Size ) )
 
+#define BYTES_2_WORDS( ByteCount ) ( ( ( ByteCount ) + 3 ) >> 2 )
+
 
 static rc_t calculate_local_size_from_remote_size( KCacheTeeFile *self )
 {
@@ -251,7 +269,63 @@ static rc_t create_bitmap_buffer( uint8_t ** bitmap, uint64_t bitmap_bytes )
 */
 static rc_t create_bitmap( KCacheTeeFile *self )
 {
-    return create_bitmap_buffer( &self->bitmap, self->bitmap_bytes );
+    /* the bitmap is modified with atomic32-operations, it has to cover whole words */
+    return create_bitmap_buffer( &self->bitmap, BYTES_2_WORDS( self->bitmap_bytes ) * sizeof( atomic32_t ) );
+}
+
+
+/* the mask of a block-bit within the atomic32_t word that contains it,
+   the byte-order in memory is the byte-order of the bitmap in the file */
+static int bitmap_word_mask( uint64_t block_nr )
+{
+    union
+    {
+        int word;
+        uint8_t bytes[ sizeof( int ) ];
+    } mask;
+    mask . word = 0;
+    mask . bytes[ ( block_nr >> 3 ) & 3 ] = BitNr2Mask[ block_nr & 7 ];
+    return mask . word;
+}
+
+
+/* sets the bit of a block, returns true if this call changed it */
+static bool atomic_set_block_bit( atomic32_t * words, uint64_t block_nr )
+{
+    atomic32_t * word = &words[ block_nr >> 5 ];
+    int mask = bitmap_word_mask( block_nr );
+    int prior = atomic32_read( word );
+    while ( ( prior & mask ) == 0 )
+    {
+        int read = atomic32_test_and_set( word, prior | mask, prior );
+        if ( read == prior )
+            return true;
+        prior = read;
+    }
+    return false;
+}
+
+
+/* clears the bit of a block, returns true if this call changed it */
+static bool atomic_clear_block_bit( atomic32_t * words, uint64_t block_nr )
+{
+    atomic32_t * word = &words[ block_nr >> 5 ];
+    int mask = bitmap_word_mask( block_nr );
+    int prior = atomic32_read( word );
+    while ( ( prior & mask ) != 0 )
+    {
+        int read = atomic32_test_and_set( word, prior & ~mask, prior );
+        if ( read == prior )
+            return true;
+        prior = read;
+    }
+    return false;
+}
+
+
+static bool atomic_is_block_bit( atomic32_t * words, uint64_t block_nr )
+{
+    return ( atomic32_read( &words[ block_nr >> 5 ] ) & bitmap_word_mask( block_nr ) ) != 0;
 }
 
 
@@ -660,6 +734,45 @@ static rc_t promote_cache( KCacheTeeFile * self )
 }
 
 
+/* the bookkeeping that allows many threads to read the same KCacheTeeFile */
+static rc_t init_concurrency( KCacheTeeFile * self )
+{
+    rc_t rc;
+    self -> busy = calloc( BYTES_2_WORDS( self -> bitmap_bytes ), sizeof *self -> busy );
+    if ( self -> busy == NULL )
+    {
+        rc = RC ( rcFS, rcFile, rcConstructing, rcMemory, rcExhausted );
+        LOGERR( klogErr, rc, "init busy-block bitmap" );
+    }
+    else
+    {
+        rc = KLockMake( &self -> fill_lock );
+        if ( rc == 0 )
+            rc = KConditionMake( &self -> fill_done );
+        if ( rc != 0 )
+        {
+            LOGERR( klogErr, rc, "cannot create lock for concurrent readers" );
+        }
+    }
+    return rc;
+}
+
+
+static void release_concurrency( KCacheTeeFile * self )
+{
+    uint32_t i;
+    for ( i = 0; i < CACHE_TEE_SCRATCH_POOL; ++i )
+    {
+        if ( self -> scratch_pool[ i ] . ptr != NULL )
+            free( self -> scratch_pool[ i ] . ptr );
+    }
+    KConditionRelease( self -> fill_done );
+    KLockRelease( self -> fill_lock );
+    if ( self -> busy != NULL )
+        free( self -> busy );
+}
+
+
 /* Destroy
  */
 static rc_t CC KCacheTeeFileDestroy( KCacheTeeFile * self )
@@ -680,10 +793,9 @@ static rc_t CC KCacheTeeFileDestroy( KCacheTeeFile * self )
 		}
     }
 
+    release_concurrency( self );
     if ( self->bitmap != NULL )
         free( self->bitmap );
-    if ( self->scratch_buffer != NULL )
-        free( self->scratch_buffer );
 
     KFileRelease ( self -> remote );
     KFileRelease ( self -> local );
@@ -698,18 +810,6 @@ static rc_t CC KCacheTeeFileDestroy( KCacheTeeFile * self )
 }
 
 
-static void set_bitmap( const KCacheTeeFile *cself, uint64_t start_block, uint64_t block_count )
-{
-    uint64_t block_idx, block_nr;
-    for ( block_idx = 0, block_nr = start_block; 
-          block_idx < block_count; 
-          ++block_idx, ++block_nr )
-    {
-        cself->bitmap[ block_nr >> 3 ] |= BitNr2Mask[ block_nr & 0x07 ];
-    }
-}
-
-
 static rc_t write_bitmap( const KCacheTeeFile *cself, uint64_t start_block, uint64_t block_count )
 {
     size_t written;
@@ -727,32 +827,45 @@ static rc_t write_bitmap( const KCacheTeeFile *cself, uint64_t start_block, uint
 }
 
 
-static rc_t resize_scratch_buffer( const KCacheTeeFile *cself, uint64_t new_size )
+/* take an idle scratch-buffer out of the pool, or make a new one if the pool is empty */
+static rc_t acquire_scratch( const KCacheTeeFile *cself, CacheTeeScratch ** scratch )
 {
-    rc_t rc = 0;
     KCacheTeeFile *self = ( KCacheTeeFile * )cself;
+    uint32_t i;
 
-    /* create scratch-buffer or resize it if needed */
-    if ( self->scratch_size == 0 )
-    {
-        self->scratch_buffer = malloc( new_size );
-        if ( self->scratch_buffer == NULL )
-            rc = RC ( rcFS, rcFile, rcConstructing, rcMemory, rcExhausted );
-        else
-            self->scratch_size = new_size;
-    }
-    else if ( self->scratch_size < new_size )
+    for ( i = 0; i < CACHE_TEE_SCRATCH_POOL; ++i )
     {
-        uint8_t * tmp = realloc( self->scratch_buffer, new_size );
-        if ( tmp == NULL )
-            rc = RC ( rcFS, rcFile, rcConstructing, rcMemory, rcExhausted );
-        else
+        void * idle = self->scratch_pool[ i ] . ptr;
+        if ( idle != NULL && atomic_test_and_set_ptr( &self->scratch_pool[ i ], NULL, idle ) == idle )
         {
-            self->scratch_buffer = tmp;
-            self->scratch_size = new_size;
+            *scratch = idle;
+            return 0;
         }
     }
-    return rc;
+
+    *scratch = malloc( sizeof **scratch + cself->block_size );
+    if ( *scratch == NULL )
+        return RC ( rcFS, rcFile, rcReading, rcMemory, rcExhausted );
+
+    ( *scratch ) -> first_block = -1;
+    ( *scratch ) -> valid_bytes = 0;
+    return 0;
+}
+
+
+/* give the scratch-buffer back to the pool, free it if the pool is full */
+static void release_scratch( const KCacheTeeFile *cself, CacheTeeScratch * scratch )
+{
+    KCacheTeeFile *self = ( KCacheTeeFile * )cself;
+    uint32_t i;
+
+    for ( i = 0; i < CACHE_TEE_SCRATCH_POOL; ++i )
+    {
+        if ( self->scratch_pool[ i ] . ptr == NULL &&
+             atomic_test_and_set_ptr( &self->scratch_pool[ i ], scratch, NULL ) == NULL )
+            return;
+    }
+    free( scratch );
 }
 
 
@@ -800,6 +913,65 @@ static rc_t rd_remote_wr_local( const KCacheTeeFile *cself, uint64_t pos,
 }
 
 
+/* downloads one block into the scratch-buffer and the local file,
+   the caller has claimed the block in the busy-bitmap */
+static rc_t fill_block( const KCacheTeeFile *cself, uint64_t block, CacheTeeScratch * scratch )
+{
+    rc_t rc, rc2;
+    uint64_t fpos = block * cself->block_size;
+    int64_t  fbsize = cself->remote_size - fpos;
+    size_t   nread = 0;
+
+    if ( fbsize > cself->block_size ) fbsize = cself->block_size;
+    rc = rd_remote_wr_local( cself, fpos, scratch->buffer, fbsize, &nread );
+    if ( rc == 0 )
+    {
+        scratch -> first_block = block;
+        scratch -> valid_bytes = nread;
+    }
+
+    rc2 = KLockAcquire( cself->fill_lock );
+    if ( rc2 == 0 )
+    {
+        if ( rc == 0 && !cself->local_read_only )
+        {
+            /* the bitmap in the file is written in whole bytes, other blocks in the same byte
+               may be set concurrently: write under the lock to never lose one of them */
+            atomic_set_block_bit( ( atomic32_t * )cself->bitmap, block );
+            rc = write_bitmap( cself, block, 1 );
+        }
+        atomic_clear_block_bit( cself->busy, block );
+        KConditionBroadcast( cself->fill_done );
+        KLockUnlock( cself->fill_lock );
+    }
+    else
+    {
+        atomic_clear_block_bit( cself->busy, block );
+        if ( rc == 0 )
+            rc = rc2;
+    }
+    return rc;
+}
+
+
+/* another reader is downloading the block: wait until it is done, successful or not */
+static rc_t wait_for_block( const KCacheTeeFile *cself, uint64_t block )
+{
+    rc_t rc = KLockAcquire( cself->fill_lock );
+    if ( rc == 0 )
+    {
+        while ( rc == 0 &&
+                atomic_is_block_bit( cself->busy, block ) &&
+                !atomic_is_block_bit( ( atomic32_t * )cself->bitmap, block ) )
+        {
+            rc = KConditionWait( cself->fill_done, cself->fill_lock );
+        }
+        KLockUnlock( cself->fill_lock );
+    }
+    return rc;
+}
+
+
 static rc_t KCacheTeeFileRead_simple2( const KCacheTeeFile *cself, uint64_t pos,
                                        void *buffer, size_t bsize, size_t *num_read )
 {
@@ -808,9 +980,10 @@ static rc_t KCacheTeeFileRead_simple2( const KCacheTeeFile *cself, uint64_t pos,
     size_t   offset = pos % cself->block_size;
     size_t   to_read_total = bsize;
 	int64_t salvage_block = -1;
+    CacheTeeScratch * scratch = NULL;
 		
     *num_read = 0;
-    rc = resize_scratch_buffer( cself, cself->block_size );
+    rc = acquire_scratch( cself, &scratch );
 
     while ( rc == 0 && to_read_total > 0 )
 	{
@@ -818,19 +991,19 @@ static rc_t KCacheTeeFileRead_simple2( const KCacheTeeFile *cself, uint64_t pos,
 		
         if ( to_read > to_read_total ) to_read = to_read_total;
 
-        if ( cself -> first_block_in_scratch == block )
+        if ( scratch -> first_block == block )
 		{
-            if ( cself -> valid_scratch_bytes <= offset )
+            if ( scratch -> valid_bytes <= offset )
 			{ /** EOF in remote file and nothing to read **/
                 to_read_total = to_read = 0; 
 			}
 			else
 			{ 
-                if ( to_read > cself -> valid_scratch_bytes - offset )
+                if ( to_read > scratch -> valid_bytes - offset )
 				{ /** EOF in remote file something left**/
-				   to_read_total = to_read = cself -> valid_scratch_bytes - offset;
+				   to_read_total = to_read = scratch -> valid_bytes - offset;
                 }
-                memcpy( buffer, cself -> scratch_buffer + offset, to_read );
+                memcpy( buffer, scratch -> buffer + offset, to_read );
 			}
 
             /*** move source counters **/
@@ -843,7 +1016,7 @@ static rc_t KCacheTeeFileRead_simple2( const KCacheTeeFile *cself, uint64_t pos,
             *num_read += to_read;
             buffer = ((char*)buffer) + to_read;
         }
-		else if ( IS_CACHE_BIT( cself, block ) )
+		else if ( atomic_is_block_bit( ( atomic32_t * )cself->bitmap, block ) )
 		{
             uint64_t fpos = block * cself->block_size;
             int64_t fbsize = cself -> remote_size - fpos;
@@ -851,20 +1024,20 @@ static rc_t KCacheTeeFileRead_simple2( const KCacheTeeFile *cself, uint64_t pos,
 
             if( fbsize > cself->block_size ) fbsize = cself -> block_size;
 
-            rc = KFileReadAll( cself->local, fpos, cself->scratch_buffer, fbsize, &nread );
+            rc = KFileReadAll( cself->local, fpos, scratch->buffer, fbsize, &nread );
             if ( rc == 0 )
 			{
                 int i;
-                uint64_t *b = ( uint64_t* )cself->scratch_buffer;
-                ( ( KCacheTeeFile * )cself ) -> first_block_in_scratch = block;
-                ( ( KCacheTeeFile * )cself ) -> valid_scratch_bytes = nread;
+                uint64_t *b = ( uint64_t* )scratch->buffer;
+                scratch -> first_block = block;
+                scratch -> valid_bytes = nread;
 				
                 if ( block != salvage_block )
 				{ /** check for fully space page, but don't do it in infinite loop **/
                     for ( i = 0; i < ( nread/ sizeof( *b ) ) && b [ i]==0; i++ ) { } 
                     if ( i == ( nread / sizeof( *b ) ) )
 					{
-                        rc = rd_remote_wr_local( cself, block*cself->block_size, cself->scratch_buffer, fbsize, &nread );
+                        rc = rd_remote_wr_local( cself, block*cself->block_size, scratch->buffer, fbsize, &nread );
                         if ( rc == 0 ) salvage_block = block;
                     }
 					else
@@ -874,189 +1047,30 @@ static rc_t KCacheTeeFileRead_simple2( const KCacheTeeFile *cself, uint64_t pos,
                 }
             }
         }
-		else
+		else if ( atomic_set_block_bit( cself->busy, block ) )
 		{
-            uint64_t fpos = block * cself->block_size;
-            int64_t  fbsize = cself->remote_size - fpos;
-            size_t   nread = 0;
-
-            if ( fbsize > cself->block_size ) fbsize = cself->block_size;
-            rc = rd_remote_wr_local( cself, fpos, cself->scratch_buffer, fbsize, &nread );
-            if ( rc == 0 )
-			{
-                ( ( KCacheTeeFile * )cself ) -> first_block_in_scratch = block;
-                ( ( KCacheTeeFile * )cself ) -> valid_scratch_bytes = nread;
-                if ( !cself->local_read_only )
-				{
-                    set_bitmap( cself, block, 1 );
-                    rc = write_bitmap( cself, block, 1 );
-                }
-            }
+            /* we claimed the block: nobody else is downloading it. but another
+               reader may have filled it and released it since we looked at the
+               bitmap - then the next pass reads it from the cache */
+            if ( atomic_is_block_bit( ( atomic32_t * )cself->bitmap, block ) )
+                atomic_clear_block_bit( cself->busy, block );
+            else
+                rc = fill_block( cself, block, scratch );
+        }
+        else
+        {
+            /* somebody else is downloading the block, after the wait it is either
+               in the cache or the other reader failed and it is up for grabs again */
+            rc = wait_for_block( cself, block );
         }
 
     }
 
-    return rc;
-}
+    if ( scratch != NULL )
+        release_scratch( cself, scratch );
 
-#if 0
-/**********************************************************************************************
-    try #3
-**********************************************************************************************/
-static rc_t KCacheTeeFileRead_3( const KCacheTeeFile *cself, uint64_t pos,
-                                 void * buffer, size_t bsize, size_t *num_read )
-{
-	rc_t rc = 0;
-	uint64_t i_pos = pos;
-	uint8_t * i_buffer = buffer;
-	size_t still_to_read = bsize;
-	size_t total_read = 0;
-	size_t bytes_read;
-
-	/* we have to exclude that we are requesting beyond EOF, we can do that because we know the size
-	   of the file, the 'constructor' of the KCacheTeeFile has requested it and rejects construction
-	   if it cannot get this size */
-	if ( ( i_pos + still_to_read ) > cself -> remote_size )
-	{
-		still_to_read = ( cself -> remote_size - i_pos );
-	}
-	
-	while ( rc == 0 && still_to_read > 0 )
-	{
-		uint64_t block = ( i_pos / cself->block_size );
-		if ( IS_CACHE_BIT( cself, block ) )
-		{
-			/* i_pos is in a cached block... */
-			size_t to_read = ( ( ( block + 1 ) * cself->block_size ) - i_pos );
-			if ( to_read > still_to_read ) to_read = still_to_read;
-			rc = KFileReadAll( cself->local, i_pos, i_buffer, to_read, &bytes_read );
-			if ( rc == 0 )
-			{
-				/* check what we read from the local file is completely empty */
-				size_t i = 0;
-				while ( i_buffer[ i ] == 0 && i < bytes_read ) { i++; }
-				if ( i == ( bytes_read + 1 ) )
-				{
-					/* we have to read from remote because this segment is zero!
-					   this is a fix for broken cache-files */
-					cself->bitmap[ block >> 3 ] &= ~( BitNr2Mask[ block & 0x07 ] );
-					rc = write_bitmap( cself, block, 1 );
-					/* do not advance the buffer, because in the loop this will be read remotely now */
-				}
-				else
-				{
-					i_buffer += bytes_read;
-					total_read += bytes_read;
-					i_pos += bytes_read;
-					still_to_read -= bytes_read;
-				}
-			}
-        }
-		else
-		{
-			/* i_pos is not in a cached block... */
-			uint64_t block_pos = ( block * cself->block_size );
-			uint64_t ofs = ( i_pos - block_pos );
-			if ( ofs == 0 && still_to_read >= cself->block_size )
-			{
-				/* read the whole block remotely, this can return less than requested if last block...
-				   and it can return 0 bytes if the http-connection times out... */
-				rc = KFileReadAll( cself->remote, i_pos, i_buffer, cself->block_size, &bytes_read );
-				if ( rc == 0 )
-				{
-					if ( bytes_read == 0 )
-					{
-						still_to_read = 0;	/* terminate the loop, return as much as read so far, return rc ==0 */
-					}
-					else
-					{
-						/* write it to the local file */
-						size_t bytes_written;
-						rc = KFileWriteAll( cself->local, i_pos, i_buffer, bytes_read, &bytes_written );
-						if ( rc == 0 )
-						{
-							if ( bytes_written != bytes_read )
-							{
-								rc = RC ( rcFS, rcFile, rcWriting, rcTransfer, rcTooShort );
-							}
-							else
-							{
-								/* write the bitmap */
-								set_bitmap( cself, block, 1 );
-								rc = write_bitmap( cself, block, 1 );
-								if ( rc == 0 )
-								{
-									i_buffer += bytes_read;
-									total_read += bytes_read;
-									i_pos += bytes_read;
-									still_to_read -= bytes_read;
-								}
-							}
-						}
-					}
-				}
-			}
-			else
-			{
-				/* use the scratch-buffer to read the whole block, copy the smaller part that was requested */
-				if ( cself->scratch_size < cself->block_size )
-				{
-					rc = resize_scratch_buffer( cself, cself->block_size );
-				}
-				if ( rc == 0 )
-				{
-					/* read the whole block remotely, this can return less than requested if last block...
-				       and it can return 0 bytes if the http-connection times out... */
-					rc = KFileReadAll( cself->remote, block_pos, cself->scratch_buffer, cself->block_size, &bytes_read );
-					if ( rc == 0 )
-					{
-						if ( bytes_read == 0 )
-						{
-							still_to_read = 0;	/* terminate the loop, return as much as read so far, return rc ==0 */
-						}
-						else
-						{
-							/* write it to the local file */
-							size_t bytes_written;
-							rc = KFileWriteAll( cself->local, block_pos, cself -> scratch_buffer, bytes_read, &bytes_written );
-							if ( rc == 0 )
-							{
-								if ( bytes_written != bytes_read )
-								{
-									rc = RC ( rcFS, rcFile, rcWriting, rcTransfer, rcTooShort );
-								}
-								else
-								{
-									/* write the bitmap */
-									set_bitmap( cself, block, 1 );
-									rc = write_bitmap( cself, block, 1 );
-									if ( rc == 0 )
-									{
-										/* here comes the difference: copy the bytes from the offset */
-										size_t to_copy = ( cself->block_size - ofs );
-										if ( to_copy > still_to_read ) to_copy = still_to_read;
-										memmove ( i_buffer, &( cself->scratch_buffer[ ofs ] ), to_copy );
-										
-										i_buffer += to_copy;
-										total_read += to_copy;
-										i_pos += to_copy;
-										still_to_read -= to_copy;
-									}
-								}
-							}
-						}
-					}
-				}
-			}
-		}
-	}
-
-	if ( rc == 0 )
-		*num_read = total_read;
-
-	return rc;
+    return rc;
 }
-#endif
 
 /**********************************************************************************************
     START vt-functions
@@ -1146,10 +1160,10 @@ static rc_t make_cache_tee( struct KDirectory *self, struct KFile const **tee,
         cf -> local  = local;
         cf -> block_size = ( blocksize > 0 ) ? blocksize : CACHE_TEE_DEFAULT_BLOCKSIZE;
         cf -> bitmap = NULL;
-        cf -> scratch_buffer = NULL;
-        cf -> scratch_size = 0;
-        cf -> first_block_in_scratch = -1;
-        cf -> valid_scratch_bytes = 0;
+        cf -> busy = NULL;
+        cf -> fill_lock = NULL;
+        cf -> fill_done = NULL;
+        memset( cf -> scratch_pool, 0, sizeof cf -> scratch_pool );
 		cf -> local_read_only = read_only;
 
 #if( CACHE_STAT > 0 )
@@ -1220,6 +1234,11 @@ static rc_t make_cache_tee( struct KDirectory *self, struct KFile const **tee,
                     cf -> remote_size = cf -> local_size;
 				}
 				
+                rc = init_concurrency( cf );
+            }
+
+            if ( rc == 0 )
+            {
                 /* now we have to AddRef() everything we hang on until the final release! */
                 rc = KDirectoryAddRef ( cf -> dir );
                 if ( rc == 0 )
@@ -1254,7 +1273,10 @@ static rc_t make_cache_tee( struct KDirectory *self, struct KFile const **tee,
                         KDirectoryRelease ( cf -> dir );
                 }
             }
+            release_concurrency( cf );
         }
+        if ( cf -> bitmap != NULL )
+            free( cf -> bitmap );
         free ( cf );
     }
     return rc;
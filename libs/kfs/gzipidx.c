@@ -0,0 +1,877 @@
+/*==============================================================================
+*
+*                            PUBLIC DOMAIN NOTICE
+*               National Center for Biotechnology Information
+*
+*  This software/database is a "United States Government Work" under the
+*  terms of the United States Copyright Act.  It was written as part of
+*  the author's official duties as a United States Government employee and
+*  thus cannot be copyrighted.  This software/database is freely available
+*  to the public for use. The National Library of Medicine and the U.S.
+*  Government have not placed any restriction on its use or reproduction.
+*
+*  Although all reasonable efforts have been taken to ensure the accuracy
+*  and reliability of the software and data, the NLM and the U.S.
+*  Government do not and cannot warrant the performance or results that
+*  may be obtained by using this software or data. The NLM and the U.S.
+*  Government disclaim all warranties, express or implied, including
+*  warranties of performance, merchantability or fitness for any particular
+*  purpose.
+*
+*  Please cite the author in any work or product based on this material.
+*
+* ===========================================================================
+*
+*/
+
+struct KGZipIdxFile;
+#define KFILE_IMPL struct KGZipIdxFile
+
+#include <kfs/extern.h>
+#include <kfs/impl.h>  /* KFile_vt_v1 */
+#include <kfs/gzip.h>
+#include <klib/refcount.h>
+#include <klib/rc.h>
+#include <sysalloc.h>
+
+#include <zlib.h>
+#include <assert.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* the access point scheme follows zran.c from the zlib examples */
+
+#define WINDOW_BITS ( 15 + 16 )         /* gzip header and trailer */
+#define RAW_WINDOW_BITS ( -15 )         /* bare deflate, resumed from a point */
+
+#define GZIDX_WINSIZE 0x8000            /* 32K of deflate history */
+#define GZIDX_CHUNK 0x20000             /* 128K of compressed input */
+#define GZIDX_DEFAULT_SPAN 0x100000     /* 1M between access points */
+#define GZIDX_TRAILER 8                 /* crc32 and isize of a gzip member */
+
+#define GZIDX_MAGIC "NCBIgzix"
+#define GZIDX_VERSION 1
+
+
+/*--------------------------------------------------------------------------
+ * KGzipIndex
+ */
+typedef struct KGzipPoint KGzipPoint;
+struct KGzipPoint
+{
+    uint64_t out;       /* decompressed offset */
+    uint64_t in;        /* offset of the first whole compressed byte */
+    uint32_t bits;      /* bits of the byte before "in" that are still unread */
+    uint32_t wsize;     /* bytes of history in "window" */
+    uint8_t * window;
+};
+
+struct KGzipIndex
+{
+    KGzipPoint * pt;
+    uint64_t span;
+    uint64_t size;      /* decompressed size, once complete */
+    uint64_t gz_size;   /* compressed size, once complete */
+    uint32_t count;
+    uint32_t allocated;
+    KRefcount refcount;
+    bool complete;
+};
+
+/* on-disk layout, all integers little-endian:
+ *
+ *  header:  magic [ 8 ], u32 version, u32 count, u64 span, u64 size, u64 gz_size
+ *  point:   u64 out, u64 in, u32 bits, u32 wsize, followed by wsize bytes of window
+ */
+#define GZIDX_HDR_SIZE 40
+#define GZIDX_POINT_HDR_SIZE 24
+
+static
+void gzidx_put32 ( uint8_t *dst, uint32_t val )
+{
+    dst [ 0 ] = ( uint8_t ) val;
+    dst [ 1 ] = ( uint8_t ) ( val >> 8 );
+    dst [ 2 ] = ( uint8_t ) ( val >> 16 );
+    dst [ 3 ] = ( uint8_t ) ( val >> 24 );
+}
+
+static
+void gzidx_put64 ( uint8_t *dst, uint64_t val )
+{
+    gzidx_put32 ( dst, ( uint32_t ) val );
+    gzidx_put32 ( dst + 4, ( uint32_t ) ( val >> 32 ) );
+}
+
+static
+uint32_t gzidx_get32 ( const uint8_t *src )
+{
+    return ( uint32_t ) src [ 0 ] |
+        ( ( uint32_t ) src [ 1 ] << 8 ) |
+        ( ( uint32_t ) src [ 2 ] << 16 ) |
+        ( ( uint32_t ) src [ 3 ] << 24 );
+}
+
+static
+uint64_t gzidx_get64 ( const uint8_t *src )
+{
+    return ( uint64_t ) gzidx_get32 ( src ) |
+        ( ( uint64_t ) gzidx_get32 ( src + 4 ) << 32 );
+}
+
+static
+void KGzipIndexWhack ( KGzipIndex *self )
+{
+    uint32_t i;
+    for ( i = 0; i < self -> count; ++ i )
+        free ( self -> pt [ i ] . window );
+    free ( self -> pt );
+    free ( self );
+}
+
+static
+rc_t KGzipIndexMakeEmpty ( KGzipIndex **idx, uint64_t span )
+{
+    KGzipIndex *self = calloc ( 1, sizeof * self );
+    if ( self == NULL )
+        return RC ( rcFS, rcIndex, rcConstructing, rcMemory, rcExhausted );
+
+    self -> span = ( span != 0 ) ? span : GZIDX_DEFAULT_SPAN;
+    KRefcountInit ( & self -> refcount, 1, "KGzipIndex", "make", "gzidx" );
+
+    * idx = self;
+    return 0;
+}
+
+LIB_EXPORT rc_t CC KGzipIndexAddRef ( const KGzipIndex *self )
+{
+    if ( self != NULL )
+    {
+        switch ( KRefcountAdd ( & self -> refcount, "KGzipIndex" ) )
+        {
+        case krefLimit:
+            return RC ( rcFS, rcIndex, rcAttaching, rcRange, rcExcessive );
+        }
+    }
+    return 0;
+}
+
+LIB_EXPORT rc_t CC KGzipIndexRelease ( const KGzipIndex *self )
+{
+    if ( self != NULL )
+    {
+        switch ( KRefcountDrop ( & self -> refcount, "KGzipIndex" ) )
+        {
+        case krefWhack:
+            KGzipIndexWhack ( ( KGzipIndex* ) self );
+            break;
+        case krefNegative:
+            return RC ( rcFS, rcIndex, rcReleasing, rcRange, rcExcessive );
+        }
+    }
+    return 0;
+}
+
+/* Find
+ *  the last access point at or before "pos"
+ */
+static
+const KGzipPoint *KGzipIndexFind ( const KGzipIndex *self, uint64_t pos )
+{
+    uint32_t left = 0, right = self -> count;
+    while ( left < right )
+    {
+        uint32_t mid = ( left + right ) / 2;
+        if ( self -> pt [ mid ] . out <= pos )
+            left = mid + 1;
+        else
+            right = mid;
+    }
+    return ( left == 0 ) ? NULL : & self -> pt [ left - 1 ];
+}
+
+/* AddPoint
+ *  "ring" holds the last "valid" bytes before "out",
+ *  laid out modulo GZIDX_WINSIZE
+ */
+static
+rc_t KGzipIndexAddPoint ( KGzipIndex *self, uint64_t out, uint64_t in,
+    uint32_t bits, const uint8_t *ring, uint32_t valid )
+{
+    KGzipPoint *pt;
+    uint32_t off, first;
+
+    if ( self -> count == self -> allocated )
+    {
+        uint32_t allocated = ( self -> allocated != 0 ) ? self -> allocated * 2 : 16;
+        void *p = realloc ( self -> pt, allocated * sizeof * self -> pt );
+        if ( p == NULL )
+            return RC ( rcFS, rcIndex, rcInserting, rcMemory, rcExhausted );
+        self -> pt = p;
+        self -> allocated = allocated;
+    }
+
+    pt = & self -> pt [ self -> count ];
+    pt -> window = malloc ( valid != 0 ? valid : 1 );
+    if ( pt -> window == NULL )
+        return RC ( rcFS, rcIndex, rcInserting, rcMemory, rcExhausted );
+
+    /* linearize the history */
+    off = ( uint32_t ) ( ( out - valid ) % GZIDX_WINSIZE );
+    first = GZIDX_WINSIZE - off;
+    if ( first >= valid )
+        memcpy ( pt -> window, ring + off, valid );
+    else
+    {
+        memcpy ( pt -> window, ring + off, first );
+        memcpy ( pt -> window + first, ring, valid - first );
+    }
+
+    pt -> out = out;
+    pt -> in = in;
+    pt -> bits = bits;
+    pt -> wsize = valid;
+    ++ self -> count;
+
+    return 0;
+}
+
+LIB_EXPORT rc_t CC KGzipIndexSave ( const KGzipIndex *self, KFile *dst )
+{
+    rc_t rc;
+    size_t num_writ;
+    uint64_t pos;
+    uint32_t i;
+    uint8_t hdr [ GZIDX_HDR_SIZE ];
+
+    if ( self == NULL )
+        return RC ( rcFS, rcIndex, rcWriting, rcSelf, rcNull );
+    if ( dst == NULL )
+        return RC ( rcFS, rcIndex, rcWriting, rcFile, rcNull );
+    if ( ! self -> complete )
+        return RC ( rcFS, rcIndex, rcWriting, rcIndex, rcIncomplete );
+
+    memmove ( hdr, GZIDX_MAGIC, 8 );
+    gzidx_put32 ( hdr + 8, GZIDX_VERSION );
+    gzidx_put32 ( hdr + 12, self -> count );
+    gzidx_put64 ( hdr + 16, self -> span );
+    gzidx_put64 ( hdr + 24, self -> size );
+    gzidx_put64 ( hdr + 32, self -> gz_size );
+
+    rc = KFileWriteAll ( dst, 0, hdr, sizeof hdr, & num_writ );
+    for ( pos = num_writ, i = 0; rc == 0 && i < self -> count; ++ i )
+    {
+        const KGzipPoint *pt = & self -> pt [ i ];
+        uint8_t phdr [ GZIDX_POINT_HDR_SIZE ];
+
+        gzidx_put64 ( phdr, pt -> out );
+        gzidx_put64 ( phdr + 8, pt -> in );
+        gzidx_put32 ( phdr + 16, pt -> bits );
+        gzidx_put32 ( phdr + 20, pt -> wsize );
+
+        rc = KFileWriteAll ( dst, pos, phdr, sizeof phdr, & num_writ );
+        if ( rc == 0 )
+        {
+            pos += num_writ;
+            rc = KFileWriteAll ( dst, pos, pt -> window, pt -> wsize, & num_writ );
+            pos += num_writ;
+        }
+    }
+
+    return rc;
+}
+
+static
+rc_t KGzipIndexReadExact ( const KFile *src, uint64_t pos, void *buffer, size_t bsize )
+{
+    size_t num_read;
+    rc_t rc;
+
+    if ( bsize == 0 )
+        return 0;
+
+    rc = KFileReadAll ( src, pos, buffer, bsize, & num_read );
+    if ( rc == 0 && num_read != bsize )
+        rc = RC ( rcFS, rcIndex, rcLoading, rcData, rcInsufficient );
+    return rc;
+}
+
+LIB_EXPORT rc_t CC KGzipIndexLoad ( const KGzipIndex **idxp, const KFile *src )
+{
+    rc_t rc;
+    uint8_t hdr [ GZIDX_HDR_SIZE ];
+
+    if ( idxp == NULL )
+        return RC ( rcFS, rcIndex, rcLoading, rcParam, rcNull );
+    * idxp = NULL;
+    if ( src == NULL )
+        return RC ( rcFS, rcIndex, rcLoading, rcFile, rcNull );
+
+    rc = KGzipIndexReadExact ( src, 0, hdr, sizeof hdr );
+    if ( rc == 0 )
+    {
+        uint32_t count = gzidx_get32 ( hdr + 12 );
+        uint64_t size = gzidx_get64 ( hdr + 24 );
+
+        if ( memcmp ( hdr, GZIDX_MAGIC, 8 ) != 0 )
+            rc = RC ( rcFS, rcIndex, rcLoading, rcFormat, rcUnrecognized );
+        else if ( gzidx_get32 ( hdr + 8 ) != GZIDX_VERSION )
+            rc = RC ( rcFS, rcIndex, rcLoading, rcFormat, rcBadVersion );
+        else
+        {
+            KGzipIndex *idx = NULL;
+            rc = KGzipIndexMakeEmpty ( & idx, gzidx_get64 ( hdr + 16 ) );
+            if ( rc == 0 && count != 0 )
+            {
+                idx -> pt = calloc ( count, sizeof * idx -> pt );
+                if ( idx -> pt == NULL )
+                    rc = RC ( rcFS, rcIndex, rcLoading, rcMemory, rcExhausted );
+                else
+                    idx -> allocated = count;
+            }
+            if ( rc == 0 )
+            {
+                uint64_t pos = sizeof hdr;
+                uint32_t i;
+                for ( i = 0; rc == 0 && i < count; ++ i )
+                {
+                    KGzipPoint *pt = & idx -> pt [ i ];
+                    uint8_t phdr [ GZIDX_POINT_HDR_SIZE ];
+                    uint64_t out;
+                    uint32_t bits, wsize;
+
+                    rc = KGzipIndexReadExact ( src, pos, phdr, sizeof phdr );
+                    if ( rc != 0 )
+                        break;
+                    pos += sizeof phdr;
+
+                    out = gzidx_get64 ( phdr );
+                    bits = gzidx_get32 ( phdr + 16 );
+                    wsize = gzidx_get32 ( phdr + 20 );
+
+                    if ( bits > 7 || wsize > GZIDX_WINSIZE ||
+                         wsize > out || out > size ||
+                         ( i != 0 && out <= idx -> pt [ i - 1 ] . out ) )
+                    {
+                        rc = RC ( rcFS, rcIndex, rcLoading, rcData, rcCorrupt );
+                        break;
+                    }
+
+                    pt -> window = malloc ( wsize != 0 ? wsize : 1 );
+                    if ( pt -> window == NULL )
+                    {
+                        rc = RC ( rcFS, rcIndex, rcLoading, rcMemory, rcExhausted );
+                        break;
+                    }
+                    idx -> count = i + 1;
+
+                    pt -> out = out;
+                    pt -> in = gzidx_get64 ( phdr + 8 );
+                    pt -> bits = bits;
+                    pt -> wsize = wsize;
+
+                    rc = KGzipIndexReadExact ( src, pos, pt -> window, pt -> wsize );
+                    pos += pt -> wsize;
+                }
+            }
+            if ( rc == 0 )
+            {
+                idx -> size = size;
+                idx -> gz_size = gzidx_get64 ( hdr + 32 );
+                idx -> complete = true;
+                * idxp = idx;
+            }
+            else if ( idx != NULL )
+            {
+                KGzipIndexWhack ( idx );
+            }
+        }
+    }
+
+    return rc;
+}
+
+
+/*--------------------------------------------------------------------------
+ * KGZipIdxFile
+ *  inflates through a 32K ring, which doubles as the history
+ *  captured at each access point
+ */
+typedef struct KGZipIdxFile KGZipIdxFile;
+struct KGZipIdxFile
+{
+    KFile dad;
+    const KFile *file;
+    KGzipIndex *idx;
+    uint64_t in_pos;    /* compressed offset just past "buff" contents */
+    uint64_t out_pos;   /* decompressed offset of the next inflated byte */
+    uint32_t valid;     /* bytes before "out_pos" still held in "window" */
+    bool building;      /* access points are added as we go */
+    bool raw;           /* inflating a member resumed from an access point */
+    bool eof;
+    z_stream strm;
+    uint8_t window [ GZIDX_WINSIZE ];
+    uint8_t buff [ GZIDX_CHUNK ];
+};
+
+static rc_t CC KGZipIdxFileDestroy ( KGZipIdxFile *self )
+{
+    rc_t rc = KFileRelease ( self -> file );
+    if ( rc == 0 )
+    {
+        inflateEnd ( & self -> strm );
+        KGzipIndexRelease ( self -> idx );
+        free ( self );
+    }
+    return rc;
+}
+
+static struct KSysFile *CC KGZipIdxFileGetSysFile ( const KGZipIdxFile *self, uint64_t *offset )
+{
+    return NULL;
+}
+
+static rc_t CC KGZipIdxFileRandomAccess ( const KGZipIdxFile *self )
+{
+    return 0;
+}
+
+static uint32_t CC KGZipIdxFileType ( const KGZipIdxFile *self )
+{
+    return KFileType ( self -> file );
+}
+
+static rc_t CC KGZipIdxFileSize ( const KGZipIdxFile *self, uint64_t *size )
+{
+    if ( self -> idx -> complete )
+    {
+        * size = self -> idx -> size;
+        return 0;
+    }
+    return RC ( rcFS, rcFile, rcAccessing, rcFunction, rcUnsupported );
+}
+
+static rc_t CC KGZipIdxFileSetSize ( KGZipIdxFile *self, uint64_t size )
+{
+    return RC ( rcFS, rcFile, rcUpdating, rcFunction, rcUnsupported );
+}
+
+static rc_t CC KGZipIdxFileWrite ( KGZipIdxFile *self, uint64_t pos,
+    const void *buffer, size_t size, size_t *num_writ )
+{
+    return RC ( rcFS, rcFile, rcWriting, rcFunction, rcUnsupported );
+}
+
+static rc_t CC KGZipIdxFileRead ( const KGZipIdxFile *cself, uint64_t pos,
+    void *buffer, size_t bsize, size_t *num_read );
+
+static KFile_vt_v1 vtKGZipIdxFile =
+{
+    /* version */
+    1, 1,
+
+    /* 1.0 */
+    KGZipIdxFileDestroy,
+    KGZipIdxFileGetSysFile,
+    KGZipIdxFileRandomAccess,
+    KGZipIdxFileSize,
+    KGZipIdxFileSetSize,
+    KGZipIdxFileRead,
+    KGZipIdxFileWrite,
+
+    /* 1.1 */
+    KGZipIdxFileType
+};
+
+/* Rewind
+ *  restart from the top of the file
+ */
+static
+rc_t KGZipIdxFileRewind ( KGZipIdxFile *self )
+{
+    if ( inflateReset2 ( & self -> strm, WINDOW_BITS ) != Z_OK )
+        return RC ( rcFS, rcFile, rcPositioning, rcNoObj, rcUnknown );
+
+    self -> strm . next_in = NULL;
+    self -> strm . avail_in = 0;
+    self -> in_pos = 0;
+    self -> out_pos = 0;
+    self -> valid = 0;
+    self -> raw = false;
+    self -> eof = false;
+
+    return 0;
+}
+
+/* Resume
+ *  restart from an access point
+ */
+static
+rc_t KGZipIdxFileResume ( KGZipIdxFile *self, const KGzipPoint *pt )
+{
+    z_stream *strm = & self -> strm;
+    uint32_t off, first;
+
+    if ( inflateReset2 ( strm, RAW_WINDOW_BITS ) != Z_OK )
+        return RC ( rcFS, rcFile, rcPositioning, rcNoObj, rcUnknown );
+
+    strm -> next_in = NULL;
+    strm -> avail_in = 0;
+    self -> in_pos = pt -> in;
+
+    if ( pt -> bits != 0 )
+    {
+        uint8_t byte;
+        size_t num_read;
+        rc_t rc = KFileReadAll ( self -> file, pt -> in - 1, & byte, 1, & num_read );
+        if ( rc != 0 )
+            return rc;
+        if ( num_read != 1 )
+            return RC ( rcFS, rcFile, rcPositioning, rcData, rcInsufficient );
+        inflatePrime ( strm, ( int ) pt -> bits, byte >> ( 8 - pt -> bits ) );
+    }
+
+    if ( inflateSetDictionary ( strm, pt -> window, pt -> wsize ) != Z_OK )
+        return RC ( rcFS, rcFile, rcPositioning, rcIndex, rcCorrupt );
+
+    /* put the history back in the ring where it belongs */
+    off = ( uint32_t ) ( ( pt -> out - pt -> wsize ) % GZIDX_WINSIZE );
+    first = GZIDX_WINSIZE - off;
+    if ( first >= pt -> wsize )
+        memcpy ( self -> window + off, pt -> window, pt -> wsize );
+    else
+    {
+        memcpy ( self -> window + off, pt -> window, first );
+        memcpy ( self -> window, pt -> window + first, pt -> wsize - first );
+    }
+
+    self -> out_pos = pt -> out;
+    self -> valid = pt -> wsize;
+    self -> raw = true;
+    self -> eof = false;
+
+    return 0;
+}
+
+static
+rc_t KGZipIdxFileFill ( KGZipIdxFile *self )
+{
+    size_t num_read;
+    rc_t rc = KFileRead ( self -> file, self -> in_pos, self -> buff, sizeof self -> buff, & num_read );
+    if ( rc == 0 )
+    {
+        self -> strm . next_in = self -> buff;
+        self -> strm . avail_in = ( uInt ) num_read;
+        self -> in_pos += num_read;
+    }
+    return rc;
+}
+
+static
+void KGZipIdxFileEnd ( KGZipIdxFile *self )
+{
+    self -> eof = true;
+    if ( self -> building )
+    {
+        self -> idx -> size = self -> out_pos;
+        self -> idx -> gz_size = self -> in_pos;
+        self -> idx -> complete = true;
+        self -> building = false;
+    }
+}
+
+/* MemberEnd
+ *  a gzip member is done - another one may follow
+ */
+static
+rc_t KGZipIdxFileMemberEnd ( KGZipIdxFile *self )
+{
+    z_stream *strm = & self -> strm;
+
+    if ( self -> raw )
+    {
+        /* a raw inflate does not consume the member trailer */
+        uint32_t skip = GZIDX_TRAILER;
+        while ( skip != 0 )
+        {
+            uint32_t n;
+            if ( strm -> avail_in == 0 )
+            {
+                rc_t rc = KGZipIdxFileFill ( self );
+                if ( rc != 0 )
+                    return rc;
+                if ( strm -> avail_in == 0 )
+                    return RC ( rcFS, rcFile, rcReading, rcData, rcInsufficient );
+            }
+            n = ( strm -> avail_in < skip ) ? strm -> avail_in : skip;
+            strm -> next_in += n;
+            strm -> avail_in -= n;
+            skip -= n;
+        }
+        self -> raw = false;
+    }
+
+    if ( inflateReset2 ( strm, WINDOW_BITS ) != Z_OK )
+        return RC ( rcFS, rcFile, rcReading, rcData, rcInvalid );
+
+    return 0;
+}
+
+/* Inflate
+ *  decompress the next stretch into the ring,
+ *  stopping at deflate block boundaries to record access points
+ */
+static
+rc_t KGZipIdxFileInflate ( KGZipIdxFile *self )
+{
+    z_stream *strm = & self -> strm;
+    uint32_t off, produced;
+    int zret;
+
+    if ( strm -> avail_in == 0 )
+    {
+        rc_t rc = KGZipIdxFileFill ( self );
+        if ( rc != 0 )
+            return rc;
+        if ( strm -> avail_in == 0 )
+        {
+            /* running dry between members is the normal end of file */
+            if ( ! self -> raw && strm -> total_in == 0 )
+            {
+                KGZipIdxFileEnd ( self );
+                return 0;
+            }
+            return RC ( rcFS, rcFile, rcReading, rcData, rcInsufficient );
+        }
+    }
+
+    off = ( uint32_t ) ( self -> out_pos % GZIDX_WINSIZE );
+    strm -> next_out = self -> window + off;
+    strm -> avail_out = GZIDX_WINSIZE - off;
+
+    zret = inflate ( strm, Z_BLOCK );
+
+    produced = ( GZIDX_WINSIZE - off ) - strm -> avail_out;
+    self -> out_pos += produced;
+    self -> valid += produced;
+    if ( self -> valid > GZIDX_WINSIZE )
+        self -> valid = GZIDX_WINSIZE;
+
+    switch ( zret )
+    {
+    case Z_OK:
+    case Z_BUF_ERROR:
+        break;
+    case Z_STREAM_END:
+        return KGZipIdxFileMemberEnd ( self );
+    case Z_NEED_DICT:
+    case Z_DATA_ERROR:
+        return RC ( rcFS, rcFile, rcReading, rcData, rcCorrupt );
+    case Z_MEM_ERROR:
+        return RC ( rcFS, rcFile, rcReading, rcMemory, rcExhausted );
+    default:
+        return RC ( rcFS, rcFile, rcReading, rcFile, rcUnknown );
+    }
+
+    /* at the end of a block that is not the last one of its member */
+    if ( self -> building && ( strm -> data_type & 128 ) != 0 && ( strm -> data_type & 64 ) == 0 )
+    {
+        KGzipIndex *idx = self -> idx;
+        if ( idx -> count == 0 ||
+             self -> out_pos >= idx -> pt [ idx -> count - 1 ] . out + idx -> span )
+        {
+            return KGzipIndexAddPoint ( idx, self -> out_pos,
+                self -> in_pos - strm -> avail_in, strm -> data_type & 7,
+                self -> window, self -> valid );
+        }
+    }
+
+    return 0;
+}
+
+/* Seek
+ *  position so that "pos" is either held in the ring or is next to inflate
+ */
+static
+rc_t KGZipIdxFileSeek ( KGZipIdxFile *self, uint64_t pos )
+{
+    rc_t rc = 0;
+
+    if ( pos + self -> valid < self -> out_pos )
+    {
+        /* behind us */
+        const KGzipPoint *pt = KGzipIndexFind ( self -> idx, pos );
+        rc = ( pt != NULL ) ? KGZipIdxFileResume ( self, pt ) : KGZipIdxFileRewind ( self );
+    }
+    else if ( pos > self -> out_pos )
+    {
+        /* ahead of us - jump if there is an access point in between */
+        const KGzipPoint *pt = KGzipIndexFind ( self -> idx, pos );
+        if ( pt != NULL && pt -> out > self -> out_pos )
+            rc = KGZipIdxFileResume ( self, pt );
+    }
+
+    while ( rc == 0 && pos > self -> out_pos && ! self -> eof )
+        rc = KGZipIdxFileInflate ( self );
+
+    return rc;
+}
+
+static rc_t CC KGZipIdxFileRead ( const KGZipIdxFile *cself, uint64_t pos,
+    void *buffer, size_t bsize, size_t *num_read )
+{
+    KGZipIdxFile *self = ( KGZipIdxFile* ) cself;
+    size_t total = 0;
+
+    rc_t rc = KGZipIdxFileSeek ( self, pos );
+    while ( rc == 0 && total < bsize )
+    {
+        uint64_t start = pos + total;
+        if ( start >= self -> out_pos )
+        {
+            if ( self -> eof )
+                break;
+            rc = KGZipIdxFileInflate ( self );
+        }
+        else
+        {
+            uint32_t off = ( uint32_t ) ( start % GZIDX_WINSIZE );
+            size_t n = ( size_t ) ( self -> out_pos - start );
+            if ( n > bsize - total )
+                n = bsize - total;
+            if ( n > GZIDX_WINSIZE - off )
+                n = GZIDX_WINSIZE - off;
+            memmove ( ( uint8_t* ) buffer + total, self -> window + off, n );
+            total += n;
+        }
+    }
+
+    * num_read = total;
+    return ( total != 0 ) ? 0 : rc;
+}
+
+static
+rc_t KGZipIdxFileMake ( KGZipIdxFile **objp, const KFile *src, const KGzipIndex *idx, uint64_t span )
+{
+    rc_t rc;
+    KGZipIdxFile *obj;
+
+    if ( idx != NULL )
+    {
+        uint64_t size;
+        if ( ! idx -> complete )
+            return RC ( rcFS, rcFile, rcConstructing, rcIndex, rcIncomplete );
+        if ( KFileSize ( src, & size ) == 0 && size != idx -> gz_size )
+            return RC ( rcFS, rcFile, rcConstructing, rcIndex, rcIncorrect );
+    }
+
+    obj = calloc ( 1, sizeof * obj );
+    if ( obj == NULL )
+        return RC ( rcFS, rcFile, rcConstructing, rcMemory, rcExhausted );
+
+    rc = KFileInit ( & obj -> dad, ( const KFile_vt* ) & vtKGZipIdxFile, "KGZipIdxFile", "no-name", true, false );
+    if ( rc == 0 )
+    {
+        if ( inflateInit2 ( & obj -> strm, WINDOW_BITS ) != Z_OK )
+            rc = RC ( rcFS, rcFile, rcConstructing, rcNoObj, rcUnknown );
+        else
+        {
+            if ( idx != NULL )
+                rc = KGzipIndexAddRef ( idx );
+            else
+            {
+                KGzipIndex *own;
+                rc = KGzipIndexMakeEmpty ( & own, span );
+                idx = own;
+                obj -> building = true;
+            }
+            if ( rc == 0 )
+            {
+                obj -> idx = ( KGzipIndex* ) idx;
+                rc = KFileAddRef ( src );
+                if ( rc == 0 )
+                {
+                    obj -> file = src;
+                    * objp = obj;
+                    return 0;
+                }
+                KGzipIndexRelease ( idx );
+            }
+            inflateEnd ( & obj -> strm );
+        }
+    }
+
+    free ( obj );
+    return rc;
+}
+
+LIB_EXPORT rc_t CC KFileMakeGzipIndexedForRead ( const KFile **gz,
+    const KFile *src, const KGzipIndex *idx, uint64_t span )
+{
+    rc_t rc;
+    KGZipIdxFile *obj;
+
+    if ( gz == NULL )
+        return RC ( rcFS, rcFile, rcConstructing, rcParam, rcNull );
+    * gz = NULL;
+    if ( src == NULL )
+        return RC ( rcFS, rcFile, rcConstructing, rcParam, rcNull );
+
+    rc = KGZipIdxFileMake ( & obj, src, idx, span );
+    if ( rc == 0 )
+        * gz = & obj -> dad;
+
+    return rc;
+}
+
+LIB_EXPORT rc_t CC KFileGzipIndex ( const KFile *self, const KGzipIndex **idx )
+{
+    rc_t rc;
+    const KGZipIdxFile *f;
+
+    if ( idx == NULL )
+        return RC ( rcFS, rcFile, rcAccessing, rcParam, rcNull );
+    * idx = NULL;
+    if ( self == NULL )
+        return RC ( rcFS, rcFile, rcAccessing, rcSelf, rcNull );
+    if ( self -> vt != ( const KFile_vt* ) & vtKGZipIdxFile )
+        return RC ( rcFS, rcFile, rcAccessing, rcType, rcIncorrect );
+
+    f = ( const KGZipIdxFile* ) self;
+    if ( ! f -> idx -> complete )
+        return RC ( rcFS, rcFile, rcAccessing, rcIndex, rcIncomplete );
+
+    rc = KGzipIndexAddRef ( f -> idx );
+    if ( rc == 0 )
+        * idx = f -> idx;
+    return rc;
+}
+
+LIB_EXPORT rc_t CC KGzipIndexMake ( const KGzipIndex **idx, const KFile *gz, uint64_t span )
+{
+    rc_t rc;
+    KGZipIdxFile *obj;
+
+    if ( idx == NULL )
+        return RC ( rcFS, rcIndex, rcConstructing, rcParam, rcNull );
+    * idx = NULL;
+    if ( gz == NULL )
+        return RC ( rcFS, rcIndex, rcConstructing, rcFile, rcNull );
+
+    rc = KGZipIdxFileMake ( & obj, gz, NULL, span );
+    if ( rc == 0 )
+    {
+        while ( rc == 0 && ! obj -> eof )
+            rc = KGZipIdxFileInflate ( obj );
+
+        if ( rc == 0 )
+        {
+            rc = KGzipIndexAddRef ( obj -> idx );
+            if ( rc == 0 )
+                * idx = obj -> idx;
+        }
+
+        KFileRelease ( & obj -> dad );
+    }
+
+    return rc;
+}
@@ -0,0 +1,359 @@
+/*===========================================================================
+ *
+ *                            PUBLIC DOMAIN NOTICE
+ *               National Center for Biotechnology Information
+ *
+ *  This software/database is a "United States Government Work" under the
+ *  terms of the United States Copyright Act.  It was written as part of
+ *  the author's official duties as a United States Government employee and
+ *  thus cannot be copyrighted.  This software/database is freely available
+ *  to the public for use. The National Library of Medicine and the U.S.
+ *  Government have not placed any restriction on its use or reproduction.
+ *
+ *  Although all reasonable efforts have been taken to ensure the accuracy
+ *  and reliability of the software and data, the NLM and the U.S.
+ *  Government do not and cannot warrant the performance or results that
+ *  may be obtained by using this software or data. The NLM and the U.S.
+ *  Government disclaim all warranties, express or implied, including
+ *  warranties of performance, merchantability or fitness for any particular
+ *  purpose.
+ *
+ *  Please cite the author in any work or product based on this material.
+ *
+ * ===========================================================================
+ */
+
+#include <kfs/extern.h>
+
+struct KPageCacheFile;
+#define KFILE_IMPL struct KPageCacheFile
+#include <kfs/impl.h>
+
+#include <kfs/pagecachefile.h>
+#include <kfs/pagefile.h>
+#include <kproc/lock.h>
+#include <kproc/cond.h>
+#include <klib/rc.h>
+#include <sysalloc.h>
+
+#include <assert.h>
+#include <stdlib.h>
+#include <string.h>
+
+
+/*--------------------------------------------------------------------------
+ * KPageCacheFile
+ *  a read-only KFile that keeps the most recently used pages
+ *  of the original file in memory
+ */
+typedef struct KPageCacheFile KPageCacheFile;
+struct KPageCacheFile
+{
+    KFile dad;
+
+    const KFile * original;
+    KPageFile * pages;
+
+    /* KPageFile is not thread-safe, the lock protects the page index
+       and the access list. pages are read from the original file and
+       copied outside of the lock, an acquired page stays valid even if
+       it is evicted meanwhile */
+    KLock * lock;
+
+    /* pages being read from the original file, guarded by "lock".
+       a reader that misses on one of them waits on "loaded" instead
+       of reading the page a second time */
+    struct KPageCacheLoad * loading;
+    KCondition * loaded;
+
+    uint64_t eof;
+};
+
+
+static
+rc_t CC KPageCacheFileDestroy ( KPageCacheFile *self )
+{
+    KPageFileRelease ( self -> pages );
+    KFileRelease ( self -> original );
+    KConditionRelease ( self -> loaded );
+    KLockRelease ( self -> lock );
+    free ( self );
+    return 0;
+}
+
+static
+struct KSysFile* CC KPageCacheFileGetSysFile ( const KPageCacheFile *self, uint64_t *offset )
+{
+    * offset = 0;
+    return NULL;
+}
+
+static
+rc_t CC KPageCacheFileRandomAccess ( const KPageCacheFile *self )
+{
+    return 0;
+}
+
+static
+rc_t CC KPageCacheFileSize ( const KPageCacheFile *self, uint64_t *size )
+{
+    * size = self -> eof;
+    return 0;
+}
+
+static
+rc_t CC KPageCacheFileSetSize ( KPageCacheFile *self, uint64_t size )
+{
+    return RC ( rcFS, rcFile, rcUpdating, rcFile, rcReadonly );
+}
+
+/* a page being read from the original file */
+typedef struct KPageCacheLoad KPageCacheLoad;
+struct KPageCacheLoad
+{
+    KPageCacheLoad * next;
+    uint64_t page_start;
+};
+
+/* GetPage
+ *  a cached page is returned under the lock. a missing one is read
+ *  with the lock dropped, so that readers of other pages, cached or
+ *  not, are not held up behind the original file
+ */
+static
+rc_t KPageCacheFileGetPage ( KPageCacheFile *self, KPage **page, uint64_t page_start )
+{
+    KPageCacheLoad load;
+    rc_t rc = KLockAcquire ( self -> lock );
+    if ( rc != 0 )
+        return rc;
+
+    while ( 1 )
+    {
+        const KPageCacheLoad * l;
+
+        rc = KPageFilePosFind ( self -> pages, page, page_start );
+        if ( rc != 0 || * page != NULL )
+        {
+            KLockUnlock ( self -> lock );
+            return rc;
+        }
+
+        for ( l = self -> loading; l != NULL; l = l -> next )
+        {
+            if ( l -> page_start == page_start )
+                break;
+        }
+        if ( l == NULL )
+            break;
+
+        /* another reader is reading this page, wait for it to finish */
+        rc = KConditionWait ( self -> loaded, self -> lock );
+        if ( rc != 0 )
+        {
+            KLockUnlock ( self -> lock );
+            return rc;
+        }
+    }
+
+    load . page_start = page_start;
+    load . next = self -> loading;
+    self -> loading = & load;
+    KLockUnlock ( self -> lock );
+
+    rc = KPageFilePosLoad ( self -> pages, page, page_start );
+
+    {
+        rc_t rc2 = KLockAcquire ( self -> lock );
+        if ( rc2 != 0 )
+        {
+            if ( rc == 0 )
+            {
+                KPageRelease ( * page );
+                * page = NULL;
+            }
+            return rc2;
+        }
+    }
+    {
+        KPageCacheLoad ** pl = & self -> loading;
+        while ( * pl != & load )
+            pl = & ( * pl ) -> next;
+        * pl = load . next;
+    }
+    if ( rc == 0 )
+    {
+        rc = KPageFileInsert ( self -> pages, page );
+        if ( rc != 0 )
+        {
+            KPageRelease ( * page );
+            * page = NULL;
+        }
+    }
+    KConditionBroadcast ( self -> loaded );
+    KLockUnlock ( self -> lock );
+
+    return rc;
+}
+
+static
+rc_t CC KPageCacheFileRead ( const KPageCacheFile *cself, uint64_t pos,
+    void *buffer, size_t bsize, size_t *num_read )
+{
+    rc_t rc = 0;
+    uint8_t * dst = buffer;
+    size_t total = 0;
+    size_t pgsize = KPageConstSize ();
+
+    /* clip the request at eof */
+    if ( pos >= cself -> eof )
+        bsize = 0;
+    else if ( ( uint64_t ) bsize > cself -> eof - pos )
+        bsize = ( size_t ) ( cself -> eof - pos );
+
+    while ( rc == 0 && total < bsize )
+    {
+        KPage * page;
+        uint64_t page_start = ( pos / pgsize ) * pgsize;
+
+        rc = KPageCacheFileGetPage ( ( KPageCacheFile* ) cself, & page, page_start );
+
+        if ( rc == 0 )
+        {
+            const uint8_t * mem;
+            size_t offset = ( size_t ) ( pos - page_start );
+            size_t to_copy = pgsize - offset;
+            if ( to_copy > bsize - total )
+                to_copy = bsize - total;
+
+            rc = KPageAccessRead ( page, ( const void** ) & mem, NULL );
+            if ( rc == 0 )
+            {
+                memmove ( & dst [ total ], & mem [ offset ], to_copy );
+                total += to_copy;
+                pos += to_copy;
+            }
+
+            KPageRelease ( page );
+        }
+    }
+
+    /* report a partial read as success */
+    if ( total != 0 )
+        rc = 0;
+
+    * num_read = total;
+    return rc;
+}
+
+static
+rc_t CC KPageCacheFileWrite ( KPageCacheFile *self, uint64_t pos,
+    const void *buffer, size_t size, size_t *num_writ )
+{
+    return RC ( rcFS, rcFile, rcUpdating, rcInterface, rcUnsupported );
+}
+
+
+static const KFile_vt_v1 vtKPageCacheFile =
+{
+    /* version 1.0 */
+    1, 0,
+
+    /* start minor version 0 methods */
+    KPageCacheFileDestroy,
+    KPageCacheFileGetSysFile,
+    KPageCacheFileRandomAccess,
+    KPageCacheFileSize,
+    KPageCacheFileSetSize,
+    KPageCacheFileRead,
+    KPageCacheFileWrite
+    /* end minor version 0 methods */
+};
+
+
+/* MakeRead
+ */
+LIB_EXPORT rc_t CC KPageCacheFileMakeRead ( const KFile ** cache,
+    const KFile * original, size_t climit )
+{
+    rc_t rc;
+
+    if ( cache == NULL )
+        return RC ( rcFS, rcFile, rcConstructing, rcParam, rcNull );
+
+    * cache = NULL;
+
+    if ( original == NULL )
+        rc = RC ( rcFS, rcFile, rcConstructing, rcParam, rcNull );
+    else if ( ! original -> read_enabled )
+        rc = RC ( rcFS, rcFile, rcConstructing, rcFile, rcNoPerm );
+    else
+    {
+        KPageCacheFile * f = calloc ( 1, sizeof * f );
+        if ( f == NULL )
+            rc = RC ( rcFS, rcFile, rcConstructing, rcMemory, rcExhausted );
+        else
+        {
+            rc = KFileSize ( original, & f -> eof );
+            if ( rc == 0 )
+                rc = KLockMake ( & f -> lock );
+            if ( rc == 0 )
+                rc = KConditionMake ( & f -> loaded );
+            if ( rc == 0 )
+                rc = KPageFileMakeRead ( ( const KPageFile** ) & f -> pages, original, climit );
+            if ( rc == 0 )
+                rc = KFileAddRef ( original );
+            if ( rc == 0 )
+            {
+                f -> original = original;
+                rc = KFileInit ( & f -> dad, ( const KFile_vt* ) & vtKPageCacheFile,
+                                 "KPageCacheFile", "no-name", true, false );
+                if ( rc == 0 )
+                {
+                    * cache = & f -> dad;
+                    return 0;
+                }
+            }
+
+            KPageCacheFileDestroy ( f );
+        }
+    }
+
+    return rc;
+}
+
+
+/* Stats
+ */
+LIB_EXPORT rc_t CC KPageCacheFileStats ( const KFile * self,
+    uint64_t * hits, uint64_t * misses, size_t * cached )
+{
+    rc_t rc;
+
+    if ( self == NULL )
+        rc = RC ( rcFS, rcFile, rcAccessing, rcSelf, rcNull );
+    else if ( self -> vt != ( const KFile_vt* ) & vtKPageCacheFile )
+        rc = RC ( rcFS, rcFile, rcAccessing, rcType, rcIncorrect );
+    else
+    {
+        KPageCacheFile * f = ( KPageCacheFile* ) self;
+        rc = KLockAcquire ( f -> lock );
+        if ( rc == 0 )
+        {
+            rc = KPageFileStats ( f -> pages, hits, misses );
+            if ( rc == 0 && cached != NULL )
+                rc = KPageFileSize ( f -> pages, NULL, NULL, cached );
+            KLockUnlock ( f -> lock );
+            return rc;
+        }
+    }
+
+    if ( hits != NULL )
+        * hits = 0;
+    if ( misses != NULL )
+        * misses = 0;
+    if ( cached != NULL )
+        * cached = 0;
+
+    return rc;
+}
@@ -643,6 +643,8 @@ struct KPageFile
     DLList by_access;
     KPageBacking *backing;
     KRefcount refcount;
+    uint64_t hits;
+    uint64_t misses;
     uint32_t count;
     uint32_t ccount;
     uint32_t climit;
@@ -818,6 +820,7 @@ LIB_EXPORT rc_t CC KPageFileMakeRead ( const KPageFile **pf, const KFile * backi
                         KRefcountInit ( & f -> refcount, 1, "KPageFile", "make", "pgfile" );
                         f -> count = 0;
                         f -> ccount = 0;
+                        f -> hits = f -> misses = 0;
                         f -> climit = ( uint32_t ) ( climit >>  PGBITS );
                         if ( f -> climit < MIN_CACHE_PAGE )
                             f -> climit = MIN_CACHE_PAGE;
@@ -893,6 +896,7 @@ LIB_EXPORT rc_t CC KPageFileMakeUpdate ( KPageFile **pf, KFile * backing, size_t
                 KRefcountInit ( & f -> refcount, 1, "KPageFile", "make", "pgfile" );
                 f -> count = 0;
                 f -> ccount = 0;
+                f -> hits = f -> misses = 0;
                 f -> climit = ( uint32_t ) ( climit >>  PGBITS );
                 if ( f -> climit < MIN_CACHE_PAGE )
                     f -> climit = MIN_CACHE_PAGE;
@@ -1043,6 +1047,35 @@ LIB_EXPORT rc_t CC KPageFileSize ( const KPageFile *self,
     return rc;
 }
 
+/* Stats
+ *  returns how often KPageFileGet found a page in the cache
+ *  and how often it had to go to the backing file
+ *
+ *  "hits" [ OUT, NULL OKAY ] - return parameter for cache hits
+ *
+ *  "misses" [ OUT, NULL OKAY ] - return parameter for cache misses
+ */
+LIB_EXPORT rc_t CC KPageFileStats ( const KPageFile *self,
+    uint64_t *hits, uint64_t *misses )
+{
+    if ( self == NULL )
+    {
+        if ( hits != NULL )
+            * hits = 0;
+        if ( misses != NULL )
+            * misses = 0;
+        return RC ( rcFS, rcFile, rcAccessing, rcSelf, rcNull );
+    }
+
+    if ( hits != NULL )
+        * hits = self -> hits;
+    if ( misses != NULL )
+        * misses = self -> misses;
+
+    return 0;
+}
+
+
 /* SetSize
  *  extends or truncates underlying file
  *  may affect cache contents
@@ -1297,6 +1330,7 @@ LIB_EXPORT rc_t CC KPageFileGet ( KPageFile *self, KPage **ppage, uint32_t page_
                 rc = KPageAddRef ( * ppage = page );
                 if ( rc == 0 )
                 {
+                    ++ self -> hits;
                     PAGE_DEBUG( ( "PAGE: {%p}.[%s] found #%u\n", self, KDbgGetColName(), page_id ) );
 
                     /* put page at head of list if not already there */
@@ -1311,6 +1345,7 @@ LIB_EXPORT rc_t CC KPageFileGet ( KPageFile *self, KPage **ppage, uint32_t page_
                 return rc;
             }
 
+            ++ self -> misses;
             rc = KPageMake ( ppage, self -> backing, page_id );
             if ( rc == 0 )
             {
@@ -1375,6 +1410,120 @@ LIB_EXPORT rc_t CC KPageFilePosGet ( KPageFile *self, KPage **page, uint64_t off
 }
 
 
+/* PosFind
+ *  returns the page corresponding to position if it is cached,
+ *  without reading from the backing file
+ *
+ *  "page" [ OUT ] - return parameter for page object,
+ *  NULL if the page is not cached
+ *
+ *  "offset" [ IN ] - offset to a byte within file
+ */
+LIB_EXPORT rc_t CC KPageFilePosFind ( KPageFile *self, KPage **ppage, uint64_t offset )
+{
+    rc_t rc;
+
+    if ( ppage == NULL )
+        return RC ( rcFS, rcFile, rcReading, rcParam, rcNull );
+
+    * ppage = NULL;
+
+    if ( self == NULL )
+        rc = RC ( rcFS, rcFile, rcReading, rcSelf, rcNull );
+    else
+    {
+        KPage *page = KPageFileIndexFind( self, ( uint32_t ) ( offset >> PGBITS ) + 1 );
+
+        rc = 0;
+        if ( page != NULL )
+        {
+            rc = KPageAddRef ( page );
+            if ( rc == 0 )
+            {
+                ++ self -> hits;
+                if ( DLListHead ( & self -> by_access ) != & page -> ln )
+                {
+                    DLListUnlink ( & self -> by_access, & page -> ln );
+                    DLListPushHead ( & self -> by_access, & page -> ln );
+                }
+                * ppage = page;
+            }
+        }
+    }
+
+    return rc;
+}
+
+
+/* PosLoad
+ *  reads the page corresponding to position from the backing file
+ *  without entering it into the cache
+ *
+ *  a read-only page file knows the size of its backing file, so
+ *  reading a page leaves the backing's eof alone and this needs
+ *  no lock against the other messages
+ *
+ *  "page" [ OUT ] - return parameter for page object
+ *
+ *  "offset" [ IN ] - offset to a byte within file
+ */
+LIB_EXPORT rc_t CC KPageFilePosLoad ( const KPageFile *self, KPage **ppage, uint64_t offset )
+{
+    rc_t rc;
+
+    if ( ppage == NULL )
+        rc = RC ( rcFS, rcFile, rcReading, rcParam, rcNull );
+    else
+    {
+        if ( self == NULL )
+            rc = RC ( rcFS, rcFile, rcReading, rcSelf, rcNull );
+        else if ( ! self -> read_only || ! self -> backing -> have_eof )
+            rc = RC ( rcFS, rcFile, rcReading, rcFile, rcUnsupported );
+        else
+            return KPageMake ( ppage, self -> backing, ( uint32_t ) ( offset >> PGBITS ) + 1 );
+
+        * ppage = NULL;
+    }
+
+    return rc;
+}
+
+
+/* Insert
+ *  enters a page returned by PosLoad into the cache
+ *
+ *  "page" [ IN, OUT ] - the page to insert. if the same page has
+ *  been cached meanwhile, the reference passed in is released and
+ *  replaced by one to the cached page
+ */
+LIB_EXPORT rc_t CC KPageFileInsert ( KPageFile *self, KPage **ppage )
+{
+    KPage *cached;
+
+    if ( ppage == NULL || * ppage == NULL )
+        return RC ( rcFS, rcFile, rcInserting, rcParam, rcNull );
+    if ( self == NULL )
+        return RC ( rcFS, rcFile, rcInserting, rcSelf, rcNull );
+    if ( ( * ppage ) -> backing != self -> backing )
+        return RC ( rcFS, rcFile, rcInserting, rcParam, rcIncorrect );
+
+    ++ self -> misses;
+
+    cached = KPageFileIndexFind( self, ( * ppage ) -> page_id );
+    if ( cached != NULL )
+    {
+        rc_t rc = KPageAddRef ( cached );
+        if ( rc != 0 )
+            return rc;
+        KPageRelease ( * ppage );
+        * ppage = cached;
+        return 0;
+    }
+
+    return KPageFileCachePage ( self, * ppage );
+}
+
+
 /* DropBacking
  *  used immediately prior to releasing
  *  prevents modified pages from being flushed to disk
@@ -0,0 +1,125 @@
+/*===========================================================================
+*
+*                            PUBLIC DOMAIN NOTICE
+*               National Center for Biotechnology Information
+*
+*  This software/database is a "United States Government Work" under the
+*  terms of the United States Copyright Act.  It was written as part of
+*  the author's official duties as a United States Government employee and
+*  thus cannot be copyrighted.  This software/database is freely available
+*  to the public for use. The National Library of Medicine and the U.S.
+*  Government have not placed any restriction on its use or reproduction.
+*
+*  Although all reasonable efforts have been taken to ensure the accuracy
+*  and reliability of the software and data, the NLM and the U.S.
+*  Government do not and cannot warrant the performance or results that
+*  may be obtained by using this software or data. The NLM and the U.S.
+*  Government disclaim all warranties, express or implied, including
+*  warranties of performance, merchantability or fitness for any particular
+*  purpose.
+*
+*  Please cite the author in any work or product based on this material.
+*
+* ===========================================================================
+*
+*/
+
+#ifndef _h_checksum_priv_
+#define _h_checksum_priv_
+
+#ifndef _h_klib_defs_
+#include <klib/defs.h>
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+/*--------------------------------------------------------------------------
+ * CHECKSUM_X86
+ *  x86-64 builds with a compiler that understands function-level
+ *  target attributes carry a carry-less multiply kernel for CRC32
+ *  and an 8-lane AVX2 kernel for MD5. the library itself keeps its
+ *  baseline instruction set; the kernels are used only when cpuid
+ *  reports the features at runtime
+ */
+#if defined __x86_64__ && \
+    ( defined __clang__ || __GNUC__ > 4 || ( __GNUC__ == 4 && __GNUC_MINOR__ >= 9 ) )
+
+#define CHECKSUM_X86 1
+#define CHECKSUM_TARGET_PCLMUL __attribute__ ( ( target ( "pclmul,ssse3" ) ) )
+#define CHECKSUM_TARGET_AVX2 __attribute__ ( ( target ( "avx2" ) ) )
+
+#include <cpuid.h>
+#include <immintrin.h>
+
+/* ckUnresolved ...
+ *  states of the cached answer to a run-time check,
+ *  kept in an atomic32_t by the file using the kernel
+ */
+enum
+{
+    ckUnresolved,
+    ckUnsupported,
+    ckSupported
+};
+
+/* ChecksumProcessorSupportsPCLMUL
+ *  run-time check for pclmulqdq and pshufb via cpuid leaf 1
+ */
+static __inline__
+bool ChecksumProcessorSupportsPCLMUL ( void )
+{
+    uint32_t a, b, c, d;
+
+    if ( __get_cpuid ( 1, & a, & b, & c, & d ) )
+    {
+        /* ecx bit 1: PCLMULQDQ, bit 9: SSSE3 */
+        if ( ( c & ( 1 << 1 ) ) != 0 && ( c & ( 1 << 9 ) ) != 0 )
+            return true;
+    }
+
+    return false;
+}
+
+/* ChecksumProcessorSupportsAVX2
+ *  run-time check for AVX2 via cpuid leaf 7, including
+ *  the operating system saving the ymm registers
+ */
+static __inline__
+bool ChecksumProcessorSupportsAVX2 ( void )
+{
+    uint32_t a, b, c, d;
+
+    if ( __get_cpuid_max ( 0, NULL ) >= 7 && __get_cpuid ( 1, & a, & b, & c, & d ) )
+    {
+        /* ecx bit 27: OSXSAVE, bit 28: AVX */
+        if ( ( c & ( 1 << 27 ) ) != 0 && ( c & ( 1 << 28 ) ) != 0 )
+        {
+            uint32_t xcr0_lo, xcr0_hi;
+
+            __asm__ ( "xgetbv" : "=a" ( xcr0_lo ), "=d" ( xcr0_hi ) : "c" ( 0 ) );
+            if ( ( xcr0_lo & 6 ) == 6 )
+            {
+                __cpuid_count ( 7, 0, a, b, c, d );
+                if ( ( b & ( 1 << 5 ) ) != 0 )
+                    return true;
+            }
+        }
+    }
+
+    return false;
+}
+
+#else
+
+#define CHECKSUM_X86 0
+
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _h_checksum_priv_ */
@@ -27,6 +27,9 @@
 #include <klib/extern.h>
 #include <klib/checksum.h>
 #include <byteswap.h>
+#include <atomic32.h>
+
+#include "checksum-priv.h"
 
 #include <sysalloc.h>
 
@@ -429,13 +432,8 @@ static uint32_t CRC32_one_byte_lookup(uint32_t previousCrc32, const void *data,
 #define QWORD_READ 0
 #define INVERT_PREVIOUS_CRC 0
 
-LIB_EXPORT uint32_t CC CRC32(uint32_t previousCrc32, const void *data, size_t length)
+static uint32_t CRC32_slicing8(uint32_t crc, const void *data, size_t length)
 {
-#if INVERT_PREVIOUS_CRC
-    uint32_t crc = ~previousCrc32; /* same as previousCrc32 ^ 0xFFFFFFFF*/
-#else
-    uint32_t crc = previousCrc32;
-#endif
 
 #if QWORD_READ == 1
     const uint64_t* current = (const uint64_t*) data;
@@ -451,6 +449,8 @@ LIB_EXPORT uint32_t CC CRC32(uint32_t previousCrc32, const void *data, size_t le
     if (nFisrtUnalignedBytes)
     {
         nFisrtUnalignedBytes = ALIGN_BYTES - nFisrtUnalignedBytes;
+        if (nFisrtUnalignedBytes > length)
+            nFisrtUnalignedBytes = length;
         crc = CRC32_one_byte_lookup(crc, data, nFisrtUnalignedBytes);
         length -= nFisrtUnalignedBytes;
         current = (const uint32_t*) ((char*)data + nFisrtUnalignedBytes);
@@ -488,7 +488,119 @@ LIB_EXPORT uint32_t CC CRC32(uint32_t previousCrc32, const void *data, size_t le
     }
 
     /* remaining 1 to 7 bytes (standard algorithm) */
-    crc = CRC32_one_byte_lookup(crc, current, length);
+    return CRC32_one_byte_lookup(crc, current, length);
+}
+
+#if CHECKSUM_X86
+/* CRC32_clmul
+ *  folds the message 512 bits at a time with carry-less multiplication
+ *  into a single 128-bit remainder, then reduces that with the tables.
+ *
+ *  the polynomial is not reflected, so each 16-byte block is byte-swapped
+ *  to put the first message byte into the most significant position.
+ *  an accumulator A = H * x^64 + L is moved forward by n bits as
+ *  H * ( x^(n+64) mod P ) ^ L * ( x^n mod P ), which keeps it within 128 bits.
+ *
+ *  requires length >= 64
+ */
+#define CRC32_X128  0xE8A45605 /* x^128 mod P */
+#define CRC32_X192  0xC5B9CD4C /* x^192 mod P */
+#define CRC32_X512  0xE6228B11 /* x^512 mod P */
+#define CRC32_X576  0x8833794C /* x^576 mod P */
+
+static CHECKSUM_TARGET_PCLMUL
+__m128i CRC32_fold(__m128i acc, __m128i k, __m128i next)
+{
+    return _mm_xor_si128(next, _mm_xor_si128(
+        _mm_clmulepi64_si128(acc, k, 0x11),
+        _mm_clmulepi64_si128(acc, k, 0x00)));
+}
+
+static CHECKSUM_TARGET_PCLMUL
+uint32_t CRC32_clmul(uint32_t crc, const void *data, size_t length)
+{
+    const __m128i bswap = _mm_setr_epi8(15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1, 0);
+    const __m128i k512 = _mm_set_epi64x(CRC32_X576, CRC32_X512);
+    const __m128i k128 = _mm_set_epi64x(CRC32_X192, CRC32_X128);
+    const __m128i* current = (const __m128i*) data;
+    __m128i a0, a1, a2, a3;
+    uint8_t tmp[16];
+
+#define LOAD_BLOCK(i) _mm_shuffle_epi8(_mm_loadu_si128(current + (i)), bswap)
+
+    /* the running crc is xor'ed into the first four message bytes */
+    a0 = _mm_xor_si128(LOAD_BLOCK(0), _mm_set_epi32((int)crc, 0, 0, 0));
+    a1 = LOAD_BLOCK(1);
+    a2 = LOAD_BLOCK(2);
+    a3 = LOAD_BLOCK(3);
+    current += 4;
+    length -= 64;
+
+    while (length >= 64)
+    {
+        a0 = CRC32_fold(a0, k512, LOAD_BLOCK(0));
+        a1 = CRC32_fold(a1, k512, LOAD_BLOCK(1));
+        a2 = CRC32_fold(a2, k512, LOAD_BLOCK(2));
+        a3 = CRC32_fold(a3, k512, LOAD_BLOCK(3));
+        current += 4;
+        length -= 64;
+    }
+
+    /* combine the four lanes */
+    a1 = CRC32_fold(a0, k128, a1);
+    a2 = CRC32_fold(a1, k128, a2);
+    a3 = CRC32_fold(a2, k128, a3);
+
+    while (length >= 16)
+    {
+        a3 = CRC32_fold(a3, k128, LOAD_BLOCK(0));
+        ++current;
+        length -= 16;
+    }
+
+#undef LOAD_BLOCK
+
+    /* the crc of the remainder with zero initial value is the crc so far */
+    _mm_storeu_si128((__m128i*) tmp, _mm_shuffle_epi8(a3, bswap));
+    crc = CRC32_slicing8(0, tmp, sizeof tmp);
+
+    return CRC32_slicing8(crc, current, length);
+}
+
+/* the kernel needs one full 512-bit fold */
+#define CRC32_CLMUL_MIN 64
+
+/* CRC32UseCLMUL
+ *  threads racing through the first call all store the same answer
+ */
+static atomic32_t crc32_clmul;
+
+static bool CRC32UseCLMUL(void)
+{
+    int state = atomic32_read(&crc32_clmul);
+    if (state == ckUnresolved)
+    {
+        state = ChecksumProcessorSupportsPCLMUL() ? ckSupported : ckUnsupported;
+        atomic32_set(&crc32_clmul, state);
+    }
+    return state == ckSupported;
+}
+#endif
+
+LIB_EXPORT uint32_t CC CRC32(uint32_t previousCrc32, const void *data, size_t length)
+{
+#if INVERT_PREVIOUS_CRC
+    uint32_t crc = ~previousCrc32; /* same as previousCrc32 ^ 0xFFFFFFFF*/
+#else
+    uint32_t crc = previousCrc32;
+#endif
+
+#if CHECKSUM_X86
+    if (length >= CRC32_CLMUL_MIN && CRC32UseCLMUL())
+        crc = CRC32_clmul(crc, data, length);
+    else
+#endif
+        crc = CRC32_slicing8(crc, data, length);
 
 #if INVERT_PREVIOUS_CRC
     return ~crc; // same as crc ^ 0xFFFFFFFF
@@ -0,0 +1,83 @@
+/*===========================================================================
+ *
+ *                            PUBLIC DOMAIN NOTICE
+ *               National Center for Biotechnology Information
+ *
+ *  This software/database is a "United States Government Work" under the
+ *  terms of the United States Copyright Act.  It was written as part of
+ *  the author's official duties as a United States Government employee and
+ *  thus cannot be copyrighted.  This software/database is freely available
+ *  to the public for use. The National Library of Medicine and the U.S.
+ *  Government have not placed any restriction on its use or reproduction.
+ *
+ *  Although all reasonable efforts have been taken to ensure the accuracy
+ *  and reliability of the software and data, the NLM and the U.S.
+ *  Government do not and cannot warrant the performance or results that
+ *  may be obtained by using this software or data. The NLM and the U.S.
+ *  Government disclaim all warranties, express or implied, including
+ *  warranties of performance, merchantability or fitness for any particular
+ *  purpose.
+ *
+ *  Please cite the author in any work or product based on this material.
+ *
+ * ===========================================================================
+ *
+ */
+
+#ifndef _h_data_buffer_priv_
+#define _h_data_buffer_priv_
+
+#ifndef _h_klib_defs_
+#include <klib/defs.h>
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+/*--------------------------------------------------------------------------
+ * KDataBufferPool
+ *  operating system support for the buffer pool in data-buffer.c,
+ *  implemented in sysbufpool.c
+ */
+
+/* Lock
+ * Unlock
+ *  guard the shared free lists
+ */
+void KDataBufferPoolLock ( void );
+void KDataBufferPoolUnlock ( void );
+
+/* GetThreadCache
+ * SetThreadCache
+ *  thread-local slot for the pool's per-thread cache.
+ *  Set returns false when the platform keeps no per-thread caches;
+ *  on thread exit a cache is handed to KDataBufferPoolReleaseThreadCache
+ */
+void * KDataBufferPoolGetThreadCache ( void );
+bool KDataBufferPoolSetThreadCache ( void * cache );
+
+/* ReleaseThreadCache
+ *  implemented by data-buffer.c
+ */
+void KDataBufferPoolReleaseThreadCache ( void * cache );
+
+/* MapHuge
+ *  map "bytes" ( a multiple of 2MB ) of zero-filled memory,
+ *  aligned to 2MB and eligible for huge pages
+ *  returns NULL if not available
+ */
+void * KDataBufferPoolMapHuge ( size_t bytes );
+
+/* UnmapHuge
+ *  unmap all or a trailing part of a mapping from MapHuge
+ */
+void KDataBufferPoolUnmapHuge ( void * addr, size_t bytes );
+
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _h_data_buffer_priv_ */
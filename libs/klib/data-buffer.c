@@ -28,9 +28,12 @@
 #include <klib/data-buffer.h>
 #include <klib/rc.h>
 #include <atomic32.h>
+#include <atomic.h>
 #include <bitstr.h>
 #include <sysalloc.h>
 
+#include "data-buffer-priv.h"
+
 #include <stdlib.h>
 #include <string.h>
 #include <assert.h>
@@ -103,7 +106,8 @@ typedef struct buffer_impl_t buffer_impl_t;
 struct buffer_impl_t {
     size_t allocated;
     atomic32_t refcount;
-    uint32_t foo;
+    uint16_t foo;
+    uint16_t origin;
 #if _ARCH_BITS == 32
     uint32_t foo2;
 #endif
@@ -115,20 +119,396 @@ static size_t roundup(size_t value, unsigned bits)
     return (value + mask) & (~mask);
 }
 
+static void *get_data_w(buffer_impl_t *self)
+{
+    return &self[1];
+}
+
+/*--------------------------------------------------------------------------
+ * buffer pool
+ *  storage of up to POOL_MAX_CAPACITY bytes comes in power of two size
+ *  classes from 4K up. released blocks go to a small per-thread cache,
+ *  from there in batches to shared free lists, and only when those are
+ *  full back to malloc. blocks of HUGE_MIN_CAPACITY and more are mapped
+ *  directly, aligned and sized to 2M so they may sit on huge pages.
+ *
+ *  "origin" in the header records where a block came from, so that
+ *  blocks allocated while the pool was disabled are still released
+ *  correctly after it has been enabled, and vice versa.
+ */
+#define POOL_MIN_BITS 12
+#define POOL_CLASSES 9
+#define POOL_MAX_CAPACITY ( ( size_t ) 1 << ( POOL_MIN_BITS + POOL_CLASSES - 1 ) )
+
+/* per class limits, in bytes, of the thread caches and shared lists */
+#define THREAD_CACHE_DEPTH 16
+#define THREAD_CACHE_BYTES ( ( size_t ) 2 << 20 )
+#define SHARED_LIST_BYTES ( ( size_t ) 16 << 20 )
+
+#define HUGE_PAGE_BITS 21
+#define HUGE_MIN_CAPACITY ( ( size_t ) 4 << 20 )
+
+#define ORIGIN_MALLOC 0
+#define ORIGIN_HUGE 0xFFFF
+/* any other origin is size class + 1 */
+
+/* a thread's cache also carries that thread's counters, so that the
+   common paths touch no shared memory beyond the live byte count */
+typedef struct pool_cache_t pool_cache_t;
+struct pool_cache_t {
+    pool_cache_t *next;
+    pool_cache_t **prev;
+    uint64_t allocations;
+    uint64_t pool_hits;
+    uint64_t resized_in_place;
+    uint32_t count[POOL_CLASSES];
+    buffer_impl_t *block[POOL_CLASSES][THREAD_CACHE_DEPTH];
+};
+
+/* both are read on every allocation and may be set from any thread;
+   the pool is off until KDataBufferPoolEnable turns it on */
+static atomic32_t pool_enabled;
+static atomic32_t pool_no_thread_cache;
+
+/* guarded by KDataBufferPoolLock */
+static buffer_impl_t *shared_list[POOL_CLASSES];
+static uint32_t shared_count[POOL_CLASSES];
+static pool_cache_t *thread_caches;
+
+/* atomic_t is 32 bits on some 64-bit platforms,
+   too small to count bytes or a long run of events */
+#if _ARCH_BITS == 64
+typedef atomic64_t stat_t;
+typedef int64_t stat_int_t;
+#define stat_read(v) atomic64_read(v)
+#define stat_add(v, i) atomic64_add(v, i)
+#define stat_add_and_read(v, i) atomic64_add_and_read(v, i)
+#define stat_test_and_set(v, s, t) atomic64_test_and_set(v, s, t)
+#define stat_inc(v) atomic64_inc(v)
+#else
+typedef atomic_t stat_t;
+typedef long stat_int_t;
+#define stat_read(v) atomic_read(v)
+#define stat_add(v, i) atomic_add(v, i)
+#define stat_add_and_read(v, i) atomic_add_and_read(v, i)
+#define stat_test_and_set(v, s, t) atomic_test_and_set(v, s, t)
+#define stat_inc(v) atomic_inc(v)
+#endif
+
+/* counters of threads without a cache, or whose cache is gone */
+static stat_t stat_allocations;
+static stat_t stat_pool_hits;
+static stat_t stat_resized_in_place;
+
+static stat_t stat_live_bytes;
+static stat_t stat_peak_bytes;
+static stat_t stat_pool_reuses;
+static stat_t stat_huge_allocations;
+
+#define COUNT_EVENT(cache, field) \
+    do { if ((cache) != NULL) ++(cache)->field; else stat_inc(&stat_##field); } while (0)
+
+static size_t class_capacity(unsigned k)
+{
+    return ((size_t)1u) << (POOL_MIN_BITS + k);
+}
+
+static size_t class_block_size(unsigned k)
+{
+    return class_capacity(k) + sizeof(buffer_impl_t);
+}
+
+static unsigned size_class(size_t capacity)
+{
+    unsigned k = 0;
+    while (class_capacity(k) < capacity)
+        ++k;
+    return k;
+}
+
+static uint32_t thread_cache_limit(unsigned k)
+{
+    size_t const n = THREAD_CACHE_BYTES / class_capacity(k);
+    return n < 2 ? 2 : n > THREAD_CACHE_DEPTH ? THREAD_CACHE_DEPTH : (uint32_t)n;
+}
+
+static uint32_t shared_list_limit(unsigned k)
+{
+    size_t const n = SHARED_LIST_BYTES / class_capacity(k);
+    return n < 4 ? 4 : (uint32_t)n;
+}
+
+/* bytes of memory behind a block, header included */
+static size_t footprint(buffer_impl_t const *self)
+{
+    switch (self->origin) {
+    case ORIGIN_MALLOC:
+        return self->allocated + sizeof(*self);
+    case ORIGIN_HUGE:
+        return roundup(self->allocated + sizeof(*self), HUGE_PAGE_BITS);
+    default:
+        return class_block_size(self->origin - 1);
+    }
+}
+
+static void account_live(size_t added, size_t removed)
+{
+    stat_int_t const live = stat_add_and_read(&stat_live_bytes, (stat_int_t)added - (stat_int_t)removed);
+    stat_int_t peak = stat_read(&stat_peak_bytes);
+
+    while (live > peak) {
+        stat_int_t const prior = stat_test_and_set(&stat_peak_bytes, live, peak);
+        if (prior == peak)
+            break;
+        peak = prior;
+    }
+}
+
+static pool_cache_t *thread_cache(void)
+{
+    pool_cache_t *cache;
+
+    if (!atomic32_read(&pool_enabled) || atomic32_read(&pool_no_thread_cache))
+        return NULL;
+
+    cache = KDataBufferPoolGetThreadCache();
+    if (cache == NULL) {
+        cache = calloc(1, sizeof(*cache));
+        if (cache != NULL) {
+            if (!KDataBufferPoolSetThreadCache(cache)) {
+                free(cache);
+                atomic32_set(&pool_no_thread_cache, 1);
+                return NULL;
+            }
+            KDataBufferPoolLock();
+            cache->next = thread_caches;
+            cache->prev = &thread_caches;
+            if (thread_caches != NULL)
+                thread_caches->prev = &cache->next;
+            thread_caches = cache;
+            KDataBufferPoolUnlock();
+        }
+    }
+    return cache;
+}
+
+static void shared_push(unsigned k, buffer_impl_t *block)
+{
+    *(buffer_impl_t **)get_data_w(block) = shared_list[k];
+    shared_list[k] = block;
+    ++shared_count[k];
+}
+
+static buffer_impl_t *shared_pop(unsigned k)
+{
+    buffer_impl_t *block = shared_list[k];
+    if (block != NULL) {
+        shared_list[k] = *(buffer_impl_t **)get_data_w(block);
+        --shared_count[k];
+    }
+    return block;
+}
+
+/* moves all but the newest "keep" blocks of a thread cache class
+   to the shared list, releasing what does not fit there */
+static void thread_cache_spill(pool_cache_t *cache, unsigned k, uint32_t keep)
+{
+    uint32_t i;
+    uint32_t const n = cache->count[k] - keep;
+    buffer_impl_t *excess[THREAD_CACHE_DEPTH];
+    uint32_t nexcess = 0;
+
+    KDataBufferPoolLock();
+    for (i = 0; i != n; ++i) {
+        if (shared_count[k] < shared_list_limit(k))
+            shared_push(k, cache->block[k][i]);
+        else
+            excess[nexcess++] = cache->block[k][i];
+    }
+    KDataBufferPoolUnlock();
+
+    memmove(&cache->block[k][0], &cache->block[k][n], keep * sizeof(cache->block[k][0]));
+    cache->count[k] = keep;
+
+    for (i = 0; i != nexcess; ++i)
+        free(excess[i]);
+}
+
+/* called by the platform layer when a thread with a cache exits */
+void KDataBufferPoolReleaseThreadCache(void *data)
+{
+    pool_cache_t *cache = data;
+    unsigned k;
+
+    for (k = 0; k != POOL_CLASSES; ++k)
+        thread_cache_spill(cache, k, 0);
+
+    KDataBufferPoolLock();
+    *cache->prev = cache->next;
+    if (cache->next != NULL)
+        cache->next->prev = cache->prev;
+    KDataBufferPoolUnlock();
+
+    stat_add(&stat_allocations, (stat_int_t)cache->allocations);
+    stat_add(&stat_pool_hits, (stat_int_t)cache->pool_hits);
+    stat_add(&stat_resized_in_place, (stat_int_t)cache->resized_in_place);
+    free(cache);
+}
+
+static buffer_impl_t *pool_get(pool_cache_t *cache, unsigned k)
+{
+    buffer_impl_t *block = NULL;
+
+    if (cache != NULL && cache->count[k] != 0) {
+        block = cache->block[k][--cache->count[k]];
+        ++cache->pool_hits;
+        return block;
+    }
+
+    KDataBufferPoolLock();
+    block = shared_pop(k);
+    if (block != NULL && cache != NULL) {
+        /* refill half of the thread cache while holding the lock */
+        uint32_t const refill = thread_cache_limit(k) / 2;
+        while (cache->count[k] < refill && shared_count[k] != 0)
+            cache->block[k][cache->count[k]++] = shared_pop(k);
+    }
+    KDataBufferPoolUnlock();
+
+    if (block != NULL)
+        stat_inc(&stat_pool_reuses);
+    else
+        block = malloc(class_block_size(k));
+    return block;
+}
+
+static void pool_put(pool_cache_t *cache, unsigned k, buffer_impl_t *block)
+{
+    if (cache != NULL) {
+        uint32_t const limit = thread_cache_limit(k);
+        if (cache->count[k] == limit)
+            thread_cache_spill(cache, k, limit / 2);
+        cache->block[k][cache->count[k]++] = block;
+        return;
+    }
+
+    KDataBufferPoolLock();
+    if (shared_count[k] < shared_list_limit(k)) {
+        shared_push(k, block);
+        block = NULL;
+    }
+    KDataBufferPoolUnlock();
+
+    free(block);
+}
+
+/* the origin a new block of "capacity" bytes would get */
+static uint16_t choose_origin(size_t capacity)
+{
+    if (!atomic32_read(&pool_enabled))
+        return ORIGIN_MALLOC;
+    if (capacity <= POOL_MAX_CAPACITY)
+        return (uint16_t)(size_class(capacity) + 1);
+    if (capacity >= HUGE_MIN_CAPACITY)
+        return ORIGIN_HUGE;
+    return ORIGIN_MALLOC;
+}
+
+static buffer_impl_t *block_alloc(size_t capacity)
+{
+    buffer_impl_t *y = NULL;
+    uint16_t origin = choose_origin(capacity);
+    pool_cache_t *cache = thread_cache();
+
+    if (origin == ORIGIN_HUGE) {
+        y = KDataBufferPoolMapHuge(roundup(capacity + sizeof(*y), HUGE_PAGE_BITS));
+        if (y != NULL)
+            stat_inc(&stat_huge_allocations);
+        else
+            origin = ORIGIN_MALLOC;
+    }
+    else if (origin != ORIGIN_MALLOC) {
+        y = pool_get(cache, origin - 1);
+    }
+    if (origin == ORIGIN_MALLOC)
+        y = malloc(capacity + sizeof(*y));
+
+    if (y != NULL) {
+        y->allocated = capacity;
+        y->origin = origin;
+        y->foo = 0;
+        atomic32_set(&y->refcount, 1);
+        COUNT_EVENT(cache, allocations);
+        account_live(footprint(y), 0);
+    }
+    return y;
+}
+
+static void block_free(buffer_impl_t *self)
+{
+    account_live(0, footprint(self));
+
+    switch (self->origin) {
+    case ORIGIN_MALLOC:
+        free(self);
+        break;
+    case ORIGIN_HUGE:
+        KDataBufferPoolUnmapHuge(self, footprint(self));
+        break;
+    default:
+        if (!atomic32_read(&pool_enabled))
+            free(self);
+        else
+            pool_put(thread_cache(), self->origin - 1, self);
+        break;
+    }
+}
+
+/* grows or shrinks a block with refcount 1 within the memory it already has */
+static bool block_fits(buffer_impl_t *self, size_t capacity)
+{
+    switch (self->origin) {
+    case ORIGIN_MALLOC:
+        return false;
+    case ORIGIN_HUGE:
+        return capacity >= HUGE_MIN_CAPACITY &&
+               capacity + sizeof(*self) <= footprint(self);
+    default:
+        return capacity <= class_capacity(self->origin - 1) &&
+               size_class(capacity) == (unsigned)(self->origin - 1);
+    }
+}
+
+/* moves the contents of a block with refcount 1 into a new block */
+static buffer_impl_t *block_move(buffer_impl_t *self, size_t capacity)
+{
+    buffer_impl_t *y;
+
+    if (self->origin == ORIGIN_MALLOC && choose_origin(capacity) == ORIGIN_MALLOC) {
+        size_t const prior = footprint(self);
+        y = realloc(self, capacity + sizeof(*y));
+        if (y != NULL) {
+            y->allocated = capacity;
+            account_live(footprint(y), prior);
+        }
+        return y;
+    }
+
+    y = block_alloc(capacity);
+    if (y != NULL) {
+        memcpy(get_data_w(y), get_data_w(self), capacity < self->allocated ? capacity : self->allocated);
+        block_free(self);
+    }
+    return y;
+}
+
 static
 rc_t allocate(buffer_impl_t **target, size_t capacity) {
-    buffer_impl_t *y = malloc(capacity + sizeof(*y));
+    buffer_impl_t *y = block_alloc(capacity);
 
     if (y == NULL)
         return RC(rcRuntime, rcBuffer, rcAllocating, rcMemory, rcExhausted);
 
-    y->allocated = capacity;
-    atomic32_set(&y->refcount, 1);
-    
-#if DEBUG_MALLOC_FREE
-    y->foo = 0;
-#endif
-
     *target = y;
     return 0;
 }
@@ -153,7 +533,7 @@ static void release(buffer_impl_t *self) {
         }
         self->foo = 55;
 #endif
-        free(self);
+        block_free(self);
     }
 #if DEBUG_MALLOC_FREE
     else if (refcount < 1) {
@@ -173,16 +553,21 @@ static rc_t reallocate(buffer_impl_t **target, size_t capacity) {
     /* check reference count for copies */
     if (atomic32_read(&self->refcount) <= 1)
     {
-        temp = realloc(self, capacity + sizeof(*temp));
+        if (block_fits(self, capacity)) {
+            self->allocated = capacity;
+            COUNT_EVENT(thread_cache(), resized_in_place);
+            return 0;
+        }
+        temp = block_move(self, capacity);
         if (temp == NULL)
             return RC(rcRuntime, rcBuffer, rcResizing, rcMemory, rcExhausted);
     }
     else
     {
-        temp = malloc(capacity + sizeof(*temp));
+        temp = block_alloc(capacity);
         if (temp == NULL)
             return RC(rcRuntime, rcBuffer, rcResizing, rcMemory, rcExhausted);
-        memcpy(temp, self, self->allocated + sizeof(*temp));
+        memcpy(get_data_w(temp), get_data_w(self), self->allocated);
         release(self);
     }
     self = temp;
@@ -198,8 +583,23 @@ static rc_t shrink(buffer_impl_t **target, size_t capacity)
     buffer_impl_t *self = *target;
     
     if (capacity < self->allocated && atomic32_read(&self->refcount) == 1) {
-        buffer_impl_t *temp = realloc(self, capacity + sizeof(*temp));
-        
+        buffer_impl_t *temp;
+
+        if (block_fits(self, capacity)) {
+            if (self->origin == ORIGIN_HUGE) {
+                /* return the tail of the mapping */
+                size_t const prior = footprint(self);
+                size_t const keep = roundup(capacity + sizeof(*self), HUGE_PAGE_BITS);
+                if (keep < prior) {
+                    KDataBufferPoolUnmapHuge((uint8_t *)self + keep, prior - keep);
+                    account_live(keep, prior);
+                }
+            }
+            self->allocated = capacity;
+            return 0;
+        }
+
+        temp = block_move(self, capacity);
         if (temp == NULL)
             return RC(rcRuntime, rcBuffer, rcResizing, rcMemory, rcExhausted);
 
@@ -217,11 +617,9 @@ static buffer_impl_t* make_copy(buffer_impl_t *self) {
     if (atomic32_read_and_add_eq(&self->refcount, 1, 1)==1)
         return self;
     else {
-        buffer_impl_t *copy = malloc(self->allocated + sizeof(*self));
-        if (copy) {
-            memcpy(copy, self, self->allocated + sizeof(*copy));
-            atomic32_set(&copy->refcount, 1);
-        }
+        buffer_impl_t *copy = block_alloc(self->allocated);
+        if (copy)
+            memcpy(get_data_w(copy), get_data_w(self), self->allocated);
         return copy;
     }
 }
@@ -352,7 +750,9 @@ static rc_t KDataBufferResizeInt(KDataBuffer *self, uint64_t new_count) {
     /* is sub-buffer but is sole reference */
     rc = allocate(&new_imp, roundup(new_size, 12));
     if (rc == 0) {
-        memcpy((void *)get_data(new_imp), self->base, new_size);
+        /* copy no more than what the old block holds past "base" */
+        size_t const avail = cur_end - (const uint8_t *)self->base;
+        memcpy((void *)get_data(new_imp), self->base, new_size < avail ? new_size : avail);
         release(imp);
         self->base = (void *)get_data(new_imp);
         self->ignore = new_imp;
@@ -606,8 +1006,13 @@ LIB_EXPORT rc_t CC KDataBufferShrink(KDataBuffer *self)
 {
     rc_t rc = 0;
     if (self && self->ignore) {
+        /* a sub-buffer keeps everything before its start */
+        size_t const offset = (uint8_t const *)self->base - (uint8_t const *)get_data(self->ignore);
+
         rc = shrink((buffer_impl_t **)&self->ignore,
-            (self->elem_bits * self->elem_count + self->bit_offset + 7) / 8);
+            offset + (self->elem_bits * self->elem_count + self->bit_offset + 7) / 8);
+        if (rc == 0)
+            self->base = (uint8_t *)get_data(self->ignore) + offset;
         cc ( self );
     }
     return rc;
@@ -654,3 +1059,92 @@ LIB_EXPORT rc_t CC KDataBufferCheckIntegrity (const KDataBuffer *self)
 }
 
 /* 0x101e9b000 */
+
+
+/*--------------------------------------------------------------------------
+ * KDataBufferPool
+ */
+
+LIB_EXPORT bool CC KDataBufferPoolEnable ( bool enable )
+{
+    int const want = enable ? 1 : 0;
+    int prior = atomic32_read ( & pool_enabled );
+
+    while ( 1 )
+    {
+        int const seen = atomic32_test_and_set ( & pool_enabled, want, prior );
+        if ( seen == prior )
+            break;
+        prior = seen;
+    }
+    return prior != 0;
+}
+
+LIB_EXPORT void CC KDataBufferPoolTrim ( void )
+{
+    unsigned k;
+    buffer_impl_t *list [ POOL_CLASSES ];
+    pool_cache_t *cache = atomic32_read ( & pool_no_thread_cache ) ? NULL : KDataBufferPoolGetThreadCache ();
+
+    /* the calling thread's cache goes to the shared lists first */
+    if ( cache != NULL )
+    {
+        for ( k = 0; k != POOL_CLASSES; ++ k )
+            thread_cache_spill ( cache, k, 0 );
+    }
+
+    KDataBufferPoolLock ();
+    for ( k = 0; k != POOL_CLASSES; ++ k )
+    {
+        list [ k ] = shared_list [ k ];
+        shared_list [ k ] = NULL;
+        shared_count [ k ] = 0;
+    }
+    KDataBufferPoolUnlock ();
+
+    for ( k = 0; k != POOL_CLASSES; ++ k )
+    {
+        while ( list [ k ] != NULL )
+        {
+            buffer_impl_t *block = list [ k ];
+            list [ k ] = * ( buffer_impl_t ** ) get_data_w ( block );
+            free ( block );
+        }
+    }
+}
+
+LIB_EXPORT rc_t CC KDataBufferPoolGetStats ( KDataBufferPoolStats *stats )
+{
+    unsigned k;
+    pool_cache_t *cache;
+
+    if ( stats == NULL )
+        return RC ( rcRuntime, rcBuffer, rcAccessing, rcParam, rcNull );
+
+    memset ( stats, 0, sizeof * stats );
+
+    /* the other threads' counters are read without stopping them,
+       so the totals are only as exact as a snapshot can be */
+    KDataBufferPoolLock ();
+    for ( k = 0; k != POOL_CLASSES; ++ k )
+        stats -> cached_bytes += ( uint64_t ) shared_count [ k ] * class_block_size ( k );
+    for ( cache = thread_caches; cache != NULL; cache = cache -> next )
+    {
+        for ( k = 0; k != POOL_CLASSES; ++ k )
+            stats -> cached_bytes += ( uint64_t ) cache -> count [ k ] * class_block_size ( k );
+        stats -> allocations += cache -> allocations;
+        stats -> pool_hits += cache -> pool_hits;
+        stats -> resized_in_place += cache -> resized_in_place;
+    }
+    KDataBufferPoolUnlock ();
+
+    stats -> live_bytes = ( uint64_t ) stat_read ( & stat_live_bytes );
+    stats -> peak_bytes = ( uint64_t ) stat_read ( & stat_peak_bytes );
+    stats -> allocations += ( uint64_t ) stat_read ( & stat_allocations );
+    stats -> pool_hits += ( uint64_t ) stat_read ( & stat_pool_hits );
+    stats -> pool_reuses = ( uint64_t ) stat_read ( & stat_pool_reuses );
+    stats -> resized_in_place += ( uint64_t ) stat_read ( & stat_resized_in_place );
+    stats -> huge_allocations = ( uint64_t ) stat_read ( & stat_huge_allocations );
+
+    return 0;
+}
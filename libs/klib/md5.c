@@ -54,6 +54,9 @@
 #include <klib/extern.h>
 #include <klib/checksum.h>
 #include <sysalloc.h>
+#include <atomic32.h>
+
+#include "checksum-priv.h"
 
 #include <string.h>
 #include <endian.h>
@@ -387,6 +390,337 @@ LIB_EXPORT void CC MD5StateAppend ( MD5State *md5, const void *data, size_t size
     }
 }
 
+#if CHECKSUM_X86
+/* MD5StateProcess8
+ *  runs the same 64 steps as MD5StateProcess on eight independent
+ *  states at once, one per 32-bit lane of the AVX2 registers.
+ *
+ *  each lane consumes "blocks [ i ]" whole blocks from "data [ i ]".
+ *  the vector loop runs while at least two lanes still have input;
+ *  lanes that finish early are fed a dummy block and keep their state.
+ *  whatever is left over for a single lane goes through MD5StateProcess.
+ */
+#define MD5_LANES 8
+
+static CHECKSUM_TARGET_AVX2
+void MD5Transpose8 ( __m256i r [ 8 ] )
+{
+    __m256i t0 = _mm256_unpacklo_epi32 ( r [ 0 ], r [ 1 ] );
+    __m256i t1 = _mm256_unpackhi_epi32 ( r [ 0 ], r [ 1 ] );
+    __m256i t2 = _mm256_unpacklo_epi32 ( r [ 2 ], r [ 3 ] );
+    __m256i t3 = _mm256_unpackhi_epi32 ( r [ 2 ], r [ 3 ] );
+    __m256i t4 = _mm256_unpacklo_epi32 ( r [ 4 ], r [ 5 ] );
+    __m256i t5 = _mm256_unpackhi_epi32 ( r [ 4 ], r [ 5 ] );
+    __m256i t6 = _mm256_unpacklo_epi32 ( r [ 6 ], r [ 7 ] );
+    __m256i t7 = _mm256_unpackhi_epi32 ( r [ 6 ], r [ 7 ] );
+
+    __m256i u0 = _mm256_unpacklo_epi64 ( t0, t2 );
+    __m256i u1 = _mm256_unpackhi_epi64 ( t0, t2 );
+    __m256i u2 = _mm256_unpacklo_epi64 ( t1, t3 );
+    __m256i u3 = _mm256_unpackhi_epi64 ( t1, t3 );
+    __m256i u4 = _mm256_unpacklo_epi64 ( t4, t6 );
+    __m256i u5 = _mm256_unpackhi_epi64 ( t4, t6 );
+    __m256i u6 = _mm256_unpacklo_epi64 ( t5, t7 );
+    __m256i u7 = _mm256_unpackhi_epi64 ( t5, t7 );
+
+    r [ 0 ] = _mm256_permute2x128_si256 ( u0, u4, 0x20 );
+    r [ 1 ] = _mm256_permute2x128_si256 ( u1, u5, 0x20 );
+    r [ 2 ] = _mm256_permute2x128_si256 ( u2, u6, 0x20 );
+    r [ 3 ] = _mm256_permute2x128_si256 ( u3, u7, 0x20 );
+    r [ 4 ] = _mm256_permute2x128_si256 ( u0, u4, 0x31 );
+    r [ 5 ] = _mm256_permute2x128_si256 ( u1, u5, 0x31 );
+    r [ 6 ] = _mm256_permute2x128_si256 ( u2, u6, 0x31 );
+    r [ 7 ] = _mm256_permute2x128_si256 ( u3, u7, 0x31 );
+}
+
+static CHECKSUM_TARGET_AVX2
+void MD5StateProcess8 ( MD5State *md5 [ MD5_LANES ],
+    const uint8_t *data [ MD5_LANES ], size_t blocks [ MD5_LANES ] )
+{
+    static const uint8_t dummy [ 64 ];
+
+    int i, active;
+    __m256i a, b, c, d;
+    uint32_t st [ 4 ] [ MD5_LANES ];
+
+    for ( active = i = 0; i < MD5_LANES; ++ i )
+    {
+        if ( blocks [ i ] != 0 )
+            ++ active;
+        st [ 0 ] [ i ] = md5 [ i ] == NULL ? 0 : md5 [ i ] -> abcd [ 0 ];
+        st [ 1 ] [ i ] = md5 [ i ] == NULL ? 0 : md5 [ i ] -> abcd [ 1 ];
+        st [ 2 ] [ i ] = md5 [ i ] == NULL ? 0 : md5 [ i ] -> abcd [ 2 ];
+        st [ 3 ] [ i ] = md5 [ i ] == NULL ? 0 : md5 [ i ] -> abcd [ 3 ];
+    }
+
+    if ( active < 2 )
+        goto scalar;
+
+    a = _mm256_loadu_si256 ( ( const __m256i* ) st [ 0 ] );
+    b = _mm256_loadu_si256 ( ( const __m256i* ) st [ 1 ] );
+    c = _mm256_loadu_si256 ( ( const __m256i* ) st [ 2 ] );
+    d = _mm256_loadu_si256 ( ( const __m256i* ) st [ 3 ] );
+
+#define ROTATE_LEFT8( x, n ) \
+    _mm256_or_si256 ( _mm256_slli_epi32 ( x, n ), _mm256_srli_epi32 ( x, 32 - ( n ) ) )
+#define F8( x, y, z ) \
+    _mm256_xor_si256 ( z, _mm256_and_si256 ( x, _mm256_xor_si256 ( y, z ) ) )
+#define G8( x, y, z ) \
+    _mm256_xor_si256 ( y, _mm256_and_si256 ( z, _mm256_xor_si256 ( x, y ) ) )
+#define H8( x, y, z ) \
+    _mm256_xor_si256 ( _mm256_xor_si256 ( x, y ), z )
+#define I8( x, y, z ) \
+    _mm256_xor_si256 ( y, _mm256_or_si256 ( x, _mm256_xor_si256 ( z, ones ) ) )
+#define SET8( f, a, b, c, d, k, s, Ti ) \
+    a = _mm256_add_epi32 ( a, _mm256_add_epi32 ( f ( b, c, d ), \
+        _mm256_add_epi32 ( X [ k ], _mm256_set1_epi32 ( ( int ) ( Ti ) ) ) ) ); \
+    a = _mm256_add_epi32 ( ROTATE_LEFT8 ( a, s ), b )
+
+    while ( active >= 2 )
+    {
+        const __m256i ones = _mm256_set1_epi32 ( -1 );
+        __m256i X [ 16 ], keep;
+        __m256i aa = a, bb = b, cc = c, dd = d;
+        int32_t live [ MD5_LANES ];
+
+        /* load 16 words per lane and turn them into 16 vectors of 8 lanes */
+        for ( i = 0; i < MD5_LANES; ++ i )
+        {
+            const uint8_t *p = dummy;
+            live [ i ] = 0;
+            if ( blocks [ i ] != 0 )
+            {
+                p = data [ i ];
+                live [ i ] = -1;
+            }
+            X [ i ] = _mm256_loadu_si256 ( ( const __m256i* ) p );
+            X [ i + 8 ] = _mm256_loadu_si256 ( ( const __m256i* ) ( p + 32 ) );
+        }
+        MD5Transpose8 ( X );
+        MD5Transpose8 ( X + 8 );
+        keep = _mm256_loadu_si256 ( ( const __m256i* ) live );
+
+        SET8 ( F8, a, b, c, d,  0,  7,  T1 );
+        SET8 ( F8, d, a, b, c,  1, 12,  T2 );
+        SET8 ( F8, c, d, a, b,  2, 17,  T3 );
+        SET8 ( F8, b, c, d, a,  3, 22,  T4 );
+        SET8 ( F8, a, b, c, d,  4,  7,  T5 );
+        SET8 ( F8, d, a, b, c,  5, 12,  T6 );
+        SET8 ( F8, c, d, a, b,  6, 17,  T7 );
+        SET8 ( F8, b, c, d, a,  7, 22,  T8 );
+        SET8 ( F8, a, b, c, d,  8,  7,  T9 );
+        SET8 ( F8, d, a, b, c,  9, 12, T10 );
+        SET8 ( F8, c, d, a, b, 10, 17, T11 );
+        SET8 ( F8, b, c, d, a, 11, 22, T12 );
+        SET8 ( F8, a, b, c, d, 12,  7, T13 );
+        SET8 ( F8, d, a, b, c, 13, 12, T14 );
+        SET8 ( F8, c, d, a, b, 14, 17, T15 );
+        SET8 ( F8, b, c, d, a, 15, 22, T16 );
+
+        SET8 ( G8, a, b, c, d,  1,  5, T17 );
+        SET8 ( G8, d, a, b, c,  6,  9, T18 );
+        SET8 ( G8, c, d, a, b, 11, 14, T19 );
+        SET8 ( G8, b, c, d, a,  0, 20, T20 );
+        SET8 ( G8, a, b, c, d,  5,  5, T21 );
+        SET8 ( G8, d, a, b, c, 10,  9, T22 );
+        SET8 ( G8, c, d, a, b, 15, 14, T23 );
+        SET8 ( G8, b, c, d, a,  4, 20, T24 );
+        SET8 ( G8, a, b, c, d,  9,  5, T25 );
+        SET8 ( G8, d, a, b, c, 14,  9, T26 );
+        SET8 ( G8, c, d, a, b,  3, 14, T27 );
+        SET8 ( G8, b, c, d, a,  8, 20, T28 );
+        SET8 ( G8, a, b, c, d, 13,  5, T29 );
+        SET8 ( G8, d, a, b, c,  2,  9, T30 );
+        SET8 ( G8, c, d, a, b,  7, 14, T31 );
+        SET8 ( G8, b, c, d, a, 12, 20, T32 );
+
+        SET8 ( H8, a, b, c, d,  5,  4, T33 );
+        SET8 ( H8, d, a, b, c,  8, 11, T34 );
+        SET8 ( H8, c, d, a, b, 11, 16, T35 );
+        SET8 ( H8, b, c, d, a, 14, 23, T36 );
+        SET8 ( H8, a, b, c, d,  1,  4, T37 );
+        SET8 ( H8, d, a, b, c,  4, 11, T38 );
+        SET8 ( H8, c, d, a, b,  7, 16, T39 );
+        SET8 ( H8, b, c, d, a, 10, 23, T40 );
+        SET8 ( H8, a, b, c, d, 13,  4, T41 );
+        SET8 ( H8, d, a, b, c,  0, 11, T42 );
+        SET8 ( H8, c, d, a, b,  3, 16, T43 );
+        SET8 ( H8, b, c, d, a,  6, 23, T44 );
+        SET8 ( H8, a, b, c, d,  9,  4, T45 );
+        SET8 ( H8, d, a, b, c, 12, 11, T46 );
+        SET8 ( H8, c, d, a, b, 15, 16, T47 );
+        SET8 ( H8, b, c, d, a,  2, 23, T48 );
+
+        SET8 ( I8, a, b, c, d,  0,  6, T49 );
+        SET8 ( I8, d, a, b, c,  7, 10, T50 );
+        SET8 ( I8, c, d, a, b, 14, 15, T51 );
+        SET8 ( I8, b, c, d, a,  5, 21, T52 );
+        SET8 ( I8, a, b, c, d, 12,  6, T53 );
+        SET8 ( I8, d, a, b, c,  3, 10, T54 );
+        SET8 ( I8, c, d, a, b, 10, 15, T55 );
+        SET8 ( I8, b, c, d, a,  1, 21, T56 );
+        SET8 ( I8, a, b, c, d,  8,  6, T57 );
+        SET8 ( I8, d, a, b, c, 15, 10, T58 );
+        SET8 ( I8, c, d, a, b,  6, 15, T59 );
+        SET8 ( I8, b, c, d, a, 13, 21, T60 );
+        SET8 ( I8, a, b, c, d,  4,  6, T61 );
+        SET8 ( I8, d, a, b, c, 11, 10, T62 );
+        SET8 ( I8, c, d, a, b,  2, 15, T63 );
+        SET8 ( I8, b, c, d, a,  9, 21, T64 );
+
+        /* lanes fed with the dummy block keep their previous state */
+        a = _mm256_blendv_epi8 ( aa, _mm256_add_epi32 ( a, aa ), keep );
+        b = _mm256_blendv_epi8 ( bb, _mm256_add_epi32 ( b, bb ), keep );
+        c = _mm256_blendv_epi8 ( cc, _mm256_add_epi32 ( c, cc ), keep );
+        d = _mm256_blendv_epi8 ( dd, _mm256_add_epi32 ( d, dd ), keep );
+
+        for ( active = i = 0; i < MD5_LANES; ++ i )
+        {
+            if ( blocks [ i ] != 0 )
+            {
+                data [ i ] += 64;
+                if ( -- blocks [ i ] != 0 )
+                    ++ active;
+            }
+        }
+    }
+
+#undef SET8
+#undef I8
+#undef H8
+#undef G8
+#undef F8
+#undef ROTATE_LEFT8
+
+    _mm256_storeu_si256 ( ( __m256i* ) st [ 0 ], a );
+    _mm256_storeu_si256 ( ( __m256i* ) st [ 1 ], b );
+    _mm256_storeu_si256 ( ( __m256i* ) st [ 2 ], c );
+    _mm256_storeu_si256 ( ( __m256i* ) st [ 3 ], d );
+
+    for ( i = 0; i < MD5_LANES; ++ i )
+    {
+        if ( md5 [ i ] != NULL )
+        {
+            md5 [ i ] -> abcd [ 0 ] = st [ 0 ] [ i ];
+            md5 [ i ] -> abcd [ 1 ] = st [ 1 ] [ i ];
+            md5 [ i ] -> abcd [ 2 ] = st [ 2 ] [ i ];
+            md5 [ i ] -> abcd [ 3 ] = st [ 3 ] [ i ];
+        }
+    }
+
+scalar:
+    for ( i = 0; i < MD5_LANES; ++ i )
+    {
+        for ( ; blocks [ i ] != 0; data [ i ] += 64, -- blocks [ i ] )
+            MD5StateProcess ( md5 [ i ], data [ i ] );
+    }
+}
+
+/* MD5StateAppend8
+ *  up to MD5_LANES streams through the vector kernel
+ */
+static
+void MD5StateAppend8 ( MD5State *md5 [], const void *const data [], const size_t size [], uint32_t count )
+{
+    uint32_t i;
+    MD5State *lane [ MD5_LANES ];
+    const uint8_t *p [ MD5_LANES ];
+    size_t blocks [ MD5_LANES ];
+    size_t left [ MD5_LANES ];
+
+    for ( i = 0; i < MD5_LANES; ++ i )
+    {
+        lane [ i ] = NULL;
+        p [ i ] = NULL;
+        blocks [ i ] = left [ i ] = 0;
+
+        if ( i < count && md5 [ i ] != NULL && data [ i ] != NULL && size [ i ] > 0 )
+        {
+            size_t offset = ( md5 [ i ] -> count [ 0 ] >> 3 ) & 63;
+
+            lane [ i ] = md5 [ i ];
+            p [ i ] = data [ i ];
+            left [ i ] = size [ i ];
+
+            /* complete a partially filled state buffer the ordinary way */
+            if ( offset != 0 )
+            {
+                size_t copy = ( offset + left [ i ] > 64 ? 64 - offset : left [ i ] );
+                MD5StateAppend ( md5 [ i ], p [ i ], copy );
+                p [ i ] += copy;
+                left [ i ] -= copy;
+            }
+
+            blocks [ i ] = left [ i ] >> 6;
+            left [ i ] &= 63;
+
+            if ( blocks [ i ] != 0 )
+            {
+                /* update the message length exactly as MD5StateAppend does */
+                size_t bytes = blocks [ i ] << 6;
+                uint32_t nbits = ( uint32_t ) ( bytes << 3 );
+                md5 [ i ] -> count [ 1 ] += ( uint32_t ) bytes >> 29;
+                md5 [ i ] -> count [ 0 ] += nbits;
+                if ( md5 [ i ] -> count [ 0 ] < nbits )
+                    ++ md5 [ i ] -> count [ 1 ];
+            }
+        }
+    }
+
+    MD5StateProcess8 ( lane, p, blocks );
+
+    /* buffer any remainder */
+    for ( i = 0; i < count && i < MD5_LANES; ++ i )
+    {
+        if ( left [ i ] != 0 )
+            MD5StateAppend ( md5 [ i ], p [ i ], left [ i ] );
+    }
+}
+
+/* MD5UseAVX2
+ *  threads racing through the first call all store the same answer
+ */
+static atomic32_t md5_avx2;
+
+static bool MD5UseAVX2 ( void )
+{
+    int state = atomic32_read ( & md5_avx2 );
+    if ( state == ckUnresolved )
+    {
+        state = ChecksumProcessorSupportsAVX2 () ? ckSupported : ckUnsupported;
+        atomic32_set ( & md5_avx2, state );
+    }
+    return state == ckSupported;
+}
+#endif
+
+/* MD5StateAppendMulti
+ *  runs MD5StateAppend on "count" independent streams,
+ *  i.e. MD5StateAppend ( md5 [ i ], data [ i ], size [ i ] ) for each i
+ *
+ *  on processors with AVX2 up to eight streams are hashed side by side
+ */
+LIB_EXPORT void CC MD5StateAppendMulti ( MD5State *md5 [],
+    const void *const data [], const size_t size [], uint32_t count )
+{
+    uint32_t i;
+
+    if ( md5 == NULL || data == NULL || size == NULL )
+        return;
+
+#if CHECKSUM_X86
+    if ( count > 1 && MD5UseAVX2 () )
+    {
+        for ( i = 0; i < count; i += MD5_LANES )
+            MD5StateAppend8 ( md5 + i, data + i, size + i, count - i );
+        return;
+    }
+#endif
+
+    for ( i = 0; i < count; ++ i )
+        MD5StateAppend ( md5 [ i ], data [ i ], size [ i ] );
+}
+
 /* MD5StateFinish
  *  processes any remaining data in "md5"
  *  returns 16 bytes of digest
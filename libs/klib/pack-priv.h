@@ -0,0 +1,127 @@
+/*===========================================================================
+*
+*                            PUBLIC DOMAIN NOTICE
+*               National Center for Biotechnology Information
+*
+*  This software/database is a "United States Government Work" under the
+*  terms of the United States Copyright Act.  It was written as part of
+*  the author's official duties as a United States Government employee and
+*  thus cannot be copyrighted.  This software/database is freely available
+*  to the public for use. The National Library of Medicine and the U.S.
+*  Government have not placed any restriction on its use or reproduction.
+*
+*  Although all reasonable efforts have been taken to ensure the accuracy
+*  and reliability of the software and data, the NLM and the U.S.
+*  Government do not and cannot warrant the performance or results that
+*  may be obtained by using this software or data. The NLM and the U.S.
+*  Government disclaim all warranties, express or implied, including
+*  warranties of performance, merchantability or fitness for any particular
+*  purpose.
+*
+*  Please cite the author in any work or product based on this material.
+*
+* ===========================================================================
+*
+*/
+
+#ifndef _h_pack_priv_
+#define _h_pack_priv_
+
+#ifndef _h_klib_defs_
+#include <klib/defs.h>
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+/*--------------------------------------------------------------------------
+ * PackKernels
+ *  the kernels Pack and Unpack dispatch to. resolved from the processor's
+ *  features on first use and kept for the life of the process
+ */
+enum
+{
+    pkUnresolved,
+    pkScalar,
+    pkBMI2
+};
+
+int PackKernels ( void );
+
+/* PackForceScalar
+ *  pins Pack and Unpack to the scalar loops when "force" is true,
+ *  or has the kernels resolved again on next use when false.
+ *  meant for tests that hold both sets of kernels against each other
+ */
+void PackForceScalar ( bool force );
+
+
+/*--------------------------------------------------------------------------
+ * PACK_BMI2
+ *  x86-64 builds with a compiler that understands function-level
+ *  target attributes carry pdep/pext kernels for Pack and Unpack.
+ *  only those functions are compiled for BMI2, so the library keeps
+ *  its baseline instruction set; the kernels are dispatched to only
+ *  when the processor reports BMI2 at runtime
+ */
+#if defined __x86_64__ && \
+    ( defined __clang__ || __GNUC__ > 4 || ( __GNUC__ == 4 && __GNUC_MINOR__ >= 9 ) )
+
+#define PACK_BMI2 1
+#define PACK_TARGET_BMI2 __attribute__ ( ( target ( "bmi2" ) ) )
+
+#include <cpuid.h>
+#include <immintrin.h>
+
+/* PackProcessorSupportsBMI2
+ *  run-time check for BMI2 via cpuid leaf 7. PackKernels
+ *  keeps the answer, so this runs once per process
+ *
+ *  AMD processors before family 19h ( Zen 3 ) implement pdep and pext
+ *  in microcode with a latency far above the scalar loops they would
+ *  replace, so they are treated as lacking the feature
+ */
+static __inline__
+bool PackProcessorSupportsBMI2 ( void )
+{
+    uint32_t a, b, c, d, max_level;
+
+    max_level = __get_cpuid_max ( 0, & b );
+    if ( max_level >= 7 )
+    {
+        bool amd = ( b == signature_AMD_ebx );
+
+        __cpuid_count ( 7, 0, a, b, c, d );
+        if ( ( b & ( 1 << 8 ) ) != 0 )
+        {
+            if ( amd )
+            {
+                uint32_t family;
+
+                __cpuid ( 1, a, b, c, d );
+                family = ( a >> 8 ) & 0xF;
+                if ( family == 0xF )
+                    family += ( a >> 20 ) & 0xFF;
+                if ( family < 0x19 )
+                    return false;
+            }
+            return true;
+        }
+    }
+
+    return false;
+}
+
+#else
+
+#define PACK_BMI2 0
+
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _h_pack_priv_ */
@@ -0,0 +1,77 @@
+/*===========================================================================
+ *
+ *                            PUBLIC DOMAIN NOTICE
+ *               National Center for Biotechnology Information
+ *
+ *  This software/database is a "United States Government Work" under the
+ *  terms of the United States Copyright Act.  It was written as part of
+ *  the author's official duties as a United States Government employee and
+ *  thus cannot be copyrighted.  This software/database is freely available
+ *  to the public for use. The National Library of Medicine and the U.S.
+ *  Government have not placed any restriction on its use or reproduction.
+ *
+ *  Although all reasonable efforts have been taken to ensure the accuracy
+ *  and reliability of the software and data, the NLM and the U.S.
+ *  Government do not and cannot warrant the performance or results that
+ *  may be obtained by using this software or data. The NLM and the U.S.
+ *  Government disclaim all warranties, express or implied, including
+ *  warranties of performance, merchantability or fitness for any particular
+ *  purpose.
+ *
+ *  Please cite the author in any work or product based on this material.
+ *
+ * ===========================================================================
+ *
+ */
+
+
+#ifndef _h_prof_priv_
+#define _h_prof_priv_
+
+#ifndef _h_klib_defs_
+#include <klib/defs.h>
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+/*--------------------------------------------------------------------------
+ * KProf
+ *  operating system support for the counters in prof.c,
+ *  implemented in sysprof.c
+ */
+
+/* Lock
+ * Unlock
+ *  guard the counter registry and the list of thread blocks
+ */
+void KProfLock ( void );
+void KProfUnlock ( void );
+
+/* GetThread
+ * SetThread
+ *  thread-local slot for the calling thread's counter block.
+ *  Set returns false when the platform keeps no per-thread blocks;
+ *  on thread exit a block is handed to KProfReleaseThread
+ */
+void * KProfGetThread ( void );
+bool KProfSetThread ( void * block );
+
+/* ReleaseThread
+ *  implemented by prof.c
+ */
+void KProfReleaseThread ( void * block );
+
+/* Clock
+ *  monotonic time in nanoseconds
+ */
+uint64_t KProfClock ( void );
+
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _h_prof_priv_ */
@@ -0,0 +1,349 @@
+/*===========================================================================
+ *
+ *                            PUBLIC DOMAIN NOTICE
+ *               National Center for Biotechnology Information
+ *
+ *  This software/database is a "United States Government Work" under the
+ *  terms of the United States Copyright Act.  It was written as part of
+ *  the author's official duties as a United States Government employee and
+ *  thus cannot be copyrighted.  This software/database is freely available
+ *  to the public for use. The National Library of Medicine and the U.S.
+ *  Government have not placed any restriction on its use or reproduction.
+ *
+ *  Although all reasonable efforts have been taken to ensure the accuracy
+ *  and reliability of the software and data, the NLM and the U.S.
+ *  Government do not and cannot warrant the performance or results that
+ *  may be obtained by using this software or data. The NLM and the U.S.
+ *  Government disclaim all warranties, express or implied, including
+ *  warranties of performance, merchantability or fitness for any particular
+ *  purpose.
+ *
+ *  Please cite the author in any work or product based on this material.
+ *
+ * ===========================================================================
+ *
+ */
+
+
+#include <klib/extern.h>
+#include <klib/prof.h>
+#include <klib/printf.h>
+#include <klib/rc.h>
+#include <sysalloc.h>
+
+#include "prof-priv.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+
+
+/*--------------------------------------------------------------------------
+ * KProf
+ *  counters are slots in a fixed table indexed by KProfId.
+ *  each thread records into its own block of slots; blocks of
+ *  exited threads are folded into "retired", which also takes
+ *  the records of threads that could not get a block.
+ */
+#define KPROF_MAX_COUNTERS 1024
+
+typedef struct KProfName KProfName;
+struct KProfName
+{
+    char *subsystem;
+    char *name;
+};
+
+typedef struct KProfSlot KProfSlot;
+struct KProfSlot
+{
+    uint64_t count;
+    uint64_t ns;
+};
+
+typedef struct KProfThread KProfThread;
+struct KProfThread
+{
+    KProfThread *next, *prev;
+    KProfSlot slot [ KPROF_MAX_COUNTERS ];
+};
+
+/* registry; entry 0 is never used */
+static KProfName names [ KPROF_MAX_COUNTERS ];
+static uint32_t name_count = 1;
+
+/* live thread blocks and the totals of the others */
+static KProfThread *threads;
+static KProfSlot retired [ KPROF_MAX_COUNTERS ];
+
+
+/* Register
+ */
+LIB_EXPORT KProfId CC KProfRegister ( const char *subsystem, const char *name )
+{
+    uint32_t id;
+
+    if ( subsystem == NULL || name == NULL )
+        return 0;
+
+    KProfLock ();
+
+    for ( id = 1; id < name_count; ++ id )
+    {
+        if ( strcmp ( names [ id ] . name, name ) == 0 &&
+             strcmp ( names [ id ] . subsystem, subsystem ) == 0 )
+        {
+            KProfUnlock ();
+            return id;
+        }
+    }
+
+    id = 0;
+    if ( name_count < KPROF_MAX_COUNTERS )
+    {
+        size_t ssize = strlen ( subsystem ) + 1;
+        size_t nsize = strlen ( name ) + 1;
+        char *text = malloc ( ssize + nsize );
+        if ( text != NULL )
+        {
+            memmove ( text, subsystem, ssize );
+            memmove ( text + ssize, name, nsize );
+            names [ name_count ] . subsystem = text;
+            names [ name_count ] . name = text + ssize;
+            id = name_count ++;
+        }
+    }
+
+    KProfUnlock ();
+
+    return id;
+}
+
+
+/* Now
+ */
+LIB_EXPORT uint64_t CC KProfNow ( void )
+{
+    return KProfClock ();
+}
+
+
+/* ReleaseThread
+ *  fold an exiting thread's block into the retired totals
+ */
+void KProfReleaseThread ( void * block )
+{
+    KProfThread *t = block;
+    if ( t != NULL )
+    {
+        uint32_t i;
+
+        KProfLock ();
+
+        if ( t -> prev != NULL )
+            t -> prev -> next = t -> next;
+        else
+            threads = t -> next;
+        if ( t -> next != NULL )
+            t -> next -> prev = t -> prev;
+
+        for ( i = 1; i < name_count; ++ i )
+        {
+            retired [ i ] . count += t -> slot [ i ] . count;
+            retired [ i ] . ns += t -> slot [ i ] . ns;
+        }
+
+        KProfUnlock ();
+
+        free ( t );
+    }
+}
+
+static
+KProfThread * KProfThreadBlock ( void )
+{
+    KProfThread *t = KProfGetThread ();
+    if ( t == NULL )
+    {
+        t = calloc ( 1, sizeof * t );
+        if ( t != NULL )
+        {
+            if ( ! KProfSetThread ( t ) )
+            {
+                free ( t );
+                return NULL;
+            }
+
+            KProfLock ();
+            t -> next = threads;
+            if ( threads != NULL )
+                threads -> prev = t;
+            threads = t;
+            KProfUnlock ();
+        }
+    }
+    return t;
+}
+
+static
+void KProfAdd ( KProfId id, uint64_t count, uint64_t ns )
+{
+    KProfThread *t;
+
+    if ( id == 0 || id >= KPROF_MAX_COUNTERS )
+        return;
+
+    t = KProfThreadBlock ();
+    if ( t != NULL )
+    {
+        t -> slot [ id ] . count += count;
+        t -> slot [ id ] . ns += ns;
+    }
+    else
+    {
+        KProfLock ();
+        retired [ id ] . count += count;
+        retired [ id ] . ns += ns;
+        KProfUnlock ();
+    }
+}
+
+
+/* Record
+ * Count
+ */
+LIB_EXPORT void CC KProfRecord ( KProfId id, uint64_t ns )
+{
+    KProfAdd ( id, 1, ns );
+}
+
+LIB_EXPORT void CC KProfCount ( KProfId id, uint64_t count )
+{
+    KProfAdd ( id, count, 0 );
+}
+
+
+/* Reset
+ */
+LIB_EXPORT void CC KProfReset ( void )
+{
+    KProfThread *t;
+
+    KProfLock ();
+
+    memset ( retired, 0, sizeof retired );
+    for ( t = threads; t != NULL; t = t -> next )
+        memset ( t -> slot, 0, sizeof t -> slot );
+
+    KProfUnlock ();
+}
+
+
+/* WriteJSON
+ */
+static
+rc_t KProfWriteAll ( KWrtWriter writer, void *data, const char *buffer, size_t size )
+{
+    while ( size != 0 )
+    {
+        size_t num_writ;
+        rc_t rc = ( * writer ) ( data, buffer, size, & num_writ );
+        if ( rc != 0 )
+            return rc;
+        if ( num_writ == 0 )
+            return RC ( rcRuntime, rcData, rcWriting, rcTransfer, rcIncomplete );
+        buffer += num_writ;
+        size -= num_writ;
+    }
+    return 0;
+}
+
+/* copy "text" into "dst" as the body of a JSON string */
+static
+size_t KProfJSONEscape ( char *dst, size_t bsize, const char *text )
+{
+    size_t i, j;
+    for ( i = j = 0; text [ i ] != 0 && j + 6 < bsize; ++ i )
+    {
+        unsigned char ch = ( unsigned char ) text [ i ];
+        if ( ch == '"' || ch == '\\' )
+        {
+            dst [ j ++ ] = '\\';
+            dst [ j ++ ] = ch;
+        }
+        else if ( ch < 0x20 )
+        {
+            static const char hex [] = "0123456789abcdef";
+            memmove ( & dst [ j ], "\\u00", 4 );
+            dst [ j + 4 ] = hex [ ch >> 4 ];
+            dst [ j + 5 ] = hex [ ch & 15 ];
+            j += 6;
+        }
+        else
+        {
+            dst [ j ++ ] = ch;
+        }
+    }
+    dst [ j ] = 0;
+    return j;
+}
+
+LIB_EXPORT rc_t CC KProfWriteJSON ( KWrtWriter writer, void *data )
+{
+    rc_t rc;
+    KProfSlot *totals;
+    uint32_t id, count;
+
+    if ( writer == NULL )
+        return RC ( rcRuntime, rcData, rcWriting, rcFunction, rcNull );
+
+    /* take a snapshot, so that "writer" runs without the lock */
+    totals = malloc ( sizeof * totals * KPROF_MAX_COUNTERS );
+    if ( totals == NULL )
+        return RC ( rcRuntime, rcData, rcWriting, rcMemory, rcExhausted );
+
+    KProfLock ();
+
+    count = name_count;
+    for ( id = 1; id < count; ++ id )
+    {
+        const KProfThread *t;
+        totals [ id ] = retired [ id ];
+        for ( t = threads; t != NULL; t = t -> next )
+        {
+            totals [ id ] . count += t -> slot [ id ] . count;
+            totals [ id ] . ns += t -> slot [ id ] . ns;
+        }
+    }
+
+    KProfUnlock ();
+
+    /* registered names are never removed, so may be read unlocked */
+    rc = KProfWriteAll ( writer, data, "{ \"counters\" : [", 16 );
+    for ( id = 1; rc == 0 && id < count; ++ id )
+    {
+        size_t num_writ;
+        char subsystem [ 256 ], name [ 1024 ], line [ 1536 ];
+
+        KProfJSONEscape ( subsystem, sizeof subsystem, names [ id ] . subsystem );
+        KProfJSONEscape ( name, sizeof name, names [ id ] . name );
+
+        rc = string_printf ( line, sizeof line, & num_writ,
+            "%s\n  { \"subsystem\" : \"%s\", \"name\" : \"%s\", \"count\" : %lu, \"ns\" : %lu }"
+            , id == 1 ? "" : ","
+            , subsystem
+            , name
+            , totals [ id ] . count
+            , totals [ id ] . ns
+            );
+        if ( rc == 0 )
+            rc = KProfWriteAll ( writer, data, line, num_writ );
+    }
+
+    if ( rc == 0 )
+        rc = KProfWriteAll ( writer, data, "\n] }\n", 5 );
+
+    free ( totals );
+
+    return rc;
+}
@@ -0,0 +1,349 @@
+/*===========================================================================
+ *
+ *                            PUBLIC DOMAIN NOTICE
+ *               National Center for Biotechnology Information
+ *
+ *  This software/database is a "United States Government Work" under the
+ *  terms of the United States Copyright Act.  It was written as part of
+ *  the author's official duties as a United States Government employee and
+ *  thus cannot be copyrighted.  This software/database is freely available
+ *  to the public for use. The National Library of Medicine and the U.S.
+ *  Government have not placed any restriction on its use or reproduction.
+ *
+ *  Although all reasonable efforts have been taken to ensure the accuracy
+ *  and reliability of the software and data, the NLM and the U.S.
+ *  Government do not and cannot warrant the performance or results that
+ *  may be obtained by using this software or data. The NLM and the U.S.
+ *  Government disclaim all warranties, express or implied, including
+ *  warranties of performance, merchantability or fitness for any particular
+ *  purpose.
+ *
+ *  Please cite the author in any work or product based on this material.
+ *
+ * ===========================================================================
+ *
+ */
+
+#include <klib/extern.h>
+#include <klib/sort.h>
+#include <klib/rc.h>
+#include <sysalloc.h>
+
+#include <stdlib.h>
+#include <string.h>
+
+
+/*--------------------------------------------------------------------------
+ * kradix_sort
+ *  LSD radix sort on 11-bit digits for arrays of integers and
+ *  in-place MSD radix sort on bytes for records with an integer key
+ */
+
+/* below this size the comparison sorts win */
+#define RADIX_MIN_ELEMS 256
+
+/* MSD buckets this small are finished with insertion sort */
+#define RADIX_INSERTION_ELEMS 32
+
+/* LSD passes work on 11-bit digits: 3 passes for 32-bit keys, 6 for 64 */
+#define RADIX_DIGIT_BITS 11
+#define RADIX_BUCKETS ( 1 << RADIX_DIGIT_BITS )
+#define RADIX_PASSES( T ) ( ( sizeof ( T ) * 8 + RADIX_DIGIT_BITS - 1 ) / RADIX_DIGIT_BITS )
+
+/* RadixLSD
+ *  sorts "count" keys through "scratch", one digit per pass from least
+ *  to most significant. the histograms for all passes are taken in a
+ *  single read into "hist", and a pass where every key shares the same
+ *  digit is skipped. returns the buffer holding the result.
+ *
+ *  keys are read as unsigned; for signed keys "sign" flips the top bit
+ *  so negative numbers sort first
+ */
+#define RADIX_LSD( T, sign )                                                    \
+static T * radix_lsd_ ## T ( T * src, T * scratch, size_t count, size_t * hist ) \
+{                                                                               \
+    const T mask = RADIX_BUCKETS - 1;                                           \
+    size_t i;                                                                   \
+    unsigned pass;                                                              \
+                                                                                \
+    memset ( hist, 0, RADIX_PASSES ( T ) * RADIX_BUCKETS * sizeof * hist );     \
+    for ( i = 0; i < count; ++ i )                                              \
+    {                                                                           \
+        T key = src [ i ] ^ ( sign );                                           \
+        for ( pass = 0; pass < RADIX_PASSES ( T ); ++ pass )                    \
+            ++ hist [ pass * RADIX_BUCKETS + ( ( key >> ( pass * RADIX_DIGIT_BITS ) ) & mask ) ]; \
+    }                                                                           \
+                                                                                \
+    for ( pass = 0; pass < RADIX_PASSES ( T ); ++ pass )                        \
+    {                                                                           \
+        size_t * offset = hist + pass * RADIX_BUCKETS;                          \
+        unsigned shift = pass * RADIX_DIGIT_BITS;                               \
+        size_t b, sum;                                                          \
+        T * tmp;                                                                \
+                                                                                \
+        /* all keys share this digit */                                         \
+        if ( offset [ ( ( src [ 0 ] ^ ( sign ) ) >> shift ) & mask ] == count ) \
+            continue;                                                           \
+                                                                                \
+        /* turn the histogram into starting offsets */                          \
+        for ( sum = 0, b = 0; b < RADIX_BUCKETS; ++ b )                         \
+        {                                                                       \
+            size_t n = offset [ b ];                                            \
+            offset [ b ] = sum;                                                 \
+            sum += n;                                                           \
+        }                                                                       \
+                                                                                \
+        for ( i = 0; i < count; ++ i )                                          \
+        {                                                                       \
+            T key = src [ i ];                                                  \
+            scratch [ offset [ ( ( key ^ ( sign ) ) >> shift ) & mask ] ++ ] = key; \
+        }                                                                       \
+                                                                                \
+        tmp = src;                                                              \
+        src = scratch;                                                          \
+        scratch = tmp;                                                          \
+    }                                                                           \
+                                                                                \
+    return src;                                                                 \
+}
+
+RADIX_LSD ( uint32_t, 0 )
+RADIX_LSD ( uint64_t, 0 )
+
+#define SIGN32 ( ( uint32_t ) 1 << 31 )
+#define SIGN64 ( ( uint64_t ) 1 << 63 )
+
+typedef uint32_t sint32_bits;
+typedef uint64_t sint64_bits;
+RADIX_LSD ( sint32_bits, SIGN32 )
+RADIX_LSD ( sint64_bits, SIGN64 )
+
+#undef RADIX_LSD
+
+#define RADIX_SORT_INTEGERS( U, fallback )                                      \
+    size_t * hist;                                                              \
+    U * scratch, * result;                                                      \
+                                                                                \
+    if ( pbase == NULL && total_elems != 0 )                                    \
+        return RC ( rcCont, rcVector, rcProcessing, rcParam, rcNull );          \
+                                                                                \
+    if ( total_elems < RADIX_MIN_ELEMS )                                        \
+    {                                                                           \
+        fallback ( pbase, total_elems );                                        \
+        return 0;                                                               \
+    }                                                                           \
+                                                                                \
+    /* histograms first, keeping both pieces aligned */                        \
+    hist = malloc ( RADIX_PASSES ( U ) * RADIX_BUCKETS * sizeof * hist +        \
+                    total_elems * sizeof * scratch );                           \
+    if ( hist == NULL )                                                         \
+    {                                                                           \
+        /* still sort, just not as quickly */                                   \
+        fallback ( pbase, total_elems );                                        \
+        return 0;                                                               \
+    }                                                                           \
+    scratch = ( U * ) ( hist + RADIX_PASSES ( U ) * RADIX_BUCKETS );            \
+                                                                                \
+    result = radix_lsd_ ## U ( ( U * ) pbase, scratch, total_elems, hist );     \
+    if ( result != ( U * ) pbase )                                              \
+        memmove ( pbase, result, total_elems * sizeof * scratch );              \
+                                                                                \
+    free ( hist );                                                              \
+    return 0
+
+LIB_EXPORT rc_t CC kradix_sort_int32_t ( int32_t *pbase, size_t total_elems )
+{
+    RADIX_SORT_INTEGERS ( sint32_bits, ksort_int32_t );
+}
+
+LIB_EXPORT rc_t CC kradix_sort_uint32_t ( uint32_t *pbase, size_t total_elems )
+{
+    RADIX_SORT_INTEGERS ( uint32_t, ksort_uint32_t );
+}
+
+LIB_EXPORT rc_t CC kradix_sort_int64_t ( int64_t *pbase, size_t total_elems )
+{
+    RADIX_SORT_INTEGERS ( sint64_bits, ksort_int64_t );
+}
+
+LIB_EXPORT rc_t CC kradix_sort_uint64_t ( uint64_t *pbase, size_t total_elems )
+{
+    RADIX_SORT_INTEGERS ( uint64_t, ksort_uint64_t );
+}
+
+#undef RADIX_SORT_INTEGERS
+
+
+/* RadixRecords
+ *  description of the records being sorted
+ */
+typedef struct RadixRecords RadixRecords;
+struct RadixRecords
+{
+    size_t size;
+    size_t key_offset;
+    size_t key_size;
+    uint64_t sign;
+
+    /* record-sized swap space */
+    uint8_t * tmp;
+};
+
+static
+uint64_t radix_record_key ( const RadixRecords * r, const uint8_t * rec )
+{
+    const uint8_t * p = rec + r -> key_offset;
+    uint64_t key;
+
+    switch ( r -> key_size )
+    {
+    case 1:
+        key = * p;
+        break;
+    case 2:
+    {
+        uint16_t k;
+        memmove ( & k, p, sizeof k );
+        key = k;
+        break;
+    }
+    case 4:
+    {
+        uint32_t k;
+        memmove ( & k, p, sizeof k );
+        key = k;
+        break;
+    }
+    default:
+        memmove ( & key, p, sizeof key );
+        break;
+    }
+
+    return key ^ r -> sign;
+}
+
+static
+void radix_record_swap ( const RadixRecords * r, uint8_t * a, uint8_t * b )
+{
+    memmove ( r -> tmp, a, r -> size );
+    memmove ( a, b, r -> size );
+    memmove ( b, r -> tmp, r -> size );
+}
+
+static
+void radix_record_insertion ( const RadixRecords * r, uint8_t * base, size_t count )
+{
+    size_t i, j;
+
+    for ( i = 1; i < count; ++ i )
+    {
+        uint64_t key = radix_record_key ( r, base + i * r -> size );
+
+        for ( j = i; j > 0 && radix_record_key ( r, base + ( j - 1 ) * r -> size ) > key; -- j )
+            ;
+
+        if ( j != i )
+        {
+            memmove ( r -> tmp, base + i * r -> size, r -> size );
+            memmove ( base + ( j + 1 ) * r -> size, base + j * r -> size, ( i - j ) * r -> size );
+            memmove ( base + j * r -> size, r -> tmp, r -> size );
+        }
+    }
+}
+
+/* radix_record_msd
+ *  American flag sort: count the bytes at "digit", then move every
+ *  record straight into its bucket by swapping, then recurse into
+ *  each bucket on the next lower byte
+ */
+static
+void radix_record_msd ( const RadixRecords * r, uint8_t * base, size_t count, unsigned digit )
+{
+    size_t hist [ 256 ];
+    size_t next [ 256 ];
+    size_t end [ 256 ];
+    size_t i, sum;
+    unsigned b, shift;
+
+    while ( count > RADIX_INSERTION_ELEMS )
+    {
+        shift = digit * 8;
+        memset ( hist, 0, sizeof hist );
+        for ( i = 0; i < count; ++ i )
+            ++ hist [ ( radix_record_key ( r, base + i * r -> size ) >> shift ) & 0xFF ];
+
+        /* all records share this byte: go straight to the next one */
+        if ( hist [ ( radix_record_key ( r, base ) >> shift ) & 0xFF ] == count )
+        {
+            if ( digit == 0 )
+                return;
+            -- digit;
+            continue;
+        }
+
+        for ( sum = 0, b = 0; b < 256; ++ b )
+        {
+            next [ b ] = sum;
+            sum += hist [ b ];
+            end [ b ] = sum;
+        }
+
+        for ( b = 0; b < 256; ++ b )
+        {
+            while ( next [ b ] < end [ b ] )
+            {
+                uint8_t * rec = base + next [ b ] * r -> size;
+                unsigned d = ( unsigned ) ( radix_record_key ( r, rec ) >> shift ) & 0xFF;
+
+                if ( d == b )
+                    ++ next [ b ];
+                else
+                    radix_record_swap ( r, rec, base + next [ d ] ++ * r -> size );
+            }
+        }
+
+        if ( digit == 0 )
+            return;
+
+        for ( sum = 0, b = 0; b < 256; sum += hist [ b ++ ] )
+        {
+            if ( hist [ b ] > 1 )
+                radix_record_msd ( r, base + sum * r -> size, hist [ b ], digit - 1 );
+        }
+        return;
+    }
+
+    radix_record_insertion ( r, base, count );
+}
+
+LIB_EXPORT rc_t CC kradix_sort_records ( void *pbase, size_t total_elems, size_t size,
+    size_t key_offset, size_t key_size, bool key_signed )
+{
+    RadixRecords r;
+    uint8_t stack_tmp [ 128 ];
+
+    if ( pbase == NULL && total_elems != 0 )
+        return RC ( rcCont, rcVector, rcProcessing, rcParam, rcNull );
+    if ( key_size != 1 && key_size != 2 && key_size != 4 && key_size != 8 )
+        return RC ( rcCont, rcVector, rcProcessing, rcParam, rcInvalid );
+    if ( size < key_size || key_offset > size - key_size )
+        return RC ( rcCont, rcVector, rcProcessing, rcParam, rcInvalid );
+
+    if ( total_elems < 2 )
+        return 0;
+
+    r . size = size;
+    r . key_offset = key_offset;
+    r . key_size = key_size;
+    r . sign = key_signed ? ( uint64_t ) 1 << ( key_size * 8 - 1 ) : 0;
+    r . tmp = size <= sizeof stack_tmp ? stack_tmp : malloc ( size );
+    if ( r . tmp == NULL )
+        return RC ( rcCont, rcVector, rcProcessing, rcMemory, rcExhausted );
+
+    radix_record_msd ( & r, pbase, total_elems, ( unsigned ) key_size - 1 );
+
+    if ( r . tmp != stack_tmp )
+        free ( r . tmp );
+
+    return 0;
+}
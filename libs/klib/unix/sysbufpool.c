@@ -0,0 +1,106 @@
+/*===========================================================================
+*
+*                            PUBLIC DOMAIN NOTICE
+*               National Center for Biotechnology Information
+*
+*  This software/database is a "United States Government Work" under the
+*  terms of the United States Copyright Act.  It was written as part of
+*  the author's official duties as a United States Government employee and
+*  thus cannot be copyrighted.  This software/database is freely available
+*  to the public for use. The National Library of Medicine and the U.S.
+*  Government have not placed any restriction on its use or reproduction.
+*
+*  Although all reasonable efforts have been taken to ensure the accuracy
+*  and reliability of the software and data, the NLM and the U.S.
+*  Government do not and cannot warrant the performance or results that
+*  may be obtained by using this software or data. The NLM and the U.S.
+*  Government disclaim all warranties, express or implied, including
+*  warranties of performance, merchantability or fitness for any particular
+*  purpose.
+*
+*  Please cite the author in any work or product based on this material.
+*
+* ===========================================================================
+*
+*/
+
+#include <klib/extern.h>
+#include "data-buffer-priv.h"
+
+#include <pthread.h>
+#include <sys/mman.h>
+#include <stdint.h>
+
+#ifndef MAP_ANONYMOUS
+#define MAP_ANONYMOUS MAP_ANON
+#endif
+
+#define HUGE_PAGE_SIZE ( ( size_t ) 2 << 20 )
+
+
+/*--------------------------------------------------------------------------
+ * KDataBufferPool
+ */
+static pthread_mutex_t pool_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_once_t pool_key_once = PTHREAD_ONCE_INIT;
+static pthread_key_t pool_key;
+static bool pool_key_valid;
+
+void KDataBufferPoolLock ( void )
+{
+    pthread_mutex_lock ( & pool_lock );
+}
+
+void KDataBufferPoolUnlock ( void )
+{
+    pthread_mutex_unlock ( & pool_lock );
+}
+
+static
+void pool_key_init ( void )
+{
+    pool_key_valid = pthread_key_create ( & pool_key, KDataBufferPoolReleaseThreadCache ) == 0;
+}
+
+void * KDataBufferPoolGetThreadCache ( void )
+{
+    pthread_once ( & pool_key_once, pool_key_init );
+    return pool_key_valid ? pthread_getspecific ( pool_key ) : NULL;
+}
+
+bool KDataBufferPoolSetThreadCache ( void * cache )
+{
+    pthread_once ( & pool_key_once, pool_key_init );
+    return pool_key_valid && pthread_setspecific ( pool_key, cache ) == 0;
+}
+
+void * KDataBufferPoolMapHuge ( size_t bytes )
+{
+    /* over-map by one huge page and trim to get 2MB alignment */
+    size_t const span = bytes + HUGE_PAGE_SIZE;
+    uint8_t * p = mmap ( NULL, span, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0 );
+    uint8_t * aligned;
+    size_t head, tail;
+
+    if ( p == MAP_FAILED )
+        return NULL;
+
+    aligned = ( uint8_t * ) ( ( ( size_t ) p + HUGE_PAGE_SIZE - 1 ) & ~ ( HUGE_PAGE_SIZE - 1 ) );
+    head = aligned - p;
+    tail = span - head - bytes;
+    if ( head != 0 )
+        munmap ( p, head );
+    if ( tail != 0 )
+        munmap ( aligned + bytes, tail );
+
+#ifdef MADV_HUGEPAGE
+    madvise ( aligned, bytes, MADV_HUGEPAGE );
+#endif
+
+    return aligned;
+}
+
+void KDataBufferPoolUnmapHuge ( void * addr, size_t bytes )
+{
+    munmap ( addr, bytes );
+}
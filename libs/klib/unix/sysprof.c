@@ -0,0 +1,76 @@
+/*===========================================================================
+ *
+ *                            PUBLIC DOMAIN NOTICE
+ *               National Center for Biotechnology Information
+ *
+ *  This software/database is a "United States Government Work" under the
+ *  terms of the United States Copyright Act.  It was written as part of
+ *  the author's official duties as a United States Government employee and
+ *  thus cannot be copyrighted.  This software/database is freely available
+ *  to the public for use. The National Library of Medicine and the U.S.
+ *  Government have not placed any restriction on its use or reproduction.
+ *
+ *  Although all reasonable efforts have been taken to ensure the accuracy
+ *  and reliability of the software and data, the NLM and the U.S.
+ *  Government do not and cannot warrant the performance or results that
+ *  may be obtained by using this software or data. The NLM and the U.S.
+ *  Government disclaim all warranties, express or implied, including
+ *  warranties of performance, merchantability or fitness for any particular
+ *  purpose.
+ *
+ *  Please cite the author in any work or product based on this material.
+ *
+ * ===========================================================================
+ *
+ */
+
+
+#include <klib/extern.h>
+#include "prof-priv.h"
+
+#include <pthread.h>
+#include <time.h>
+
+
+/*--------------------------------------------------------------------------
+ * KProf
+ */
+static pthread_mutex_t prof_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_once_t prof_key_once = PTHREAD_ONCE_INIT;
+static pthread_key_t prof_key;
+static bool prof_key_valid;
+
+void KProfLock ( void )
+{
+    pthread_mutex_lock ( & prof_lock );
+}
+
+void KProfUnlock ( void )
+{
+    pthread_mutex_unlock ( & prof_lock );
+}
+
+static
+void prof_key_init ( void )
+{
+    prof_key_valid = pthread_key_create ( & prof_key, KProfReleaseThread ) == 0;
+}
+
+void * KProfGetThread ( void )
+{
+    pthread_once ( & prof_key_once, prof_key_init );
+    return prof_key_valid ? pthread_getspecific ( prof_key ) : NULL;
+}
+
+bool KProfSetThread ( void * block )
+{
+    pthread_once ( & prof_key_once, prof_key_init );
+    return prof_key_valid && pthread_setspecific ( prof_key, block ) == 0;
+}
+
+uint64_t KProfClock ( void )
+{
+    struct timespec ts;
+    clock_gettime ( CLOCK_MONOTONIC, & ts );
+    return ( uint64_t ) ts . tv_sec * 1000000000 + ts . tv_nsec;
+}
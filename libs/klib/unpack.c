@@ -30,6 +30,8 @@
 #include <arch-impl.h>
 #include <sysalloc.h>
 
+#include "pack-priv.h"
+
 #include <endian.h>
 #include <byteswap.h>
 #include <string.h>
@@ -208,16 +210,23 @@ uint8_t unpack_8_from_1_arr[256][8]={
 {1,1,1,1,1,1,0,0},{1,1,1,1,1,1,0,1},{1,1,1,1,1,1,1,0},{1,1,1,1,1,1,1,1},
 };
 
+/* Unpack8From2, Unpack8From1
+ *  work from right to left like the general code,
+ *  so that unpacking in place is safe
+ */
 static
 void CC Unpack8From2(uint8_t *dst,const uint8_t *src,int32_t count)
 {
 	if(count > 0){
-		int i;
-		for(i=0;i<count/4;i++,dst+=4,src++){
-			memcpy(dst,unpack_8_from_2_arr[*src],4);
+		int i, full = count/4;
+		if((count&3) != 0){
+			const uint8_t *tail = unpack_8_from_2_arr[src[full]];
+			for(i=0;i< (count&3);i++){
+				dst[full*4+i] = tail[i];
+			}
 		}
-		for(i=0;i< (count&3);i++){
-			dst[i] = unpack_8_from_2_arr[*src][i];
+		for(i=full;i-- > 0;){
+			memcpy(dst+i*4,unpack_8_from_2_arr[src[i]],4);
 		}
 	}
 }
@@ -225,12 +234,15 @@ static
 void CC Unpack8From1(uint8_t *dst,const uint8_t *src,int32_t count)
 {
 	if(count > 0){
-		int i;
-		for(i=0;i<count/8;i++,dst+=8,src++){
-			memcpy(dst,unpack_8_from_1_arr[*src],8);
+		int i, full = count/8;
+		if((count&7) != 0){
+			const uint8_t *tail = unpack_8_from_1_arr[src[full]];
+			for(i=0;i< (count&7);i++){
+				dst[full*8+i] = tail[i];
+			}
 		}
-		for(i=0;i< (count&7);i++){
-			dst[i] = unpack_8_from_1_arr[*src][i];
+		for(i=full;i-- > 0;){
+			memcpy(dst+i*8,unpack_8_from_1_arr[src[i]],8);
 		}
 	}
 }
@@ -716,6 +728,232 @@ void CC Unpack64b ( uint32_t packed, uint32_t count, void *dst,
 }
 
 
+/* Unpack64
+ */
+static
+void CC Unpack64 ( uint32_t packed, uint32_t count, void *dst,
+    const void *src, bitsz_t src_off, bitsz_t ssize )
+{
+    if ( packed > 32 )
+        Unpack64b ( packed, count, dst, src, src_off, ssize );
+    else
+        Unpack64a ( packed, count, dst, src, src_off, ssize );
+}
+
+#if PACK_BMI2
+
+/* UnpackReadBE64
+ *  reads 8 bytes of the packed stream as a big-endian word
+ *  zero-fills any part that lies beyond "end"
+ */
+static __inline__ PACK_TARGET_BMI2
+uint64_t UnpackReadBE64 ( const uint8_t *p, const uint8_t *end )
+{
+    uint64_t word = 0;
+    if ( end - p >= 8 )
+        memcpy ( & word, p, 8 );
+    else
+        memcpy ( & word, p, end - p );
+    return bswap_64 ( word );
+}
+
+/* UnpackReadField
+ *  returns "width" bits of the packed stream starting at bit "off",
+ *  right-aligned. requires ( off & 7 ) + width <= 64
+ */
+static __inline__ PACK_TARGET_BMI2
+uint64_t UnpackReadField ( const uint8_t *src, const uint8_t *end,
+    bitsz_t off, uint32_t width )
+{
+    return ( UnpackReadBE64 ( src + ( off >> 3 ), end ) << ( off & 7 ) ) >> ( 64 - width );
+}
+
+/* UnpackBMI2
+ *  the BMI2 kernels deposit a whole field of several packed elements
+ *  into the lanes of a register with a single pdep, 8 elements at a time
+ *
+ *  elements come out of pdep with the first element in the highest
+ *  lane, so lanes are reversed before being stored. groups are written
+ *  from last to first, preserving the right-to-left order that allows
+ *  unpacking in place: any bytes a group reads beyond its own bits are
+ *  shifted away, so it does not matter that they may be overwritten.
+ *
+ *  the kernels require the source to be exactly "count" elements and
+ *  fall back to the scalar code for widths whose fields could straddle
+ *  a 64-bit load, or where the scalar code measured as fast
+ */
+static PACK_TARGET_BMI2
+void CC Unpack8BMI2 ( uint32_t packed, uint32_t count, void *dst,
+    const void *src, bitsz_t src_off, bitsz_t ssize )
+{
+    uint32_t g, groups = count >> 3, rem = count & 7;
+    const uint8_t *end = ( const uint8_t* ) src + ( ( ssize + 7 ) >> 3 );
+    uint64_t mask = ( ( ( uint64_t ) 1 << packed ) - 1 ) * UINT64_C ( 0x0101010101010101 );
+
+    /* the lookup tables used for 1 and 2 bits are faster still */
+    if ( packed <= 2 || packed >= 8 || src_off != 0 || ssize != ( bitsz_t ) count * packed )
+    {
+        Unpack8 ( packed, count, dst, src, src_off, ssize );
+        return;
+    }
+
+    /* a group of 8 elements occupies exactly "packed" bytes */
+    if ( rem != 0 )
+    {
+        Unpack8 ( packed, rem, ( uint8_t* ) dst + ( groups << 3 ),
+            ( const uint8_t* ) src + ( size_t ) groups * packed, 0, ( bitsz_t ) rem * packed );
+    }
+
+    for ( g = groups; g != 0; )
+    {
+        uint64_t out;
+        -- g;
+        out = _pdep_u64 ( UnpackReadField ( src, end, ( bitsz_t ) g * packed << 3, packed << 3 ), mask );
+        out = bswap_64 ( out );
+        memcpy ( ( uint8_t* ) dst + ( ( size_t ) g << 3 ), & out, 8 );
+    }
+}
+
+static PACK_TARGET_BMI2
+void CC Unpack16BMI2 ( uint32_t packed, uint32_t count, void *dst,
+    const void *src, bitsz_t src_off, bitsz_t ssize )
+{
+    uint32_t g, groups = count >> 3, rem = count & 7;
+    const uint8_t *end = ( const uint8_t* ) src + ( ( ssize + 7 ) >> 3 );
+    uint64_t mask = ( ( ( uint64_t ) 1 << packed ) - 1 ) * UINT64_C ( 0x0001000100010001 );
+
+    if ( packed >= 16 || src_off != 0 || ssize != ( bitsz_t ) count * packed )
+    {
+        Unpack16 ( packed, count, dst, src, src_off, ssize );
+        return;
+    }
+
+    if ( rem != 0 )
+    {
+        Unpack16 ( packed, rem, ( uint16_t* ) dst + ( groups << 3 ),
+            ( const uint8_t* ) src + ( size_t ) groups * packed, 0, ( bitsz_t ) rem * packed );
+    }
+
+    for ( g = groups; g != 0; )
+    {
+        uint64_t out [ 2 ];
+        bitsz_t off;
+        uint32_t i;
+
+        -- g;
+        off = ( bitsz_t ) g * packed << 3;
+
+        /* read both halves before writing either */
+        out [ 0 ] = UnpackReadField ( src, end, off, packed << 2 );
+        out [ 1 ] = UnpackReadField ( src, end, off + ( packed << 2 ), packed << 2 );
+
+        for ( i = 0; i < 2; ++ i )
+        {
+            uint64_t x = _pdep_u64 ( out [ i ], mask );
+            x = ( x >> 32 ) | ( x << 32 );
+            x = ( ( x >> 16 ) & UINT64_C ( 0x0000FFFF0000FFFF ) ) |
+                ( ( x & UINT64_C ( 0x0000FFFF0000FFFF ) ) << 16 );
+            out [ i ] = x;
+        }
+
+        memcpy ( ( uint16_t* ) dst + ( ( size_t ) g << 3 ), out, sizeof out );
+    }
+}
+
+static PACK_TARGET_BMI2
+void CC Unpack32BMI2 ( uint32_t packed, uint32_t count, void *dst,
+    const void *src, bitsz_t src_off, bitsz_t ssize )
+{
+    uint32_t g, groups = count >> 3, rem = count & 7;
+    const uint8_t *end = ( const uint8_t* ) src + ( ( ssize + 7 ) >> 3 );
+    uint64_t mask = ( ( ( uint64_t ) 1 << packed ) - 1 ) * UINT64_C ( 0x0000000100000001 );
+
+    /* a pair of 31-bit elements may start 6 bits into a byte,
+       and up to 24 bits the scalar loop keeps pace anyway */
+    if ( packed <= 24 || packed >= 31 || src_off != 0 || ssize != ( bitsz_t ) count * packed )
+    {
+        Unpack32 ( packed, count, dst, src, src_off, ssize );
+        return;
+    }
+
+    if ( rem != 0 )
+    {
+        Unpack32 ( packed, rem, ( uint32_t* ) dst + ( groups << 3 ),
+            ( const uint8_t* ) src + ( size_t ) groups * packed, 0, ( bitsz_t ) rem * packed );
+    }
+
+    for ( g = groups; g != 0; )
+    {
+        uint64_t out [ 4 ];
+        bitsz_t off;
+        uint32_t i;
+
+        -- g;
+        off = ( bitsz_t ) g * packed << 3;
+
+        for ( i = 0; i < 4; ++ i )
+            out [ i ] = UnpackReadField ( src, end, off + ( bitsz_t ) i * ( packed << 1 ), packed << 1 );
+
+        for ( i = 0; i < 4; ++ i )
+        {
+            uint64_t x = _pdep_u64 ( out [ i ], mask );
+            out [ i ] = ( x >> 32 ) | ( x << 32 );
+        }
+
+        memcpy ( ( uint32_t* ) dst + ( ( size_t ) g << 3 ), out, sizeof out );
+    }
+}
+
+/* Unpack64BMI2
+ *  every element is its own field, so there is nothing to deposit;
+ *  the gain comes from dropping the 128-bit accumulator of Unpack64b
+ */
+static PACK_TARGET_BMI2
+void CC Unpack64BMI2 ( uint32_t packed, uint32_t count, void *dst,
+    const void *src, bitsz_t src_off, bitsz_t ssize )
+{
+    uint32_t i;
+    const uint8_t *end = ( const uint8_t* ) src + ( ( ssize + 7 ) >> 3 );
+
+    /* up to 32 bits the scalar loop works on 64-bit halves and is faster */
+    if ( packed <= 32 || packed > 57 || src_off != 0 || ssize != ( bitsz_t ) count * packed )
+    {
+        Unpack64 ( packed, count, dst, src, src_off, ssize );
+        return;
+    }
+
+    for ( i = count; i != 0; )
+    {
+        uint64_t out;
+        -- i;
+        out = UnpackReadField ( src, end, ( bitsz_t ) i * packed, packed );
+        memcpy ( ( uint64_t* ) dst + i, & out, 8 );
+    }
+}
+
+#endif /* PACK_BMI2 */
+
+
+/* unpack_dispatch
+ *  kernel for each unpacked size, indexed by log2 ( unpacked ) - 3.
+ *  the choice between them is made by PackKernels
+ */
+typedef void ( CC * UnpackFunc ) ( uint32_t packed, uint32_t count, void *dst,
+    const void *src, bitsz_t src_off, bitsz_t ssize );
+
+static const UnpackFunc unpack_scalar [ 4 ] =
+{
+    Unpack8, Unpack16, Unpack32, Unpack64
+};
+
+#if PACK_BMI2
+static const UnpackFunc unpack_bmi2 [ 4 ] =
+{
+    Unpack8BMI2, Unpack16BMI2, Unpack32BMI2, Unpack64BMI2
+};
+#endif
+
+
 /* Unpack
  *  accepts a series of packed source bits
  *  produces a series of unpacked destination bits by left-padding zeros
@@ -748,6 +986,7 @@ LIB_EXPORT rc_t CC Unpack ( uint32_t packed, uint32_t unpacked,
     void *dst, size_t dsize, size_t *usize )
 {
     uint32_t count;
+    const UnpackFunc *unpack_dispatch;
 
     /* prepare for failure */
     if ( consumed != NULL )
@@ -806,26 +1045,39 @@ LIB_EXPORT rc_t CC Unpack ( uint32_t packed, uint32_t unpacked,
         return 0;
     }
 
+    /* full width 64-bit elements only change byte order,
+       and the general code cannot shift its accumulator by 64 */
+    if ( unpacked == 64 && packed == 64 && src_off == 0 )
+    {
+        uint32_t i;
+        for ( i = 0; i < count; ++ i )
+            ( ( uint64_t* ) dst ) [ i ] = READ_PACKED64 ( src, i );
+        return 0;
+    }
+
     /* TBD - enable unpacking from offsets */
     if ( src_off != 0 )
         return RC ( rcXF, rcBuffer, rcUnpacking, rcOffset, rcUnsupported );
 
+    unpack_dispatch = unpack_scalar;
+#if PACK_BMI2
+    if ( PackKernels () == pkBMI2 )
+        unpack_dispatch = unpack_bmi2;
+#endif
+
     switch ( unpacked )
     {
     case 8:
-        Unpack8 ( packed, count, dst, src, src_off, ssize );
+        unpack_dispatch [ 0 ] ( packed, count, dst, src, src_off, ssize );
         break;
     case 16:
-        Unpack16 ( packed, count, dst, src, src_off, ssize );
+        unpack_dispatch [ 1 ] ( packed, count, dst, src, src_off, ssize );
         break;
     case 32:
-        Unpack32 ( packed, count, dst, src, src_off, ssize );
+        unpack_dispatch [ 2 ] ( packed, count, dst, src, src_off, ssize );
         break;
     case 64:
-        if ( packed > 32 )
-            Unpack64b ( packed, count, dst, src, src_off, ssize );
-        else
-            Unpack64a ( packed, count, dst, src, src_off, ssize );
+        unpack_dispatch [ 3 ] ( packed, count, dst, src, src_off, ssize );
         break;
     }
 
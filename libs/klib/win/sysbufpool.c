@@ -0,0 +1,69 @@
+/*===========================================================================
+*
+*                            PUBLIC DOMAIN NOTICE
+*               National Center for Biotechnology Information
+*
+*  This software/database is a "United States Government Work" under the
+*  terms of the United States Copyright Act.  It was written as part of
+*  the author's official duties as a United States Government employee and
+*  thus cannot be copyrighted.  This software/database is freely available
+*  to the public for use. The National Library of Medicine and the U.S.
+*  Government have not placed any restriction on its use or reproduction.
+*
+*  Although all reasonable efforts have been taken to ensure the accuracy
+*  and reliability of the software and data, the NLM and the U.S.
+*  Government do not and cannot warrant the performance or results that
+*  may be obtained by using this software or data. The NLM and the U.S.
+*  Government disclaim all warranties, express or implied, including
+*  warranties of performance, merchantability or fitness for any particular
+*  purpose.
+*
+*  Please cite the author in any work or product based on this material.
+*
+* ===========================================================================
+*
+*/
+
+#include <klib/extern.h>
+#include "data-buffer-priv.h"
+
+/* do not include windows.h, it is included already by os-native.h */
+#include <os-native.h>
+
+
+/*--------------------------------------------------------------------------
+ * KDataBufferPool
+ *  Windows gives no portable hook for thread exit here, so the pool
+ *  keeps only its shared lists, and large pages need a privilege the
+ *  process normally lacks, so large buffers stay with malloc
+ */
+static SRWLOCK pool_lock = SRWLOCK_INIT;
+
+void KDataBufferPoolLock ( void )
+{
+    AcquireSRWLockExclusive ( & pool_lock );
+}
+
+void KDataBufferPoolUnlock ( void )
+{
+    ReleaseSRWLockExclusive ( & pool_lock );
+}
+
+void * KDataBufferPoolGetThreadCache ( void )
+{
+    return NULL;
+}
+
+bool KDataBufferPoolSetThreadCache ( void * cache )
+{
+    return false;
+}
+
+void * KDataBufferPoolMapHuge ( size_t bytes )
+{
+    return NULL;
+}
+
+void KDataBufferPoolUnmapHuge ( void * addr, size_t bytes )
+{
+}
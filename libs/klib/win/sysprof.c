@@ -0,0 +1,74 @@
+/*===========================================================================
+ *
+ *                            PUBLIC DOMAIN NOTICE
+ *               National Center for Biotechnology Information
+ *
+ *  This software/database is a "United States Government Work" under the
+ *  terms of the United States Copyright Act.  It was written as part of
+ *  the author's official duties as a United States Government employee and
+ *  thus cannot be copyrighted.  This software/database is freely available
+ *  to the public for use. The National Library of Medicine and the U.S.
+ *  Government have not placed any restriction on its use or reproduction.
+ *
+ *  Although all reasonable efforts have been taken to ensure the accuracy
+ *  and reliability of the software and data, the NLM and the U.S.
+ *  Government do not and cannot warrant the performance or results that
+ *  may be obtained by using this software or data. The NLM and the U.S.
+ *  Government disclaim all warranties, express or implied, including
+ *  warranties of performance, merchantability or fitness for any particular
+ *  purpose.
+ *
+ *  Please cite the author in any work or product based on this material.
+ *
+ * ===========================================================================
+ *
+ */
+
+
+#include <klib/extern.h>
+#include "prof-priv.h"
+
+/* do not include windows.h, it is included already by os-native.h */
+#include <os-native.h>
+
+
+/*--------------------------------------------------------------------------
+ * KProf
+ *  Windows gives no portable hook for thread exit here, so every
+ *  record goes to the shared totals under the lock
+ */
+static SRWLOCK prof_lock = SRWLOCK_INIT;
+
+void KProfLock ( void )
+{
+    AcquireSRWLockExclusive ( & prof_lock );
+}
+
+void KProfUnlock ( void )
+{
+    ReleaseSRWLockExclusive ( & prof_lock );
+}
+
+void * KProfGetThread ( void )
+{
+    return NULL;
+}
+
+bool KProfSetThread ( void * block )
+{
+    return false;
+}
+
+uint64_t KProfClock ( void )
+{
+    static LARGE_INTEGER freq;
+    LARGE_INTEGER now;
+
+    if ( freq . QuadPart == 0 )
+        QueryPerformanceFrequency ( & freq );
+    QueryPerformanceCounter ( & now );
+
+    /* split to keep the multiply from overflowing */
+    return ( uint64_t ) ( now . QuadPart / freq . QuadPart ) * 1000000000 +
+        ( uint64_t ) ( now . QuadPart % freq . QuadPart ) * 1000000000 / freq . QuadPart;
+}
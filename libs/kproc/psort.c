@@ -0,0 +1,334 @@
+/*===========================================================================
+*
+*                            PUBLIC DOMAIN NOTICE
+*               National Center for Biotechnology Information
+*
+*  This software/database is a "United States Government Work" under the
+*  terms of the United States Copyright Act.  It was written as part of
+*  the author's official duties as a United States Government employee and
+*  thus cannot be copyrighted.  This software/database is freely available
+*  to the public for use. The National Library of Medicine and the U.S.
+*  Government have not placed any restriction on its use or reproduction.
+*
+*  Although all reasonable efforts have been taken to ensure the accuracy
+*  and reliability of the software and data, the NLM and the U.S.
+*  Government do not and cannot warrant the performance or results that
+*  may be obtained by using this software or data. The NLM and the U.S.
+*  Government disclaim all warranties, express or implied, including
+*  warranties of performance, merchantability or fitness for any particular
+*  purpose.
+*
+*  Please cite the author in any work or product based on this material.
+*
+* ===========================================================================
+*
+*/
+
+#include <kproc/extern.h>
+
+#include <kproc/psort.h>
+#include <kproc/thread.h>
+#include <klib/sort.h>
+#include <klib/rc.h>
+#include <sysalloc.h>
+
+#include <stdlib.h>
+#include <string.h>
+
+#define rcSort rcVector
+
+/* below this many elements per thread, threads are not worth starting */
+#define PSORT_MIN_RUN 4096
+
+/* never start more threads than this */
+#define PSORT_MAX_THREADS 64
+
+
+/*--------------------------------------------------------------------------
+ * PSortJob
+ *  one unit of work for a thread: either sorting a run in place,
+ *  or merging a slice of two sorted runs into "out"
+ */
+typedef struct PSortJob PSortJob;
+struct PSortJob
+{
+    const uint8_t * a;
+    const uint8_t * b;
+    uint8_t * out;
+    size_t a_count;
+    size_t b_count;
+};
+
+typedef struct PSort PSort;
+struct PSort
+{
+    int ( CC * cmp ) ( const void*, const void*, void *data );
+    void * data;
+    size_t size;
+
+    PSortJob * jobs;
+    uint32_t num_jobs;
+    uint32_t stride;
+    bool sorting;
+};
+
+typedef struct PSortWorker PSortWorker;
+struct PSortWorker
+{
+    const PSort * ps;
+    uint32_t first;
+};
+
+
+static
+void PSortMerge ( const PSort * ps, const PSortJob * job )
+{
+    const uint8_t * a = job -> a, * a_end = a + job -> a_count * ps -> size;
+    const uint8_t * b = job -> b, * b_end = b + job -> b_count * ps -> size;
+    uint8_t * out = job -> out;
+
+    while ( a < a_end && b < b_end )
+    {
+        /* take from "a" on ties, matching the split in PSortCoRank */
+        if ( ( * ps -> cmp ) ( b, a, ps -> data ) < 0 )
+        {
+            memmove ( out, b, ps -> size );
+            b += ps -> size;
+        }
+        else
+        {
+            memmove ( out, a, ps -> size );
+            a += ps -> size;
+        }
+        out += ps -> size;
+    }
+
+    if ( a < a_end )
+        memmove ( out, a, a_end - a );
+    else if ( b < b_end )
+        memmove ( out, b, b_end - b );
+}
+
+/* PSortCoRank
+ *  find how many of the first "k" merged elements come from "a",
+ *  so that a merge can be cut into independent slices
+ */
+static
+size_t PSortCoRank ( const PSort * ps, size_t k,
+    const uint8_t * a, size_t a_count, const uint8_t * b, size_t b_count )
+{
+    size_t lo = k > b_count ? k - b_count : 0;
+    size_t hi = k < a_count ? k : a_count;
+
+    while ( lo < hi )
+    {
+        /* i elements from a, k - i from b */
+        size_t i = lo + ( hi - lo + 1 ) / 2;
+        size_t j = k - i;
+
+        /* too many from a if a [ i - 1 ] sorts after b [ j ] */
+        if ( j < b_count && ( * ps -> cmp ) ( b + j * ps -> size,
+                 a + ( i - 1 ) * ps -> size, ps -> data ) < 0 )
+            hi = i - 1;
+        else
+            lo = i;
+    }
+
+    return lo;
+}
+
+static
+void PSortRunJobs ( const PSort * ps, uint32_t first )
+{
+    uint32_t i;
+    for ( i = first; i < ps -> num_jobs; i += ps -> stride )
+    {
+        const PSortJob * job = & ps -> jobs [ i ];
+        if ( ps -> sorting )
+            ksort ( job -> out, job -> a_count, ps -> size, ps -> cmp, ps -> data );
+        else
+            PSortMerge ( ps, job );
+    }
+}
+
+static
+rc_t CC PSortThread ( const KThread * self, void * data )
+{
+    const PSortWorker * w = data;
+    PSortRunJobs ( w -> ps, w -> first );
+    return 0;
+}
+
+/* PSortRun
+ *  runs the current job list on "stride" threads, the caller being one
+ *  of them. a thread that cannot be started has its share run here.
+ */
+static
+void PSortRun ( PSort * ps, uint32_t stride )
+{
+    KThread * t [ PSORT_MAX_THREADS ];
+    PSortWorker w [ PSORT_MAX_THREADS ];
+    uint32_t i;
+
+    ps -> stride = stride;
+
+    for ( i = 1; i < stride; ++ i )
+    {
+        w [ i ] . ps = ps;
+        w [ i ] . first = i;
+        if ( KThreadMake ( & t [ i ], PSortThread, & w [ i ] ) != 0 )
+            t [ i ] = NULL;
+    }
+
+    PSortRunJobs ( ps, 0 );
+
+    for ( i = 1; i < stride; ++ i )
+    {
+        if ( t [ i ] == NULL )
+            PSortRunJobs ( ps, i );
+        else
+        {
+            KThreadWait ( t [ i ], NULL );
+            KThreadRelease ( t [ i ] );
+        }
+    }
+}
+
+LIB_EXPORT rc_t CC ksort_parallel ( void *pbase, size_t total_elems, size_t size,
+    int ( CC * cmp ) ( const void*, const void*, void *data ), void *data,
+    uint32_t num_threads )
+{
+    PSort ps;
+    PSortJob * jobs;
+    size_t * runs;
+    uint8_t * src, * dst, * scratch;
+    uint32_t i, num_runs;
+
+    if ( pbase == NULL && total_elems != 0 )
+        return RC ( rcPS, rcSort, rcProcessing, rcParam, rcNull );
+    if ( cmp == NULL )
+        return RC ( rcPS, rcSort, rcProcessing, rcFunction, rcNull );
+    if ( size == 0 )
+        return RC ( rcPS, rcSort, rcProcessing, rcParam, rcInvalid );
+
+    if ( num_threads > PSORT_MAX_THREADS )
+        num_threads = PSORT_MAX_THREADS;
+    if ( num_threads > total_elems / PSORT_MIN_RUN )
+        num_threads = ( uint32_t ) ( total_elems / PSORT_MIN_RUN );
+
+    if ( num_threads <= 1 )
+    {
+        ksort ( pbase, total_elems, size, cmp, data );
+        return 0;
+    }
+
+    /* a merge round has at most one job per thread plus an odd run;
+       the run boundaries share the block with the jobs */
+    scratch = malloc ( total_elems * size );
+    jobs = malloc ( ( num_threads + 1 ) * ( sizeof * jobs + sizeof * runs ) );
+    if ( scratch == NULL || jobs == NULL )
+    {
+        free ( jobs );
+        free ( scratch );
+        ksort ( pbase, total_elems, size, cmp, data );
+        return 0;
+    }
+    runs = ( size_t* ) ( jobs + num_threads + 1 );
+
+    ps . cmp = cmp;
+    ps . data = data;
+    ps . size = size;
+    ps . jobs = jobs;
+
+    /* sort one run per thread */
+    num_runs = num_threads;
+    for ( i = 0; i <= num_runs; ++ i )
+        runs [ i ] = ( size_t ) ( ( ( uint64_t ) total_elems * i ) / num_runs );
+    for ( i = 0; i < num_runs; ++ i )
+    {
+        jobs [ i ] . out = ( uint8_t* ) pbase + runs [ i ] * size;
+        jobs [ i ] . a_count = runs [ i + 1 ] - runs [ i ];
+    }
+    ps . num_jobs = num_runs;
+    ps . sorting = true;
+    PSortRun ( & ps, num_threads );
+
+    /* merge pairs of runs until one is left, cutting each merge
+       into as many slices as there are threads to spare */
+    ps . sorting = false;
+    src = pbase;
+    dst = scratch;
+    while ( num_runs > 1 )
+    {
+        uint32_t pairs = num_runs / 2;
+        uint32_t slices = num_threads / pairs;
+        uint32_t r;
+
+        if ( slices == 0 )
+            slices = 1;
+
+        ps . num_jobs = 0;
+        for ( r = 0; r + 1 < num_runs; r += 2 )
+        {
+            const uint8_t * a = src + runs [ r ] * size;
+            const uint8_t * b = src + runs [ r + 1 ] * size;
+            size_t a_count = runs [ r + 1 ] - runs [ r ];
+            size_t b_count = runs [ r + 2 ] - runs [ r + 1 ];
+            size_t total = a_count + b_count;
+            size_t prev_k = 0, prev_i = 0;
+            uint32_t s;
+
+            for ( s = 1; s <= slices; ++ s )
+            {
+                PSortJob * job = & jobs [ ps . num_jobs ++ ];
+                size_t k = ( size_t ) ( ( ( uint64_t ) total * s ) / slices );
+                size_t ai = s == slices ? a_count :
+                    PSortCoRank ( & ps, k, a, a_count, b, b_count );
+
+                job -> a = a + prev_i * size;
+                job -> a_count = ai - prev_i;
+                job -> b = b + ( prev_k - prev_i ) * size;
+                job -> b_count = ( k - ai ) - ( prev_k - prev_i );
+                job -> out = dst + ( runs [ r ] + prev_k ) * size;
+
+                prev_k = k;
+                prev_i = ai;
+            }
+        }
+
+        /* an odd run out is carried over unchanged */
+        if ( num_runs & 1 )
+        {
+            PSortJob * job = & jobs [ ps . num_jobs ++ ];
+            job -> a = src + runs [ num_runs - 1 ] * size;
+            job -> a_count = runs [ num_runs ] - runs [ num_runs - 1 ];
+            job -> b = NULL;
+            job -> b_count = 0;
+            job -> out = dst + runs [ num_runs - 1 ] * size;
+        }
+
+        PSortRun ( & ps, num_threads < ps . num_jobs ? num_threads : ps . num_jobs );
+
+        /* every other boundary survives */
+        for ( r = 0; r <= num_runs; r += 2 )
+            runs [ r / 2 ] = runs [ r ];
+        if ( num_runs & 1 )
+            runs [ ( num_runs + 1 ) / 2 ] = runs [ num_runs ];
+        num_runs = ( num_runs + 1 ) / 2;
+
+        /* swap buffers */
+        {
+            uint8_t * tmp = src;
+            src = dst;
+            dst = tmp;
+        }
+    }
+
+    if ( src != pbase )
+        memmove ( pbase, src, total_elems * size );
+
+    free ( jobs );
+    free ( scratch );
+
+    return 0;
+}
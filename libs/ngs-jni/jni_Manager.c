@@ -39,6 +39,7 @@
 #include <klib/sra-release-version.h> /* SraReleaseVersion */
 
 #include "NGS_ReadCollection.h"
+#include "NGS_Export.h"
 
 #include <assert.h>
 #include <string.h> /* memset */
@@ -145,3 +146,150 @@ JNIEXPORT jstring JNICALL Java_gov_nih_nlm_ncbi_ngs_Manager_Version
         return JStringMake(ctx, jenv, "");
     }
 }
+
+/* Export
+ *  fill Java arrays with the next batch of records from an iterator,
+ *  so that Java code crosses into the engine once per batch
+ *  rather than once per getter per record
+ *
+ *  "joffsets" and "jid_offsets" hold one more element than the number of
+ *  records wanted. "jquals", "jids" and "jid_offsets" may be null.
+ *  "jpending" is a single-element in/out array, see NGS_ReadIteratorExport.
+ */
+static
+jint JExport ( ctx_t ctx, JNIEnv * jenv, bool alignments, jlong jiter,
+    jbyteArray jbases, jbyteArray jquals, jintArray joffsets,
+    jbyteArray jids, jintArray jid_offsets, jbooleanArray jpending )
+{
+    FUNC_ENTRY ( ctx, rcSRA, rcRow, rcReading );
+
+    NGS_ExportBuffer buf;
+    jboolean jpend;
+    bool pending;
+    bool pinned;
+    uint32_t count = 0;
+
+    if ( jiter == 0 || jbases == NULL || joffsets == NULL || jpending == NULL ||
+         ( jids != NULL && jid_offsets == NULL ) )
+    {
+        USER_ERROR ( xcParamNull, "bad input" );
+        ErrorMsgThrow ( jenv, ctx, __LINE__, "null argument to export" );
+        return 0;
+    }
+
+    memset ( & buf, 0, sizeof buf );
+    buf . data_capacity = ( * jenv ) -> GetArrayLength ( jenv, jbases );
+    if ( jquals != NULL && ( size_t ) ( * jenv ) -> GetArrayLength ( jenv, jquals ) < buf . data_capacity )
+        buf . data_capacity = ( * jenv ) -> GetArrayLength ( jenv, jquals );
+    buf . max_records = ( * jenv ) -> GetArrayLength ( jenv, joffsets );
+    if ( jids != NULL )
+    {
+        uint32_t id_records = ( * jenv ) -> GetArrayLength ( jenv, jid_offsets );
+        buf . ids_capacity = ( * jenv ) -> GetArrayLength ( jenv, jids );
+        if ( id_records < buf . max_records )
+            buf . max_records = id_records;
+    }
+    /* offsets have one more element than there are records */
+    if ( buf . max_records != 0 )
+        -- buf . max_records;
+
+    /* throws on an empty array */
+    ( * jenv ) -> GetBooleanArrayRegion ( jenv, jpending, 0, 1, & jpend );
+    if ( ( * jenv ) -> ExceptionCheck ( jenv ) )
+        return 0;
+    pending = jpend != JNI_FALSE;
+
+    /* pin or copy the arrays once for the whole batch,
+       stopping at the first that fails with an exception pending */
+    buf . bases = ( char * ) ( * jenv ) -> GetByteArrayElements ( jenv, jbases, NULL );
+    pinned = buf . bases != NULL;
+    if ( pinned )
+    {
+        buf . data_offsets = ( uint32_t * ) ( * jenv ) -> GetIntArrayElements ( jenv, joffsets, NULL );
+        pinned = buf . data_offsets != NULL;
+    }
+    if ( pinned && jquals != NULL )
+    {
+        buf . qualities = ( char * ) ( * jenv ) -> GetByteArrayElements ( jenv, jquals, NULL );
+        pinned = buf . qualities != NULL;
+    }
+    if ( pinned && jids != NULL )
+    {
+        buf . ids = ( char * ) ( * jenv ) -> GetByteArrayElements ( jenv, jids, NULL );
+        pinned = buf . ids != NULL;
+        if ( pinned )
+        {
+            buf . id_offsets = ( uint32_t * ) ( * jenv ) -> GetIntArrayElements ( jenv, jid_offsets, NULL );
+            pinned = buf . id_offsets != NULL;
+        }
+    }
+
+    if ( ! pinned )
+    {
+        /* nothing has been written: unpin what is pinned and leave
+           the exception raised by the JVM to the caller */
+        if ( buf . ids != NULL )
+            ( * jenv ) -> ReleaseByteArrayElements ( jenv, jids, ( jbyte * ) buf . ids, JNI_ABORT );
+        if ( buf . qualities != NULL )
+            ( * jenv ) -> ReleaseByteArrayElements ( jenv, jquals, ( jbyte * ) buf . qualities, JNI_ABORT );
+        if ( buf . data_offsets != NULL )
+            ( * jenv ) -> ReleaseIntArrayElements ( jenv, joffsets, ( jint * ) buf . data_offsets, JNI_ABORT );
+        if ( buf . bases != NULL )
+            ( * jenv ) -> ReleaseByteArrayElements ( jenv, jbases, ( jbyte * ) buf . bases, JNI_ABORT );
+        return 0;
+    }
+
+    if ( alignments )
+        count = NGS_AlignmentIteratorExport ( ( struct NGS_Alignment * ) ( size_t ) jiter, ctx, & buf, & pending );
+    else
+        count = NGS_ReadIteratorExport ( ( struct NGS_Read * ) ( size_t ) jiter, ctx, & buf, & pending );
+
+    /* copy back whatever has been written, even on error */
+    if ( buf . id_offsets != NULL )
+        ( * jenv ) -> ReleaseIntArrayElements ( jenv, jid_offsets, ( jint * ) buf . id_offsets, 0 );
+    if ( buf . ids != NULL )
+        ( * jenv ) -> ReleaseByteArrayElements ( jenv, jids, ( jbyte * ) buf . ids, 0 );
+    if ( buf . qualities != NULL )
+        ( * jenv ) -> ReleaseByteArrayElements ( jenv, jquals, ( jbyte * ) buf . qualities, 0 );
+    ( * jenv ) -> ReleaseIntArrayElements ( jenv, joffsets, ( jint * ) buf . data_offsets, 0 );
+    ( * jenv ) -> ReleaseByteArrayElements ( jenv, jbases, ( jbyte * ) buf . bases, 0 );
+
+    jpend = pending ? JNI_TRUE : JNI_FALSE;
+    ( * jenv ) -> SetBooleanArrayRegion ( jenv, jpending, 0, 1, & jpend );
+
+    if ( FAILED () )
+    {
+        ErrorMsgThrow ( jenv, ctx, __LINE__, "failed to export records" );
+        return 0;
+    }
+
+    return ( jint ) count;
+}
+
+/*
+ * Class:     gov_nih_nlm_ncbi_ngs_Manager
+ * Method:    ExportReads
+ * Signature: (J[B[B[I[B[I[Z)I
+ */
+JNIEXPORT jint JNICALL Java_gov_nih_nlm_ncbi_ngs_Manager_ExportReads
+    ( JNIEnv * jenv, jclass jcls, jlong jiter, jbyteArray jbases, jbyteArray jquals, jintArray joffsets,
+      jbyteArray jids, jintArray jid_offsets, jbooleanArray jpending )
+{
+    HYBRID_FUNC_ENTRY ( rcSRA, rcRow, rcReading );
+    return JExport ( ctx, jenv, false, jiter,
+                     jbases, jquals, joffsets, jids, jid_offsets, jpending );
+}
+
+/*
+ * Class:     gov_nih_nlm_ncbi_ngs_Manager
+ * Method:    ExportAlignments
+ * Signature: (J[B[B[I[B[I[Z)I
+ */
+JNIEXPORT jint JNICALL Java_gov_nih_nlm_ncbi_ngs_Manager_ExportAlignments
+    ( JNIEnv * jenv, jclass jcls, jlong jiter, jbyteArray jbases, jbyteArray jquals, jintArray joffsets,
+      jbyteArray jids, jintArray jid_offsets, jbooleanArray jpending )
+{
+    HYBRID_FUNC_ENTRY ( rcSRA, rcRow, rcReading );
+    return JExport ( ctx, jenv, true, jiter,
+                     jbases, jquals, joffsets, jids, jid_offsets, jpending );
+}
@@ -47,6 +47,22 @@ JNIEXPORT jlong JNICALL Java_gov_nih_nlm_ncbi_ngs_Manager_OpenReadCollection
 JNIEXPORT void JNICALL Java_gov_nih_nlm_ncbi_ngs_Manager_release
   (JNIEnv *, jclass, jlong);
 
+/*
+ * Class:     gov_nih_nlm_ncbi_ngs_Manager
+ * Method:    ExportReads
+ * Signature: (J[B[B[I[B[I[Z)I
+ */
+JNIEXPORT jint JNICALL Java_gov_nih_nlm_ncbi_ngs_Manager_ExportReads
+  (JNIEnv *, jclass, jlong, jbyteArray, jbyteArray, jintArray, jbyteArray, jintArray, jbooleanArray);
+
+/*
+ * Class:     gov_nih_nlm_ncbi_ngs_Manager
+ * Method:    ExportAlignments
+ * Signature: (J[B[B[I[B[I[Z)I
+ */
+JNIEXPORT jint JNICALL Java_gov_nih_nlm_ncbi_ngs_Manager_ExportAlignments
+  (JNIEnv *, jclass, jlong, jbyteArray, jbyteArray, jintArray, jbyteArray, jintArray, jbooleanArray);
+
 #ifdef __cplusplus
 }
 #endif
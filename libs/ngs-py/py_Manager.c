@@ -11,6 +11,7 @@
 #include "NGS_String.h"
 #include "NGS_ReadCollection.h"
 #include "NGS_Refcount.h"
+#include "NGS_Export.h"
 
 #include <assert.h>
 #include <string.h>
@@ -46,6 +47,69 @@ PY_RES_TYPE PY_NGS_Engine_ReadCollectionMake(char const* spec, void** ppReadColl
     return PY_RES_OK;
 }
 
+static PY_RES_TYPE PY_NGS_Engine_Export(ctx_t ctx, bool alignments, void* pIterator, int* pPending,
+    char* pBases, char* pQualities, size_t nDataCapacity, uint32_t* pDataOffsets,
+    char* pIds, size_t nIdsCapacity, uint32_t* pIdOffsets, uint32_t nMaxRecords,
+    uint32_t* pRetCount, char* pStrError, size_t nStrErrorBufferSize)
+{
+    NGS_ExportBuffer buf;
+    bool pending;
+    uint32_t count;
+
+    assert(pPending != NULL);
+    assert(pRetCount != NULL);
+
+    buf.bases = pBases;
+    buf.qualities = pQualities;
+    buf.data_offsets = pDataOffsets;
+    buf.ids = pIds;
+    buf.id_offsets = pIdOffsets;
+    buf.data_capacity = nDataCapacity;
+    buf.ids_capacity = nIdsCapacity;
+    buf.max_records = nMaxRecords;
+    buf.num_records = 0;
+
+    pending = *pPending != 0;
+    if (alignments)
+        count = NGS_AlignmentIteratorExport((struct NGS_Alignment*)pIterator, ctx, &buf, &pending);
+    else
+        count = NGS_ReadIteratorExport((struct NGS_Read*)pIterator, ctx, &buf, &pending);
+    *pPending = pending;
+    *pRetCount = count;
+
+    if (FAILED())
+    {
+        return NGSErrorHandler(ctx, pStrError, nStrErrorBufferSize);
+    }
+
+    CLEAR();
+    return PY_RES_OK;
+}
+
+PY_RES_TYPE PY_NGS_Engine_ReadIteratorExport(void* pIterator, int* pPending,
+    char* pBases, char* pQualities, size_t nDataCapacity, uint32_t* pDataOffsets,
+    char* pIds, size_t nIdsCapacity, uint32_t* pIdOffsets, uint32_t nMaxRecords,
+    uint32_t* pRetCount, char* pStrError, size_t nStrErrorBufferSize)
+{
+    HYBRID_FUNC_ENTRY(rcSRA, rcRow, rcReading);
+
+    return PY_NGS_Engine_Export(ctx, false, pIterator, pPending,
+        pBases, pQualities, nDataCapacity, pDataOffsets, pIds, nIdsCapacity, pIdOffsets, nMaxRecords,
+        pRetCount, pStrError, nStrErrorBufferSize);
+}
+
+PY_RES_TYPE PY_NGS_Engine_AlignmentIteratorExport(void* pIterator, int* pPending,
+    char* pBases, char* pQualities, size_t nDataCapacity, uint32_t* pDataOffsets,
+    char* pIds, size_t nIdsCapacity, uint32_t* pIdOffsets, uint32_t nMaxRecords,
+    uint32_t* pRetCount, char* pStrError, size_t nStrErrorBufferSize)
+{
+    HYBRID_FUNC_ENTRY(rcSRA, rcRow, rcReading);
+
+    return PY_NGS_Engine_Export(ctx, true, pIterator, pPending,
+        pBases, pQualities, nDataCapacity, pDataOffsets, pIds, nIdsCapacity, pIdOffsets, nMaxRecords,
+        pRetCount, pStrError, nStrErrorBufferSize);
+}
+
 
 #if 0
 PY_RES_TYPE PY_NGS_Engine_RefcountRelease(void* pRefcount, void** ppNGSStrError)
@@ -6,8 +6,27 @@ extern "C" {
 
 #include "py_ngs_defs.h"
 #include <stddef.h>
+#include <stdint.h>
 
 PY_RES_TYPE PY_NGS_Engine_ReadCollectionMake(char const* spec, void** ppReadCollection, char* pStrError, size_t nStrErrorBufferSize);
+
+/*
+Batch export into caller-provided buffers (e.g. bytearray or numpy arrays
+passed through the buffer protocol), one call per batch instead of one per
+getter per record.
+pBases and pQualities hold nDataCapacity bytes each, pDataOffsets and pIdOffsets
+hold nMaxRecords + 1 elements. pQualities, pIds and pIdOffsets may be NULL.
+pPending is in/out: 0 on the first call, then the value returned by the previous one.
+*/
+PY_RES_TYPE PY_NGS_Engine_ReadIteratorExport(void* pIterator, int* pPending,
+    char* pBases, char* pQualities, size_t nDataCapacity, uint32_t* pDataOffsets,
+    char* pIds, size_t nIdsCapacity, uint32_t* pIdOffsets, uint32_t nMaxRecords,
+    uint32_t* pRetCount, char* pStrError, size_t nStrErrorBufferSize);
+
+PY_RES_TYPE PY_NGS_Engine_AlignmentIteratorExport(void* pIterator, int* pPending,
+    char* pBases, char* pQualities, size_t nDataCapacity, uint32_t* pDataOffsets,
+    char* pIds, size_t nIdsCapacity, uint32_t* pIdOffsets, uint32_t nMaxRecords,
+    uint32_t* pRetCount, char* pStrError, size_t nStrErrorBufferSize);
 /*
 These functions are not needed:
 *ReadCollection can be released with Release functon from ngs-sdk
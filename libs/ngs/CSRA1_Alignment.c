@@ -333,34 +333,25 @@ struct NGS_String* CSRA1_AlignmentGetClippedFragmentQualities( CSRA1_Alignment*
     }
 
     {
-        NGS_String* phred = NGS_CursorGetString ( GetCursor ( self ), ctx, self -> cur_row, align_CLIPPED_QUALITY );
-        /* convert to ascii-33 */
-        size_t size = NGS_StringSize ( phred, ctx ); 
-        char * copy = malloc ( size + 1 );
-        if ( copy == NULL )
+        TRY ( NGS_String* phred = NGS_CursorGetString ( GetCursor ( self ), ctx, self -> cur_row, align_CLIPPED_QUALITY ) )
         {
-            SYSTEM_ERROR ( xcNoMemory, 
-                           "allocating %u bytes for %s row %ld", 
-                           size + 1, "CLIPPED_QUALITY", self -> cur_row );
-            NGS_StringRelease ( phred, ctx );
-            return NULL;
-        }
-        else
-        {
-            NGS_String* ret;
-            const char* orig = NGS_StringData ( phred, ctx );
-            size_t i;
-            for ( i = 0; i < size ; ++ i )
-                copy [ i ] = ( char ) ( (uint8_t)(orig [ i ]) + 33 );
-            copy [ i ] = 0;
-
-            ret = NGS_StringMakeOwned ( ctx, copy, size );
-            if ( FAILED () )
-                free ( copy );
+            /* convert to ascii-33 into a buffer reused from row to row */
+            size_t size = NGS_StringSize ( phred, ctx ); 
+            TRY ( char * copy = NGS_StringRecycle ( & self -> col_data [ align_CLIPPED_QUALITY ], ctx, size ) )
+            {
+                const char* orig = NGS_StringData ( phred, ctx );
+                size_t i;
+                for ( i = 0; i < size ; ++ i )
+                    copy [ i ] = ( char ) ( (uint8_t)(orig [ i ]) + 33 );
+
+                NGS_StringRelease ( phred, ctx );
+                return NGS_StringDuplicate ( self -> col_data [ align_CLIPPED_QUALITY ], ctx );
+            }
             NGS_StringRelease ( phred, ctx );
-            return ret;
         }
     }
+
+    return NULL;
 }
 
 struct NGS_String* CSRA1_AlignmentGetAlignedFragmentBases( CSRA1_Alignment* self, ctx_t ctx )
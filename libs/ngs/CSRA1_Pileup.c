@@ -340,21 +340,6 @@ void CSRA1_Pileup_AlignCursorDataGetNonEmptyCell ( CSRA1_Pileup_AlignCursorData
     }
 }
 
-static
-uint8_t CSRA1_Pileup_AlignCursorDataGetUInt8 ( CSRA1_Pileup_AlignCursorData * self, ctx_t ctx,
-    int64_t row_id, uint32_t col_idx )
-{
-    FUNC_ENTRY ( ctx, rcSRA, rcCursor, rcAccessing );
-
-    TRY ( CSRA1_Pileup_AlignCursorDataGetNonEmptyCell ( self, ctx, row_id, col_idx ) )
-    {
-        const uint8_t * p = self -> cell_data [ col_idx ];
-        return p [ 0 ];
-    }
-
-    return 0;
-}
-
 static
 int32_t CSRA1_Pileup_AlignCursorDataGetInt32 ( CSRA1_Pileup_AlignCursorData * self, ctx_t ctx,
     int64_t row_id, uint32_t col_idx )
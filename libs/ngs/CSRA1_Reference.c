@@ -525,7 +525,10 @@ void LoadOverlaps ( CSRA1_Reference * self,
         const void* base;
         uint32_t elem_bits, boff, row_len;
         ON_FAIL ( NGS_CursorCellDataDirect ( self -> curs, ctx, first_row, reference_OVERLAP_REF_LEN, & elem_bits, & base, & boff, & row_len ) )
-        {   /* no overlap columns, apply 10-chunk lookback */
+        {   /* no overlap columns, apply 10-chunk lookback.
+               loaders write the columns through ReferenceMgr_ReCover;
+               older archives without them get a bounded scan here rather
+               than reading every alignment of the reference */
             CLEAR ();
             if ( first_row > 11 ) 
             {
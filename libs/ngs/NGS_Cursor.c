@@ -35,6 +35,7 @@
 #include <kfc/except.h>
 #include <kfc/xc.h>
 
+#include <vdb/blob.h>
 #include <vdb/cursor.h>
 #include <vdb/vdb-priv.h>
 #include <vdb/table.h>
@@ -58,6 +59,7 @@ struct NGS_Cursor
     char ** col_specs;      /* [num_cols] */
     uint32_t* col_idx;      /* [num_cols] */
     NGS_String ** col_data; /* [num_cols] */
+    const VBlob ** col_blob; /* [num_cols] */
     
     /* row range */
     int64_t first;
@@ -76,10 +78,13 @@ void NGS_CursorWhack ( NGS_Cursor * self, ctx_t ctx )
     {
         free ( self -> col_specs [ i ] );
         NGS_StringRelease ( self -> col_data [ i ], ctx );
+        if ( self -> col_blob != NULL )
+            VBlobRelease ( self -> col_blob [ i ] );
     }
 
     free ( self -> col_specs );
     free ( self -> col_data );
+    free ( self -> col_blob );
             
     free ( self -> col_idx );
 }
@@ -151,6 +156,14 @@ const NGS_Cursor * NGS_CursorMake ( ctx_t ctx, const struct VTable* table, const
                 return NULL;
             }
             
+            ref -> col_blob = calloc ( num_cols,  sizeof ( ref -> col_blob [ 0 ] ) );
+            if ( ref -> col_blob == NULL )
+            {
+                SYSTEM_ERROR ( xcNoMemory, "allocating NGS_Cursor . col_blob" );
+                NGS_CursorWhack ( ref, ctx );
+                return NULL;
+            }
+            
             {   /* add first column; leave other for lazy add */
                 const char * col_spec = col_specs [ 0 ];
                 rc_t rc = VCursorAddColumn ( ref -> curs, & ref -> col_idx [ 0 ], "%s", col_spec );
@@ -279,6 +292,42 @@ void NGS_CursorCellDataDirect ( const NGS_Cursor *self,
         INTERNAL_ERROR ( xcColumnNotFound, "VCursorCellDataDirect failed: '%s' [%ld] rc = %R", self -> col_specs [ colIdx ], rowId, rc );
     }
 }
+
+void NGS_CursorCellDataBatch ( const NGS_Cursor *self, 
+                               ctx_t ctx,
+                               int64_t firstRowId,
+                               uint32_t colIdx, 
+                               uint32_t count,
+                               uint32_t *elem_bits, 
+                               const void **base,
+                               uint32_t *boff, 
+                               uint32_t *row_len,
+                               uint32_t *num_rows )
+{
+    FUNC_ENTRY ( ctx, rcSRA, rcCursor, rcAccessing );
+
+    rc_t rc;
+    
+    assert ( self != NULL );
+    
+    /* lazy add */
+    if ( self -> col_idx [ colIdx ] == 0 ) 
+    {
+        const char * col_spec = self -> col_specs [ colIdx ];
+        rc = VCursorAddColumn ( self -> curs, & self -> col_idx [ colIdx ], "%s", col_spec );
+        if ( rc != 0 && GetRCState ( rc ) != rcExists )
+        {
+            INTERNAL_ERROR ( xcColumnNotFound, "VCursorAddColumn failed: '%s' rc = %R", col_spec, rc );
+            return;
+        }
+    }    
+    
+    rc = VCursorCellDataBatch ( self -> curs, firstRowId, self -> col_idx [ colIdx ], count, elem_bits, base, boff, row_len, num_rows );
+    if ( rc != 0 )
+    {
+        INTERNAL_ERROR ( xcColumnNotFound, "VCursorCellDataBatch failed: '%s' [%ld] rc = %R", self -> col_specs [ colIdx ], firstRowId, rc );
+    }
+}
                                 
 /* GetRowCount
  */
@@ -301,6 +350,74 @@ void NGS_CursorGetRowRange ( const NGS_Cursor * self, ctx_t ctx, int64_t* first,
     *count = self -> count;
 }
     
+/* CellDataBlob
+ *  like CellDataDirect, but also returns the blob holding the cell
+ *  the blob is cached on the cursor until a row outside of it is requested
+ */
+static
+const VBlob * NGS_CursorCellDataBlob ( const NGS_Cursor *self, 
+                                       ctx_t ctx,
+                                       int64_t rowId,
+                                       uint32_t colIdx, 
+                                       uint32_t *elem_bits, 
+                                       const void **base,
+                                       uint32_t *boff, 
+                                       uint32_t *row_len )
+{
+    FUNC_ENTRY ( ctx, rcSRA, rcCursor, rcAccessing );
+
+    rc_t rc;
+    const VBlob * blob;
+    
+    assert ( self != NULL );
+    
+    /* lazy add */
+    if ( self -> col_idx [ colIdx ] == 0 ) 
+    {
+        const char * col_spec = self -> col_specs [ colIdx ];
+        rc = VCursorAddColumn ( self -> curs, & self -> col_idx [ colIdx ], "%s", col_spec );
+        if ( rc != 0 && GetRCState ( rc ) != rcExists )
+        {
+            INTERNAL_ERROR ( xcColumnNotFound, "VCursorAddColumn failed: '%s' rc = %R", col_spec, rc );
+            return NULL;
+        }
+    }    
+
+    /* see if the cached blob has this row */
+    blob = self -> col_blob [ colIdx ];
+    if ( blob != NULL )
+    {
+        int64_t first;
+        uint64_t count;
+        rc = VBlobIdRange ( blob, & first, & count );
+        if ( rc != 0 || rowId < first || ( uint64_t ) ( rowId - first ) >= count )
+        {
+            VBlobRelease ( blob );
+            self -> col_blob [ colIdx ] = blob = NULL;
+        }
+    }
+
+    if ( blob == NULL )
+    {
+        rc = VCursorGetBlobDirect ( self -> curs, & blob, rowId, self -> col_idx [ colIdx ] );
+        if ( rc != 0 )
+        {
+            INTERNAL_ERROR ( xcColumnNotFound, "VCursorGetBlobDirect failed: '%s' [%ld] rc = %R", self -> col_specs [ colIdx ], rowId, rc );
+            return NULL;
+        }
+        self -> col_blob [ colIdx ] = blob;
+    }
+
+    rc = VBlobCellData ( blob, rowId, elem_bits, base, boff, row_len );
+    if ( rc != 0 )
+    {
+        INTERNAL_ERROR ( xcColumnNotFound, "VBlobCellData failed: '%s' [%ld] rc = %R", self -> col_specs [ colIdx ], rowId, rc );
+        return NULL;
+    }
+
+    return blob;
+}
+
 NGS_String * NGS_CursorGetString ( const NGS_Cursor * self, ctx_t ctx, int64_t rowId, uint32_t colIdx )
 {
     FUNC_ENTRY ( ctx, rcSRA, rcCursor, rcReading );
@@ -309,24 +426,18 @@ NGS_String * NGS_CursorGetString ( const NGS_Cursor * self, ctx_t ctx, int64_t r
     assert ( self -> col_data );
     assert ( self -> curs );
     
-    /* invalidate any outstanding string */
-    NGS_StringInvalidate ( self -> col_data [ colIdx ], ctx );
-
     {
         const void * base;
         uint32_t elem_bits, boff, row_len;
-        TRY ( NGS_CursorCellDataDirect ( self, ctx, rowId, colIdx, & elem_bits, & base, & boff, & row_len ) )
+        TRY ( const VBlob * blob = NGS_CursorCellDataBlob ( self, ctx, rowId, colIdx, & elem_bits, & base, & boff, & row_len ) )
         {
-            NGS_String * new_data;
-
             assert ( elem_bits == 8 );
             assert ( boff == 0 );
 
-            /* create new string */
-            TRY ( new_data = NGS_StringMake ( ctx, base, row_len ) )
+            /* the string keeps the blob alive, so strings handed out earlier
+               remain valid; the cached one is reused once its caller let go */
+            TRY ( NGS_StringRecycleBlob ( & self -> col_data [ colIdx ], ctx, blob, base, row_len ) )
             {
-                NGS_StringRelease ( self -> col_data [ colIdx ], ctx );
-                self -> col_data [ colIdx ] = new_data;
                 return NGS_StringDuplicate ( self -> col_data [ colIdx ], ctx );
             }
         }
@@ -79,6 +79,22 @@ void NGS_CursorCellDataDirect ( const NGS_Cursor *self,
                                 uint32_t *boff, 
                                 uint32_t *row_len );
 
+/* CellDataBatch
+ * Adds requested column if necessary and calls VCursorCellDataBatch:
+ * fills up to "count" cells starting at firstRowId, stopping at the end
+ * of the blob; "num_rows" receives the number of cells filled
+*/
+void NGS_CursorCellDataBatch ( const NGS_Cursor *self, 
+                               ctx_t ctx,
+                               int64_t firstRowId,
+                               uint32_t colIdx, 
+                               uint32_t count,
+                               uint32_t *elem_bits, 
+                               const void **base,
+                               uint32_t *boff, 
+                               uint32_t *row_len,
+                               uint32_t *num_rows );
+
 /* GetString
 */                                
 struct NGS_String * NGS_CursorGetString ( const NGS_Cursor * self, ctx_t ctx, int64_t rowId, uint32_t colIdx );
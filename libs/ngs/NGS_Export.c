@@ -0,0 +1,265 @@
+/*===========================================================================
+*
+*                            PUBLIC DOMAIN NOTICE
+*               National Center for Biotechnology Information
+*
+*  This software/database is a "United States Government Work" under the
+*  terms of the United States Copyright Act.  It was written as part of
+*  the author's official duties as a United States Government employee and
+*  thus cannot be copyrighted.  This software/database is freely available
+*  to the public for use. The National Library of Medicine and the U.S.
+*  Government have not placed any restriction on its use or reproduction.
+*
+*  Although all reasonable efforts have been taken to ensure the accuracy
+*  and reliability of the software and data, the NLM and the U.S.
+*  Government do not and cannot warrant the performance or results that
+*  may be obtained by using this software or data. The NLM and the U.S.
+*  Government disclaim all warranties, express or implied, including
+*  warranties of performance, merchantability or fitness for any particular
+*  purpose.
+*
+*  Please cite the author in any work or product based on this material.
+*
+* ===========================================================================
+*
+*/
+
+#include "NGS_Export.h"
+
+#include "NGS_Read.h"
+#include "NGS_Alignment.h"
+#include "NGS_String.h"
+
+#include <kfc/ctx.h>
+#include <kfc/rsrc.h>
+#include <kfc/except.h>
+#include <kfc/xc.h>
+
+#include <string.h>
+#include <assert.h>
+
+/*--------------------------------------------------------------------------
+ * NGS_ExportBuffer
+ */
+
+typedef struct NGS_ExportGetters NGS_ExportGetters;
+struct NGS_ExportGetters
+{
+    NGS_String * ( * get_bases )     ( void * self, ctx_t ctx );
+    NGS_String * ( * get_qualities ) ( void * self, ctx_t ctx );
+    NGS_String * ( * get_id )        ( void * self, ctx_t ctx );
+    bool         ( * next )          ( void * self, ctx_t ctx );
+};
+
+/* the buffers are indexed by 32-bit offsets */
+static
+size_t NGS_ExportCapacity ( size_t capacity )
+{
+    return capacity > UINT32_MAX ? UINT32_MAX : capacity;
+}
+
+/* Append
+ *  copy the current record into the buffer
+ *  returns false if it does not fit
+ */
+static
+bool NGS_ExportAppend ( void * self, ctx_t ctx, const NGS_ExportGetters * get, NGS_ExportBuffer * buf, uint32_t idx )
+{
+    FUNC_ENTRY ( ctx, rcSRA, rcBuffer, rcWriting );
+
+    bool ret = false;
+    NGS_String * quals = NULL;
+    NGS_String * id = NULL;
+
+    TRY ( NGS_String * bases = get -> get_bases ( self, ctx ) )
+    {
+        if ( buf -> qualities != NULL )
+            quals = get -> get_qualities ( self, ctx );
+        if ( ! FAILED () && buf -> ids != NULL )
+            id = get -> get_id ( self, ctx );
+
+        if ( ! FAILED () )
+        {
+            size_t data_start = buf -> data_offsets [ idx ];
+            size_t size = NGS_StringSize ( bases, ctx );
+            size_t id_start = 0;
+            size_t id_size = 0;
+
+            if ( id != NULL )
+            {
+                id_start = buf -> id_offsets [ idx ];
+                id_size = NGS_StringSize ( id, ctx );
+            }
+
+            if ( quals != NULL && NGS_StringSize ( quals, ctx ) != size )
+            {
+                INTERNAL_ERROR ( xcUnexpected, "sequence and qualities differ in length: %zu, %zu",
+                                 size, NGS_StringSize ( quals, ctx ) );
+            }
+            else if ( data_start + size <= NGS_ExportCapacity ( buf -> data_capacity ) &&
+                      id_start + id_size <= NGS_ExportCapacity ( buf -> ids_capacity ) )
+            {
+                memmove ( & buf -> bases [ data_start ], NGS_StringData ( bases, ctx ), size );
+                if ( quals != NULL )
+                    memmove ( & buf -> qualities [ data_start ], NGS_StringData ( quals, ctx ), size );
+                buf -> data_offsets [ idx + 1 ] = ( uint32_t ) ( data_start + size );
+
+                if ( id != NULL )
+                {
+                    memmove ( & buf -> ids [ id_start ], NGS_StringData ( id, ctx ), id_size );
+                    buf -> id_offsets [ idx + 1 ] = ( uint32_t ) ( id_start + id_size );
+                }
+
+                ret = true;
+            }
+            else if ( idx == 0 )
+            {
+                USER_ERROR ( xcBufferInsufficient, "record of %zu bases, %zu id bytes does not fit into an empty export buffer",
+                             size, id_size );
+            }
+        }
+
+        NGS_StringRelease ( id, ctx );
+        NGS_StringRelease ( quals, ctx );
+        NGS_StringRelease ( bases, ctx );
+    }
+
+    return ret;
+}
+
+static
+uint32_t NGS_ExportRecords ( void * self, ctx_t ctx, const NGS_ExportGetters * get, NGS_ExportBuffer * buf, bool * pending )
+{
+    FUNC_ENTRY ( ctx, rcSRA, rcBuffer, rcWriting );
+
+    uint32_t count = 0;
+
+    if ( self == NULL || buf == NULL || pending == NULL )
+    {
+        USER_ERROR ( xcParamNull, "bad input" );
+        return 0;
+    }
+    if ( buf -> bases == NULL || buf -> data_offsets == NULL || 
+         ( buf -> ids != NULL && buf -> id_offsets == NULL ) )
+    {
+        USER_ERROR ( xcParamNull, "export buffer is missing storage" );
+        return 0;
+    }
+    if ( buf -> max_records == 0 )
+    {
+        USER_ERROR ( xcParamOutOfBounds, "export buffer has no room for records" );
+        return 0;
+    }
+
+    buf -> num_records = 0;
+    buf -> data_offsets [ 0 ] = 0;
+    if ( buf -> ids != NULL )
+        buf -> id_offsets [ 0 ] = 0;
+
+    if ( ! * pending )
+    {
+        ON_FAIL ( * pending = get -> next ( self, ctx ) )
+            return 0;
+    }
+
+    while ( * pending && count < buf -> max_records )
+    {
+        /* a record that does not fit stays pending for the next call */
+        ON_FAIL ( bool appended = NGS_ExportAppend ( self, ctx, get, buf, count ) )
+            break;
+        if ( ! appended )
+            break;
+
+        ++ count;
+
+        ON_FAIL ( * pending = get -> next ( self, ctx ) )
+            break;
+    }
+
+    buf -> num_records = count;
+    return count;
+}
+
+/*--------------------------------------------------------------------------
+ * NGS_Read
+ */
+
+static
+NGS_String * NGS_ExportReadBases ( void * self, ctx_t ctx )
+{
+    return NGS_ReadGetReadSequence ( self, ctx, 0, ( uint64_t ) -1 );
+}
+
+static
+NGS_String * NGS_ExportReadQualities ( void * self, ctx_t ctx )
+{
+    return NGS_ReadGetReadQualities ( self, ctx, 0, ( uint64_t ) -1 );
+}
+
+static
+NGS_String * NGS_ExportReadId ( void * self, ctx_t ctx )
+{
+    return NGS_ReadGetReadId ( self, ctx );
+}
+
+static
+bool NGS_ExportReadNext ( void * self, ctx_t ctx )
+{
+    return NGS_ReadIteratorNext ( self, ctx );
+}
+
+static NGS_ExportGetters NGS_ExportRead_getters =
+{
+    NGS_ExportReadBases,
+    NGS_ExportReadQualities,
+    NGS_ExportReadId,
+    NGS_ExportReadNext
+};
+
+uint32_t NGS_ReadIteratorExport ( struct NGS_Read * self, ctx_t ctx, NGS_ExportBuffer * buf, bool * pending )
+{
+    FUNC_ENTRY ( ctx, rcSRA, rcRow, rcReading );
+    return NGS_ExportRecords ( self, ctx, & NGS_ExportRead_getters, buf, pending );
+}
+
+/*--------------------------------------------------------------------------
+ * NGS_Alignment
+ */
+
+static
+NGS_String * NGS_ExportAlignmentBases ( void * self, ctx_t ctx )
+{
+    return NGS_AlignmentGetClippedFragmentBases ( self, ctx );
+}
+
+static
+NGS_String * NGS_ExportAlignmentQualities ( void * self, ctx_t ctx )
+{
+    return NGS_AlignmentGetClippedFragmentQualities ( self, ctx );
+}
+
+static
+NGS_String * NGS_ExportAlignmentId ( void * self, ctx_t ctx )
+{
+    return NGS_AlignmentGetAlignmentId ( self, ctx );
+}
+
+static
+bool NGS_ExportAlignmentNext ( void * self, ctx_t ctx )
+{
+    return NGS_AlignmentIteratorNext ( self, ctx );
+}
+
+static NGS_ExportGetters NGS_ExportAlignment_getters =
+{
+    NGS_ExportAlignmentBases,
+    NGS_ExportAlignmentQualities,
+    NGS_ExportAlignmentId,
+    NGS_ExportAlignmentNext
+};
+
+uint32_t NGS_AlignmentIteratorExport ( struct NGS_Alignment * self, ctx_t ctx, NGS_ExportBuffer * buf, bool * pending )
+{
+    FUNC_ENTRY ( ctx, rcSRA, rcRow, rcReading );
+    return NGS_ExportRecords ( self, ctx, & NGS_ExportAlignment_getters, buf, pending );
+}
@@ -0,0 +1,104 @@
+/*===========================================================================
+*
+*                            PUBLIC DOMAIN NOTICE
+*               National Center for Biotechnology Information
+*
+*  This software/database is a "United States Government Work" under the
+*  terms of the United States Copyright Act.  It was written as part of
+*  the author's official duties as a United States Government employee and
+*  thus cannot be copyrighted.  This software/database is freely available
+*  to the public for use. The National Library of Medicine and the U.S.
+*  Government have not placed any restriction on its use or reproduction.
+*
+*  Although all reasonable efforts have been taken to ensure the accuracy
+*  and reliability of the software and data, the NLM and the U.S.
+*  Government do not and cannot warrant the performance or results that
+*  may be obtained by using this software or data. The NLM and the U.S.
+*  Government disclaim all warranties, express or implied, including
+*  warranties of performance, merchantability or fitness for any particular
+*  purpose.
+*
+*  Please cite the author in any work or product based on this material.
+*
+* ===========================================================================
+*
+*/
+
+#ifndef _h_ngs_export_
+#define _h_ngs_export_
+
+#ifndef _h_kfc_defs_
+#include <kfc/defs.h>
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*--------------------------------------------------------------------------
+ * forwards
+ */
+struct NGS_Read;
+struct NGS_Alignment;
+
+/*--------------------------------------------------------------------------
+ * NGS_ExportBuffer
+ *  caller-provided flat storage for a batch of records, so that language
+ *  bindings can retrieve many records with a single call
+ *
+ *  record i occupies bases [ data_offsets [ i ] .. data_offsets [ i + 1 ] ),
+ *  with qualities at the same offsets, and its id occupies
+ *  ids [ id_offsets [ i ] .. id_offsets [ i + 1 ] ). nothing is NUL-terminated.
+ *
+ *  "qualities" and "ids" may be NULL when not wanted; their offsets are
+ *  then not written either and the data is never fetched.
+ */
+typedef struct NGS_ExportBuffer NGS_ExportBuffer;
+struct NGS_ExportBuffer
+{
+    /* bases and qualities, both of data_capacity bytes */
+    char * bases;
+    char * qualities;
+    uint32_t * data_offsets;    /* [ max_records + 1 ] */
+
+    /* record ids */
+    char * ids;
+    uint32_t * id_offsets;      /* [ max_records + 1 ] */
+
+    size_t data_capacity;
+    size_t ids_capacity;
+    uint32_t max_records;
+
+    /* output: number of records written */
+    uint32_t num_records;
+};
+
+
+/* ExportReads
+ *  fill "buf" with the sequences, qualities and ids of successive reads
+ *
+ *  "pending" [ IN/OUT ] - true if the iterator is already positioned on a
+ *  read that has not been exported yet. pass false on the first call, and
+ *  the value returned by the previous call afterwards. on return it is
+ *  true if the iterator is positioned on a read that did not fit into "buf",
+ *  false when the iterator is exhausted.
+ *
+ *  returns the number of records written, also stored in buf -> num_records.
+ *  a single read that is too large for an empty buffer is an error.
+ */
+uint32_t NGS_ReadIteratorExport ( struct NGS_Read * self, ctx_t ctx,
+    NGS_ExportBuffer * buf, bool * pending );
+
+/* ExportAlignments
+ *  same as above for the clipped bases, clipped qualities and ids of
+ *  successive alignments
+ */
+uint32_t NGS_AlignmentIteratorExport ( struct NGS_Alignment * self, ctx_t ctx,
+    NGS_ExportBuffer * buf, bool * pending );
+
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _h_ngs_export_ */
@@ -472,6 +472,83 @@ struct NGS_Read * NGS_ReadCollectionGetReadRange ( NGS_ReadCollection * self, ct
     return NULL;
 }
 
+/* SHARDS
+ */
+static
+bool NGS_ReadCollectionShardRange ( ctx_t ctx, uint64_t total, uint32_t shard, uint32_t num_shards,
+    uint64_t * first, uint64_t * count )
+{
+    FUNC_ENTRY ( ctx, rcSRA, rcDatabase, rcAccessing );
+
+    if ( num_shards == 0 )
+        USER_ERROR ( xcParamOutOfBounds, "shard count is zero" );
+    else if ( shard >= num_shards )
+        USER_ERROR ( xcParamOutOfBounds, "shard %u of %u", shard, num_shards );
+    else
+    {
+        /* spread the remainder over the leading shards */
+        uint64_t size = total / num_shards;
+        uint64_t extra = total % num_shards;
+
+        * first = shard * size + ( shard < extra ? shard : extra );
+        * count = size + ( shard < extra ? 1 : 0 );
+        return true;
+    }
+
+    return false;
+}
+
+struct NGS_Alignment * NGS_ReadCollectionGetAlignmentShard ( NGS_ReadCollection * self, ctx_t ctx,
+    uint32_t shard, uint32_t num_shards, bool wants_primary, bool wants_secondary )
+{
+    FUNC_ENTRY ( ctx, rcSRA, rcDatabase, rcAccessing );
+
+    if ( self == NULL )
+        INTERNAL_ERROR ( xcSelfNull, "failed to get alignment shard %u of %u", shard, num_shards );
+    else
+    {
+        /* secondary alignment ids follow all of the primary ones */
+        uint64_t base = 1;
+        if ( ! wants_primary )
+        {
+            ON_FAIL ( base += NGS_ReadCollectionGetAlignmentCount ( self, ctx, true, false ) )
+                return NULL;
+        }
+
+        {
+            TRY ( uint64_t total = NGS_ReadCollectionGetAlignmentCount ( self, ctx, wants_primary, wants_secondary ) )
+            {
+                uint64_t first, count;
+                if ( NGS_ReadCollectionShardRange ( ctx, total, shard, num_shards, & first, & count ) )
+                    return NGS_ReadCollectionGetAlignmentRange ( self, ctx, base + first, count, wants_primary, wants_secondary );
+            }
+        }
+    }
+
+    return NULL;
+}
+
+struct NGS_Read * NGS_ReadCollectionGetReadShard ( NGS_ReadCollection * self, ctx_t ctx,
+    uint32_t shard, uint32_t num_shards, bool wants_full, bool wants_partial, bool wants_unaligned )
+{
+    FUNC_ENTRY ( ctx, rcSRA, rcDatabase, rcAccessing );
+
+    if ( self == NULL )
+        INTERNAL_ERROR ( xcSelfNull, "failed to get read shard %u of %u", shard, num_shards );
+    else
+    {
+        /* shard by row, leaving category filtering to the range iterator */
+        TRY ( uint64_t total = NGS_ReadCollectionGetReadCount ( self, ctx, true, true, true ) )
+        {
+            uint64_t first, count;
+            if ( NGS_ReadCollectionShardRange ( ctx, total, shard, num_shards, & first, & count ) )
+                return NGS_ReadCollectionGetReadRange ( self, ctx, 1 + first, count, wants_full, wants_partial, wants_unaligned );
+        }
+    }
+
+    return NULL;
+}
+
 struct NGS_Statistics* NGS_ReadCollectionGetStatistics ( NGS_ReadCollection * self, ctx_t ctx )
 {
     if ( self == NULL )
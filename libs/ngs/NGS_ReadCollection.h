@@ -136,6 +136,28 @@ struct NGS_Read * NGS_ReadCollectionGetReadRange ( NGS_ReadCollection * self,
                                                    bool wants_partial, 
                                                    bool wants_unaligned );
 
+/* SHARDS
+ *  split the rows of a collection into "num_shards" contiguous ranges
+ *  of balanced size and return an iterator over range number "shard",
+ *  where 0 <= shard < num_shards
+ *
+ *  each shard reads through cursors of its own upon the database
+ *  already opened by the collection. create all shards on one thread;
+ *  after that, each may be handed to a separate thread.
+ *
+ *  decoded blobs are NOT shared between shards: the blob cache belongs
+ *  to a cursor and is not locked, and shards read disjoint row ranges,
+ *  so they would only ever meet on the blob at a shard boundary
+ *
+ *  for alignments, primary rows are stored in reference order, so
+ *  primary shards are also ranges of reference and position
+ */
+struct NGS_Alignment * NGS_ReadCollectionGetAlignmentShard ( NGS_ReadCollection * self, ctx_t ctx,
+    uint32_t shard, uint32_t num_shards, bool wants_primary, bool wants_secondary );
+
+struct NGS_Read * NGS_ReadCollectionGetReadShard ( NGS_ReadCollection * self, ctx_t ctx,
+    uint32_t shard, uint32_t num_shards, bool wants_full, bool wants_partial, bool wants_unaligned );
+
 /* STATISTICS
  */                                                   
 struct NGS_Statistics* NGS_ReadCollectionGetStatistics ( NGS_ReadCollection * self, ctx_t ctx );
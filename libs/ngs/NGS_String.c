@@ -32,6 +32,7 @@
 #include <klib/refcount.h>
 #include <klib/printf.h>
 #include <klib/text.h>
+#include <vdb/blob.h>
 
 #include "NGS_ErrBlock.h"
 #include <ngs/itf/Refcount.h>
@@ -57,6 +58,12 @@ struct NGS_String
     char * owned;
     const char * str;
     size_t size;
+
+    /* allocated size of "owned" when it may be recycled, or 0 */
+    size_t capacity;
+
+    /* blob holding "str", when created over cursor memory */
+    const VBlob * blob;
 };
 
 
@@ -69,6 +76,8 @@ void NGS_StringWhack ( NGS_String * self, ctx_t ctx )
         NGS_StringRelease ( self -> orig, ctx );
     if ( self -> owned != NULL )
         free ( self -> owned );
+    if ( self -> blob != NULL )
+        VBlobRelease ( self -> blob );
 }
 
 
@@ -104,6 +113,7 @@ void NGS_StringInvalidate ( NGS_String * self, ctx_t ctx )
     if ( self != NULL )
     {
         NGS_String * orig = self -> orig;
+        const VBlob * blob = self -> blob;
         self -> size = 0;
         self -> str = "";
         if ( orig != NULL )
@@ -111,6 +121,11 @@ void NGS_StringInvalidate ( NGS_String * self, ctx_t ctx )
             self -> orig = NULL;
             NGS_StringRelease ( orig, ctx );
         }
+        if ( blob != NULL )
+        {
+            self -> blob = NULL;
+            VBlobRelease ( blob );
+        }
     }
 }
 
@@ -373,6 +388,123 @@ NGS_String * NGS_StringMakeCopy ( ctx_t ctx, const char * temp_data, size_t size
     return NULL;
 }
 
+NGS_String * NGS_StringMakeBlob ( ctx_t ctx, const VBlob * blob, const char * data, size_t size )
+{
+    FUNC_ENTRY ( ctx, rcSRA, rcString, rcConstructing );
+
+    if ( blob == NULL )
+        USER_ERROR ( xcParamNull, "bad input" );
+    else
+    {
+        TRY ( NGS_String * ref = NGS_StringMake ( ctx, data, size ) )
+        {
+            rc_t rc = VBlobAddRef ( blob );
+            if ( rc == 0 )
+            {
+                ref -> blob = blob;
+                return ref;
+            }
+
+            INTERNAL_ERROR ( xcRefcountOutOfBounds, "VBlob at %#p", blob );
+            NGS_StringRelease ( ref, ctx );
+        }
+    }
+
+    return NULL;
+}
+
+/* Shared
+ *  true if anybody besides the holder of "self" has a reference
+ */
+static
+bool NGS_StringShared ( const NGS_String * self )
+{
+    return atomic32_read ( & self -> dad . refcount ) != 1;
+}
+
+/* RecycleBlob
+ */
+void NGS_StringRecycleBlob ( NGS_String ** cached, ctx_t ctx, const VBlob * blob, const char * data, size_t size )
+{
+    FUNC_ENTRY ( ctx, rcSRA, rcString, rcConstructing );
+
+    NGS_String * self;
+
+    assert ( cached != NULL );
+    self = * cached;
+
+    if ( self != NULL && ! NGS_StringShared ( self ) && self -> orig == NULL && self -> owned == NULL )
+    {
+        /* retarget in place: nobody else can observe the change */
+        if ( self -> blob != blob )
+        {
+            rc_t rc = VBlobAddRef ( blob );
+            if ( rc != 0 )
+            {
+                INTERNAL_ERROR ( xcRefcountOutOfBounds, "VBlob at %#p", blob );
+                return;
+            }
+            if ( self -> blob != NULL )
+                VBlobRelease ( self -> blob );
+            self -> blob = blob;
+        }
+
+        self -> str = data;
+        self -> size = size;
+    }
+    else
+    {
+        TRY ( NGS_String * ref = NGS_StringMakeBlob ( ctx, blob, data, size ) )
+        {
+            NGS_StringRelease ( self, ctx );
+            * cached = ref;
+        }
+    }
+}
+
+/* Recycle
+ */
+char * NGS_StringRecycle ( NGS_String ** cached, ctx_t ctx, size_t size )
+{
+    FUNC_ENTRY ( ctx, rcSRA, rcString, rcConstructing );
+
+    NGS_String * self;
+
+    assert ( cached != NULL );
+    self = * cached;
+
+    if ( self != NULL && ! NGS_StringShared ( self ) && self -> capacity > size )
+    {
+        self -> size = size;
+        self -> owned [ size ] = 0;
+        return self -> owned;
+    }
+    else
+    {
+        /* round up, so that slightly longer rows do not reallocate */
+        size_t capacity = ( size + 1 + 255 ) & ~ ( size_t ) 255;
+        char * owned_data = malloc ( capacity );
+        if ( owned_data == NULL )
+            SYSTEM_ERROR ( xcNoMemory, "allocating %zu bytes", capacity );
+        else
+        {
+            TRY ( NGS_String * ref = NGS_StringMakeOwned ( ctx, owned_data, size ) )
+            {
+                ref -> capacity = capacity;
+                owned_data [ size ] = 0;
+
+                NGS_StringRelease ( self, ctx );
+                * cached = ref;
+                return owned_data;
+            }
+
+            free ( owned_data );
+        }
+    }
+
+    return NULL;
+}
+
 NGS_String * NGS_StringFromI64 ( ctx_t ctx, int64_t i )
 {
     size_t size;
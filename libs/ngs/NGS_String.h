@@ -41,6 +41,11 @@ typedef struct NGS_String NGS_String;
 extern "C" {
 #endif
 
+/*--------------------------------------------------------------------------
+ * forwards
+ */
+struct VBlob;
+
 /*--------------------------------------------------------------------------
  * NGS_String
  *  a reference into NGS string data
@@ -54,6 +59,29 @@ NGS_String * NGS_StringMake ( ctx_t ctx, const char * data, size_t size );
 NGS_String * NGS_StringMakeOwned ( ctx_t ctx, char * owned_data, size_t size );
 NGS_String * NGS_StringMakeCopy ( ctx_t ctx, const char * temp_data, size_t size );
 
+/* MakeBlob
+ *  make a string over "size" bytes at "data" within "blob"
+ *  the string holds a reference to the blob, so it remains valid
+ *  after the cursor that produced it has moved on
+ */
+NGS_String * NGS_StringMakeBlob ( ctx_t ctx, struct VBlob const * blob, const char * data, size_t size );
+
+/* RecycleBlob
+ *  point "* cached" at "size" bytes at "data" within "blob"
+ *  the existing object is retargeted when nobody else holds it,
+ *  and replaced by a new one otherwise
+ */
+void NGS_StringRecycleBlob ( NGS_String ** cached, ctx_t ctx,
+    struct VBlob const * blob, const char * data, size_t size );
+
+/* Recycle
+ *  make "* cached" a string of "size" bytes to be filled in by caller,
+ *  for data derived from cursor cells such as converted qualities
+ *  the existing allocation is reused when nobody else holds it
+ *  returns a writable pointer to the NUL-terminated string data
+ */
+char * NGS_StringRecycle ( NGS_String ** cached, ctx_t ctx, size_t size );
+
 /* TEMPORARY */
 NGS_String * NGS_StringFromI64 ( ctx_t ctx, int64_t i );
 
@@ -89,6 +89,9 @@ struct SRA_Read
     bool wants_unaligned;
     
     NGS_String* group_name; /* if not NULL, only return reads from this read group */
+
+    /* reused for qualities converted to ascii-33 */
+    NGS_String* qual_buffer;
 };
 
 const char * sequence_col_specs [] =
@@ -208,6 +211,7 @@ void SRA_ReadWhack ( SRA_Read * self, ctx_t ctx )
 {
     NGS_CursorRelease ( self -> curs, ctx );
     
+    NGS_StringRelease ( self -> qual_buffer, ctx );
     NGS_StringRelease ( self -> group_name, ctx );
     NGS_StringRelease ( self -> run_name, ctx );
 }
@@ -468,51 +472,33 @@ NGS_String * GetReadQualities ( SRA_Read * self, ctx_t ctx )
         uint32_t elem_bits, boff, row_len;
         if ( self -> has_phred_33 )
         {
-            ON_FAIL ( NGS_CursorCellDataDirect ( self -> curs, ctx, self -> cur_row, seq_QUALITY_ASCII, & elem_bits, & base, & boff, & row_len ) )
+            /* references cursor memory directly */
+            ON_FAIL ( NGS_String * ascii = NGS_CursorGetString ( self -> curs, ctx, self -> cur_row, seq_QUALITY_ASCII ) )
             {   /* apparently no ascii qualities present, switch to raw */
                 self -> has_phred_33 = false;
             }
-        }
-        if ( !self -> has_phred_33 )
-        {
-            ON_FAIL ( NGS_CursorCellDataDirect ( self -> curs, ctx, self -> cur_row, seq_QUALITY, & elem_bits, & base, & boff, & row_len ) )
-                return NULL;
-        }
-            
-        {
-            NGS_String * new_data = NULL;
-
-            assert ( elem_bits == 8 );
-            assert ( boff == 0 );
-
-            /* convert to ascii-33 if needed */
-            if ( ! self -> has_phred_33 )
-            {
-                char * copy = malloc ( row_len + 1 );
-                if ( copy == NULL )
-                    SYSTEM_ERROR ( xcNoMemory, "allocating %u bytes for QUALITY row %ld", row_len + 1, self -> cur_row );
-                else
-                {
-                    uint32_t i;
-                    const uint8_t * orig = base;
-                    for ( i = 0; i < row_len; ++ i )
-                        copy [ i ] = ( char ) ( orig [ i ] + 33 );
-                    copy [ i ] = 0;
-
-                    new_data = NGS_StringMakeOwned ( ctx, copy, row_len );
-                    if ( FAILED () )
-                        free ( copy );
-                }
-            }
             else
             {
-                /* create new string */
-                new_data = NGS_StringMake ( ctx, base, row_len );
+                return ascii;
             }
-            
-            if ( ! FAILED () )
+        }
+
+        ON_FAIL ( NGS_CursorCellDataDirect ( self -> curs, ctx, self -> cur_row, seq_QUALITY, & elem_bits, & base, & boff, & row_len ) )
+            return NULL;
+
+        assert ( elem_bits == 8 );
+        assert ( boff == 0 );
+
+        /* convert to ascii-33 into a buffer reused from row to row */
+        {
+            TRY ( char * copy = NGS_StringRecycle ( & self -> qual_buffer, ctx, row_len ) )
             {
-                return new_data;
+                uint32_t i;
+                const uint8_t * orig = base;
+                for ( i = 0; i < row_len; ++ i )
+                    copy [ i ] = ( char ) ( orig [ i ] + 33 );
+
+                return NGS_StringDuplicate ( self -> qual_buffer, ctx );
             }
         }
     }
@@ -41,7 +41,9 @@
 
 #include <vdb/manager.h>
 #include <kdb/column.h>
+#include <klib/symbol.h>
 #include <klib/log.h>
+#include <klib/prof.h>
 #include <klib/rc.h>
 #include <sysalloc.h>
 
@@ -175,6 +177,9 @@ rc_t VColumnInit ( VColumn *self, const VSchema *schema, const SColumn *scol )
         self -> scol = scol;
         self -> td = scol -> td;
         self -> read_only = scol -> read_only;
+#if KPROF
+        self -> prof_id = KProfRegister ( KPROF_COLUMN, scol -> name -> name . addr );
+#endif
     }
     return rc;
 }
@@ -235,7 +240,10 @@ rc_t VColumnReadBlob ( const VColumn *cself, const VBlob **vblobp, int64_t row_i
     else
     {
         VBlob *vblob;
+        KPROF_TIMER ( read );
+
         rc = VProductionReadBlob ( cself -> in, & vblob, row_id, 1, cctx );
+        KPROF_TIMER_STOP ( cself -> prof_id, read );
         if ( rc == 0 )
         {
             VColumn *self = ( VColumn* ) cself;
@@ -275,7 +283,10 @@ rc_t VColumnRead ( const VColumn *cself, int64_t row_id,
         rc = RC ( rcVDB, rcColumn, rcReading, rcColumn, rcNotOpen );
     else
     {
+        KPROF_TIMER ( read );
+
         rc = VProductionReadBlob ( cself -> in, vblob, row_id, 1, NULL );
+        KPROF_TIMER_STOP ( cself -> prof_id, read );
         if ( rc == 0 )
         {
             VColumn *self = ( VColumn* ) cself;
@@ -93,6 +93,9 @@ struct VColumn
     /* vector ids */
     uint32_t ord;
 
+    /* instrumentation counter ( see <klib/prof.h> ) */
+    uint32_t prof_id;
+
     bool read_only;
     uint8_t align [ 3 ];
 };
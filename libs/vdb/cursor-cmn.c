@@ -421,11 +421,42 @@ rc_t VCursorSupplementName ( const KSymTable *tbl,
     return rc;
 }
 
+static
+rc_t VCursorListPhysical ( const VCursor *self, KNamelist **names )
+{
+    rc_t rc;
+    KNamelist *prior;
+    VTable *tbl = ( VTable* ) self -> tbl;
+
+    /* the columns of a read-only table do not change,
+       so the listing is taken once and shared by all cursors */
+    if ( ! tbl -> read_only )
+        return KTableListCol ( tbl -> ktbl, names );
+
+    * names = tbl -> phys_col_names . ptr;
+    if ( * names == NULL )
+    {
+        rc = KTableListCol ( tbl -> ktbl, names );
+        if ( rc != 0 )
+            return rc;
+
+        prior = atomic_test_and_set_ptr ( & tbl -> phys_col_names, * names, NULL );
+        if ( prior != NULL )
+        {
+            /* lost the race - use the winner's list */
+            KNamelistRelease ( * names );
+            * names = prior;
+        }
+    }
+
+    return KNamelistAddRef ( * names );
+}
+
 static
 rc_t VCursorSupplementPhysical ( const KSymTable *tbl, const VCursor *self )
 {
     KNamelist *names;
-    rc_t rc = KTableListCol ( self -> tbl -> ktbl, & names );
+    rc_t rc = VCursorListPhysical ( self, & names );
     if ( rc == 0 )
     {
         uint32_t i, count;
@@ -651,6 +682,33 @@ LIB_EXPORT rc_t CC VCursorSuspendTriggers ( const VCursor *cself )
     return rc;
 }
 
+/* PermitLazyOpen
+ *  defers column resolution until first read
+ */
+LIB_EXPORT rc_t CC VCursorPermitLazyOpen ( const VCursor *cself )
+{
+    rc_t rc;
+    VCursor *self = ( VCursor* ) cself;
+
+    if ( self == NULL )
+        rc = RC ( rcVDB, rcCursor, rcUpdating, rcSelf, rcNull );
+    else if ( ! self -> read_only )
+        rc = RC ( rcVDB, rcCursor, rcUpdating, rcCursor, rcWriteonly );
+    else if ( self -> state == vcFailed )
+        rc = RC ( rcVDB, rcCursor, rcUpdating, rcCursor, rcInvalid );
+    else if ( self -> state != vcConstruct )
+        rc = RC ( rcVDB, rcCursor, rcUpdating, rcCursor, rcOpen );
+    else
+    {
+        self -> lazy_open = true;
+        if ( self -> cache_curs != NULL )
+            VCursorPermitLazyOpen ( self -> cache_curs );
+        rc = 0;
+    }
+
+    return rc;
+}
+
 
 /* AddSColumn
  */
@@ -989,6 +1047,23 @@ LIB_EXPORT rc_t CC VCursorGetColumnIdx ( const VCursor *self, uint32_t *idx, con
 }
 
 
+/* ResolveLazy
+ *  resolve a single column of a lazily opened cursor upon first use
+ */
+static rc_t VCursorOpenColumn ( const VCursor *cself, VColumn *col );
+
+static
+rc_t VCursorResolveLazy ( const VCursor *self, const VColumn *col )
+{
+    if ( ! self -> lazy_open || self -> state < vcReady )
+        return 0;
+    if ( col -> in == FAILED_PRODUCTION )
+        return RC ( rcVDB, rcCursor, rcOpening, rcColumn, rcUndefined );
+    if ( col -> in != NULL )
+        return 0;
+    return VCursorOpenColumn ( self, ( VColumn* ) col );
+}
+
 /* Datatype
  *  returns typedecl and/or typedef for column data
  *
@@ -1104,6 +1179,13 @@ LIB_EXPORT rc_t CC VCursorIdRange ( const VCursor *self, uint32_t idx,
         {
             VCursorIdRangeData pb;
 
+            rc = VCursorResolveLazyColumns ( self );
+            if ( rc != 0 )
+            {
+                * first = * count = 0;
+                return rc;
+            }
+
             pb . first = INT64_MAX;
             pb . last = INT64_MIN;
             pb . rc = RC ( rcVDB, rcCursor, rcAccessing, rcRange, rcEmpty );
@@ -1125,7 +1207,9 @@ LIB_EXPORT rc_t CC VCursorIdRange ( const VCursor *self, uint32_t idx,
             else {
                 int64_t last;
 
-                rc = VColumnIdRange ( vcol, first, &last );
+                rc = VCursorResolveLazy ( self, vcol );
+                if ( rc == 0 )
+                    rc = VColumnIdRange ( vcol, first, &last );
                 if (rc == 0)
                     *count = last + 1 - *first;
                 return rc;
@@ -1161,7 +1245,11 @@ LIB_EXPORT rc_t CC VCursorPageIdRange ( struct VCursor const *self,
             if ( vcol == NULL )
                 rc = RC ( rcVDB, rcCursor, rcAccessing, rcColumn, rcNotFound );
             else
-                return VColumnPageIdRange ( vcol, id, first, last );
+            {
+                rc = VCursorResolveLazy ( self, vcol );
+                if ( rc == 0 )
+                    return VColumnPageIdRange ( vcol, id, first, last );
+            }
         }
 
         * first = * last = 0;
@@ -1284,9 +1372,38 @@ rc_t VCursorOpenColumn ( const VCursor *cself, VColumn *col )
  */
 rc_t VCursorPostOpenAddRead ( VCursor *self, VColumn *col )
 {
+    /* a lazy cursor picks the column up on first read */
+    if ( self -> lazy_open )
+        return 0;
     return VCursorOpenColumn ( self, col );
 }
 
+/* ResolveLazyColumns
+ *  resolve every column still pending on a lazily opened cursor
+ */
+rc_t VCursorResolveLazyColumns ( const VCursor *self )
+{
+    uint32_t idx, end;
+
+    if ( ! self -> lazy_open || self -> state < vcReady )
+        return 0;
+
+    idx = VectorStart ( & self -> row );
+    end = idx + VectorLength ( & self -> row );
+    for ( ; idx < end; ++ idx )
+    {
+        const VColumn *col = ( const VColumn* ) VectorGet ( & self -> row, idx );
+        if ( col != NULL )
+        {
+            rc_t rc = VCursorResolveLazy ( self, col );
+            if ( rc != 0 )
+                return rc;
+        }
+    }
+
+    return 0;
+}
+
 
 static
 rc_t VCursorResolveColumnProductions ( VCursor *self,
@@ -1328,7 +1445,9 @@ rc_t VCursorOpenRead ( VCursor *self, const KDlset *libs )
         rc = RC ( rcVDB, rcCursor, rcOpening, rcCursor, rcInvalid );
     else
     {
-        rc = VCursorResolveColumnProductions ( self, libs, false );
+        /* a lazy cursor resolves each column upon first use */
+        rc = self -> lazy_open ? 0 :
+            VCursorResolveColumnProductions ( self, libs, false );
         if ( rc == 0 )
         {
             self -> row_id = self -> start_id = self -> end_id = 1;
@@ -1460,6 +1579,10 @@ rc_t VCursorReadColumnDirectInt ( const VCursor *cself, int64_t row_id, uint32_t
     if ( col == NULL )
         return RC ( rcVDB, rcCursor, rcReading, rcColumn, rcInvalid );
 
+    rc = VCursorResolveLazy ( cself, col );
+    if ( rc != 0 )
+        return rc;
+
     /* 2.0 behavior if not caching */
     if ( cself -> blob_mru_cache == NULL )
         return VColumnRead ( col, row_id, elem_bits, base, boff, row_len, (VBlob**) rslt );
@@ -2076,6 +2199,239 @@ LIB_EXPORT rc_t CC VCursorCellDataDirect ( const VCursor *self, int64_t row_id,
     return rc;
 }
 
+
+/* CellDataBatch
+ *  access pointers to the cells of consecutive rows of one column
+ *
+ *  the blob holding "first_row" is located once and its page map is
+ *  walked sequentially, rather than looking up blob and row per cell
+ */
+static
+rc_t VCursorReadBlobDirect ( const VCursor *self, int64_t row_id, uint32_t col_idx,
+    uint32_t *elem_bits, const void **base, uint32_t *boff, uint32_t *row_len,
+    const VBlob **blob )
+{
+    if ( ! self -> read_only )
+        return RC ( rcVDB, rcCursor, rcReading, rcCursor, rcWriteonly );
+
+    switch ( self -> state )
+    {
+    case vcConstruct:
+        return RC ( rcVDB, rcCursor, rcReading, rcCursor, rcNotOpen );
+    case vcReady:
+    case vcRowOpen:
+        break;
+    default:
+        return RC ( rcVDB, rcCursor, rcReading, rcCursor, rcInvalid );
+    }
+
+    /* cells of cache-cursor columns may come from either cursor,
+       so they can only be handed out one at a time */
+    * blob = NULL;
+    if ( self -> cache_curs != NULL && VectorGet ( & self -> v_cache_curs, col_idx ) != NULL )
+        return VCursorReadColumnDirect ( self, row_id, col_idx, elem_bits, base, boff, row_len );
+
+    /* a blob read on an MRU miss comes back as a new reference, while
+       one found in the MRU cache or kept by the column is only lent.
+       take a reference to the latter so the caller always owns "blob" */
+    {
+        rc_t rc;
+        bool owned = false;
+
+        if ( self -> blob_mru_cache != NULL )
+            owned = VBlobMRUCacheFind ( self -> blob_mru_cache, col_idx, row_id ) == NULL;
+
+        rc = VCursorReadColumnDirectInt ( self, row_id, col_idx,
+            elem_bits, base, boff, row_len, NULL, blob );
+        if ( rc == 0 && * blob != NULL && ! owned )
+        {
+            rc = VBlobAddRef ( ( VBlob* ) * blob );
+            if ( rc != 0 )
+                * blob = NULL;
+        }
+        return rc;
+    }
+}
+
+/* whether the rows of a page map are stored back to back
+   in row order, all with the same length */
+static
+bool VCursorBlobIsContiguous ( const VBlob *blob )
+{
+    return ! blob -> pm -> random_access && PageMapHasSimpleStructure ( blob -> pm ) != 0;
+}
+
+LIB_EXPORT rc_t CC VCursorCellDataBatch ( const VCursor *self, int64_t first_row,
+    uint32_t col_idx, uint32_t count, uint32_t *elem_bits, const void **base,
+    uint32_t *boff, uint32_t *row_len, uint32_t *num_rows )
+{
+    rc_t rc;
+
+    uint32_t dummy;
+    if ( elem_bits == NULL )
+        elem_bits = & dummy;
+
+    if ( num_rows == NULL )
+        return RC ( rcVDB, rcCursor, rcReading, rcParam, rcNull );
+
+    * num_rows = 0;
+    * elem_bits = 0;
+
+    if ( base == NULL || row_len == NULL )
+        rc = RC ( rcVDB, rcCursor, rcReading, rcParam, rcNull );
+    else if ( self == NULL )
+        rc = RC ( rcVDB, rcCursor, rcReading, rcSelf, rcNull );
+    else if ( count == 0 )
+        rc = 0;
+    else
+    {
+        const VBlob *blob;
+        uint32_t off;
+
+        rc = VCursorReadBlobDirect ( self, first_row, col_idx, elem_bits,
+            & base [ 0 ], & off, & row_len [ 0 ], & blob );
+        if ( rc == 0 )
+        {
+            uint64_t i, idx, n;
+            const uint8_t *data;
+
+            if ( boff != NULL )
+                boff [ 0 ] = off;
+            if ( blob == NULL || blob -> pm == NULL )
+            {
+                * num_rows = 1;
+                VBlobRelease ( ( VBlob* ) blob );
+                return 0;
+            }
+
+            idx = ( uint64_t ) ( first_row - blob -> start_id );
+            n = ( uint64_t ) ( blob -> stop_id - first_row ) + 1;
+            if ( n > count )
+                n = count;
+            data = blob -> data . base;
+
+            if ( VCursorBlobIsContiguous ( blob ) )
+            {
+                const uint64_t len = PageMapFixedRowLength ( blob -> pm );
+                const uint64_t step = len * * elem_bits;
+                uint64_t start = idx * step;
+
+                for ( i = 0; i < n; ++ i, start += step )
+                {
+                    base [ i ] = data + ( start >> 3 );
+                    if ( boff != NULL )
+                        boff [ i ] = ( uint32_t ) start & 7;
+                    row_len [ i ] = ( uint32_t ) len;
+                }
+            }
+            else
+            {
+                PageMapIterator iter;
+
+                if ( PageMapNewIterator ( blob -> pm, & iter, idx, n ) != 0 )
+                    /* the first cell is already in place */
+                    n = 1;
+                else
+                {
+                    for ( i = 0; i < n; ++ i )
+                    {
+                        const uint64_t start = ( uint64_t ) PageMapIteratorDataOffset ( & iter ) * * elem_bits;
+
+                        base [ i ] = data + ( start >> 3 );
+                        if ( boff != NULL )
+                            boff [ i ] = ( uint32_t ) start & 7;
+                        row_len [ i ] = PageMapIteratorDataLength ( & iter );
+                        if ( ! PageMapIteratorNext ( & iter ) )
+                        {
+                            ++ i;
+                            break;
+                        }
+                    }
+                    n = i;
+                }
+            }
+
+            /* the cells stay where they are after this: the column
+               keeps its last blob, just as for CellDataDirect */
+            VBlobRelease ( ( VBlob* ) blob );
+            * num_rows = ( uint32_t ) n;
+            return 0;
+        }
+
+        * elem_bits = 0;
+    }
+
+    return rc;
+}
+
+/* CellDataSpan
+ *  access a run of fixed-length cells stored back to back
+ */
+LIB_EXPORT rc_t CC VCursorCellDataSpan ( const VCursor *self, int64_t first_row,
+    uint32_t col_idx, uint32_t count, uint32_t *elem_bits, const void **base,
+    uint32_t *boff, uint32_t *row_len, uint32_t *num_rows )
+{
+    rc_t rc;
+
+    uint32_t dummy [ 2 ];
+    if ( elem_bits == NULL )
+        elem_bits = & dummy [ 0 ];
+    if ( boff == NULL )
+        boff = & dummy [ 1 ];
+
+    if ( num_rows == NULL )
+        return RC ( rcVDB, rcCursor, rcReading, rcParam, rcNull );
+
+    * num_rows = 0;
+
+    if ( base == NULL || row_len == NULL )
+        rc = RC ( rcVDB, rcCursor, rcReading, rcParam, rcNull );
+    else if ( self == NULL )
+        rc = RC ( rcVDB, rcCursor, rcReading, rcSelf, rcNull );
+    else if ( count == 0 )
+        rc = RC ( rcVDB, rcCursor, rcReading, rcParam, rcInvalid );
+    else
+    {
+        const VBlob *blob;
+
+        rc = VCursorReadBlobDirect ( self, first_row, col_idx,
+            elem_bits, base, boff, row_len, & blob );
+        if ( rc == 0 )
+        {
+            uint64_t n = 1;
+
+            /* a single cell is always a span */
+            if ( blob != NULL && blob -> pm != NULL && count > 1 && blob -> stop_id > first_row )
+            {
+                if ( ! VCursorBlobIsContiguous ( blob ) )
+                    rc = RC ( rcVDB, rcCursor, rcReading, rcData, rcUnsupported );
+                else
+                {
+                    n = ( uint64_t ) ( blob -> stop_id - first_row ) + 1;
+                    if ( n > count )
+                        n = count;
+                }
+            }
+
+            VBlobRelease ( ( VBlob* ) blob );
+            if ( rc == 0 )
+            {
+                * num_rows = ( uint32_t ) n;
+                return 0;
+            }
+        }
+
+        * base = NULL;
+    }
+
+    * elem_bits = 0;
+    * boff = 0;
+    if ( row_len != NULL )
+        * row_len = 0;
+
+    return rc;
+}
+
 LIB_EXPORT rc_t CC VCursorDataPrefetch ( const VCursor *cself, const int64_t *row_ids, uint32_t col_idx, uint32_t num_rows,int64_t min_valid_row_id, int64_t max_valid_row_id, bool continue_on_error)
 {
 	rc_t rc=0;
@@ -2083,6 +2439,10 @@ LIB_EXPORT rc_t CC VCursorDataPrefetch ( const VCursor *cself, const int64_t *ro
 	if ( col == NULL )
 		return RC ( rcVDB, rcCursor, rcReading, rcColumn, rcInvalid );
 
+	rc = VCursorResolveLazy ( cself, col );
+	if ( rc != 0 )
+		return rc;
+
 	if(cself->blob_mru_cache && num_rows > 0){
 		int64_t *row_ids_sorted = malloc(num_rows*sizeof(*row_ids_sorted));
 		if(row_ids_sorted){
@@ -2648,7 +3008,9 @@ LIB_EXPORT rc_t CC VCursorIsStaticColumn ( const VCursor *self, uint32_t col_idx
             else
             {
                 VColumn *col = VectorGet ( & self -> row, col_idx );
-                return VColumnIsStatic ( col, is_static );
+                rc = VCursorResolveLazy ( self, col );
+                if ( rc == 0 )
+                    return VColumnIsStatic ( col, is_static );
             }
         }
 
@@ -232,6 +232,8 @@ struct VCursor
     bool permit_post_open_add;
     /* support suspension of schema-declared triggers **/
     bool suspend_triggers;
+    /* defer resolution of columns until first read */
+    bool lazy_open;
     /* cursor used in sub-selects */
     bool is_sub_cursor; 
     /* cursor for VDB columns located in separate db.tbl ***/
@@ -303,6 +305,11 @@ rc_t VCursorListSeededWritableColumns ( struct VCursor *self, BSTree *columns, s
 rc_t VCursorPostOpenAdd ( struct VCursor *self, struct VColumn *col );
 rc_t VCursorPostOpenAddRead ( struct VCursor *self, struct VColumn *col );
 
+/* ResolveLazyColumns
+ *  resolve every column still pending on a lazily opened cursor
+ */
+rc_t VCursorResolveLazyColumns ( struct VCursor const *self );
+
 /* OpenRowRead
  * CloseRowRead
  */
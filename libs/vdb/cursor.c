@@ -109,7 +109,15 @@ LIB_EXPORT rc_t CC VCursorOpen ( const VCursor *cself )
                 int64_t first;
                 uint64_t count;
                 
-                rc = VCursorIdRange ( self, 0, & first, & count );
+                if ( self -> lazy_open && VectorLength ( & self -> row ) != 0 )
+                {
+                    /* only the first column is resolved to find the starting row */
+                    rc = VCursorIdRange ( self, VectorStart ( & self -> row ), & first, & count );
+                }
+                else
+                {
+                    rc = VCursorIdRange ( self, 0, & first, & count );
+                }
                 if ( rc != 0 )
                 {
                     /* permit empty open when run from sradb */
@@ -72,15 +72,32 @@ rc_t VDatabaseLoadSchema ( VDatabase *self )
            but by using the callback mechanism we don't
            have buffer or allocation issues. */
         KMDataNodeSchemaFillData pb;
+        const VSchema *cached = NULL;
         pb . node = node;
         pb . pos = 0;
         pb . add_v0 = false;
 
+        /* a read-only database can share a schema already
+           parsed from the same text */
+        if ( self -> read_only )
+        {
+            rc = VSchemaCacheLoad ( self -> mgr -> schema_cache, self -> mgr -> schema,
+                self -> schema -> dad, node, "VDatabaseLoadSchema", & cached );
+            if ( rc == 0 && cached != NULL )
+            {
+                VSchemaRelease ( self -> schema );
+                self -> schema = ( VSchema* ) cached;
+            }
+        }
+
         /* add in schema text. it is not mandatory, but it is
            the design of the system to store object schema with
            the object so that it is capable of standing alone */
-        rc = VSchemaParseTextCallback ( self -> schema,
-            "VDatabaseLoadSchema", KMDataNodeFillSchema, & pb );
+        if ( rc == 0 && cached == NULL )
+        {
+            rc = VSchemaParseTextCallback ( self -> schema,
+                "VDatabaseLoadSchema", KMDataNodeFillSchema, & pb );
+        }
         if ( rc == 0 )
         {
             /* determine database type */
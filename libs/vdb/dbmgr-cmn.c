@@ -53,7 +53,9 @@
 #include <kfg/config.h>
 #include <kfs/directory.h>
 #include <kfs/dyload.h>
+#include <kfs/file.h>
 #include <klib/log.h>
+#include <klib/prof.h>
 #include <klib/text.h>
 #include <klib/rc.h>
 #include <sysalloc.h>
@@ -83,6 +85,13 @@ rc_t VDBManagerWhack ( VDBManager *self )
 
     KRefcountWhack ( & self -> refcount, "VDBManager" );
 
+    /* leave the counters behind if asked */
+    {
+        const char *profile = getenv ( "VDB_PROFILE" );
+        if ( profile != NULL && profile [ 0 ] != 0 )
+            VDBManagerWriteProfile ( self, "%s", profile );
+    }
+
     rc = KDBManagerRelease ( self -> kmgr );
     if ( rc == 0 )
     {
@@ -94,6 +103,7 @@ rc_t VDBManagerWhack ( VDBManager *self )
             self -> user_whack = NULL;
         }
 
+        VSchemaCacheWhack ( self -> schema_cache );
         VSchemaRelease ( self -> schema );
         VLinkerRelease ( self -> linker );
         free ( self );
@@ -853,3 +863,69 @@ LIB_EXPORT rc_t CC VDBManagerSetResolver
 
     return rc;
 }
+
+
+/* WriteProfile
+ *  write instrumentation counters as JSON
+ */
+typedef struct VDBManagerProfileFile VDBManagerProfileFile;
+struct VDBManagerProfileFile
+{
+    KFile *f;
+    uint64_t pos;
+};
+
+static
+rc_t CC VDBManagerProfileWrite ( void *data, const char *buffer, size_t bsize, size_t *num_writ )
+{
+    VDBManagerProfileFile *pb = data;
+    rc_t rc = KFileWrite ( pb -> f, pb -> pos, buffer, bsize, num_writ );
+    if ( rc == 0 )
+        pb -> pos += * num_writ;
+    return rc;
+}
+
+LIB_EXPORT rc_t CC VDBManagerVWriteProfile ( const VDBManager *self,
+    const char *path, va_list args )
+{
+    rc_t rc;
+
+    if ( self == NULL )
+        rc = RC ( rcVDB, rcMgr, rcWriting, rcSelf, rcNull );
+    else if ( path == NULL )
+        rc = RC ( rcVDB, rcMgr, rcWriting, rcPath, rcNull );
+    else if ( path [ 0 ] == 0 )
+        rc = RC ( rcVDB, rcMgr, rcWriting, rcPath, rcEmpty );
+    else
+    {
+        KDirectory *wd;
+        rc = KDirectoryNativeDir ( & wd );
+        if ( rc == 0 )
+        {
+            VDBManagerProfileFile pb;
+            rc = KDirectoryVCreateFile ( wd, & pb . f, false, 0664, kcmInit | kcmParents, path, args );
+            if ( rc == 0 )
+            {
+                pb . pos = 0;
+                rc = KProfWriteJSON ( VDBManagerProfileWrite, & pb );
+                KFileRelease ( pb . f );
+            }
+            KDirectoryRelease ( wd );
+        }
+    }
+
+    return rc;
+}
+
+LIB_EXPORT rc_t CC VDBManagerWriteProfile ( const VDBManager *self,
+    const char *path, ... )
+{
+    rc_t rc;
+    va_list args;
+
+    va_start ( args, path );
+    rc = VDBManagerVWriteProfile ( self, path, args );
+    va_end ( args );
+
+    return rc;
+}
@@ -59,6 +59,7 @@ extern "C" {
 struct KDBManager;
 struct VSchema;
 struct VLinker;
+struct VSchemaCache;
 
 
 /*--------------------------------------------------------------------------
@@ -76,6 +77,9 @@ struct VDBManager
     /* intrinsic functions */
     struct VLinker *linker;
 
+    /* parsed schemas shared by read-only objects */
+    struct VSchemaCache *schema_cache;
+
     /* user data */
     void *user;
     void ( CC * user_whack ) ( void *data );
@@ -93,14 +93,20 @@ LIB_EXPORT rc_t CC VDBManagerMakeReadWithVFSManager ( const VDBManager ** mgrp,
                     rc = VLinkerMakeIntrinsic ( & mgr -> linker );
                     if ( rc == 0 )
                     {
-                        rc = VDBManagerConfigPaths ( mgr, false );
+                        rc = VSchemaCacheMake ( & mgr -> schema_cache );
                         if ( rc == 0 )
                         {
-                            mgr -> user = NULL;
-                            mgr -> user_whack = NULL;
-                            KRefcountInit ( & mgr -> refcount, 1, "VDBManager", "make-read", "vmgr" );
-                            * mgrp = mgr;
-                            return 0;
+                            rc = VDBManagerConfigPaths ( mgr, false );
+                            if ( rc == 0 )
+                            {
+                                mgr -> user = NULL;
+                                mgr -> user_whack = NULL;
+                                KRefcountInit ( & mgr -> refcount, 1, "VDBManager", "make-read", "vmgr" );
+                                * mgrp = mgr;
+                                return 0;
+                            }
+
+                            VSchemaCacheWhack ( mgr -> schema_cache );
                         }
 
                         VLinkerRelease ( mgr -> linker );
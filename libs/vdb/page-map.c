@@ -34,6 +34,7 @@
 
 #include <klib/pack.h>
 #include <klib/vlen-encode.h>
+#include <klib/prof.h>
 #include <sysalloc.h>
 #include "page-map.h"
 
@@ -1503,6 +1504,7 @@ rc_t PageMapDeserialize_v1(PageMap **lhs, const uint8_t *Src, uint64_t ssize, ui
 
 rc_t PageMapDeserialize (PageMap **lhs, const void *src, uint64_t ssize, uint64_t row_count) {
     rc_t rc;
+    KPROF_SITE ( deserialize, KPROF_PAGEMAP, "deserialize" );
 
     if ((uint32_t)row_count != row_count)
         return RC(rcVDB, rcPagemap, rcConstructing, rcParam, rcTooBig);
@@ -1514,6 +1516,7 @@ rc_t PageMapDeserialize (PageMap **lhs, const void *src, uint64_t ssize, uint64_
     if (src == NULL || ssize == 0)
         return 0;
 
+    KPROF_START ( deserialize );
     switch (*(const uint8_t *)src >> 2) {
     case 0:
         rc = PageMapDeserialize_v0(lhs, src, ssize, (uint32_t)row_count);
@@ -1525,6 +1528,7 @@ rc_t PageMapDeserialize (PageMap **lhs, const void *src, uint64_t ssize, uint64_
     default:
         return RC(rcVDB, rcPagemap, rcConstructing, rcData, rcBadVersion);
     }
+    KPROF_STOP ( deserialize );
     if (rc == 0)
         (**lhs).row_count = (uint32_t)row_count;
     else
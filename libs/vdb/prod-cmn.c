@@ -54,6 +54,7 @@
 #include <klib/symbol.h>
 #include <klib/log.h>
 #include <klib/debug.h>
+#include <klib/prof.h>
 #include <klib/rc.h>
 #include <os-native.h>
 #include <sysalloc.h>
@@ -360,6 +361,9 @@ rc_t VFunctionProdMake ( VFunctionProd **prodp, Vector *owned,
     {
         prod = * prodp;
         prod -> curs = curs;
+#if KPROF
+        prod -> prof_id = KProfRegister ( KPROF_TRANSFORM, name );
+#endif
 
         if ( sub != prodFuncByteswap )
             VectorInit ( & prod -> parms, 0, 4 );
@@ -1722,6 +1726,9 @@ static rc_t VFunctionProdReadNormal ( VFunctionProd *self, VBlob **vblob, int64_
         rc = pb . rc;
     else for( id_run=id, cnt_run=cnt, rc=0; cnt_run > 0 && rc==0;) 
     {
+        /* inputs are already fetched, so this times the function alone */
+        KPROF_TIMER ( call );
+
         switch ( self -> dad . sub )
         {
         case vftLegacyBlob:
@@ -1753,6 +1760,8 @@ static rc_t VFunctionProdReadNormal ( VFunctionProd *self, VBlob **vblob, int64_
         default:
             rc = RC ( rcVDB, rcFunction, rcReading, rcProduction, rcCorrupt );
         }
+        KPROF_TIMER_STOP ( self -> prof_id, call );
+
         if (rc == 0){
             if (vb == NULL) {
                 rc = RC ( rcVDB, rcFunction, rcReading, rcProduction, rcNull );
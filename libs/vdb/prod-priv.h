@@ -331,6 +331,9 @@ struct VFunctionProd
     /* adaptive prefetch parameters */
    int64_t start_id;
    int64_t stop_id;
+
+    /* instrumentation counter ( see <klib/prof.h> ) */
+    uint32_t prof_id;
 };
 
 
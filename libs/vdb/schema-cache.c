@@ -0,0 +1,341 @@
+/*===========================================================================
+*
+*                            PUBLIC DOMAIN NOTICE
+*               National Center for Biotechnology Information
+*
+*  This software/database is a "United States Government Work" under the
+*  terms of the United States Copyright Act.  It was written as part of
+*  the author's official duties as a United States Government employee and
+*  thus cannot be copyrighted.  This software/database is freely available
+*  to the public for use. The National Library of Medicine and the U.S.
+*  Government have not placed any restriction on its use or reproduction.
+*
+*  Although all reasonable efforts have been taken to ensure the accuracy
+*  and reliability of the software and data, the NLM and the U.S.
+*  Government do not and cannot warrant the performance or results that
+*  may be obtained by using this software or data. The NLM and the U.S.
+*  Government disclaim all warranties, express or implied, including
+*  warranties of performance, merchantability or fitness for any particular
+*  purpose.
+*
+*  Please cite the author in any work or product based on this material.
+*
+* ===========================================================================
+*
+*/
+
+#include <vdb/extern.h>
+
+#include "schema-priv.h"
+#include "dbmgr-priv.h"
+
+#include <vdb/manager.h>
+#include <vdb/vdb-priv.h>
+#include <kdb/meta.h>
+#include <kproc/lock.h>
+#include <klib/rc.h>
+#include <sysalloc.h>
+
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+
+
+/* default number of schemas kept */
+#define SCHEMA_CACHE_LIMIT 32
+
+
+/* Addr
+ *  reach into node and get address
+ *  returns raw pointer and node size
+ */
+rc_t CC KMDataNodeAddr ( const KMDataNode *self,
+    const void **addr, size_t *size );
+
+
+/*--------------------------------------------------------------------------
+ * VSchemaCache
+ *  parsed schemas keyed by their parent and the hash of their text
+ */
+typedef struct VSchemaCacheEntry VSchemaCacheEntry;
+struct VSchemaCacheEntry
+{
+    const VSchema *dad;
+    const VSchema *schema;
+    char *text;
+    size_t size;
+    uint64_t hash;
+    uint64_t last_use;
+};
+
+struct VSchemaCache
+{
+    KLock *lock;
+    VSchemaCacheEntry *entry;
+    uint32_t count;
+    uint32_t limit;
+    uint64_t clock;
+};
+
+
+/* Make
+ * Whack
+ */
+rc_t VSchemaCacheMake ( VSchemaCache **cachep )
+{
+    rc_t rc;
+    VSchemaCache *cache = calloc ( 1, sizeof * cache );
+    if ( cache == NULL )
+        rc = RC ( rcVDB, rcMgr, rcConstructing, rcMemory, rcExhausted );
+    else
+    {
+        rc = KLockMake ( & cache -> lock );
+        if ( rc == 0 )
+        {
+            cache -> limit = SCHEMA_CACHE_LIMIT;
+            * cachep = cache;
+            return 0;
+        }
+
+        free ( cache );
+    }
+
+    * cachep = NULL;
+    return rc;
+}
+
+static
+void VSchemaCacheEntryWhack ( VSchemaCacheEntry *self )
+{
+    VSchemaRelease ( self -> schema );
+    free ( self -> text );
+}
+
+void VSchemaCacheWhack ( VSchemaCache *self )
+{
+    if ( self != NULL )
+    {
+        /* entries are released newest first, since
+           a schema may be the parent of one made later */
+        while ( self -> count != 0 )
+            VSchemaCacheEntryWhack ( & self -> entry [ -- self -> count ] );
+
+        free ( self -> entry );
+        KLockRelease ( self -> lock );
+        free ( self );
+    }
+}
+
+
+/* hash of schema text */
+static
+uint64_t VSchemaCacheHash ( const char *text, size_t size )
+{
+    /* FNV-1a */
+    size_t i;
+    uint64_t hash = 14695981039346656037ULL;
+    for ( i = 0; i < size; ++ i )
+    {
+        hash ^= ( uint8_t ) text [ i ];
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
+
+/* a parent whose content is known not to change:
+   the intrinsic schema, or one produced by the cache */
+static
+bool VSchemaCacheStableDad ( const VSchemaCache *self,
+    const VSchema *intrinsic, const VSchema *dad )
+{
+    uint32_t i;
+
+    if ( dad == intrinsic )
+        return true;
+
+    for ( i = 0; i < self -> count; ++ i )
+    {
+        if ( self -> entry [ i ] . schema == dad )
+            return true;
+    }
+
+    return false;
+}
+
+static
+const VSchemaCacheEntry *VSchemaCacheFind ( VSchemaCache *self,
+    const VSchema *dad, const char *text, size_t size, uint64_t hash )
+{
+    uint32_t i;
+    for ( i = 0; i < self -> count; ++ i )
+    {
+        VSchemaCacheEntry *entry = & self -> entry [ i ];
+        if ( entry -> hash == hash && entry -> dad == dad &&
+             entry -> size == size && memcmp ( entry -> text, text, size ) == 0 )
+        {
+            entry -> last_use = ++ self -> clock;
+            return entry;
+        }
+    }
+    return NULL;
+}
+
+static
+rc_t VSchemaCacheInsert ( VSchemaCache *self, const VSchema *dad,
+    const VSchema *schema, const char *text, size_t size, uint64_t hash )
+{
+    VSchemaCacheEntry *entry;
+
+    if ( self -> count == self -> limit )
+    {
+        /* evict the least recently used entry that no other entry
+           has as its parent */
+        uint32_t i, j, victim = self -> count;
+        for ( i = 0; i < self -> count; ++ i )
+        {
+            for ( j = 0; j < self -> count; ++ j )
+            {
+                if ( self -> entry [ j ] . dad == self -> entry [ i ] . schema )
+                    break;
+            }
+            if ( j == self -> count && ( victim == self -> count ||
+                 self -> entry [ i ] . last_use < self -> entry [ victim ] . last_use ) )
+            {
+                victim = i;
+            }
+        }
+
+        if ( victim == self -> count )
+            return 0;
+
+        VSchemaCacheEntryWhack ( & self -> entry [ victim ] );
+        self -> entry [ victim ] = self -> entry [ -- self -> count ];
+    }
+    else if ( self -> entry == NULL )
+    {
+        self -> entry = malloc ( self -> limit * sizeof * self -> entry );
+        if ( self -> entry == NULL )
+            return RC ( rcVDB, rcSchema, rcInserting, rcMemory, rcExhausted );
+    }
+
+    entry = & self -> entry [ self -> count ];
+    entry -> text = malloc ( size );
+    if ( entry -> text == NULL )
+        return RC ( rcVDB, rcSchema, rcInserting, rcMemory, rcExhausted );
+    memcpy ( entry -> text, text, size );
+
+    entry -> schema = VSchemaAttach ( schema );
+    entry -> dad = dad;
+    entry -> size = size;
+    entry -> hash = hash;
+    entry -> last_use = ++ self -> clock;
+    ++ self -> count;
+
+    return 0;
+}
+
+
+/* Load
+ *  returns a schema derived from "dad" with the text of "node" parsed
+ *  into it, shared with any earlier load of the same text
+ *
+ *  "intrinsic" [ IN ] - the manager's intrinsic schema
+ *
+ *  "schema" [ OUT ] - new reference, or NULL when "dad" may change
+ *  and the caller must parse into its own schema instead
+ */
+rc_t VSchemaCacheLoad ( VSchemaCache *self, const VSchema *intrinsic,
+    const VSchema *dad, const KMDataNode *node, const char *name,
+    const VSchema **schemap )
+{
+    rc_t rc;
+    size_t size;
+    const void *addr;
+
+    * schemap = NULL;
+
+    if ( self == NULL )
+        return 0;
+
+    rc = KMDataNodeAddr ( node, & addr, & size );
+    if ( rc == 0 )
+    {
+        const char *text = addr;
+        uint64_t hash = VSchemaCacheHash ( text, size );
+
+        rc = KLockAcquire ( self -> lock );
+        if ( rc == 0 )
+        {
+            if ( self -> limit != 0 && VSchemaCacheStableDad ( self, intrinsic, dad ) )
+            {
+                const VSchemaCacheEntry *entry =
+                    VSchemaCacheFind ( self, dad, text, size, hash );
+                if ( entry != NULL )
+                    * schemap = VSchemaAttach ( entry -> schema );
+                else
+                {
+                    /* parse while holding the lock, so concurrent
+                       opens of the same schema parse it only once */
+                    VSchema *schema;
+                    rc = VSchemaMake ( & schema, dad );
+                    if ( rc == 0 )
+                    {
+                        rc = VSchemaParseText ( schema, name, text, size );
+
+                        /* text that includes files depends upon them */
+                        if ( rc == 0 && schema -> file_count == 0 )
+                            rc = VSchemaCacheInsert ( self, dad, schema, text, size, hash );
+
+                        if ( rc == 0 )
+                            * schemap = schema;
+                        else
+                            VSchemaRelease ( schema );
+                    }
+                }
+            }
+
+            KLockUnlock ( self -> lock );
+        }
+    }
+
+    return rc;
+}
+
+
+/* SetLimit
+ */
+static
+rc_t VSchemaCacheSetLimit ( VSchemaCache *self, uint32_t limit )
+{
+    rc_t rc = KLockAcquire ( self -> lock );
+    if ( rc == 0 )
+    {
+        /* drop everything */
+        while ( self -> count != 0 )
+            VSchemaCacheEntryWhack ( & self -> entry [ -- self -> count ] );
+
+        free ( self -> entry );
+        self -> entry = NULL;
+        self -> limit = limit;
+
+        KLockUnlock ( self -> lock );
+    }
+    return rc;
+}
+
+
+/*--------------------------------------------------------------------------
+ * VDBManager
+ */
+
+/* SetSchemaCacheLimit
+ */
+LIB_EXPORT rc_t CC VDBManagerSetSchemaCacheLimit ( const VDBManager *self, uint32_t limit )
+{
+    if ( self == NULL )
+        return RC ( rcVDB, rcMgr, rcUpdating, rcSelf, rcNull );
+    if ( self -> schema_cache == NULL )
+        return RC ( rcVDB, rcMgr, rcUpdating, rcSchema, rcNull );
+
+    return VSchemaCacheSetLimit ( self -> schema_cache, limit );
+}
@@ -317,6 +317,33 @@ VSchema *VSchemaAttach ( const VSchema *self );
 rc_t VSchemaSever ( const VSchema *self );
 
 
+/*--------------------------------------------------------------------------
+ * VSchemaCache
+ *  parsed schemas shared between objects opened read-only
+ *  whose stored schema text is identical
+ */
+typedef struct VSchemaCache VSchemaCache;
+
+/* Make
+ * Whack
+ */
+rc_t VSchemaCacheMake ( VSchemaCache **cache );
+void VSchemaCacheWhack ( VSchemaCache *self );
+
+/* Load
+ *  returns a schema derived from "dad" with the text of "node" parsed
+ *  into it, shared with any earlier load of the same text
+ *
+ *  "intrinsic" [ IN ] - the manager's intrinsic schema
+ *
+ *  "schema" [ OUT ] - new reference, or NULL when "dad" may change
+ *  and the caller must parse into its own schema instead
+ */
+rc_t VSchemaCacheLoad ( VSchemaCache *self, const VSchema *intrinsic,
+    const VSchema *dad, struct KMDataNode const *node, const char *name,
+    const VSchema **schema );
+
+
 /* ParseTextCallback
  *  parse schema text
  *  add productions to existing schema
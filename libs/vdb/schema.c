@@ -48,6 +48,7 @@
 #include <klib/data-buffer.h>
 #include <klib/printf.h>
 #include <klib/out.h>
+#include <klib/prof.h>
 #include <klib/rc.h>
 #include <os-native.h>      /* because of snprintf on windows */
 #include <sysalloc.h>
@@ -775,7 +776,13 @@ LIB_EXPORT rc_t CC VSchemaParseText ( VSchema *self, const char *name,
     else if ( text == NULL )
         rc = RC ( rcVDB, rcSchema, rcParsing, rcParam, rcNull );
     else
+    {
+        KPROF_SITE ( parse, KPROF_SCHEMA, "parse" );
+
+        KPROF_START ( parse );
         rc = VSchemaParseTextInt ( self, name, text, bytes );
+        KPROF_STOP ( parse );
+    }
 
     return rc;
 }
@@ -793,8 +800,10 @@ LIB_EXPORT rc_t CC VSchemaParseText ( VSchema *self, const char *name,
 rc_t VSchemaParseTextCallback ( VSchema *self, const char *name,
     rc_t ( CC * fill ) ( void *self, KTokenText *tt, size_t save ), void *data )
 {
+    rc_t rc;
     KTokenText tt;
     KTokenSource src;
+    KPROF_SITE ( parse, KPROF_SCHEMA, "parse-stored" );
 
     KTokenTextInitCString ( & tt, "", name );
     tt . read = fill;
@@ -802,7 +811,11 @@ rc_t VSchemaParseTextCallback ( VSchema *self, const char *name,
 
     KTokenSourceInit ( & src, & tt );
 
-    return schema ( & src, self );
+    KPROF_START ( parse );
+    rc = schema ( & src, self );
+    KPROF_STOP ( parse );
+
+    return rc;
 }
 
 
@@ -75,6 +75,7 @@ rc_t VTableWhack ( VTable *self )
 
     BSTreeWhack ( & self -> read_col_cache, VColumnRefWhack, NULL );
     BSTreeWhack ( & self -> write_col_cache, VColumnRefWhack, NULL );
+    KNamelistRelease ( self -> phys_col_names . ptr );
     VTableRelease(self -> cache_tbl);
 
     KMDataNodeRelease ( self -> col_node );
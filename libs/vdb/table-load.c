@@ -133,7 +133,8 @@ rc_t VTableFindType ( VTable *self )
 static
 rc_t VTableLoadSchemaNode ( VTable *self, const KMDataNode *node )
 {
-    rc_t rc;
+    rc_t rc = 0;
+    const VSchema *cached = NULL;
     
     /* the node is probably within our 4K buffer,
      but by using the callback mechanism we don't
@@ -142,12 +143,28 @@ rc_t VTableLoadSchemaNode ( VTable *self, const KMDataNode *node )
     pb . node = node;
     pb . pos = 0;
     pb . add_v0 = false;
+
+    /* a read-only table can share a schema already
+       parsed from the same text */
+    if ( self -> read_only )
+    {
+        rc = VSchemaCacheLoad ( self -> mgr -> schema_cache, self -> mgr -> schema,
+            self -> schema -> dad, node, "VTableLoadSchema", & cached );
+        if ( rc == 0 && cached != NULL )
+        {
+            VSchemaRelease ( self -> schema );
+            self -> schema = ( VSchema* ) cached;
+        }
+    }
     
     /* add in schema text. it is not mandatory, but it is
      the design of the system to store object schema with
      the object so that it is capable of standing alone */
-    rc = VSchemaParseTextCallback ( self -> schema,
-        "VTableLoadSchema", KMDataNodeFillSchema, & pb );
+    if ( rc == 0 && cached == NULL )
+    {
+        rc = VSchemaParseTextCallback ( self -> schema,
+            "VTableLoadSchema", KMDataNodeFillSchema, & pb );
+    }
     if ( rc == 0 )
     {
         /* determine table type */
@@ -55,6 +55,10 @@
 #include <klib/refcount.h>
 #endif
 
+#ifndef _h_atomic_
+#include <atomic.h>
+#endif
+
 #ifndef KONST
 #define KONST
 #endif
@@ -119,6 +123,10 @@ struct VTable
     BSTree read_col_cache;
     BSTree write_col_cache;
 
+    /* KNamelist of physical column names, listed by the first
+       read cursor and shared with later ones ( read-only tables ) */
+    atomic_ptr_t phys_col_names;
+
     /* user data */
     void *user;
     void ( CC * user_whack ) ( void *data );
@@ -58,6 +58,7 @@
 #include <kfs/buffile.h>
 #include <kfs/quickmount.h>
 #include <kfs/cacheteefile.h>
+#include <kfs/pagecachefile.h>
 #include <kfs/lockfile.h>
 
 #include <kns/http.h>
@@ -90,6 +91,10 @@
 
 #define DEFAULT_CACHE_BLOCKSIZE ( 32768 * 4 )
 
+/* configuration node for the size limit of the in-memory page cache
+   of remote files, the cache is off if missing or 0 */
+#define KFG_PAGE_CACHE_LIMIT "/vfs/page-cache/limit"
+
 #define VFS_KRYPTO_PASSWORD_MAX_SIZE 4096
 
 /*--------------------------------------------------------------------------
@@ -121,6 +126,9 @@ struct VFSManager
     /* encryption key storage */ 
     struct KKeyStore* keystore;
 
+    /* memory limit for the page cache of remote files without cache location */
+    size_t page_cache_limit;
+
     KRefcount refcount;
 };
 
@@ -226,7 +234,12 @@ rc_t VFSManagerMakeHTTPFile( const VFSManager * self, const KFile **cfp,
     {
         const KFile *temp_file;
         rc_t rc2;
-        if ( cache_location == NULL )
+        if ( cache_location == NULL && self -> page_cache_limit != 0 )
+        {
+            /* there is no cache_location! keep the recently used pages in memory */
+            rc2 = KPageCacheFileMakeRead ( & temp_file, * cfp, self -> page_cache_limit );
+        }
+        else if ( cache_location == NULL )
         {
             /* there is no cache_location! just wrap the remote file in a buffer */
             rc2 = KBufFileMakeRead ( & temp_file, * cfp, 128 * 1024 * 1024 );
@@ -2317,6 +2330,12 @@ LIB_EXPORT rc_t CC VFSManagerMakeFromKfg ( struct VFSManager ** pmanager,
                                 rc = 0;
                             }
 
+                            {
+                                uint64_t limit;
+                                if ( KConfigReadU64 ( obj -> cfg, KFG_PAGE_CACHE_LIMIT, & limit ) == 0 )
+                                    obj -> page_cache_limit = ( size_t ) limit;
+                            }
+
                             *pmanager = singleton = obj;
        DBGMSG(DBG_KNS, DBG_FLAG(DBG_KNS_MGR),  ("%s(%p)\n", __FUNCTION__, cfg));
                             return 0;
@@ -2412,6 +2431,32 @@ LIB_EXPORT rc_t CC VFSManagerSetResolver
 }
 
 
+LIB_EXPORT rc_t CC VFSManagerSetPageCacheLimit ( VFSManager * self, size_t limit )
+{
+    if ( self == NULL )
+        return RC (rcVFS, rcMgr, rcUpdating, rcSelf, rcNull);
+
+    self -> page_cache_limit = limit;
+    return 0;
+}
+
+
+LIB_EXPORT rc_t CC VFSManagerGetPageCacheLimit ( const VFSManager * self, size_t * limit )
+{
+    if ( limit == NULL )
+        return RC (rcVFS, rcMgr, rcAccessing, rcParam, rcNull);
+
+    if ( self == NULL )
+    {
+        * limit = 0;
+        return RC (rcVFS, rcMgr, rcAccessing, rcSelf, rcNull);
+    }
+
+    * limit = self -> page_cache_limit;
+    return 0;
+}
+
+
 LIB_EXPORT rc_t CC VFSManagerGetKNSMgr ( const VFSManager * self, struct KNSManager ** kns )
 {
     rc_t rc;
@@ -53,6 +53,7 @@
 #include <klib/data-buffer.h>
 #include <klib/debug.h>
 #include <klib/log.h>
+#include <klib/prof.h>
 #include <klib/rc.h>
 
 #include <sysalloc.h>
@@ -3258,7 +3259,13 @@ LIB_EXPORT
 rc_t CC VResolverQuery ( const VResolver * self, VRemoteProtocols protocols,
     const VPath * query, const VPath ** local, const VPath ** remote, const VPath ** cache )
 {
-    rc_t rc = VResolverQueryInt ( self, protocols, query, local, remote, cache );
+    rc_t rc;
+    KPROF_SITE ( query, KPROF_VFS, "resolve" );
+
+    KPROF_START ( query );
+    rc = VResolverQueryInt ( self, protocols, query, local, remote, cache );
+    KPROF_STOP ( query );
+
     if ( rc == 0 )
     {
         /* the paths returned from resolver are highly reliable */
@@ -47,6 +47,8 @@
 #include <stdio.h>
 #include <assert.h>
 
+#include "izip-simd.h"
+
 typedef struct {
     size_t size;
     size_t used;
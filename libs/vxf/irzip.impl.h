@@ -320,27 +320,36 @@ static rc_t DECODE(STYPE Y[], unsigned N, int64_t* min, int64_t* slope, uint8_t
     unsigned i;
     uint8_t *scratch=NULL;
     rc_t rc=0;
-    bool    first;
 
-    memset(Y, 0, sizeof(Y[0]) * N);
-    for (j = k = 0, m = 1,first=true; m < 0x100; m <<= 1, k += 8) {
-        size_t n;
-        
-        if ((planes & m) == 0)
-            continue;
-        
-        n = 0;
-	if( !scratch ) scratch = malloc(N);
-	
-        rc = zlib_decompress(scratch, N, &n, src + j, ssize - j);
-        if (rc) goto DONE;
-        j += n;
-	if(first){
-		for (i = 0; i != N; ++i) Y[i] = ((STYPE)scratch[i]) << k;
-		first = false;
-	} else {
-		for (i = 0; i != N; ++i) Y[i] |= ((STYPE)scratch[i]) << k;
-	}
+    {
+        /* decompress every plane first, then merge them in one pass */
+        const uint8_t *plane[8] = { NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL };
+        unsigned nplanes = 0;
+
+        for (m = planes; m != 0; m &= m - 1)
+            ++nplanes;
+        if (nplanes != 0) {
+            scratch = malloc((size_t)N * nplanes);
+            if (scratch == NULL)
+                return RC(rcXF, rcFunction, rcExecuting, rcMemory, rcExhausted);
+        }
+        for (j = k = 0, m = 1; m < 0x100; m <<= 1, ++k) {
+            size_t n;
+            uint8_t *dst;
+
+            if ((planes & m) == 0)
+                continue;
+
+            n = 0;
+            dst = scratch + (size_t)N * --nplanes; /* any free slot will do */
+            rc = zlib_decompress(dst, N, &n, src + j, ssize - j);
+            if (rc) goto DONE;
+            j += n;
+            /* planes above the element size contribute nothing */
+            if (k < sizeof(Y[0]))
+                plane[k] = dst;
+        }
+        izip_merge_planes(Y, N, sizeof(Y[0]), plane);
     }
     if(series_count == 2){
 #if 0 /** trying to unroll ***/
@@ -447,28 +456,38 @@ static rc_t DECODE(STYPE Y[], unsigned N, int64_t* min, int64_t* slope, uint8_t
     } else if(slope[0] == DELTA_POS){
 	assert(Y[0] == 0);
 	Y[0] = (STYPE)min[0];
-	for (i = 1; i != N; ++i){
-		Y[i] = Y[i-1] + Y[i];
+	if (!izip_delta_decode(Y, N, sizeof(Y[0]), IZIP_DELTA_ADD)) {
+		for (i = 1; i != N; ++i){
+			Y[i] = Y[i-1] + Y[i];
+		}
 	}
     } else if (slope[0] == DELTA_NEG ) {
 	assert(Y[0] == 0);
 	Y[0] = (STYPE)min[0];
-	for (i = 1; i != N; ++i){
-		Y[i] =  Y[i-1] - Y[i];
+	if (!izip_delta_decode(Y, N, sizeof(Y[0]), IZIP_DELTA_SUB)) {
+		for (i = 1; i != N; ++i){
+			Y[i] =  Y[i-1] - Y[i];
+		}
 	}
     } else if (slope[0] == DELTA_BOTH){
 	assert(Y[0] == 0);
 	Y[0] = (STYPE)min[0];
-	for (i = 1; i != N; ++i){
-		USTYPE val = (USTYPE)Y[i];
-		val >>= 1;
-		if(Y[i] & 1) Y[i] = Y[i-1] - val;
-		else         Y[i] = Y[i-1] + val;
+	if (!izip_delta_decode(Y, N, sizeof(Y[0]), IZIP_DELTA_SIGNED)) {
+		for (i = 1; i != N; ++i){
+			USTYPE val = (USTYPE)Y[i];
+			val >>= 1;
+			if(Y[i] & 1) Y[i] = Y[i-1] - val;
+			else         Y[i] = Y[i-1] + val;
+		}
 	}
     } else if(slope[0] == 0) {
-	for (i = 0; i != N; ++i){
-		Y[i]  += (STYPE)min[0];
+	if (!izip_add_linear(Y, N, sizeof(Y[0]), (uint64_t)min[0], 0)) {
+		for (i = 0; i != N; ++i){
+			Y[i]  += (STYPE)min[0];
+		}
 	}
+    } else if (izip_add_linear(Y, N, sizeof(Y[0]), (uint64_t)min[0], (uint64_t)slope[0])) {
+	min[0] = (int64_t)((uint64_t)min[0] + (uint64_t)slope[0] * N);
     } else {
 	for (i = 0; i != N; ++i){
                 Y[i]  += (STYPE)min[0];
@@ -44,6 +44,7 @@
 #include <assert.h>
 
 #include "izip-common.h"
+#include "izip-simd.h"
 
 static void unpack_nbuf16_swap(nbuf *x) {
     unsigned i;
@@ -61,26 +62,79 @@ static void unpack_nbuf32_swap(nbuf *x) {
     }
 }
 
+/* unpack_nbuf8, unpack_nbuf16, unpack_nbuf32
+ *  widen in place to int64 and add the minimum. blocks are processed
+ *  from the end, since the widened elements overwrite the source
+ */
 static void unpack_nbuf8(nbuf *x) {
-    unsigned i;
+    unsigned i = x->used;
     
-    for (i = x->used; i; --i) {
+#if IZIP_SSE2
+    const __m128i min = _mm_set1_epi64x(x->min);
+    const __m128i zero = _mm_setzero_si128();
+    
+    for (; i >= 16; i -= 16) {
+        const __m128i v = _mm_loadu_si128((const __m128i *)&x->data.u8[i - 16]);
+        const __m128i w[2] = { _mm_unpacklo_epi8(v, zero), _mm_unpackhi_epi8(v, zero) };
+        __m128i *dst = (__m128i *)&x->data.raw[i - 16];
+        unsigned j;
+        
+        for (j = 0; j != 2; ++j) {
+            const __m128i d0 = _mm_unpacklo_epi16(w[j], zero);
+            const __m128i d1 = _mm_unpackhi_epi16(w[j], zero);
+            
+            _mm_storeu_si128(dst++, _mm_add_epi64(_mm_unpacklo_epi32(d0, zero), min));
+            _mm_storeu_si128(dst++, _mm_add_epi64(_mm_unpackhi_epi32(d0, zero), min));
+            _mm_storeu_si128(dst++, _mm_add_epi64(_mm_unpacklo_epi32(d1, zero), min));
+            _mm_storeu_si128(dst++, _mm_add_epi64(_mm_unpackhi_epi32(d1, zero), min));
+        }
+    }
+#endif
+    for (; i; --i) {
         x->data.raw[i - 1] = x->data.u8[i - 1] + x->min;
     }
 }
 
 static void unpack_nbuf16(nbuf *x) {
-    unsigned i;
+    unsigned i = x->used;
     
-    for (i = x->used; i; --i) {
+#if IZIP_SSE2
+    const __m128i min = _mm_set1_epi64x(x->min);
+    const __m128i zero = _mm_setzero_si128();
+    
+    for (; i >= 8; i -= 8) {
+        const __m128i v = _mm_loadu_si128((const __m128i *)&x->data.u16[i - 8]);
+        const __m128i d0 = _mm_unpacklo_epi16(v, zero);
+        const __m128i d1 = _mm_unpackhi_epi16(v, zero);
+        __m128i *dst = (__m128i *)&x->data.raw[i - 8];
+        
+        _mm_storeu_si128(dst++, _mm_add_epi64(_mm_unpacklo_epi32(d0, zero), min));
+        _mm_storeu_si128(dst++, _mm_add_epi64(_mm_unpackhi_epi32(d0, zero), min));
+        _mm_storeu_si128(dst++, _mm_add_epi64(_mm_unpacklo_epi32(d1, zero), min));
+        _mm_storeu_si128(dst++, _mm_add_epi64(_mm_unpackhi_epi32(d1, zero), min));
+    }
+#endif
+    for (; i; --i) {
         x->data.raw[i - 1] = x->data.u16[i - 1] + x->min;
     }
 }
 
 static void unpack_nbuf32(nbuf *x) {
-    unsigned i;
+    unsigned i = x->used;
     
-    for (i = x->used; i; --i) {
+#if IZIP_SSE2
+    const __m128i min = _mm_set1_epi64x(x->min);
+    const __m128i zero = _mm_setzero_si128();
+    
+    for (; i >= 4; i -= 4) {
+        const __m128i v = _mm_loadu_si128((const __m128i *)&x->data.u32[i - 4]);
+        __m128i *dst = (__m128i *)&x->data.raw[i - 4];
+        
+        _mm_storeu_si128(dst++, _mm_add_epi64(_mm_unpacklo_epi32(v, zero), min));
+        _mm_storeu_si128(dst++, _mm_add_epi64(_mm_unpackhi_epi32(v, zero), min));
+    }
+#endif
+    for (; i; --i) {
         x->data.raw[i - 1] = x->data.u32[i - 1] + x->min;
     }
 }
@@ -77,7 +77,19 @@ rc_t DECODE(STYPE Y[], unsigned N, const uint8_t src[], unsigned ssize, int swap
                 if (decoded.type[i]) {
                     if (N == 121)
                         DEBUG_PRINT("extracting stored segment %u; length: %u", i, n);
-                    for (j = 0; j != n; ++j, ++k, ++v)
+                    j = 0;
+#if IZIP_SSE2
+                    if (sizeof(Y[0]) == 4) {
+                        /* keep the low half of each 64-bit value */
+                        for (; j + 4 <= n; j += 4, k += 4, v += 4) {
+                            const __m128i lo = _mm_shuffle_epi32(_mm_loadu_si128((const __m128i *)&decoded.outlier->data.raw[v    ]), 0x08);
+                            const __m128i hi = _mm_shuffle_epi32(_mm_loadu_si128((const __m128i *)&decoded.outlier->data.raw[v + 2]), 0x08);
+                            
+                            _mm_storeu_si128((__m128i *)&Y[k], _mm_unpacklo_epi64(lo, hi));
+                        }
+                    }
+#endif
+                    for (; j != n; ++j, ++k, ++v)
                         Y[k] = (STYPE)( decoded.outlier->data.raw[v] );
                 }
                 else {
@@ -85,7 +97,28 @@ rc_t DECODE(STYPE Y[], unsigned N, const uint8_t src[], unsigned ssize, int swap
                     
                     if (N == 121)
                         DEBUG_PRINT("extracting line segment %u; length: %u; dy: %lli; dx: %lli; a: %lli", i, n, decoded.dy->data.raw[u], decoded.dx->data.raw[u], decoded.a->data.raw[u]);
-                    for (j = 0; j != n; ++j, ++k) {
+                    j = 0;
+#if IZIP_SSE2
+                    /* two points per step; cvttpd2dq truncates exactly like
+                     * the scalar conversion only for types up to int32 */
+                    if (sizeof(Y[0]) < 4 || (sizeof(Y[0]) == 4 && (STYPE)-1 < 0)) {
+                        const __m128d vm = _mm_set1_pd(m);
+                        const __m128d va = _mm_set1_pd((double)decoded.a->data.raw[u]);
+                        const __m128d two = _mm_set1_pd(2.0);
+                        __m128d vj = _mm_set_pd(1.0, 0.0);
+                        
+                        for (; j + 2 <= n; j += 2, k += 2) {
+                            const __m128i d = _mm_loadu_si128((const __m128i *)&decoded.diff->data.raw[k]);
+                            const __m128i y = _mm_add_epi32(_mm_cvttpd_epi32(_mm_add_pd(va, _mm_mul_pd(vj, vm))),
+                                                            _mm_shuffle_epi32(d, 0x08));
+                            
+                            Y[k    ] = (STYPE)_mm_cvtsi128_si32(y);
+                            Y[k + 1] = (STYPE)_mm_cvtsi128_si32(_mm_srli_si128(y, 4));
+                            vj = _mm_add_pd(vj, two);
+                        }
+                    }
+#endif
+                    for (; j != n; ++j, ++k) {
                         Y[k] = (STYPE)( decoded.diff->data.raw[k] + (STYPE)(decoded.a->data.raw[u] + j * m) );
                         if (N == 121)
                             DEBUG_PRINT("    %u: %i", k, (int)Y[k]);
@@ -0,0 +1,305 @@
+/*===========================================================================
+ *
+ *                            PUBLIC DOMAIN NOTICE
+ *               National Center for Biotechnology Information
+ *
+ *  This software/database is a "United States Government Work" under the
+ *  terms of the United States Copyright Act.  It was written as part of
+ *  the author's official duties as a United States Government employee and
+ *  thus cannot be copyrighted.  This software/database is freely available
+ *  to the public for use. The National Library of Medicine and the U.S.
+ *  Government have not placed any restriction on its use or reproduction.
+ *
+ *  Although all reasonable efforts have been taken to ensure the accuracy
+ *  and reliability of the software and data, the NLM and the U.S.
+ *  Government do not and cannot warrant the performance or results that
+ *  may be obtained by using this software or data. The NLM and the U.S.
+ *  Government disclaim all warranties, express or implied, including
+ *  warranties of performance, merchantability or fitness for any particular
+ *  purpose.
+ *
+ *  Please cite the author in any work or product based on this material.
+ *
+ * ===========================================================================
+ *
+ */
+
+#ifndef _h_izip_simd_
+#define _h_izip_simd_
+
+/*--------------------------------------------------------------------------
+ * vectorized steps shared by the izip and irzip decoders
+ *
+ *  SSE2 is part of the x86-64 baseline, so the kernels need no
+ *  runtime check; other targets run the scalar loops over the whole
+ *  range. all arithmetic is modulo the element size, exactly like the
+ *  per-type loops in the decoders, so results are bit-identical.
+ *  defining IZIP_SSE2 as 0 before inclusion forces the scalar loops
+ */
+
+#ifndef IZIP_SSE2
+#if defined __SSE2__ || defined _M_X64
+#define IZIP_SSE2 1
+#else
+#define IZIP_SSE2 0
+#endif
+#endif
+
+#if IZIP_SSE2
+#include <emmintrin.h>
+#endif
+
+/* izip_merge_planes
+ *  builds N elements of "size" bytes from byte planes, where plane [ b ]
+ *  holds bits 8b..8b+7 of every element and NULL stands for zeros.
+ *  one pass over the output instead of one pass per plane
+ */
+static __inline__ void izip_merge_planes(void *dst, unsigned N, unsigned size, const uint8_t *const plane[8])
+{
+    unsigned i = 0;
+    unsigned b;
+
+#if IZIP_SSE2
+    const __m128i zero = _mm_setzero_si128();
+    __m128i *out = (__m128i *)dst;
+
+    for (; size > 1 && i + 16 <= N; i += 16) {
+        __m128i v[8];
+
+        for (b = 0; b != size; ++b)
+            v[b] = plane[b] ? _mm_loadu_si128((const __m128i *)(plane[b] + i)) : zero;
+
+        /* interleave bytes, then pairs, then quads of bytes */
+        if (size == 2) {
+            _mm_storeu_si128(out++, _mm_unpacklo_epi8(v[0], v[1]));
+            _mm_storeu_si128(out++, _mm_unpackhi_epi8(v[0], v[1]));
+        }
+        else if (size == 4) {
+            const __m128i lo01 = _mm_unpacklo_epi8(v[0], v[1]);
+            const __m128i hi01 = _mm_unpackhi_epi8(v[0], v[1]);
+            const __m128i lo23 = _mm_unpacklo_epi8(v[2], v[3]);
+            const __m128i hi23 = _mm_unpackhi_epi8(v[2], v[3]);
+
+            _mm_storeu_si128(out++, _mm_unpacklo_epi16(lo01, lo23));
+            _mm_storeu_si128(out++, _mm_unpackhi_epi16(lo01, lo23));
+            _mm_storeu_si128(out++, _mm_unpacklo_epi16(hi01, hi23));
+            _mm_storeu_si128(out++, _mm_unpackhi_epi16(hi01, hi23));
+        }
+        else {
+            __m128i w[8];
+            __m128i q[8];
+
+            for (b = 0; b != 4; ++b) {
+                w[b]     = _mm_unpacklo_epi8(v[2 * b], v[2 * b + 1]);
+                w[b + 4] = _mm_unpackhi_epi8(v[2 * b], v[2 * b + 1]);
+            }
+            /* q[0..3]: bytes 0-3 of elements 0-3, 4-7, 8-11, 12-15
+               q[4..7]: bytes 4-7 of the same elements */
+            for (b = 0; b != 2; ++b) {
+                q[4 * b + 0] = _mm_unpacklo_epi16(w[2 * b], w[2 * b + 1]);
+                q[4 * b + 1] = _mm_unpackhi_epi16(w[2 * b], w[2 * b + 1]);
+                q[4 * b + 2] = _mm_unpacklo_epi16(w[2 * b + 4], w[2 * b + 5]);
+                q[4 * b + 3] = _mm_unpackhi_epi16(w[2 * b + 4], w[2 * b + 5]);
+            }
+            for (b = 0; b != 4; ++b) {
+                _mm_storeu_si128(out++, _mm_unpacklo_epi32(q[b], q[b + 4]));
+                _mm_storeu_si128(out++, _mm_unpackhi_epi32(q[b], q[b + 4]));
+            }
+        }
+    }
+#endif
+
+    for (; i != N; ++i) {
+        uint64_t val = 0;
+
+        for (b = 0; b != size; ++b) {
+            if (plane[b])
+                val |= ((uint64_t)plane[b][i]) << (8 * b);
+        }
+        switch (size) {
+        case 1:
+            ((uint8_t *)dst)[i] = (uint8_t)val;
+            break;
+        case 2:
+            ((uint16_t *)dst)[i] = (uint16_t)val;
+            break;
+        case 4:
+            ((uint32_t *)dst)[i] = (uint32_t)val;
+            break;
+        default:
+            ((uint64_t *)dst)[i] = val;
+            break;
+        }
+    }
+}
+
+/* izip_delta_decode
+ *  Y [ 0 ] holds the starting value; every following element is
+ *  replaced by its predecessor plus or minus the delta it holds.
+ *  IZIP_DELTA_ADD adds, IZIP_DELTA_SUB subtracts and IZIP_DELTA_SIGNED
+ *  takes the sign from bit 0 and the magnitude from the bits above.
+ *
+ *  runs as a prefix sum: the deltas are first turned into signed
+ *  addends, then summed in-register with log-step shifts and carried
+ *  from one vector to the next
+ *
+ *  returns false for element sizes without a kernel
+ */
+enum { IZIP_DELTA_ADD, IZIP_DELTA_SUB, IZIP_DELTA_SIGNED };
+
+static __inline__ void izip_delta_decode32(uint32_t Y[], unsigned N, int mode)
+{
+    unsigned i = 1;
+
+    if (N == 0)
+        return;
+#if IZIP_SSE2
+    {
+        const __m128i one = _mm_set1_epi32(1);
+        __m128i carry = _mm_set1_epi32((int)Y[0]);
+
+        for (; i + 4 <= N; i += 4) {
+            __m128i x = _mm_loadu_si128((const __m128i *)&Y[i]);
+
+            if (mode == IZIP_DELTA_SUB)
+                x = _mm_sub_epi32(_mm_setzero_si128(), x);
+            else if (mode == IZIP_DELTA_SIGNED) {
+                const __m128i neg = _mm_sub_epi32(_mm_setzero_si128(), _mm_and_si128(x, one));
+                x = _mm_sub_epi32(_mm_xor_si128(_mm_srli_epi32(x, 1), neg), neg);
+            }
+            x = _mm_add_epi32(x, _mm_slli_si128(x, 4));
+            x = _mm_add_epi32(x, _mm_slli_si128(x, 8));
+            x = _mm_add_epi32(x, carry);
+            _mm_storeu_si128((__m128i *)&Y[i], x);
+            carry = _mm_shuffle_epi32(x, 0xFF);
+        }
+    }
+#endif
+    for (; i != N; ++i) {
+        uint32_t val = Y[i];
+
+        if (mode == IZIP_DELTA_ADD)
+            Y[i] = Y[i - 1] + val;
+        else if (mode == IZIP_DELTA_SUB)
+            Y[i] = Y[i - 1] - val;
+        else if (val & 1)
+            Y[i] = Y[i - 1] - (val >> 1);
+        else
+            Y[i] = Y[i - 1] + (val >> 1);
+    }
+}
+
+static __inline__ void izip_delta_decode64(uint64_t Y[], unsigned N, int mode)
+{
+    unsigned i = 1;
+
+    if (N == 0)
+        return;
+#if IZIP_SSE2
+    {
+        const __m128i one = _mm_set_epi32(0, 1, 0, 1);
+        __m128i carry;
+
+        carry = _mm_loadl_epi64((const __m128i *)&Y[0]);
+        carry = _mm_unpacklo_epi64(carry, carry);
+        for (; i + 2 <= N; i += 2) {
+            __m128i x = _mm_loadu_si128((const __m128i *)&Y[i]);
+
+            if (mode == IZIP_DELTA_SUB)
+                x = _mm_sub_epi64(_mm_setzero_si128(), x);
+            else if (mode == IZIP_DELTA_SIGNED) {
+                const __m128i neg = _mm_sub_epi64(_mm_setzero_si128(), _mm_and_si128(x, one));
+                x = _mm_sub_epi64(_mm_xor_si128(_mm_srli_epi64(x, 1), neg), neg);
+            }
+            x = _mm_add_epi64(x, _mm_slli_si128(x, 8));
+            x = _mm_add_epi64(x, carry);
+            _mm_storeu_si128((__m128i *)&Y[i], x);
+            carry = _mm_unpackhi_epi64(x, x);
+        }
+    }
+#endif
+    for (; i != N; ++i) {
+        uint64_t val = Y[i];
+
+        if (mode == IZIP_DELTA_ADD)
+            Y[i] = Y[i - 1] + val;
+        else if (mode == IZIP_DELTA_SUB)
+            Y[i] = Y[i - 1] - val;
+        else if (val & 1)
+            Y[i] = Y[i - 1] - (val >> 1);
+        else
+            Y[i] = Y[i - 1] + (val >> 1);
+    }
+}
+
+static __inline__ bool izip_delta_decode(void *Y, unsigned N, size_t size, int mode)
+{
+    switch (size) {
+    case 4:
+        izip_delta_decode32((uint32_t *)Y, N, mode);
+        return true;
+    case 8:
+        izip_delta_decode64((uint64_t *)Y, N, mode);
+        return true;
+    }
+    return false;
+}
+
+/* izip_add_linear
+ *  Y [ i ] += base + i * step
+ *  returns false for element sizes without a kernel
+ */
+static __inline__ void izip_add_linear32(uint32_t Y[], unsigned N, uint32_t base, uint32_t step)
+{
+    unsigned i = 0;
+
+#if IZIP_SSE2
+    {
+        __m128i cur = _mm_setr_epi32((int)base, (int)(base + step), (int)(base + 2 * step), (int)(base + 3 * step));
+        const __m128i inc = _mm_set1_epi32((int)(4 * step));
+
+        for (; i + 4 <= N; i += 4) {
+            __m128i *p = (__m128i *)&Y[i];
+            _mm_storeu_si128(p, _mm_add_epi32(_mm_loadu_si128(p), cur));
+            cur = _mm_add_epi32(cur, inc);
+        }
+    }
+#endif
+    for (; i != N; ++i)
+        Y[i] += base + i * step;
+}
+
+static __inline__ void izip_add_linear64(uint64_t Y[], unsigned N, uint64_t base, uint64_t step)
+{
+    unsigned i = 0;
+
+#if IZIP_SSE2
+    {
+        __m128i cur = _mm_set_epi64x((long long)(base + step), (long long)base);
+        const __m128i inc = _mm_set1_epi64x((long long)(2 * step));
+
+        for (; i + 2 <= N; i += 2) {
+            __m128i *p = (__m128i *)&Y[i];
+            _mm_storeu_si128(p, _mm_add_epi64(_mm_loadu_si128(p), cur));
+            cur = _mm_add_epi64(cur, inc);
+        }
+    }
+#endif
+    for (; i != N; ++i)
+        Y[i] += base + i * step;
+}
+
+static __inline__ bool izip_add_linear(void *Y, unsigned N, size_t size, uint64_t base, uint64_t step)
+{
+    switch (size) {
+    case 4:
+        izip_add_linear32((uint32_t *)Y, N, (uint32_t)base, (uint32_t)step);
+        return true;
+    case 8:
+        izip_add_linear64((uint64_t *)Y, N, base, step);
+        return true;
+    }
+    return false;
+}
+
+#endif /* _h_izip_simd_ */
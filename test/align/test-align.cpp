@@ -0,0 +1,362 @@
+// ===========================================================================
+//
+//                            PUBLIC DOMAIN NOTICE
+//               National Center for Biotechnology Information
+//
+//  This software/database is a "United States Government Work" under the
+//  terms of the United States Copyright Act.  It was written as part of
+//  the author's official duties as a United States Government employee and
+//  thus cannot be copyrighted.  This software/database is freely available
+//  to the public for use. The National Library of Medicine and the U.S.
+//  Government have not placed any restriction on its use or reproduction.
+//
+//  Although all reasonable efforts have been taken to ensure the accuracy
+//  and reliability of the software and data, the NLM and the U.S.
+//  Government do not and cannot warrant the performance or results that
+//  may be obtained by using this software or data. The NLM and the U.S.
+//  Government disclaim all warranties, express or implied, including
+//  warranties of performance, merchantability or fitness for any particular
+//  purpose.
+//
+//  Please cite the author in any work or product based on this material.
+//
+// ===========================================================================
+
+
+/**
+* Unit tests for the reference iterator of the align library
+* and the pool recycling its placement records
+*/
+
+#include <align/manager.h>
+#include <align/iterator.h>
+#include <align/reference.h>
+
+#include <vdb/manager.h>
+#include <vdb/database.h>
+
+#include <klib/rc.h>
+
+#include <ktst/unit_test.hpp>
+#include <kfg/config.h>
+
+#include <cstring>
+#include <stdexcept>
+
+#include "../../libs/align/placement-pool.h"
+#include <vector>
+
+using namespace std;
+
+TEST_SUITE( AlignTestSuite )
+
+// ReferenceIteratorCoverage has to report the same depths as walking
+// the window with ReferenceIteratorNextPos/ReferenceIteratorPosition;
+// the window cuts through placements at both ends and contains
+// placements starting, overlapping and ending inside of it
+class RefIterFixture
+{
+public:
+    RefIterFixture()
+    : vmgr ( 0 ), db ( 0 ), list ( 0 ), refobj ( 0 ), amgr ( 0 )
+    {
+        if ( VDBManagerMakeRead ( & vmgr, NULL ) != 0 )
+            throw logic_error ( "RefIterFixture: VDBManagerMakeRead failed" );
+        if ( VDBManagerOpenDBRead ( vmgr, & db, NULL, "%s", Accession ) != 0 )
+            throw logic_error ( "RefIterFixture: VDBManagerOpenDBRead failed" );
+        if ( ReferenceList_MakeDatabase ( & list, db, ereferencelist_usePrimaryIds, 0, NULL, 0 ) != 0 )
+            throw logic_error ( "RefIterFixture: ReferenceList_MakeDatabase failed" );
+        if ( ReferenceList_Find ( list, & refobj, RefName, strlen ( RefName ) ) != 0 )
+            throw logic_error ( "RefIterFixture: ReferenceList_Find failed" );
+        if ( AlignMgrMakeRead ( & amgr ) != 0 )
+            throw logic_error ( "RefIterFixture: AlignMgrMakeRead failed" );
+    }
+    ~RefIterFixture()
+    {
+        AlignMgrRelease ( amgr );
+        ReferenceObj_Release ( refobj );
+        ReferenceList_Release ( list );
+        VDatabaseRelease ( db );
+        VDBManagerRelease ( vmgr );
+    }
+
+    // positions the iterator on the one window [ WindowPos, WindowPos + WindowLen )
+    ReferenceIterator * MakeIterator ( int32_t min_mapq, INSDC_coord_zero & first, INSDC_coord_len & len )
+    {
+        ReferenceIterator * it;
+        if ( AlignMgrMakeReferenceIterator ( amgr, & it, NULL, min_mapq ) != 0 )
+            throw logic_error ( "MakeIterator: AlignMgrMakeReferenceIterator failed" );
+        if ( ReferenceIteratorAddPlacements ( it, refobj, WindowPos, WindowLen, NULL, NULL, primary_align_ids, NULL, NULL ) != 0 ||
+             ReferenceIteratorNextReference ( it, NULL, NULL, NULL ) != 0 ||
+             ReferenceIteratorNextWindow ( it, & first, & len ) != 0 )
+        {
+            ReferenceIteratorRelease ( it );
+            throw logic_error ( "MakeIterator: failed to get to the window" );
+        }
+        return it;
+    }
+
+    vector < uint32_t > Coverage ( int32_t min_mapq )
+    {
+        INSDC_coord_zero first;
+        INSDC_coord_len len;
+        ReferenceIterator * it = MakeIterator ( min_mapq, first, len );
+        vector < uint32_t > depth ( len );
+        rc_t rc = ReferenceIteratorCoverage ( it, first, len, & depth [ 0 ], NULL );
+        rc_t rc2 = ReferenceIteratorNextPos ( it, false );
+        ReferenceIteratorRelease ( it );
+        if ( rc != 0 )
+            throw logic_error ( "Coverage: ReferenceIteratorCoverage failed" );
+        if ( GetRCState ( rc2 ) != rcDone )
+            throw logic_error ( "Coverage: window is not used up" );
+        if ( first != WindowPos || len != WindowLen )
+            throw logic_error ( "Coverage: unexpected window" );
+        return depth;
+    }
+
+    // the window walked position by position, 0 where NextPos does not stop
+    vector < uint32_t > Walk ( int32_t min_mapq )
+    {
+        INSDC_coord_zero first;
+        INSDC_coord_len len;
+        ReferenceIterator * it = MakeIterator ( min_mapq, first, len );
+        vector < uint32_t > depth ( len );
+        rc_t rc;
+        while ( ( rc = ReferenceIteratorNextPos ( it, false ) ) == 0 )
+        {
+            INSDC_coord_zero pos;
+            uint32_t d;
+            rc = ReferenceIteratorPosition ( it, & pos, & d, NULL );
+            if ( rc != 0 )
+                break;
+            if ( pos >= first && pos < first + ( INSDC_coord_zero ) len )
+                depth [ pos - first ] = d;
+        }
+        ReferenceIteratorRelease ( it );
+        if ( GetRCState ( rc ) != rcDone )
+            throw logic_error ( "Walk: ReferenceIteratorNextPos/Position failed" );
+        return depth;
+    }
+
+    static const char Accession [];
+    static const char RefName [];
+    static const INSDC_coord_zero WindowPos = 2200;
+    static const INSDC_coord_len WindowLen = 500;
+
+    const VDBManager * vmgr;
+    const VDatabase * db;
+    const ReferenceList * list;
+    const ReferenceObj * refobj;
+    const AlignMgr * amgr;
+};
+
+const char RefIterFixture :: Accession [] = "SRR341578";
+const char RefIterFixture :: RefName [] = "NC_011752.1";
+
+FIXTURE_TEST_CASE ( ReferenceIteratorCoverage_vs_Position, RefIterFixture )
+{
+    vector < uint32_t > coverage = Coverage ( 0 );
+    vector < uint32_t > walk = Walk ( 0 );
+    REQUIRE_EQ ( coverage . size (), walk . size () );
+
+    uint32_t total = 0;
+    for ( size_t i = 0; i < coverage . size (); ++ i )
+    {
+        REQUIRE_EQ ( coverage [ i ], walk [ i ] );
+        total += coverage [ i ];
+    }
+    REQUIRE_NE ( total, ( uint32_t ) 0 );
+}
+
+FIXTURE_TEST_CASE ( ReferenceIteratorCoverage_vs_Position_Filtered, RefIterFixture )
+{
+    // min_mapq drops placements in the middle of the window
+    const int32_t min_mapq = 30;
+    vector < uint32_t > coverage = Coverage ( min_mapq );
+    vector < uint32_t > walk = Walk ( min_mapq );
+    vector < uint32_t > all = Coverage ( 0 );
+    REQUIRE_EQ ( coverage . size (), walk . size () );
+
+    for ( size_t i = 0; i < coverage . size (); ++ i )
+    {
+        REQUIRE_EQ ( coverage [ i ], walk [ i ] );
+        REQUIRE_LE ( coverage [ i ], all [ i ] );
+    }
+}
+
+TEST_CASE ( ReferenceIteratorCoverage_BadArgs )
+{
+    uint32_t depth [ 1 ];
+    REQUIRE_RC_FAIL ( ReferenceIteratorCoverage ( NULL, 0, 1, depth, NULL ) );
+}
+
+FIXTURE_TEST_CASE ( ReferenceIteratorCoverage_AfterNextPos, RefIterFixture )
+{
+    INSDC_coord_zero first;
+    INSDC_coord_len len;
+    ReferenceIterator * it = MakeIterator ( 0, first, len );
+    vector < uint32_t > depth ( len );
+    REQUIRE_RC_FAIL ( ReferenceIteratorCoverage ( it, first, 0, & depth [ 0 ], NULL ) );
+    REQUIRE_RC_FAIL ( ReferenceIteratorCoverage ( it, first, len, NULL, NULL ) );
+    REQUIRE_RC ( ReferenceIteratorNextPos ( it, false ) );
+    // the window has been started on already
+    REQUIRE_RC_FAIL ( ReferenceIteratorCoverage ( it, first, len, & depth [ 0 ], NULL ) );
+    REQUIRE_RC ( ReferenceIteratorRelease ( it ) );
+}
+
+// PlacementRecordPool
+TEST_CASE ( PlacementRecordPool_SlotHeader )
+{
+    // records follow the slot header and must keep malloc's alignment
+    REQUIRE_EQ ( sizeof ( PlacementRecordSlot ), ( size_t ) PLACEMENT_POOL_SLOT_SIZE );
+
+    PlacementRecordPool * pool = PlacementRecordPoolMake ();
+    REQUIRE_NOT_NULL ( pool );
+    for ( size_t size = 1; size <= 4096; size *= 3 )
+    {
+        void * rec = PlacementRecordAlloc ( pool, size );
+        REQUIRE_NOT_NULL ( rec );
+        REQUIRE_EQ ( ( size_t ) rec % 16, ( size_t ) 0 );
+        PlacementRecordFree ( rec );
+    }
+    PlacementRecordPoolRelease ( pool );
+}
+
+TEST_CASE ( PlacementRecordPool_NoPool )
+{
+    char * rec = ( char * ) PlacementRecordAlloc ( NULL, 200 );
+    REQUIRE_NOT_NULL ( rec );
+    PlacementRecordSlot * slot = ( ( PlacementRecordSlot * ) rec ) - 1;
+    REQUIRE_EQ ( slot -> size_class, ( uint32_t ) PLACEMENT_POOL_NO_CLASS );
+    for ( size_t i = 0; i < 200; ++ i )
+        REQUIRE_EQ ( rec [ i ], ( char ) 0 );
+    PlacementRecordFree ( rec );
+}
+
+TEST_CASE ( PlacementRecordPool_Recycle )
+{
+    PlacementRecordPool * pool = PlacementRecordPoolMake ();
+    REQUIRE_NOT_NULL ( pool );
+
+    char * rec = ( char * ) PlacementRecordAlloc ( pool, 200 );
+    REQUIRE_NOT_NULL ( rec );
+    REQUIRE_EQ ( pool -> refcount, ( uint32_t ) 2 );
+    memset ( rec, 0xFF, 200 );
+    PlacementRecordFree ( rec );
+    REQUIRE_EQ ( pool -> refcount, ( uint32_t ) 1 );
+
+    // 200 + the header is in the 256 byte class
+    REQUIRE_EQ ( pool -> free_count [ 1 ], ( uint32_t ) 1 );
+
+    // same class: the slot comes back, zeroed
+    char * again = ( char * ) PlacementRecordAlloc ( pool, 220 );
+    REQUIRE_EQ ( again, rec );
+    REQUIRE_EQ ( pool -> free_count [ 1 ], ( uint32_t ) 0 );
+    for ( size_t i = 0; i < 220; ++ i )
+        REQUIRE_EQ ( again [ i ], ( char ) 0 );
+
+    // another class does not take it
+    PlacementRecordFree ( again );
+    char * other = ( char * ) PlacementRecordAlloc ( pool, 60 );
+    REQUIRE_NOT_NULL ( other );
+    REQUIRE_EQ ( pool -> free_count [ 1 ], ( uint32_t ) 1 );
+    PlacementRecordFree ( other );
+    REQUIRE_EQ ( pool -> free_count [ 0 ], ( uint32_t ) 1 );
+
+    PlacementRecordPoolRelease ( pool );
+}
+
+TEST_CASE ( PlacementRecordPool_TooLarge )
+{
+    PlacementRecordPool * pool = PlacementRecordPoolMake ();
+    REQUIRE_NOT_NULL ( pool );
+
+    void * rec = PlacementRecordAlloc ( pool, 64 * 1024 );
+    REQUIRE_NOT_NULL ( rec );
+    REQUIRE_EQ ( ( ( PlacementRecordSlot * ) rec ) [ -1 ] . size_class, ( uint32_t ) PLACEMENT_POOL_NO_CLASS );
+    PlacementRecordFree ( rec );
+    for ( uint32_t i = 0; i < PLACEMENT_POOL_CLASSES; ++ i )
+        REQUIRE_EQ ( pool -> free_count [ i ], ( uint32_t ) 0 );
+
+    PlacementRecordPoolRelease ( pool );
+}
+
+TEST_CASE ( PlacementRecordPool_FreeListCap )
+{
+    PlacementRecordPool * pool = PlacementRecordPoolMake ();
+    REQUIRE_NOT_NULL ( pool );
+
+    // the smallest and the largest class
+    const size_t sizes [] = { 64, 60 * 1024 };
+    const uint32_t classes [] = { 0, PLACEMENT_POOL_CLASSES - 1 };
+    for ( size_t k = 0; k < 2; ++ k )
+    {
+        const uint32_t cap = PLACEMENT_POOL_MAX_FREE >> ( PLACEMENT_POOL_MIN_SHIFT + classes [ k ] );
+        vector < void * > recs ( cap + 10 );
+        for ( size_t i = 0; i < recs . size (); ++ i )
+        {
+            recs [ i ] = PlacementRecordAlloc ( pool, sizes [ k ] );
+            REQUIRE_NOT_NULL ( recs [ i ] );
+        }
+        for ( size_t i = 0; i < recs . size (); ++ i )
+            PlacementRecordFree ( recs [ i ] );
+        REQUIRE_EQ ( pool -> free_count [ classes [ k ] ], cap );
+
+        uint32_t listed = 0;
+        for ( PlacementRecordSlot * slot = pool -> free_list [ classes [ k ] ]; slot != NULL; slot = slot -> next )
+            ++ listed;
+        REQUIRE_EQ ( listed, cap );
+    }
+    REQUIRE_EQ ( pool -> refcount, ( uint32_t ) 1 );
+
+    PlacementRecordPoolRelease ( pool );
+}
+
+TEST_CASE ( PlacementRecordPool_OutlivesOwner )
+{
+    PlacementRecordPool * pool = PlacementRecordPoolMake ();
+    REQUIRE_NOT_NULL ( pool );
+    void * rec1 = PlacementRecordAlloc ( pool, 64 );
+    void * rec2 = PlacementRecordAlloc ( pool, 64 );
+    REQUIRE_NOT_NULL ( rec1 );
+    REQUIRE_NOT_NULL ( rec2 );
+
+    // the iterator goes away first, the records keep the pool alive
+    PlacementRecordPoolRelease ( pool );
+    REQUIRE_EQ ( pool -> refcount, ( uint32_t ) 2 );
+    PlacementRecordFree ( rec1 );
+    REQUIRE_EQ ( pool -> refcount, ( uint32_t ) 1 );
+    REQUIRE_EQ ( pool -> free_count [ 0 ], ( uint32_t ) 1 );
+    PlacementRecordFree ( rec2 );
+}
+
+//////////////////////////////////////////// Main
+extern "C"
+{
+
+#include <kapp/args.h>
+
+ver_t CC KAppVersion ( void )
+{
+    return 0x1000000;
+}
+rc_t CC UsageSummary (const char * progname)
+{
+    return 0;
+}
+
+rc_t CC Usage ( const Args * args )
+{
+    return 0;
+}
+
+const char UsageDefaultName[] = "test-align";
+
+rc_t CC KMain ( int argc, char *argv [] )
+{
+    KConfigDisableUserSettings();
+    rc_t rc=AlignTestSuite(argc, argv);
+    return rc;
+}
+
+}
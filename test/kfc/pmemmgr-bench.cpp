@@ -0,0 +1,131 @@
+/*===========================================================================
+*
+*                            PUBLIC DOMAIN NOTICE
+*               National Center for Biotechnology Information
+*
+*  This software/database is a "United States Government Work" under the
+*  terms of the United States Copyright Act.  It was written as part of
+*  the author's official duties as a United States Government employee and
+*  thus cannot be copyrighted.  This software/database is freely available
+*  to the public for use. The National Library of Medicine and the U.S.
+*  Government have not placed any restriction on its use or reproduction.
+*
+*  Although all reasonable efforts have been taken to ensure the accuracy
+*  and reliability of the software and data, the NLM and the U.S.
+*  Government do not and cannot warrant the performance or results that
+*  may be obtained by using this software or data. The NLM and the U.S.
+*  Government disclaim all warranties, express or implied, including
+*  warranties of performance, merchantability or fitness for any particular
+*  purpose.
+*
+*  Please cite the author in any work or product based on this material.
+*
+* ===========================================================================
+*
+*/
+
+/*
+ * cost of allocating and releasing Mem blocks through the primordial
+ * memory manager, next to the malloc and free it used to be built on.
+ * meant to be run by hand, not as part of the tests.
+ */
+
+#include <kfc/callstk.hpp>
+#include <kfc/rsrc.hpp>
+#include <kfc/memory.hpp>
+#include <kfc/except.hpp>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+using namespace vdb3;
+
+class TopStk : public CallStk
+{
+public:
+
+    TopStk ()
+        : CallStk ( s_src_loc )
+    {
+    }
+};
+
+static const int BENCH_ITERS = 1000000;
+
+// the working set: blocks are held this long before being released
+static const int BENCH_LIVE = 64;
+
+static
+double now ()
+{
+    struct timespec ts;
+    clock_gettime ( CLOCK_MONOTONIC, & ts );
+    return ts . tv_sec + ts . tv_nsec * 1e-9;
+}
+
+static
+void bench_mmgr ( size_t bytes )
+{
+    Mem live [ BENCH_LIVE ];
+
+    double start = now ();
+    for ( int i = 0; i < BENCH_ITERS; ++ i )
+        live [ i % BENCH_LIVE ] = rsrc -> mmgr . alloc ( bytes, false );
+    double secs = now () - start;
+
+    printf ( "MemMgr alloc  %7zu bytes: %6.1f ns\n", bytes, secs * 1e9 / BENCH_ITERS );
+}
+
+static
+void bench_malloc ( size_t bytes )
+{
+    // a block plus the object describing it, as before
+    void * live [ BENCH_LIVE ] [ 2 ];
+    for ( int i = 0; i < BENCH_LIVE; ++ i )
+        live [ i ] [ 0 ] = live [ i ] [ 1 ] = 0;
+
+    double start = now ();
+    for ( int i = 0; i < BENCH_ITERS; ++ i )
+    {
+        void ** slot = live [ i % BENCH_LIVE ];
+        free ( slot [ 0 ] );
+        free ( slot [ 1 ] );
+        slot [ 0 ] = malloc ( bytes );
+        slot [ 1 ] = calloc ( 1, 64 );
+    }
+    double secs = now () - start;
+
+    for ( int i = 0; i < BENCH_LIVE; ++ i )
+    {
+        free ( live [ i ] [ 0 ] );
+        free ( live [ i ] [ 1 ] );
+    }
+
+    printf ( "malloc + free %7zu bytes: %6.1f ns\n", bytes, secs * 1e9 / BENCH_ITERS );
+}
+
+int main ( int argc, char * argv [] )
+{
+    static const size_t sizes [] = { 16, 64, 256, 1000, 4096, 64 * 1024 };
+
+    TopStk stk;
+    TopRsrc top ( "pmemmgr-bench" );
+
+    try
+    {
+        for ( size_t i = 0; i < sizeof sizes / sizeof sizes [ 0 ]; ++ i )
+        {
+            bench_mmgr ( sizes [ i ] );
+            bench_malloc ( sizes [ i ] );
+        }
+    }
+    catch ( exception & x )
+    {
+        NULTermString what = x . what ();
+        fprintf ( stderr, "%s - failed: %s\n", argv [ 0 ], ( const char * ) what );
+        return 1;
+    }
+
+    return 0;
+}
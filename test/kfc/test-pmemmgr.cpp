@@ -0,0 +1,289 @@
+/*===========================================================================
+*
+*                            PUBLIC DOMAIN NOTICE
+*               National Center for Biotechnology Information
+*
+*  This software/database is a "United States Government Work" under the
+*  terms of the United States Copyright Act.  It was written as part of
+*  the author's official duties as a United States Government employee and
+*  thus cannot be copyrighted.  This software/database is freely available
+*  to the public for use. The National Library of Medicine and the U.S.
+*  Government have not placed any restriction on its use or reproduction.
+*
+*  Although all reasonable efforts have been taken to ensure the accuracy
+*  and reliability of the software and data, the NLM and the U.S.
+*  Government do not and cannot warrant the performance or results that
+*  may be obtained by using this software or data. The NLM and the U.S.
+*  Government disclaim all warranties, express or implied, including
+*  warranties of performance, merchantability or fitness for any particular
+*  purpose.
+*
+*  Please cite the author in any work or product based on this material.
+*
+* ===========================================================================
+*
+*/
+
+#include <kfc/callstk.hpp>
+#include <kfc/rsrc.hpp>
+#include <kfc/memory.hpp>
+#include <kfc/except.hpp>
+#include "pmemmgr.hpp"
+
+#include <pthread.h>
+#include <stdio.h>
+
+using namespace vdb3;
+
+/*--------------------------------------------------------------------
+ * TopStk
+ *  the frame at the top of each thread's call stack
+ */
+class TopStk : public CallStk
+{
+public:
+
+    TopStk ()
+        : CallStk ( s_src_loc )
+    {
+    }
+};
+
+#define REQUIRE( cond ) \
+    if ( ! ( cond ) ) throw "requirement failed: " # cond
+
+static
+PrimordMemStats stats ()
+{
+    PrimordMemStats s;
+    PrimordMemMgr :: get_stats ( s );
+    return s;
+}
+
+static
+void test_slab_reuse ()
+{
+    FUNC_ENTRY ();
+
+    // warm the size class
+    rsrc -> mmgr . alloc ( 100, false );
+
+    PrimordMemStats before = stats ();
+    for ( int i = 0; i < 1000; ++ i )
+    {
+        Mem m = rsrc -> mmgr . alloc ( 100, true );
+        REQUIRE ( m . find_first ( 1 ) == -1 );
+        m . fill ( 100, 0, 1 );
+    }
+    PrimordMemStats after = stats ();
+
+    // freed blocks were reused and every byte was given back
+    REQUIRE ( after . slab_reserved == before . slab_reserved );
+    REQUIRE ( after . in_use == before . in_use );
+    REQUIRE ( after . peak >= before . in_use + 100 );
+}
+
+static
+void test_resize_across_tiers ()
+{
+    FUNC_ENTRY ();
+
+    PrimordMemStats before = stats ();
+
+    Mem m = rsrc -> mmgr . alloc ( 100, false );
+    m . fill ( 100, 0, 7 );
+
+    // slab to heap
+    m . resize ( 10000, true );
+    REQUIRE ( m . find_first ( 0 ) == 100 );
+    REQUIRE ( m . find_first ( 7, 100 ) == -1 );
+
+    // heap to huge pages
+    m . resize ( 3 * 1024 * 1024, true );
+    REQUIRE ( m . find_first ( 0 ) == 100 );
+    REQUIRE ( m . find_first ( 7, 100 ) == -1 );
+    REQUIRE ( stats () . huge_mapped >= before . huge_mapped + 3 * 1024 * 1024 );
+
+    // grow within the huge tier
+    m . resize ( 5 * 1024 * 1024, true );
+    REQUIRE ( m . find_first ( 7, 100 ) == -1 );
+
+    // back to a slab block
+    m . resize ( 50, false );
+    REQUIRE ( m . find_first ( 0 ) == -1 );
+    REQUIRE ( stats () . huge_mapped == before . huge_mapped );
+
+    m = Mem ();
+    REQUIRE ( stats () . in_use == before . in_use );
+}
+
+static
+void test_quota ()
+{
+    FUNC_ENTRY ();
+
+    PrimordMemStats before = stats ();
+    {
+        MemMgr sub = PrimordMemMgr :: make_quota ( 4096 );
+        Mem a = sub . alloc ( 1000, false );
+
+        bool refused = false;
+        try
+        {
+            sub . alloc ( 5000, false );
+        }
+        catch ( xc_mem_quota & x )
+        {
+            refused = true;
+        }
+        REQUIRE ( refused );
+
+        // freeing makes room again
+        a = Mem ();
+        Mem b = sub . alloc ( 3000, false );
+
+        refused = false;
+        try
+        {
+            b . resize ( 5000, false );
+        }
+        catch ( xc_mem_quota & x )
+        {
+            refused = true;
+        }
+        REQUIRE ( refused );
+        REQUIRE ( b . size () == ( U64 ) 3000 );
+    }
+    REQUIRE ( stats () . in_use == before . in_use );
+}
+
+static const Rsrc * shared_rsrc;
+
+static
+void * churn_thread ( void * data )
+{
+    TopStk stk;
+    rsrc = shared_rsrc;
+    try
+    {
+        FUNC_ENTRY ();
+        U32 seed = ( U32 ) ( size_t ) data;
+        for ( int i = 0; i < 20000; ++ i )
+        {
+            seed = seed * 1103515245 + 12345;
+            Mem m = rsrc -> mmgr . alloc ( ( seed >> 8 ) % 6000 + 1, false );
+            m . fill ( 1, 0, 1 );
+        }
+    }
+    catch ( ... )
+    {
+        data = 0;
+    }
+    rsrc = 0;
+    return data;
+}
+
+static
+void test_threads ()
+{
+    FUNC_ENTRY ();
+
+    const int num_threads = 4;
+    pthread_t t [ num_threads ];
+
+    PrimordMemStats before = stats ();
+
+    shared_rsrc = rsrc;
+    for ( int i = 0; i < num_threads; ++ i )
+        REQUIRE ( pthread_create ( & t [ i ], 0, churn_thread, ( void * ) ( size_t ) ( i + 1 ) ) == 0 );
+    for ( int i = 0; i < num_threads; ++ i )
+    {
+        void * rslt;
+        REQUIRE ( pthread_join ( t [ i ], & rslt ) == 0 );
+        REQUIRE ( rslt != 0 );
+    }
+
+    REQUIRE ( stats () . in_use == before . in_use );
+
+    // the threads' blocks went back to the depot on exit
+    PrimordMemStats mid = stats ();
+    Mem held [ 100 ];
+    for ( int i = 0; i < 100; ++ i )
+        held [ i ] = rsrc -> mmgr . alloc ( 64 * ( i % 8 + 1 ), false );
+    REQUIRE ( stats () . slab_reserved == mid . slab_reserved );
+}
+
+static PrimordMemStats held_stats;
+
+static
+void * hold_thread ( void * data )
+{
+    TopStk stk;
+    rsrc = shared_rsrc;
+    try
+    {
+        FUNC_ENTRY ();
+        Mem m = rsrc -> mmgr . alloc ( 100, false );
+        held_stats = stats ();
+    }
+    catch ( ... )
+    {
+        data = 0;
+    }
+    rsrc = 0;
+    return data;
+}
+
+static
+void test_exact_charge ()
+{
+    FUNC_ENTRY ();
+
+    PrimordMemStats before = stats ();
+
+    // a new thread's first small block charges only what it uses
+    shared_rsrc = rsrc;
+    pthread_t t;
+    void * rslt;
+    REQUIRE ( pthread_create ( & t, 0, hold_thread, ( void * ) 1 ) == 0 );
+    REQUIRE ( pthread_join ( t, & rslt ) == 0 );
+    REQUIRE ( rslt != 0 );
+
+    REQUIRE ( held_stats . in_use > before . in_use );
+    REQUIRE ( held_stats . in_use < before . in_use + 1024 );
+
+    // and the high-water mark follows bytes in use
+    U64 high = before . peak > held_stats . in_use ? before . peak : held_stats . in_use;
+    REQUIRE ( held_stats . peak == high );
+
+    REQUIRE ( stats () . in_use == before . in_use );
+}
+
+int main ( int argc, char * argv [] )
+{
+    TopStk stk;
+    TopRsrc top ( "test-pmemmgr" );
+
+    try
+    {
+        test_exact_charge ();
+        test_slab_reuse ();
+        test_resize_across_tiers ();
+        test_quota ();
+        test_threads ();
+    }
+    catch ( exception & x )
+    {
+        NULTermString what = x . what ();
+        fprintf ( stderr, "%s - failed: %s\n", argv [ 0 ], ( const char * ) what );
+        return 1;
+    }
+    catch ( const char * msg )
+    {
+        fprintf ( stderr, "%s - failed: %s\n", argv [ 0 ], msg );
+        return 1;
+    }
+
+    fprintf ( stderr, "%s - succeeded\n", argv [ 0 ] );
+    return 0;
+}
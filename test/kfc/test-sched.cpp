@@ -0,0 +1,389 @@
+/*===========================================================================
+*
+*                            PUBLIC DOMAIN NOTICE
+*               National Center for Biotechnology Information
+*
+*  This software/database is a "United States Government Work" under the
+*  terms of the United States Copyright Act.  It was written as part of
+*  the author's official duties as a United States Government employee and
+*  thus cannot be copyrighted.  This software/database is freely available
+*  to the public for use. The National Library of Medicine and the U.S.
+*  Government have not placed any restriction on its use or reproduction.
+*
+*  Although all reasonable efforts have been taken to ensure the accuracy
+*  and reliability of the software and data, the NLM and the U.S.
+*  Government do not and cannot warrant the performance or results that
+*  may be obtained by using this software or data. The NLM and the U.S.
+*  Government disclaim all warranties, express or implied, including
+*  warranties of performance, merchantability or fitness for any particular
+*  purpose.
+*
+*  Please cite the author in any work or product based on this material.
+*
+* ===========================================================================
+*
+*/
+
+#include <kfc/callstk.hpp>
+#include <kfc/rsrc.hpp>
+#include <kfc/task-impl.hpp>
+#include <kfc/time.hpp>
+#include <kfc/caps.hpp>
+#include <kfc/except.hpp>
+#include "psched.hpp"
+
+#include <pthread.h>
+#include <unistd.h>
+#include <stdio.h>
+
+using namespace vdb3;
+
+/*--------------------------------------------------------------------
+ * TopStk
+ *  the frame at the top of the call stack
+ */
+class TopStk : public CallStk
+{
+public:
+
+    TopStk ()
+        : CallStk ( s_src_loc )
+    {
+    }
+};
+
+#define REQUIRE( cond ) \
+    if ( ! ( cond ) ) throw "requirement failed: " # cond
+
+static Sched sched;
+
+/*--------------------------------------------------------------------
+ * SliceTask
+ *  yields "slices" times before completing
+ */
+class SliceTask : public TaskImpl
+{
+public:
+
+    static Task make ( U32 slices, atomic_t < U64 > & runs )
+    {
+        SliceTask * obj = new SliceTask ( slices, runs );
+        return obj -> make_ref ( obj, CAP_EXECUTE | CAP_SUSPEND );
+    }
+
+protected:
+
+    virtual bool execute ()
+    {
+        ++ runs;
+        return ++ done > slices;
+    }
+
+private:
+
+    SliceTask ( U32 _slices, atomic_t < U64 > & _runs )
+        : runs ( _runs )
+        , slices ( _slices )
+        , done ( 0 )
+    {
+    }
+
+    atomic_t < U64 > & runs;
+    U32 slices;
+    U32 done;
+};
+
+/*--------------------------------------------------------------------
+ * ForkTask
+ *  spawns children from within a worker, which are then stolen
+ */
+static atomic_t < U64 > child_runs ( 0 );
+static pthread_t child_threads [ 256 ];
+
+class ChildTask : public TaskImpl
+{
+public:
+
+    static Task make ( U32 idx )
+    {
+        ChildTask * obj = new ChildTask ( idx );
+        return obj -> make_ref ( obj, CAP_EXECUTE | CAP_SUSPEND );
+    }
+
+protected:
+
+    virtual bool execute ()
+    {
+        child_threads [ idx ] = pthread_self ();
+        ++ child_runs;
+        usleep ( 500 );
+        return true;
+    }
+
+private:
+
+    ChildTask ( U32 _idx )
+        : idx ( _idx )
+    {
+    }
+
+    U32 idx;
+};
+
+class ForkTask : public TaskImpl
+{
+public:
+
+    static Task make ()
+    {
+        ForkTask * obj = new ForkTask;
+        return obj -> make_ref ( obj, CAP_EXECUTE | CAP_SUSPEND );
+    }
+
+protected:
+
+    virtual bool execute ()
+    {
+        for ( U32 i = 0; i < 256; ++ i )
+            sched . spawn ( ChildTask :: make ( i ) );
+        return true;
+    }
+};
+
+/*--------------------------------------------------------------------
+ * WaitTask
+ *  waits upon a timer or a descriptor and records being resumed
+ */
+class WaitTask : public TaskImpl
+{
+public:
+
+    static Task make ( int fd, I64 delay_nS, WaitTask * & obj )
+    {
+        obj = new WaitTask ( fd, delay_nS );
+        return obj -> make_ref ( obj, CAP_EXECUTE | CAP_SUSPEND );
+    }
+
+    volatile bool resumed;
+    volatile char data;
+
+protected:
+
+    virtual bool execute ()
+    {
+        if ( fd >= 0 )
+            sched . wait_ready ( fd );
+        else
+            sched . wait ( nS_t ( delay_nS ) );
+        return false;
+    }
+
+    virtual bool resume ()
+    {
+        resumed = true;
+        if ( fd >= 0 )
+            REQUIRE ( read ( fd, ( void * ) & data, 1 ) == 1 );
+        return true;
+    }
+
+private:
+
+    WaitTask ( int _fd, I64 _delay_nS )
+        : resumed ( false )
+        , data ( 0 )
+        , fd ( _fd )
+        , delay_nS ( _delay_nS )
+    {
+    }
+
+    int fd;
+    I64 delay_nS;
+};
+
+/*--------------------------------------------------------------------
+ * ThrowTask
+ */
+class ThrowTask : public TaskImpl
+{
+public:
+
+    static Task make ()
+    {
+        ThrowTask * obj = new ThrowTask;
+        return obj -> make_ref ( obj, CAP_EXECUTE | CAP_SUSPEND );
+    }
+
+protected:
+
+    virtual bool execute ()
+    {
+        FUNC_ENTRY ();
+        CONST_THROW ( xc_param_err, "task failure" );
+    }
+};
+
+static
+I64 now_nS ()
+{
+    return ( I64 ) rsrc -> tmmgr . cur_time ();
+}
+
+static
+void test_yield ()
+{
+    FUNC_ENTRY ();
+
+    atomic_t < U64 > runs ( 0 );
+    for ( U32 i = 0; i < 1000; ++ i )
+        sched . spawn ( SliceTask :: make ( i % 10, runs ) );
+
+    REQUIRE ( sched . drain () == ( U64 ) 0 );
+
+    // each task ran once for every slice plus its last
+    U64 expected = 0;
+    for ( U32 i = 0; i < 1000; ++ i )
+        expected += i % 10 + 1;
+    REQUIRE ( runs == expected );
+}
+
+static
+void test_steal ()
+{
+    FUNC_ENTRY ();
+
+    sched . spawn ( ForkTask :: make () );
+    REQUIRE ( sched . drain () == ( U64 ) 0 );
+    REQUIRE ( child_runs == ( U64 ) 256 );
+
+    // the children did not all stay with the worker that spawned them
+    bool spread = false;
+    for ( U32 i = 1; i < 256; ++ i )
+    {
+        if ( ! pthread_equal ( child_threads [ i ], child_threads [ 0 ] ) )
+            spread = true;
+    }
+    REQUIRE ( spread );
+}
+
+static
+void test_timers ()
+{
+    FUNC_ENTRY ();
+
+    WaitTask * waiting;
+    Task t = WaitTask :: make ( -1, 20 * 1000 * 1000, waiting );
+
+    I64 start = now_nS ();
+    sched . spawn ( t );
+    REQUIRE ( sched . drain () == ( U64 ) 0 );
+    REQUIRE ( waiting -> resumed );
+    REQUIRE ( now_nS () - start >= 19 * 1000 * 1000 );
+
+    // spawned later
+    atomic_t < U64 > runs ( 0 );
+    start = now_nS ();
+    sched . spawn_after ( SliceTask :: make ( 0, runs ), nS_t ( 10 * 1000 * 1000 ) );
+    REQUIRE ( sched . drain () == ( U64 ) 0 );
+    REQUIRE ( runs == ( U64 ) 1 );
+    REQUIRE ( now_nS () - start >= 9 * 1000 * 1000 );
+}
+
+static
+void * delayed_write ( void * data )
+{
+    usleep ( 20 * 1000 );
+    REQUIRE ( write ( * ( int * ) data, "x", 1 ) == 1 );
+    return 0;
+}
+
+static
+void test_io ()
+{
+    FUNC_ENTRY ();
+
+    int p [ 2 ];
+    REQUIRE ( pipe ( p ) == 0 );
+
+    WaitTask * waiting;
+    Task t = WaitTask :: make ( p [ 0 ], 0, waiting );
+    sched . spawn ( t );
+
+    pthread_t writer;
+    REQUIRE ( pthread_create ( & writer, 0, delayed_write, & p [ 1 ] ) == 0 );
+
+    REQUIRE ( sched . drain () == ( U64 ) 0 );
+    pthread_join ( writer, 0 );
+
+    REQUIRE ( waiting -> resumed );
+    REQUIRE ( waiting -> data == 'x' );
+
+    close ( p [ 0 ] );
+    close ( p [ 1 ] );
+}
+
+static
+void test_failure ()
+{
+    FUNC_ENTRY ();
+
+    atomic_t < U64 > runs ( 0 );
+    sched . spawn ( ThrowTask :: make () );
+    sched . spawn ( SliceTask :: make ( 3, runs ) );
+    REQUIRE ( sched . drain () == ( U64 ) 1 );
+    REQUIRE ( runs == ( U64 ) 4 );
+
+    // a task that may not be suspended fails when it waits,
+    // and the scheduler carries on
+    WaitTask * waiting;
+    Task t = WaitTask :: make ( -1, 1000, waiting );
+    sched . spawn ( Task ( t, CAP_SUSPEND ) );
+    t = Task ();
+    sched . spawn ( SliceTask :: make ( 0, runs ) );
+    REQUIRE ( sched . drain () == ( U64 ) 1 );
+    REQUIRE ( runs == ( U64 ) 5 );
+
+    // waiting belongs to a running task
+    bool thrown = false;
+    try
+    {
+        sched . wait ( nS_t ( 0 ) );
+    }
+    catch ( xc_program_state_violation & x )
+    {
+        thrown = true;
+    }
+    REQUIRE ( thrown );
+}
+
+int main ( int argc, char * argv [] )
+{
+    TopStk stk;
+    TopRsrc top ( "test-sched" );
+
+    try
+    {
+        sched = PrimordSched :: make ( 4 );
+
+        test_yield ();
+        test_steal ();
+        test_timers ();
+        test_io ();
+        test_failure ();
+
+        sched = Sched ();
+    }
+    catch ( exception & x )
+    {
+        NULTermString what = x . what ();
+        fprintf ( stderr, "%s - failed: %s\n", argv [ 0 ], ( const char * ) what );
+        return 1;
+    }
+    catch ( const char * msg )
+    {
+        fprintf ( stderr, "%s - failed: %s\n", argv [ 0 ], msg );
+        return 1;
+    }
+
+    fprintf ( stderr, "%s - succeeded\n", argv [ 0 ] );
+    return 0;
+}
@@ -0,0 +1,244 @@
+/*===========================================================================
+*
+*                            PUBLIC DOMAIN NOTICE
+*               National Center for Biotechnology Information
+*
+*  This software/database is a "United States Government Work" under the
+*  terms of the United States Copyright Act.  It was written as part of
+*  the author's official duties as a United States Government employee and
+*  thus cannot be copyrighted.  This software/database is freely available
+*  to the public for use. The National Library of Medicine and the U.S.
+*  Government have not placed any restriction on its use or reproduction.
+*
+*  Although all reasonable efforts have been taken to ensure the accuracy
+*  and reliability of the software and data, the NLM and the U.S.
+*  Government do not and cannot warrant the performance or results that
+*  may be obtained by using this software or data. The NLM and the U.S.
+*  Government disclaim all warranties, express or implied, including
+*  warranties of performance, merchantability or fitness for any particular
+*  purpose.
+*
+*  Please cite the author in any work or product based on this material.
+*
+* ===========================================================================
+*
+*/
+
+#include <kfc/callstk.hpp>
+#include <kfc/rsrc.hpp>
+#include <kfc/memory.hpp>
+#include <kfc/stream.hpp>
+#include <kfc/fdmgr.hpp>
+#include <kfc/fd.hpp>
+#include <kfc/array.hpp>
+#include <kfc/caps.hpp>
+#include <kfc/except.hpp>
+
+#include <unistd.h>
+#include <fcntl.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+
+using namespace vdb3;
+
+/*--------------------------------------------------------------------
+ * TopStk
+ *  the frame at the top of the call stack
+ */
+class TopStk : public CallStk
+{
+public:
+
+    TopStk ()
+        : CallStk ( s_src_loc )
+    {
+    }
+};
+
+#define REQUIRE( cond ) \
+    if ( ! ( cond ) ) throw "requirement failed: " # cond
+
+/*--------------------------------------------------------------------
+ * SinkImpl
+ *  a stream without a file descriptor, collecting what is written
+ */
+class SinkImpl : public Refcount
+    , implements StreamItf
+{
+public:
+
+    static Stream make ( SinkImpl * & obj )
+    {
+        obj = new SinkImpl;
+        return obj -> make_ref ( obj, CAP_WRITE );
+    }
+
+    virtual bytes_t write ( const bytes_t & num_bytes,
+        const Mem & src, const bytes_t & start )
+    {
+        const Array < U8 > a = src;
+        memcpy ( & data [ size ], & a [ start ], ( size_t ) ( U64 ) num_bytes );
+        size += ( U64 ) num_bytes;
+        return num_bytes;
+    }
+
+    virtual bytes_t get_mtu () const
+    {
+        return bytes_t ( 4096 );
+    }
+
+    U8 data [ 256 * 1024 ];
+    size_t size;
+
+private:
+
+    SinkImpl ()
+        : size ( 0 )
+    {
+    }
+};
+
+static const size_t test_size = 48 * 1024 + 123;
+static U8 pattern [ test_size ];
+
+// a temporary file holding the pattern
+static
+int make_file ( const char * name, bool fill )
+{
+    int fd = open ( name, O_RDWR | O_CREAT | O_TRUNC, 0600 );
+    REQUIRE ( fd >= 0 );
+    unlink ( name );
+    if ( fill )
+    {
+        REQUIRE ( write ( fd, pattern, test_size ) == ( ssize_t ) test_size );
+        REQUIRE ( lseek ( fd, 0, SEEK_SET ) == 0 );
+    }
+    return fd;
+}
+
+static
+void check_file ( int fd, size_t expected )
+{
+    static U8 buffer [ test_size ];
+    REQUIRE ( lseek ( fd, 0, SEEK_SET ) == 0 );
+    REQUIRE ( read ( fd, buffer, sizeof buffer ) == ( ssize_t ) expected );
+    REQUIRE ( memcmp ( buffer, pattern, expected ) == 0 );
+}
+
+static
+Stream make_stream ( int fd, caps_t caps )
+{
+    FileDesc desc = rsrc -> fdmgr . make ( fd, caps, true );
+    return Stream ( desc );
+}
+
+static
+void test_file_to_file ()
+{
+    FUNC_ENTRY ();
+
+    int src_fd = make_file ( "test-stream.src", true );
+    int dst_fd = make_file ( "test-stream.dst", false );
+    Stream src = make_stream ( src_fd, CAP_PROP_READ | CAP_READ );
+    Stream dst = make_stream ( dst_fd, CAP_WRITE );
+
+    // asks for more than the file holds
+    bytes_t zero_copy ( 0 );
+    bytes_t total = src . transfer_to ( dst, 1024 * 1024, zero_copy );
+    REQUIRE ( total == ( U64 ) test_size );
+    REQUIRE ( zero_copy == ( U64 ) test_size );
+    check_file ( dst_fd, test_size );
+}
+
+static
+void test_pipes ()
+{
+    FUNC_ENTRY ();
+
+    // the pattern fits within the pipe's buffer
+    int p [ 2 ];
+    REQUIRE ( pipe ( p ) == 0 );
+
+    int src_fd = make_file ( "test-stream.src", true );
+    Stream src = make_stream ( src_fd, CAP_PROP_READ | CAP_READ );
+    Stream pipe_in = make_stream ( p [ 1 ], CAP_WRITE );
+    Stream pipe_out = make_stream ( p [ 0 ], CAP_PROP_READ | CAP_READ );
+
+    // file into the pipe, stopping short
+    bytes_t zero_copy ( 0 );
+    bytes_t total = src . transfer_to ( pipe_in, test_size - 100, zero_copy );
+    REQUIRE ( total == ( U64 ) ( test_size - 100 ) );
+    REQUIRE ( zero_copy == total );
+    pipe_in = Stream ();
+
+    // and back out into a file, until end of stream
+    int dst_fd = make_file ( "test-stream.dst", false );
+    Stream dst = make_stream ( dst_fd, CAP_WRITE );
+    total = pipe_out . transfer_to ( dst, test_size, zero_copy );
+    REQUIRE ( total == ( U64 ) ( test_size - 100 ) );
+    REQUIRE ( zero_copy == total );
+    check_file ( dst_fd, test_size - 100 );
+}
+
+static
+void test_fallback ()
+{
+    FUNC_ENTRY ();
+
+    int src_fd = make_file ( "test-stream.src", true );
+    Stream src = make_stream ( src_fd, CAP_PROP_READ | CAP_READ );
+
+    SinkImpl * sink;
+    Stream dst = SinkImpl :: make ( sink );
+
+    bytes_t zero_copy ( 1 );
+    bytes_t total = src . transfer_to ( dst, test_size, zero_copy );
+    REQUIRE ( total == ( U64 ) test_size );
+    REQUIRE ( zero_copy == ( U64 ) 0 );
+    REQUIRE ( sink -> size == test_size );
+    REQUIRE ( memcmp ( sink -> data, pattern, test_size ) == 0 );
+
+    // requires read capability at the source
+    Stream write_only ( src, CAP_READ );
+    bool thrown = false;
+    try
+    {
+        write_only . transfer_to ( dst, test_size );
+    }
+    catch ( xc_caps_violation_err & x )
+    {
+        thrown = true;
+    }
+    REQUIRE ( thrown );
+}
+
+int main ( int argc, char * argv [] )
+{
+    TopStk stk;
+    TopRsrc top ( "test-stream" );
+
+    for ( size_t i = 0; i < test_size; ++ i )
+        pattern [ i ] = ( U8 ) ( i * 7 + ( i >> 9 ) );
+
+    try
+    {
+        test_file_to_file ();
+        test_pipes ();
+        test_fallback ();
+    }
+    catch ( exception & x )
+    {
+        NULTermString what = x . what ();
+        fprintf ( stderr, "%s - failed: %s\n", argv [ 0 ], ( const char * ) what );
+        return 1;
+    }
+    catch ( const char * msg )
+    {
+        fprintf ( stderr, "%s - failed: %s\n", argv [ 0 ], msg );
+        return 1;
+    }
+
+    fprintf ( stderr, "%s - succeeded\n", argv [ 0 ] );
+    return 0;
+}
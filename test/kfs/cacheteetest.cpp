@@ -397,6 +397,74 @@ TEST_CASE( CacheTee_Multiple_Users )
 }
 
 
+struct SharedTee
+{
+	const KFile * org;
+	const KFile * tee;
+	int id;
+};
+
+static rc_t CC shared_tee_thread_func( const KThread *self, void *data )
+{
+	SharedTee * shared = ( SharedTee * ) data;
+	rc_t rc = 0;
+	for ( int i = 0; rc == 0 && i < 64; ++i )
+	{
+		uint64_t pos = rand_32( 0, DATAFILESIZE - 1 );
+		size_t len = rand_32( 1, 1024 * 64 );
+		if ( pos + len > DATAFILESIZE )
+			len = DATAFILESIZE - pos;
+		rc = compare_file_content( shared -> org, shared -> tee, pos, len );
+	}
+	if ( rc != 0 )
+		KOutMsg( "Test: Thread #%d failed\n", shared -> id );
+	return rc;
+}
+
+
+TEST_CASE( CacheTee_Multiple_Threads_Shared_Tee )
+{
+	KOutMsg( "Test: CacheTee_Multiple_Threads_Shared_Tee\n" );
+	remove_file( CACHEFILE );	// to start with a clean slate on caching...
+	remove_file( CACHEFILE1 );
+
+    KDirectory * dir;
+    REQUIRE_RC( KDirectoryNativeDir( &dir ) );
+
+	const KFile * org;
+    REQUIRE_RC( KDirectoryOpenFileRead( dir, &org, "%s", DATAFILE ) );
+
+	/* one cache-tee, read concurrently by many threads */
+	const KFile * tee;
+	REQUIRE_RC( KDirectoryMakeCacheTee ( dir, &tee, org, 0, "%s", CACHEFILE ) );
+
+	const int n = 8;
+	KThread *t [ n ];
+	SharedTee shared[ n ];
+	for ( int i = 0; i < n; ++i )
+	{
+		shared[ i ] . org = org;
+		shared[ i ] . tee = tee;
+		shared[ i ] . id = i + 1;
+		REQUIRE_RC( KThreadMake ( &( t[ i ] ), shared_tee_thread_func, &( shared[ i ] ) ) );
+	}
+	for ( int i = 0; i < n; ++i )
+	{
+		rc_t rc_thread;
+		REQUIRE_RC( KThreadWait ( t[ i ], &rc_thread ) );
+		REQUIRE_RC( rc_thread );
+		REQUIRE_RC( KThreadRelease ( t[ i ] ) );
+	}
+
+	/* everything the threads have put into the cache has to be correct */
+	REQUIRE_RC( compare_file_content( org, tee, 0, DATAFILESIZE ) );
+	REQUIRE_RC( KFileRelease( tee ) );
+
+	REQUIRE_RC( KFileRelease( org ) );	
+	REQUIRE_RC( KDirectoryRelease( dir ) );
+}
+
+
 TEST_CASE( CacheTee_ReadOnly )
 {
 	KOutMsg( "Test: CacheTee_ReadOnly\n" );
@@ -35,6 +35,14 @@
 #include <kfs/directory.h>
 #include <kfs/impl.h>
 #include <kfs/tar.h>
+#include <kfs/pagecachefile.h>
+#include <kfs/gzip.h>
+#include <kfs/bzip.h>
+#include <kproc/thread.h>
+#include <kproc/lock.h>
+#include <kproc/cond.h>
+#include <kproc/timeout.h>
+#include <os-native.h> // timeout_t
 
 #include <kfs/ffext.h>
 #include <kfs/ffmagic.h>
@@ -165,6 +173,431 @@ TEST_CASE(Tar_Parse)
     REQUIRE_RC(KDirectoryRelease(dir));
 }                                 
 
+TEST_CASE(KPageCacheFile_Read_and_Stats)
+{
+    KDirectory *wd;
+    REQUIRE_RC(KDirectoryNativeDir ( & wd ));
+
+    const char* fileName="pagecache.file";
+    const size_t fileSize = 100 * 1024 + 17; // 4 pages, the last one partial
+    char * contents = (char*)malloc(fileSize);
+    REQUIRE_NOT_NULL(contents);
+    for ( size_t i = 0; i < fileSize; ++i )
+        contents[i] = (char)(i * 7);
+
+    {   // create temp file, close
+        KFile* file;
+        REQUIRE_RC(KDirectoryCreateFile(wd, &file, true, 0664, kcmInit, fileName));
+        size_t num_writ=0;
+        REQUIRE_RC(KFileWriteAll(file, 0, contents, fileSize, &num_writ));
+        REQUIRE_EQ(num_writ, fileSize);
+        REQUIRE_RC(KFileRelease(file));
+    }
+
+    const KFile* file;
+    REQUIRE_RC(KDirectoryOpenFileRead(wd, &file, fileName));
+    const KFile* cache;
+    REQUIRE_RC(KPageCacheFileMakeRead(&cache, file, 1024 * 1024));
+
+    uint64_t size;
+    REQUIRE_RC(KFileSize(cache, &size));
+    REQUIRE_EQ(size, (uint64_t)fileSize);
+
+    char buffer[ 40000 ];
+    size_t num_read;
+    // a read crossing a page boundary
+    REQUIRE_RC(KFileReadAll(cache, 30000, buffer, sizeof buffer, &num_read));
+    REQUIRE_EQ(num_read, sizeof buffer);
+    REQUIRE_EQ(memcmp(buffer, contents + 30000, num_read), 0);
+    // the same pages again
+    REQUIRE_RC(KFileReadAll(cache, 32768, buffer, 100, &num_read));
+    REQUIRE_EQ(memcmp(buffer, contents + 32768, num_read), 0);
+    // a read clipped at eof
+    REQUIRE_RC(KFileReadAll(cache, fileSize - 10, buffer, sizeof buffer, &num_read));
+    REQUIRE_EQ(num_read, (size_t)10);
+    REQUIRE_EQ(memcmp(buffer, contents + fileSize - 10, num_read), 0);
+
+    uint64_t hits, misses;
+    size_t cached;
+    REQUIRE_RC(KPageCacheFileStats(cache, &hits, &misses, &cached));
+    REQUIRE_EQ(misses, (uint64_t)4);
+    REQUIRE_EQ(hits, (uint64_t)1);
+    REQUIRE_EQ(cached, (size_t)4 * 32768);
+
+    // not a page cache file
+    REQUIRE_RC_FAIL(KPageCacheFileStats(file, &hits, &misses, &cached));
+
+    REQUIRE_RC(KFileRelease(cache));
+    REQUIRE_RC(KFileRelease(file));
+    free(contents);
+    REQUIRE_RC(KDirectoryRemove(wd, false, fileName));
+    REQUIRE_RC(KDirectoryRelease ( wd ));
+}
+
+// A mock KFile that forwards to another file, except that a read starting at
+// "GatedPos" waits until the test opens the gate, or gives up after a while.
+struct GatedReader
+{
+    KFile dad;
+    const KFile * original;
+    KLock * lock;
+    KCondition * cond;
+    bool entered;
+    bool open;
+    bool timed_out;
+
+    static const uint64_t GatedPos = 2 * 32768;
+    static const uint32_t TimeoutMs = 5000;
+
+    static rc_t MakeFileRead(GatedReader** f, const KFile * original)
+    {
+        GatedReader* ret=(GatedReader*)calloc(1, sizeof(GatedReader));
+        rc_t rc = KLockMake(&ret->lock);
+        if (rc == 0)
+            rc = KConditionMake(&ret->cond);
+        if (rc == 0)
+            rc = KFileInit(&ret->dad, (const KFile_vt*)&vt, "GatedReader", "gated", true, false);
+        if (rc == 0)
+            rc = KFileAddRef(original);
+        if (rc != 0)
+        {
+            destroy(&ret->dad);
+            return rc;
+        }
+        ret->original = original;
+        *f = ret;
+        return 0;
+    }
+    // waits until a read is held at the gate
+    rc_t WaitEntered()
+    {
+        rc_t rc = KLockAcquire(lock);
+        timeout_t tm;
+        TimeoutInit(&tm, TimeoutMs);
+        while (rc == 0 && !entered)
+            rc = KConditionTimedWait(cond, lock, &tm);
+        KLockUnlock(lock);
+        return rc;
+    }
+    void Open()
+    {
+        KLockAcquire(lock);
+        open = true;
+        KConditionBroadcast(cond);
+        KLockUnlock(lock);
+    }
+
+    static rc_t CC get_size ( const KFILE_IMPL *self, uint64_t *size )
+    {
+        return KFileSize(((const GatedReader*)self)->original, size);
+    }
+    static rc_t CC read( const KFILE_IMPL *cself, uint64_t pos, void *buffer, size_t bsize, size_t *num_read )
+    {
+        GatedReader* self = (GatedReader*)cself;
+        if (pos == GatedPos)
+        {
+            KLockAcquire(self->lock);
+            self->entered = true;
+            KConditionBroadcast(self->cond);
+            timeout_t tm;
+            TimeoutInit(&tm, TimeoutMs);
+            while (!self->open)
+            {
+                if (KConditionTimedWait(self->cond, self->lock, &tm) != 0)
+                {
+                    self->timed_out = true;
+                    break;
+                }
+            }
+            KLockUnlock(self->lock);
+        }
+        return KFileRead(self->original, pos, buffer, bsize, num_read);
+    }
+    static rc_t CC destroy( KFILE_IMPL *cself )
+    {
+        GatedReader* self = (GatedReader*)cself;
+        KFileRelease(self->original);
+        KConditionRelease(self->cond);
+        KLockRelease(self->lock);
+        free(self);
+        return 0;
+    }
+
+    // the rest of the functions do not matter
+    static struct KSysFile* CC get_sysfile ( const KFILE_IMPL *self, uint64_t *offset ) { *offset=0; return 0; }
+    static rc_t CC random_access ( const KFILE_IMPL *self ) { return 0; }
+    static rc_t CC set_size ( KFILE_IMPL *self, uint64_t size ) { return 0; }
+    static rc_t CC write( KFILE_IMPL *self, uint64_t pos, const void *buffer, size_t size, size_t *num_writ ) { *num_writ=0; return 0; }
+
+    static KFile_vt_v1 vt;
+};
+KFile_vt_v1 GatedReader::vt=
+{   1, 0,
+    GatedReader::destroy,
+    GatedReader::get_sysfile,
+    GatedReader::random_access,
+    GatedReader::get_size,
+    GatedReader::set_size,
+    GatedReader::read,
+    GatedReader::write
+};
+
+struct GatedRead
+{
+    const KFile * cache;
+    char buffer [ 100 ];
+};
+
+static rc_t CC gated_read_thread ( const KThread *self, void *data )
+{
+    GatedRead * r = ( GatedRead * ) data;
+    size_t num_read;
+    return KFileReadAll ( r -> cache, GatedReader::GatedPos, r -> buffer, sizeof r -> buffer, & num_read );
+}
+
+TEST_CASE(KPageCacheFile_HitsDuringSlowMiss)
+{
+    KDirectory *wd;
+    REQUIRE_RC(KDirectoryNativeDir ( & wd ));
+
+    const char* fileName="pagecache_mt.file";
+    const size_t fileSize = 4 * 32768;
+    char * contents = (char*)malloc(fileSize);
+    REQUIRE_NOT_NULL(contents);
+    for ( size_t i = 0; i < fileSize; ++i )
+        contents[i] = (char)(i * 13);
+
+    {   // create temp file, close
+        KFile* file;
+        REQUIRE_RC(KDirectoryCreateFile(wd, &file, true, 0664, kcmInit, fileName));
+        size_t num_writ=0;
+        REQUIRE_RC(KFileWriteAll(file, 0, contents, fileSize, &num_writ));
+        REQUIRE_RC(KFileRelease(file));
+    }
+
+    const KFile* file;
+    REQUIRE_RC(KDirectoryOpenFileRead(wd, &file, fileName));
+    GatedReader* gated;
+    REQUIRE_RC(GatedReader::MakeFileRead(&gated, file));
+    const KFile* cache;
+    REQUIRE_RC(KPageCacheFileMakeRead(&cache, &gated->dad, 1024 * 1024));
+
+    char buffer[ 100 ];
+    size_t num_read;
+    REQUIRE_RC(KFileReadAll(cache, 0, buffer, sizeof buffer, &num_read));
+
+    // another thread misses on page 2 and is held in the original file
+    GatedRead r;
+    r.cache = cache;
+    KThread* t;
+    REQUIRE_RC(KThreadMake(&t, gated_read_thread, &r));
+    REQUIRE_RC(gated->WaitEntered());
+
+    // meanwhile, a cached page and another missing one can still be read
+    for ( int i = 0; i < 100; ++i )
+    {
+        REQUIRE_RC(KFileReadAll(cache, 10 * i, buffer, sizeof buffer, &num_read));
+        REQUIRE_EQ(memcmp(buffer, contents + 10 * i, sizeof buffer), 0);
+    }
+    REQUIRE_RC(KFileReadAll(cache, 32768, buffer, sizeof buffer, &num_read));
+    REQUIRE_EQ(memcmp(buffer, contents + 32768, sizeof buffer), 0);
+
+    gated->Open();
+    rc_t rc_thread;
+    REQUIRE_RC(KThreadWait(t, &rc_thread));
+    REQUIRE_RC(rc_thread);
+    REQUIRE_RC(KThreadRelease(t));
+    REQUIRE_EQ(memcmp(r.buffer, contents + GatedReader::GatedPos, sizeof r.buffer), 0);
+    // had the reads above waited for the slow one, the gate would have timed out
+    REQUIRE(!gated->timed_out);
+
+    uint64_t hits, misses;
+    REQUIRE_RC(KPageCacheFileStats(cache, &hits, &misses, NULL));
+    REQUIRE_EQ(misses, (uint64_t)3);
+    REQUIRE_EQ(hits, (uint64_t)100);
+
+    REQUIRE_RC(KFileRelease(cache));
+    REQUIRE_RC(KFileRelease(&gated->dad));
+    REQUIRE_RC(KFileRelease(file));
+    free(contents);
+    REQUIRE_RC(KDirectoryRemove(wd, false, fileName));
+    REQUIRE_RC(KDirectoryRelease ( wd ));
+}
+
+TEST_CASE(KGzipIndex_RandomRead)
+{
+    KDirectory *wd;
+    REQUIRE_RC(KDirectoryNativeDir ( & wd ));
+
+    const char* fileName="gzipindex.gz";
+    const char* indexName="gzipindex.gz.idx";
+    const size_t fileSize = 3 * 1024 * 1024 + 5;
+    char * contents = (char*)malloc(fileSize);
+    REQUIRE_NOT_NULL(contents);
+    uint32_t seed = 1;
+    for ( size_t i = 0; i < fileSize; ++i )
+    {   // compressible, but not trivially so
+        seed = seed * 1103515245 + 12345;
+        contents[i] = "ACGT\n" [ ( seed >> 16 ) % 5 ];
+    }
+
+    {   // create the compressed file
+        KFile* file;
+        REQUIRE_RC(KDirectoryCreateFile(wd, &file, false, 0664, kcmInit, fileName));
+        KFile* gz;
+        REQUIRE_RC(KFileMakeGzipForWrite(&gz, file));
+        size_t num_writ=0;
+        REQUIRE_RC(KFileWriteAll(gz, 0, contents, fileSize, &num_writ));
+        REQUIRE_EQ(num_writ, fileSize);
+        REQUIRE_RC(KFileRelease(gz));
+        REQUIRE_RC(KFileRelease(file));
+    }
+
+    const KFile* file;
+    REQUIRE_RC(KDirectoryOpenFileRead(wd, &file, fileName));
+
+    char buffer[ 50000 ];
+    size_t num_read;
+    const KGzipIndex* idx;
+    {   // index built on the first pass
+        const KFile* gz;
+        REQUIRE_RC(KFileMakeGzipIndexedForRead(&gz, file, NULL, 64 * 1024));
+        REQUIRE_RC_FAIL(KFileGzipIndex(gz, &idx));
+        // reading backward works even before the index is complete
+        REQUIRE_RC(KFileReadAll(gz, 200000, buffer, sizeof buffer, &num_read));
+        REQUIRE_EQ(memcmp(buffer, contents + 200000, num_read), 0);
+        REQUIRE_RC(KFileReadAll(gz, 1000, buffer, sizeof buffer, &num_read));
+        REQUIRE_EQ(memcmp(buffer, contents + 1000, num_read), 0);
+        // run to the end
+        REQUIRE_RC(KFileReadAll(gz, fileSize - 10, buffer, sizeof buffer, &num_read));
+        REQUIRE_EQ(num_read, (size_t)10);
+        REQUIRE_EQ(memcmp(buffer, contents + fileSize - 10, num_read), 0);
+
+        uint64_t size;
+        REQUIRE_RC(KFileSize(gz, &size));
+        REQUIRE_EQ(size, (uint64_t)fileSize);
+        REQUIRE_RC(KFileGzipIndex(gz, &idx));
+        REQUIRE_RC(KFileRelease(gz));
+    }
+
+    {   // save and reload
+        KFile* out;
+        REQUIRE_RC(KDirectoryCreateFile(wd, &out, false, 0664, kcmInit, indexName));
+        REQUIRE_RC(KGzipIndexSave(idx, out));
+        REQUIRE_RC(KFileRelease(out));
+        REQUIRE_RC(KGzipIndexRelease(idx));
+
+        const KFile* in;
+        REQUIRE_RC(KDirectoryOpenFileRead(wd, &in, indexName));
+        REQUIRE_RC(KGzipIndexLoad(&idx, in));
+        REQUIRE_RC(KFileRelease(in));
+    }
+
+    {   // random reads through a loaded index
+        const KFile* gz;
+        REQUIRE_RC(KFileMakeGzipIndexedForRead(&gz, file, idx, 0));
+        const uint64_t positions [] = { 2500000, 10, 1048576, 3000000, 65536, 2500001 };
+        for ( size_t i = 0; i < sizeof positions / sizeof positions [ 0 ]; ++i )
+        {
+            REQUIRE_RC(KFileReadAll(gz, positions[i], buffer, sizeof buffer, &num_read));
+            REQUIRE_EQ(num_read, sizeof buffer);
+            REQUIRE_EQ(memcmp(buffer, contents + positions[i], num_read), 0);
+        }
+        REQUIRE_RC(KFileRelease(gz));
+    }
+
+    {   // an index built on demand matches the loaded one
+        const KGzipIndex* idx2;
+        REQUIRE_RC(KGzipIndexMake(&idx2, file, 0));
+        const KFile* gz;
+        REQUIRE_RC(KFileMakeGzipIndexedForRead(&gz, file, idx2, 0));
+        REQUIRE_RC(KFileReadAll(gz, 1234567, buffer, sizeof buffer, &num_read));
+        REQUIRE_EQ(memcmp(buffer, contents + 1234567, num_read), 0);
+        REQUIRE_RC(KFileRelease(gz));
+        REQUIRE_RC(KGzipIndexRelease(idx2));
+    }
+
+    // not an indexed gzip file
+    const KGzipIndex* none;
+    REQUIRE_RC_FAIL(KFileGzipIndex(file, &none));
+
+    REQUIRE_RC(KGzipIndexRelease(idx));
+    REQUIRE_RC(KFileRelease(file));
+    free(contents);
+    REQUIRE_RC(KDirectoryRemove(wd, false, indexName));
+    REQUIRE_RC(KDirectoryRemove(wd, false, fileName));
+    REQUIRE_RC(KDirectoryRelease ( wd ));
+}
+
+TEST_CASE(KBzip2_ParallelRead)
+{
+    KDirectory *wd;
+    REQUIRE_RC(KDirectoryNativeDir ( & wd ));
+
+    const char* fileName="parallel.bz2";
+    const size_t fileSize = 4 * 1024 * 1024 + 11; // several 900K blocks
+    char * contents = (char*)malloc(fileSize);
+    REQUIRE_NOT_NULL(contents);
+    uint32_t seed = 7;
+    for ( size_t i = 0; i < fileSize; ++i )
+    {
+        seed = seed * 1103515245 + 12345;
+        contents[i] = "ACGTN\n" [ ( seed >> 16 ) % 6 ];
+    }
+
+    {   // create the compressed file
+        KFile* file;
+        REQUIRE_RC(KDirectoryCreateFile(wd, &file, false, 0664, kcmInit, fileName));
+        KFile* bz;
+        REQUIRE_RC(KFileMakeBzip2ForWrite(&bz, file));
+        size_t num_writ=0;
+        REQUIRE_RC(KFileWriteAll(bz, 0, contents, fileSize, &num_writ));
+        REQUIRE_EQ(num_writ, fileSize);
+        REQUIRE_RC(KFileRelease(bz));
+        REQUIRE_RC(KFileRelease(file));
+    }
+
+    const KFile* file;
+    REQUIRE_RC(KDirectoryOpenFileRead(wd, &file, fileName));
+
+    char buffer[ 100000 ];
+    size_t num_read;
+    {   // a serial pass, in odd sized pieces
+        const KFile* bz;
+        REQUIRE_RC(KFileMakeBzip2ForParallelRead(&bz, file, 3));
+        uint64_t pos = 0;
+        while ( true )
+        {
+            REQUIRE_RC(KFileRead(bz, pos, buffer, 77777, &num_read));
+            if ( num_read == 0 )
+                break;
+            REQUIRE_EQ(memcmp(buffer, contents + pos, num_read), 0);
+            pos += num_read;
+        }
+        REQUIRE_EQ(pos, (uint64_t)fileSize);
+        REQUIRE_RC(KFileRelease(bz));
+    }
+
+    {   // skipping forward
+        const KFile* bz;
+        REQUIRE_RC(KFileMakeBzip2ForParallelRead(&bz, file, 0));
+        REQUIRE_RC(KFileReadAll(bz, 1000000, buffer, sizeof buffer, &num_read));
+        REQUIRE_EQ(num_read, sizeof buffer);
+        REQUIRE_EQ(memcmp(buffer, contents + 1000000, num_read), 0);
+        REQUIRE_RC(KFileReadAll(bz, fileSize - 5, buffer, sizeof buffer, &num_read));
+        REQUIRE_EQ(num_read, (size_t)5);
+        REQUIRE_EQ(memcmp(buffer, contents + fileSize - 5, num_read), 0);
+        // serial only
+        REQUIRE_RC_FAIL(KFileRead(bz, 0, buffer, sizeof buffer, &num_read));
+        REQUIRE_RC(KFileRelease(bz));
+    }
+
+    REQUIRE_RC(KFileRelease(file));
+    free(contents);
+    REQUIRE_RC(KDirectoryRemove(wd, false, fileName));
+    REQUIRE_RC(KDirectoryRelease ( wd ));
+}
+
 //////////////////////////////////////////// Main
 extern "C"
 {
@@ -0,0 +1,168 @@
+/*===========================================================================
+*
+*                            PUBLIC DOMAIN NOTICE
+*               National Center for Biotechnology Information
+*
+*  This software/database is a "United States Government Work" under the
+*  terms of the United States Copyright Act.  It was written as part of
+*  the author's official duties as a United States Government employee and
+*  thus cannot be copyrighted.  This software/database is freely available
+*  to the public for use. The National Library of Medicine and the U.S.
+*  Government have not placed any restriction on its use or reproduction.
+*
+*  Although all reasonable efforts have been taken to ensure the accuracy
+*  and reliability of the software and data, the NLM and the U.S.
+*  Government do not and cannot warrant the performance or results that
+*  may be obtained by using this software or data. The NLM and the U.S.
+*  Government disclaim all warranties, express or implied, including
+*  warranties of performance, merchantability or fitness for any particular
+*  purpose.
+*
+*  Please cite the author in any work or product based on this material.
+*
+* ===========================================================================
+*
+*/
+
+/*
+ * throughput of Pack and Unpack for every element width,
+ * in MB of unpacked data per second. meant to be run by hand
+ * to compare kernels across processors, not as part of the tests.
+ */
+
+#include <klib/pack.h>
+#include <klib/rc.h>
+#include <klib/out.h>
+#include <klib/time.h>
+#include <kapp/main.h>
+#include <kapp/args.h>
+
+#include <stdlib.h>
+#include <string.h>
+
+#define BENCH_BYTES ( 1024 * 1024 )
+#define BENCH_MS 200
+
+static uint64_t seed = 88172645463325252ULL;
+
+static
+uint64_t Random ( void )
+{
+    seed ^= seed << 13;
+    seed ^= seed >> 7;
+    seed ^= seed << 17;
+    return seed;
+}
+
+static
+void Fill ( void *src, uint32_t unpacked, uint32_t packed, size_t count )
+{
+    size_t i;
+    uint64_t mask = packed == 64 ? ~ ( uint64_t ) 0 : ( ( uint64_t ) 1 << packed ) - 1;
+
+    for ( i = 0; i < count; ++ i )
+    {
+        uint64_t v = Random () & mask;
+        switch ( unpacked )
+        {
+        case 8:  ( ( uint8_t* ) src ) [ i ] = ( uint8_t ) v; break;
+        case 16: ( ( uint16_t* ) src ) [ i ] = ( uint16_t ) v; break;
+        case 32: ( ( uint32_t* ) src ) [ i ] = ( uint32_t ) v; break;
+        default: ( ( uint64_t* ) src ) [ i ] = v; break;
+        }
+    }
+}
+
+static
+rc_t Bench ( uint32_t unpacked, uint32_t packed, void *src, void *packed_buf, void *dst )
+{
+    rc_t rc = 0;
+    size_t count = BENCH_BYTES / ( unpacked >> 3 );
+    uint64_t pack_bytes = 0, unpack_bytes = 0;
+    KTimeMs_t start, pack_ms, unpack_ms;
+
+    Fill ( src, unpacked, packed, count );
+
+    start = KTimeMsStamp ();
+    do
+    {
+        bitsz_t psize;
+        rc = Pack ( unpacked, packed, src, BENCH_BYTES, NULL,
+            packed_buf, 0, ( bitsz_t ) BENCH_BYTES * 8, & psize );
+        pack_bytes += BENCH_BYTES;
+        pack_ms = KTimeMsStamp () - start;
+    }
+    while ( rc == 0 && pack_ms < BENCH_MS );
+
+    start = KTimeMsStamp ();
+    while ( rc == 0 )
+    {
+        size_t usize;
+        rc = Unpack ( packed, unpacked, packed_buf, 0, ( bitsz_t ) count * packed, NULL,
+            dst, BENCH_BYTES, & usize );
+        unpack_bytes += BENCH_BYTES;
+        unpack_ms = KTimeMsStamp () - start;
+        if ( unpack_ms >= BENCH_MS )
+            break;
+    }
+
+    if ( rc == 0 && memcmp ( src, dst, BENCH_BYTES ) != 0 )
+        rc = RC ( rcExe, rcBuffer, rcValidating, rcData, rcCorrupt );
+
+    if ( rc == 0 )
+    {
+        rc = KOutMsg ( "%2u -> %2u bits: pack %6lu MB/s, unpack %6lu MB/s\n",
+            unpacked, packed,
+            ( uint64_t ) ( pack_bytes / 1000 / pack_ms ),
+            ( uint64_t ) ( unpack_bytes / 1000 / unpack_ms ) );
+    }
+
+    return rc;
+}
+
+ver_t CC KAppVersion ( void )
+{
+    return 0;
+}
+
+const char UsageDefaultName[] = "test-pack-bench";
+
+rc_t CC UsageSummary ( const char * progname )
+{
+    return KOutMsg (
+        "Usage:\n"
+        " %s\n"
+        "\n"
+        "    measure Pack and Unpack throughput for every element width\n"
+        "\n", progname );
+}
+
+rc_t CC Usage ( const Args * args )
+{
+    return UsageSummary ( UsageDefaultName );
+}
+
+rc_t CC KMain ( int argc, char *argv [] )
+{
+    rc_t rc = 0;
+    uint32_t unpacked, packed;
+
+    void *src = malloc ( BENCH_BYTES );
+    void *packed_buf = malloc ( BENCH_BYTES );
+    void *dst = malloc ( BENCH_BYTES );
+
+    if ( src == NULL || packed_buf == NULL || dst == NULL )
+        rc = RC ( rcExe, rcBuffer, rcAllocating, rcMemory, rcExhausted );
+
+    for ( unpacked = 8; rc == 0 && unpacked <= 64; unpacked <<= 1 )
+    {
+        for ( packed = 1; rc == 0 && packed <= unpacked; ++ packed )
+            rc = Bench ( unpacked, packed, src, packed_buf, dst );
+    }
+
+    free ( dst );
+    free ( packed_buf );
+    free ( src );
+
+    return rc;
+}
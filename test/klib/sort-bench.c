@@ -0,0 +1,250 @@
+/*===========================================================================
+*
+*                            PUBLIC DOMAIN NOTICE
+*               National Center for Biotechnology Information
+*
+*  This software/database is a "United States Government Work" under the
+*  terms of the United States Copyright Act.  It was written as part of
+*  the author's official duties as a United States Government employee and
+*  thus cannot be copyrighted.  This software/database is freely available
+*  to the public for use. The National Library of Medicine and the U.S.
+*  Government have not placed any restriction on its use or reproduction.
+*
+*  Although all reasonable efforts have been taken to ensure the accuracy
+*  and reliability of the software and data, the NLM and the U.S.
+*  Government do not and cannot warrant the performance or results that
+*  may be obtained by using this software or data. The NLM and the U.S.
+*  Government disclaim all warranties, express or implied, including
+*  warranties of performance, merchantability or fitness for any particular
+*  purpose.
+*
+*  Please cite the author in any work or product based on this material.
+*
+* ===========================================================================
+*
+*/
+
+/*
+ * time of the radix and parallel sorts against ksort on the same
+ * random input, in milliseconds. meant to be run by hand, not as
+ * part of the tests.
+ */
+
+#include <klib/sort.h>
+#include <klib/rc.h>
+#include <klib/out.h>
+#include <klib/printf.h>
+#include <klib/time.h>
+#include <kproc/psort.h>
+#include <kapp/main.h>
+#include <kapp/args.h>
+
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define BENCH_ELEMS ( 4 * 1024 * 1024 )
+
+static uint64_t seed = 88172645463325252ULL;
+
+static
+uint64_t Random ( void )
+{
+    seed ^= seed << 13;
+    seed ^= seed >> 7;
+    seed ^= seed << 17;
+    return seed;
+}
+
+/* a record with its key in the middle, as alignment tools tend to have */
+typedef struct BenchRecord BenchRecord;
+struct BenchRecord
+{
+    uint32_t id;
+    uint32_t len;
+    int64_t pos;
+    uint64_t payload;
+};
+
+static
+int CC CompareU64 ( const void *a, const void *b, void *data )
+{
+    uint64_t x = * ( const uint64_t* ) a;
+    uint64_t y = * ( const uint64_t* ) b;
+    return x < y ? -1 : x > y;
+}
+
+static
+int CC CompareRecord ( const void *a, const void *b, void *data )
+{
+    int64_t x = ( ( const BenchRecord* ) a ) -> pos;
+    int64_t y = ( ( const BenchRecord* ) b ) -> pos;
+    return x < y ? -1 : x > y;
+}
+
+static
+rc_t Report ( const char *name, KTimeMs_t base_ms, KTimeMs_t ms,
+    const void *base, const void *test, size_t bytes )
+{
+    if ( memcmp ( base, test, bytes ) != 0 )
+        return RC ( rcExe, rcBuffer, rcValidating, rcData, rcCorrupt );
+
+    return KOutMsg ( "%-28s %6lu ms  ksort %6lu ms  x%lu.%02lu\n", name,
+        ( uint64_t ) ms, ( uint64_t ) base_ms,
+        ( uint64_t ) ( base_ms / ( ms ? ms : 1 ) ),
+        ( uint64_t ) ( ( base_ms * 100 / ( ms ? ms : 1 ) ) % 100 ) );
+}
+
+static
+rc_t BenchIntegers ( uint64_t *orig, uint64_t *base, uint64_t *test )
+{
+    rc_t rc;
+    size_t i;
+    KTimeMs_t start, base_ms, ms;
+    uint32_t *orig32 = ( uint32_t* ) orig, *base32 = ( uint32_t* ) base, *test32 = ( uint32_t* ) test;
+
+    for ( i = 0; i < BENCH_ELEMS; ++ i )
+        orig [ i ] = Random ();
+
+    memmove ( base, orig, BENCH_ELEMS * sizeof * orig );
+    start = KTimeMsStamp ();
+    ksort_uint64_t ( base, BENCH_ELEMS );
+    base_ms = KTimeMsStamp () - start;
+
+    memmove ( test, orig, BENCH_ELEMS * sizeof * orig );
+    start = KTimeMsStamp ();
+    rc = kradix_sort_uint64_t ( test, BENCH_ELEMS );
+    ms = KTimeMsStamp () - start;
+    if ( rc == 0 )
+        rc = Report ( "kradix_sort_uint64_t", base_ms, ms, base, test, BENCH_ELEMS * sizeof * test );
+
+    /* the first half of the same bytes as 32-bit keys */
+    if ( rc == 0 )
+    {
+        memmove ( base32, orig32, BENCH_ELEMS * sizeof * orig32 );
+        start = KTimeMsStamp ();
+        ksort_uint32_t ( base32, BENCH_ELEMS );
+        base_ms = KTimeMsStamp () - start;
+
+        memmove ( test32, orig32, BENCH_ELEMS * sizeof * orig32 );
+        start = KTimeMsStamp ();
+        rc = kradix_sort_uint32_t ( test32, BENCH_ELEMS );
+        ms = KTimeMsStamp () - start;
+        if ( rc == 0 )
+            rc = Report ( "kradix_sort_uint32_t", base_ms, ms, base32, test32, BENCH_ELEMS * sizeof * test32 );
+    }
+
+    return rc;
+}
+
+static
+rc_t BenchRecords ( BenchRecord *orig, BenchRecord *base, BenchRecord *test )
+{
+    rc_t rc = 0;
+    size_t i;
+    KTimeMs_t start, base_ms, ms;
+
+    for ( i = 0; i < BENCH_ELEMS; ++ i )
+    {
+        /* positions along a 3G genome, unique so the order is defined */
+        orig [ i ] . pos = ( int64_t ) ( ( Random () % 3000000 ) << 22 ) + ( int64_t ) i;
+        orig [ i ] . id = ( uint32_t ) i;
+        orig [ i ] . len = ( uint32_t ) Random () % 1000;
+        orig [ i ] . payload = Random ();
+    }
+
+    memmove ( base, orig, BENCH_ELEMS * sizeof * orig );
+    start = KTimeMsStamp ();
+    ksort ( base, BENCH_ELEMS, sizeof * base, CompareRecord, NULL );
+    base_ms = KTimeMsStamp () - start;
+
+    memmove ( test, orig, BENCH_ELEMS * sizeof * orig );
+    start = KTimeMsStamp ();
+    rc = kradix_sort_records ( test, BENCH_ELEMS, sizeof * test,
+        offsetof ( BenchRecord, pos ), sizeof test -> pos, true );
+    ms = KTimeMsStamp () - start;
+    if ( rc == 0 )
+        rc = Report ( "kradix_sort_records", base_ms, ms, base, test, BENCH_ELEMS * sizeof * test );
+
+    return rc;
+}
+
+static
+rc_t BenchParallel ( uint64_t *orig, uint64_t *base, uint64_t *test )
+{
+    rc_t rc = 0;
+    size_t i;
+    uint32_t threads;
+    KTimeMs_t start, base_ms, ms;
+
+    for ( i = 0; i < BENCH_ELEMS; ++ i )
+        orig [ i ] = Random ();
+
+    memmove ( base, orig, BENCH_ELEMS * sizeof * orig );
+    start = KTimeMsStamp ();
+    ksort ( base, BENCH_ELEMS, sizeof * base, CompareU64, NULL );
+    base_ms = KTimeMsStamp () - start;
+
+    for ( threads = 2; rc == 0 && threads <= 16; threads <<= 1 )
+    {
+        char name [ 64 ];
+        memmove ( test, orig, BENCH_ELEMS * sizeof * orig );
+        start = KTimeMsStamp ();
+        rc = ksort_parallel ( test, BENCH_ELEMS, sizeof * test, CompareU64, NULL, threads );
+        ms = KTimeMsStamp () - start;
+        if ( rc == 0 )
+        {
+            string_printf ( name, sizeof name, NULL, "ksort_parallel %u threads", threads );
+            rc = Report ( name, base_ms, ms, base, test, BENCH_ELEMS * sizeof * test );
+        }
+    }
+
+    return rc;
+}
+
+ver_t CC KAppVersion ( void )
+{
+    return 0;
+}
+
+const char UsageDefaultName[] = "test-sort-bench";
+
+rc_t CC UsageSummary ( const char * progname )
+{
+    return KOutMsg (
+        "Usage:\n"
+        " %s\n"
+        "\n"
+        "    compare radix and parallel sorts with ksort\n"
+        "\n", progname );
+}
+
+rc_t CC Usage ( const Args * args )
+{
+    return UsageSummary ( UsageDefaultName );
+}
+
+rc_t CC KMain ( int argc, char *argv [] )
+{
+    rc_t rc = 0;
+
+    void *orig = malloc ( BENCH_ELEMS * sizeof ( BenchRecord ) );
+    void *base = malloc ( BENCH_ELEMS * sizeof ( BenchRecord ) );
+    void *test = malloc ( BENCH_ELEMS * sizeof ( BenchRecord ) );
+
+    if ( orig == NULL || base == NULL || test == NULL )
+        rc = RC ( rcExe, rcBuffer, rcAllocating, rcMemory, rcExhausted );
+
+    if ( rc == 0 )
+        rc = BenchIntegers ( orig, base, test );
+    if ( rc == 0 )
+        rc = BenchRecords ( orig, base, test );
+    if ( rc == 0 )
+        rc = BenchParallel ( orig, base, test );
+
+    free ( test );
+    free ( base );
+    free ( orig );
+
+    return rc;
+}
@@ -33,14 +33,21 @@
 #include <klib/sort.h>
 #include <klib/printf.h>
 #include <klib/data-buffer.h>
+#include <klib/pack.h>
+#include <klib/checksum.h>
 #include <klib/log.h>
 #include <klib/num-gen.h>
 #include <klib/text.h>
 #include <klib/misc.h> /* is_user_admin() */
+#include <klib/prof.h>
 
+#include "../../libs/klib/pack-priv.h" /* PackForceScalar */
+
+#include <cstddef>
 #include <cstdlib>
 #include <cstring>
 #include <stdexcept>
+#include <string>
 #include <stdint.h>
 
 using namespace std;
@@ -366,7 +373,90 @@ TEST_CASE(KSORT_int64)
 
     ksort_int64_t (karr, Size);
     ksort(qarr, Size, ElemSize, cmp_int64_t , 0);
-    REQUIRE_EQ(memcmp(karr, qarr, sizeof(karr)), 0);    
+    REQUIRE_EQ(memcmp(karr, qarr, sizeof(karr)), 0);
+}
+
+///////////////////////////////////////////////// radix sort
+
+TEST_CASE(KLib_kradix_sort_null)
+{
+    REQUIRE_RC(kradix_sort_int64_t(0, 0));
+    REQUIRE_RC_FAIL(kradix_sort_int64_t(0, 1));
+    REQUIRE_RC_FAIL(kradix_sort_records(0, 1, 8, 0, 8, false));
+}
+
+TEST_CASE(KLib_kradix_sort_int64_vs_ksort)
+{
+    // long enough to take the radix path, with negative keys and keys
+    // that share their upper bytes
+    const size_t Size = 10000;
+    int64_t * rarr = new int64_t [ Size ];
+    int64_t * karr = new int64_t [ Size ];
+    uint64_t x = 88172645463325252ULL;
+    for ( size_t i = 0; i < Size; ++ i )
+    {
+        x ^= x << 13; x ^= x >> 7; x ^= x << 17;
+        rarr [ i ] = ( int64_t ) x >> ( i % 48 );
+    }
+    memcpy(karr, rarr, Size * sizeof * rarr);
+
+    REQUIRE_RC(kradix_sort_int64_t(rarr, Size));
+    ksort_int64_t(karr, Size);
+    REQUIRE_EQ(memcmp(rarr, karr, Size * sizeof * rarr), 0);
+
+    delete [] rarr;
+    delete [] karr;
+}
+
+TEST_CASE(KLib_kradix_sort_uint32_vs_ksort)
+{
+    const size_t Size = 10000;
+    uint32_t * rarr = new uint32_t [ Size ];
+    uint32_t * karr = new uint32_t [ Size ];
+    for ( size_t i = 0; i < Size; ++ i )
+        rarr [ i ] = ( uint32_t ) ( i * 2654435761U ) & 0xFF00FFFF;
+    memcpy(karr, rarr, Size * sizeof * rarr);
+
+    REQUIRE_RC(kradix_sort_uint32_t(rarr, Size));
+    ksort_uint32_t(karr, Size);
+    REQUIRE_EQ(memcmp(rarr, karr, Size * sizeof * rarr), 0);
+
+    delete [] rarr;
+    delete [] karr;
+}
+
+struct RadixRecord
+{
+    uint32_t payload;
+    int16_t key;
+    char tag [ 10 ];
+};
+
+TEST_CASE(KLib_kradix_sort_records)
+{
+    const size_t Size = 5000;
+    RadixRecord * arr = new RadixRecord [ Size ];
+    for ( size_t i = 0; i < Size; ++ i )
+    {
+        arr [ i ] . key = ( int16_t ) ( i * 40503 );
+        arr [ i ] . payload = ( uint32_t ) arr [ i ] . key * 3;
+        memset ( arr [ i ] . tag, ( char ) i, sizeof arr [ i ] . tag );
+    }
+
+    REQUIRE_RC(kradix_sort_records(arr, Size, sizeof * arr, offsetof(RadixRecord, key), sizeof arr -> key, true));
+    for ( size_t i = 0; i < Size; ++ i )
+    {
+        // payload travels with its key
+        REQUIRE_EQ(arr [ i ] . payload, ( uint32_t ) arr [ i ] . key * 3);
+        if ( i > 0 )
+            REQUIRE_LE(arr [ i - 1 ] . key, arr [ i ] . key);
+    }
+
+    // bad key descriptions
+    REQUIRE_RC_FAIL(kradix_sort_records(arr, Size, sizeof * arr, offsetof(RadixRecord, key), 3, true));
+    REQUIRE_RC_FAIL(kradix_sort_records(arr, Size, sizeof * arr, sizeof * arr - 1, 2, true));
+
+    delete [] arr;
 }
 
 
@@ -558,6 +648,135 @@ TEST_CASE(KDataBuffer_Resize)
     KDataBufferWhack ( & src );
 }
 
+TEST_CASE(KDataBuffer_Pool_OffByDefault)
+{
+    KDataBufferPoolStats before, after;
+    REQUIRE_RC ( KDataBufferPoolGetStats ( & before ) );
+
+    KDataBuffer buf;
+    REQUIRE_RC ( KDataBufferMakeBytes ( & buf, 10000 ) );
+    KDataBufferWhack ( & buf );
+    REQUIRE_RC ( KDataBufferMakeBytes ( & buf, 9000 ) );
+
+    REQUIRE_RC ( KDataBufferPoolGetStats ( & after ) );
+    REQUIRE_EQ ( before . allocations + 2, after . allocations );
+    REQUIRE_EQ ( before . pool_hits, after . pool_hits );
+    REQUIRE_EQ ( ( uint64_t ) 0, after . cached_bytes );
+
+    KDataBufferWhack ( & buf );
+    REQUIRE ( ! KDataBufferPoolEnable ( false ) );
+}
+
+TEST_CASE(KDataBuffer_Pool_Reuse)
+{
+    const bool prior = KDataBufferPoolEnable ( true );
+    KDataBufferPoolStats before, after;
+    REQUIRE_RC ( KDataBufferPoolGetStats ( & before ) );
+
+    KDataBuffer buf;
+    REQUIRE_RC ( KDataBufferMakeBytes ( & buf, 10000 ) );
+    memset ( buf . base, 1, 10000 );
+    KDataBufferWhack ( & buf );
+
+    /* same size class, served from the thread cache */
+    REQUIRE_RC ( KDataBufferMakeBytes ( & buf, 9000 ) );
+    memset ( buf . base, 2, 9000 );
+    REQUIRE_RC ( KDataBufferCheckIntegrity ( & buf ) );
+
+    REQUIRE_RC ( KDataBufferPoolGetStats ( & after ) );
+    REQUIRE_EQ ( before . allocations + 2, after . allocations );
+    REQUIRE_LT ( before . pool_hits, after . pool_hits );
+    REQUIRE_LT ( before . live_bytes, after . live_bytes );
+
+    KDataBufferWhack ( & buf );
+    REQUIRE_RC ( KDataBufferPoolGetStats ( & after ) );
+    REQUIRE_EQ ( before . live_bytes, after . live_bytes );
+
+    KDataBufferPoolEnable ( prior );
+}
+
+TEST_CASE(KDataBuffer_Pool_ResizeInPlace)
+{
+    const bool prior = KDataBufferPoolEnable ( true );
+    KDataBufferPoolStats before, after;
+    REQUIRE_RC ( KDataBufferPoolGetStats ( & before ) );
+
+    KDataBuffer buf;
+    REQUIRE_RC ( KDataBufferMakeBytes ( & buf, 20000 ) );
+    memset ( buf . base, 3, 20000 );
+    void * base = buf . base;
+
+    /* 20000 and 30000 share the 32K class */
+    REQUIRE_RC ( KDataBufferResize ( & buf, 30000 ) );
+    REQUIRE_EQ ( base, buf . base );
+    REQUIRE_EQ ( ( uint8_t ) 3, ( ( uint8_t * ) buf . base ) [ 19999 ] );
+
+    REQUIRE_RC ( KDataBufferPoolGetStats ( & after ) );
+    REQUIRE_EQ ( before . resized_in_place + 1, after . resized_in_place );
+
+    /* a shared buffer is never grown in place */
+    KDataBuffer copy;
+    REQUIRE_RC ( KDataBufferSub ( & buf, & copy, 0, UINT64_MAX ) );
+    REQUIRE ( ! KDataBufferWritable ( & buf ) );
+    REQUIRE_RC_FAIL ( KDataBufferResize ( & buf, 40000 ) );
+
+    KDataBufferWhack ( & copy );
+    KDataBufferWhack ( & buf );
+    KDataBufferPoolEnable ( prior );
+}
+
+TEST_CASE(KDataBuffer_Pool_Huge)
+{
+    const bool prior = KDataBufferPoolEnable ( true );
+    const size_t Size = 5 << 20;
+    KDataBuffer buf;
+    REQUIRE_RC ( KDataBufferMakeBytes ( & buf, Size ) );
+    memset ( buf . base, 4, Size );
+
+    KDataBuffer sub;
+    REQUIRE_RC ( KDataBufferSub ( & buf, & sub, Size - 10, 10 ) );
+    REQUIRE_EQ ( ( uint8_t ) 4, ( ( uint8_t * ) sub . base ) [ 9 ] );
+
+    /* copy-on-write still applies */
+    KDataBuffer writable;
+    REQUIRE_RC ( KDataBufferMakeWritable ( & sub, & writable ) );
+    REQUIRE_NE ( sub . base, writable . base );
+    ( ( uint8_t * ) writable . base ) [ 0 ] = 5;
+    REQUIRE_EQ ( ( uint8_t ) 4, ( ( uint8_t * ) sub . base ) [ 0 ] );
+
+    KDataBufferWhack ( & writable );
+    KDataBufferWhack ( & sub );
+
+    /* sole reference again, so it can grow */
+    REQUIRE_RC ( KDataBufferResize ( & buf, Size * 2 ) );
+    REQUIRE_EQ ( ( uint8_t ) 4, ( ( uint8_t * ) buf . base ) [ Size - 1 ] );
+
+    KDataBufferWhack ( & buf );
+    KDataBufferPoolEnable ( prior );
+}
+
+TEST_CASE(KDataBuffer_Pool_Disable)
+{
+    KDataBuffer pooled, plain;
+    const bool prior = KDataBufferPoolEnable ( true );
+    REQUIRE_RC ( KDataBufferMakeBytes ( & pooled, 1000 ) );
+
+    REQUIRE ( KDataBufferPoolEnable ( false ) );
+    REQUIRE_RC ( KDataBufferMakeBytes ( & plain, 1000 ) );
+    REQUIRE_RC ( KDataBufferResize ( & pooled, 100000 ) );
+    KDataBufferWhack ( & pooled );
+
+    REQUIRE ( ! KDataBufferPoolEnable ( true ) );
+    REQUIRE_RC ( KDataBufferResize ( & plain, 100000 ) );
+    KDataBufferWhack ( & plain );
+
+    KDataBufferPoolTrim ();
+    KDataBufferPoolStats stats;
+    REQUIRE_RC ( KDataBufferPoolGetStats ( & stats ) );
+    REQUIRE_EQ ( ( uint64_t ) 0, stats . cached_bytes );
+    KDataBufferPoolEnable ( prior );
+}
+
 TEST_CASE(KDataBuffer_Cast_W32Assert)
 {   
     KDataBuffer src;
@@ -566,6 +785,262 @@ TEST_CASE(KDataBuffer_Cast_W32Assert)
     KDataBufferWhack ( & src );
 }
 
+//////////////////////////////////////////// Pack / Unpack
+
+// straightforward bit-at-a-time packer, the reference for all kernels
+static
+void ReferencePack ( uint32_t unpacked, uint32_t packed, const void * src, size_t count, uint8_t * dst )
+{
+    memset ( dst, 0, ( count * packed + 7 ) / 8 );
+    size_t bit = 0;
+    for ( size_t i = 0; i < count; ++ i )
+    {
+        uint64_t v;
+        switch ( unpacked )
+        {
+        case 8:  v = ( ( const uint8_t * ) src ) [ i ]; break;
+        case 16: v = ( ( const uint16_t * ) src ) [ i ]; break;
+        case 32: v = ( ( const uint32_t * ) src ) [ i ]; break;
+        default: v = ( ( const uint64_t * ) src ) [ i ]; break;
+        }
+        for ( int b = ( int ) packed - 1; b >= 0; --b, ++ bit )
+        {
+            if ( ( v >> b ) & 1 )
+                dst [ bit >> 3 ] |= ( uint8_t ) ( 0x80 >> ( bit & 7 ) );
+        }
+    }
+}
+
+class PackFixture
+{
+public:
+    static const size_t BufSize = 64 * 1024;
+
+    PackFixture ()
+    :   seed ( 88172645463325252ULL )
+    {
+    }
+
+    // fills "src" with "count" random elements that fit into "packed" bits
+    void Fill ( uint32_t unpacked, uint32_t packed, size_t count )
+    {
+        uint64_t mask = packed == 64 ? ~ ( uint64_t ) 0 : ( ( uint64_t ) 1 << packed ) - 1;
+        for ( size_t i = 0; i < count; ++ i )
+        {
+            uint64_t v = Random () & mask;
+            switch ( unpacked )
+            {
+            case 8:  ( ( uint8_t * ) src ) [ i ] = ( uint8_t ) v; break;
+            case 16: ( ( uint16_t * ) src ) [ i ] = ( uint16_t ) v; break;
+            case 32: ( ( uint32_t * ) src ) [ i ] = ( uint32_t ) v; break;
+            default: ( ( uint64_t * ) src ) [ i ] = v; break;
+            }
+        }
+        ReferencePack ( unpacked, packed, src, count, ref );
+    }
+
+    // element counts covering every tail length, then a few long runs
+    size_t Count ( int iteration )
+    {
+        return iteration < 72 ? ( size_t ) iteration : ( size_t ) ( Random () % 4000 );
+    }
+
+    uint64_t Random ()
+    {
+        seed ^= seed << 13;
+        seed ^= seed >> 7;
+        seed ^= seed << 17;
+        return seed;
+    }
+
+    uint64_t seed;
+    uint64_t src [ BufSize / 8 ];
+    uint64_t dst [ BufSize / 8 ];
+    uint8_t ref [ BufSize ];
+};
+
+FIXTURE_TEST_CASE(KLib_Pack_vs_reference, PackFixture)
+{
+    for ( uint32_t unpacked = 8; unpacked <= 64; unpacked <<= 1 )
+    {
+        for ( uint32_t packed = 1; packed <= unpacked; ++ packed )
+        {
+            for ( int i = 0; i < 80; ++ i )
+            {
+                size_t count = Count ( i );
+                Fill ( unpacked, packed, count );
+
+                bitsz_t psize;
+                memset ( dst, 0xAA, sizeof dst );
+                REQUIRE_RC ( Pack ( unpacked, packed, src, count * unpacked / 8, NULL, dst, 0, sizeof dst * 8, & psize ) );
+                REQUIRE_EQ ( ( bitsz_t ) ( count * packed ), psize );
+                REQUIRE_EQ ( 0, memcmp ( dst, ref, ( psize + 7 ) / 8 ) );
+
+                // in place
+                REQUIRE_RC ( Pack ( unpacked, packed, src, count * unpacked / 8, NULL, src, 0, sizeof src * 8, & psize ) );
+                REQUIRE_EQ ( 0, memcmp ( src, ref, ( psize + 7 ) / 8 ) );
+            }
+        }
+    }
+}
+
+FIXTURE_TEST_CASE(KLib_Unpack_vs_reference, PackFixture)
+{
+    for ( uint32_t unpacked = 8; unpacked <= 64; unpacked <<= 1 )
+    {
+        for ( uint32_t packed = 1; packed <= unpacked; ++ packed )
+        {
+            for ( int i = 1; i < 80; ++ i )
+            {
+                size_t count = Count ( i );
+                Fill ( unpacked, packed, count );
+
+                size_t usize;
+                REQUIRE_RC ( Unpack ( packed, unpacked, ref, 0, count * packed, NULL, dst, sizeof dst, & usize ) );
+                REQUIRE_EQ ( count * unpacked / 8, usize );
+                REQUIRE_EQ ( 0, memcmp ( dst, src, usize ) );
+
+                // in place
+                memmove ( dst, ref, ( count * packed + 7 ) / 8 );
+                REQUIRE_RC ( Unpack ( packed, unpacked, dst, 0, count * packed, NULL, dst, sizeof dst, & usize ) );
+                REQUIRE_EQ ( 0, memcmp ( dst, src, usize ) );
+            }
+        }
+    }
+}
+
+// the scalar loops against the kernels picked for this processor
+FIXTURE_TEST_CASE(KLib_Pack_scalar_vs_dispatched, PackFixture)
+{
+    static uint64_t scalar [ BufSize / 8 ];
+
+    for ( uint32_t unpacked = 8; unpacked <= 64; unpacked <<= 1 )
+    {
+        for ( uint32_t packed = 1; packed <= unpacked; ++ packed )
+        {
+            for ( int i = 1; i < 80; ++ i )
+            {
+                size_t count = Count ( i );
+                Fill ( unpacked, packed, count );
+
+                bitsz_t psize, scalar_psize;
+                memset ( scalar, 0xAA, sizeof scalar );
+                memset ( dst, 0xAA, sizeof dst );
+                PackForceScalar ( true );
+                int kernels = PackKernels ();
+                rc_t rc = Pack ( unpacked, packed, src, count * unpacked / 8, NULL, scalar, 0, sizeof scalar * 8, & scalar_psize );
+                PackForceScalar ( false );
+                REQUIRE_EQ ( ( int ) pkScalar, kernels );
+                REQUIRE_RC ( rc );
+                REQUIRE_RC ( Pack ( unpacked, packed, src, count * unpacked / 8, NULL, dst, 0, sizeof dst * 8, & psize ) );
+                REQUIRE_EQ ( scalar_psize, psize );
+                REQUIRE_EQ ( 0, memcmp ( dst, scalar, sizeof dst ) );
+
+                size_t usize, scalar_usize;
+                memset ( scalar, 0xAA, sizeof scalar );
+                memset ( dst, 0xAA, sizeof dst );
+                PackForceScalar ( true );
+                rc = Unpack ( packed, unpacked, ref, 0, count * packed, NULL, scalar, sizeof scalar, & scalar_usize );
+                PackForceScalar ( false );
+                REQUIRE_RC ( rc );
+                REQUIRE_RC ( Unpack ( packed, unpacked, ref, 0, count * packed, NULL, dst, sizeof dst, & usize ) );
+                REQUIRE_EQ ( scalar_usize, usize );
+                REQUIRE_EQ ( 0, memcmp ( dst, scalar, sizeof dst ) );
+            }
+        }
+    }
+}
+
+//////////////////////////////////////////// CRC32 / MD5
+
+// bit-at-a-time crc over the same non-reflected polynomial
+static
+uint32_t ReferenceCRC32 ( uint32_t crc, const uint8_t * data, size_t size )
+{
+    for ( size_t i = 0; i < size; ++ i )
+    {
+        crc ^= ( uint32_t ) data [ i ] << 24;
+        for ( int b = 0; b < 8; ++ b )
+            crc = ( crc & 0x80000000 ) ? ( crc << 1 ) ^ 0x04C11DB7 : crc << 1;
+    }
+    return crc;
+}
+
+class ChecksumFixture
+{
+public:
+    static const size_t BufSize = 64 * 1024;
+
+    ChecksumFixture ()
+    :   seed ( 88172645463325252ULL )
+    {
+        for ( size_t i = 0; i < BufSize; ++ i )
+            data [ i ] = ( uint8_t ) Random ();
+    }
+
+    uint64_t Random ()
+    {
+        seed ^= seed << 13;
+        seed ^= seed >> 7;
+        seed ^= seed << 17;
+        return seed;
+    }
+
+    uint64_t seed;
+    uint8_t data [ BufSize ];
+};
+
+FIXTURE_TEST_CASE(KLib_CRC32_vs_reference, ChecksumFixture)
+{
+    // every short length at every alignment, then long runs
+    for ( int i = 0; i < 2000; ++ i )
+    {
+        size_t offset = i % 16;
+        size_t size = i < 1024 ? ( size_t ) ( i / 4 ) : ( size_t ) ( Random () % ( BufSize - 16 ) );
+        uint32_t init = ( uint32_t ) Random ();
+
+        REQUIRE_EQ ( ReferenceCRC32 ( init, data + offset, size ), CRC32 ( init, data + offset, size ) );
+    }
+}
+
+FIXTURE_TEST_CASE(KLib_MD5StateAppendMulti_vs_Append, ChecksumFixture)
+{
+    const uint32_t Streams = 11;
+
+    MD5State single [ Streams ];
+    MD5State multi [ Streams ];
+    MD5State * states [ Streams ];
+    for ( uint32_t i = 0; i < Streams; ++ i )
+    {
+        MD5StateInit ( & single [ i ] );
+        MD5StateInit ( & multi [ i ] );
+        states [ i ] = & multi [ i ];
+    }
+
+    // uneven chunks, so lanes run out of input at different times
+    // and partially filled buffers are carried between calls
+    for ( int round = 0; round < 20; ++ round )
+    {
+        const void * chunk [ Streams ];
+        size_t size [ Streams ];
+        for ( uint32_t i = 0; i < Streams; ++ i )
+        {
+            chunk [ i ] = data + Random () % 1024;
+            size [ i ] = ( round + i ) % 3 == 0 ? ( size_t ) ( Random () % 70 ) : ( size_t ) ( Random () % 8192 );
+            MD5StateAppend ( & single [ i ], chunk [ i ], size [ i ] );
+        }
+        MD5StateAppendMulti ( states, chunk, size, Streams );
+    }
+
+    for ( uint32_t i = 0; i < Streams; ++ i )
+    {
+        uint8_t expected [ 16 ], actual [ 16 ];
+        MD5StateFinish ( & single [ i ], expected );
+        MD5StateFinish ( & multi [ i ], actual );
+        REQUIRE_EQ ( 0, memcmp ( expected, actual, sizeof actual ) );
+    }
+}
+
 //////////////////////////////////////////// Log
 TEST_CASE(KLog_Formatting)
 {
@@ -803,6 +1278,50 @@ FIXTURE_TEST_CASE(num_gen_IteratorNext, NumGenFixture)
 //rc_t num_gen_range_check( struct num_gen * self, const int64_t first, const uint64_t count );
 //rc_t num_gen_iterator_percent( const struct num_gen_iter * self, uint8_t fract_digits, uint32_t * value );
 
+// Instrumentation
+static rc_t CC ProfToString ( void * self, const char * buffer, size_t bufsize, size_t * num_writ )
+{
+    static_cast < string* > ( self ) -> append ( buffer, bufsize );
+    * num_writ = bufsize;
+    return 0;
+}
+
+TEST_CASE(KProf_Register)
+{
+    KProfId id = KProfRegister ( "test", "register" );
+    REQUIRE_NE ( ( KProfId ) 0, id );
+    REQUIRE_EQ ( id, KProfRegister ( "test", "register" ) );
+    REQUIRE_NE ( id, KProfRegister ( "test2", "register" ) );
+    REQUIRE_EQ ( ( KProfId ) 0, KProfRegister ( NULL, "register" ) );
+}
+
+TEST_CASE(KProf_RecordAndWrite)
+{
+    KProfId id = KProfRegister ( "test", "record \"quoted\"" );
+    KProfRecord ( id, 100 );
+    KProfRecord ( id, 50 );
+    KProfCount ( id, 3 );
+    KProfRecord ( 0, 1 ); /* ignored */
+
+    string json;
+    REQUIRE_RC ( KProfWriteJSON ( ProfToString, & json ) );
+    REQUIRE_NE ( string::npos, json . find ( "\"name\" : \"record \\\"quoted\\\"\", \"count\" : 5, \"ns\" : 150" ) );
+
+    KProfReset ();
+    json . clear ();
+    REQUIRE_RC ( KProfWriteJSON ( ProfToString, & json ) );
+    REQUIRE_NE ( string::npos, json . find ( "\"name\" : \"record \\\"quoted\\\"\", \"count\" : 0, \"ns\" : 0" ) );
+
+    REQUIRE_RC_FAIL ( KProfWriteJSON ( NULL, NULL ) );
+}
+
+TEST_CASE(KProf_Now)
+{
+    uint64_t a = KProfNow ();
+    uint64_t b = KProfNow ();
+    REQUIRE_LE ( a, b );
+}
+
 // Error reporting
 #if _DEBUGGING
 TEST_CASE(GetUnreadRCInfo_LogRC)
@@ -31,15 +31,18 @@
 #include <ktst/unit_test.hpp>
 
 #include <klib/rc.h>
+#include <klib/sort.h>
 
 #include <atomic32.h>
 #include <os-native.h>
 
 #include <kproc/cond.h>
 #include <kproc/lock.h>
+#include <kproc/psort.h>
 #include <kproc/thread.h>
 #include <kproc/timeout.h>
 
+#include <cstring>
 #include <stdexcept>
 
 using namespace std;
@@ -518,6 +521,46 @@ TEST_CASE( KCondition_MakeRelease )
 
 //TODO: KConditionWait, KConditionTimedWait, KConditionSignal, KConditionBroadcast
 
+//ksort_parallel
+static
+int CC CompareU64 ( const void *a, const void *b, void *data )
+{
+    uint64_t x = * ( const uint64_t* ) a;
+    uint64_t y = * ( const uint64_t* ) b;
+    return x < y ? -1 : x > y;
+}
+
+TEST_CASE( KSortParallel_NULL )
+{
+    uint64_t val = 0;
+    REQUIRE_RC_FAIL(ksort_parallel(NULL, 1, sizeof val, CompareU64, NULL, 4));
+    REQUIRE_RC_FAIL(ksort_parallel(&val, 1, sizeof val, NULL, NULL, 4));
+}
+
+TEST_CASE( KSortParallel_vs_ksort )
+{
+    // odd sizes and thread counts leave runs that are carried over between merge rounds
+    const size_t Size = 100003;
+    uint64_t * parr = new uint64_t [ Size ];
+    uint64_t * karr = new uint64_t [ Size ];
+    for ( uint32_t threads = 0; threads <= 7; ++ threads )
+    {
+        uint64_t x = 88172645463325252ULL + threads;
+        for ( size_t i = 0; i < Size; ++ i )
+        {
+            x ^= x << 13; x ^= x >> 7; x ^= x << 17;
+            parr [ i ] = x % ( Size / 2 ); // plenty of ties
+        }
+        memcpy ( karr, parr, Size * sizeof * parr );
+
+        REQUIRE_RC(ksort_parallel(parr, Size, sizeof * parr, CompareU64, NULL, threads));
+        ksort(karr, Size, sizeof * karr, CompareU64, NULL);
+        REQUIRE_EQ(memcmp(parr, karr, Size * sizeof * parr), 0);
+    }
+    delete [] parr;
+    delete [] karr;
+}
+
 //TODO: KSemaphore
 //TODO: KQueue
 //TODO: Timeout
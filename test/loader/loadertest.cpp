@@ -32,11 +32,21 @@
 #include <vdb/manager.h> // VDBManager
 #include <vdb/database.h> 
 #include <vdb/schema.h> /* VSchemaRelease */
+#include <kfs/directory.h>
+#include <kfs/file.h>
+#include <klib/checksum.h>
+#include <align/writer-reference.h>
 
 extern "C" {
 #include <loader/sequence-writer.h>
 }
 
+#include <cctype>
+#include <cstdio>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
 using namespace std;
 
 TEST_SUITE(LoaderTestSuite);
@@ -123,6 +133,144 @@ TEST_CASE ( SequenceWriter_Write )
     }
 }
 
+//////////////////////////////////////////// ReferenceMgr fasta import
+
+// a multi-sequence fasta file big enough to be imported on several threads,
+// with lower case, X and line breaks for the import to clean up
+class FastaImportFixture
+{
+public:
+    static const unsigned Records = 12;
+    static const size_t RecordBases = 500 * 1024;
+
+    FastaImportFixture ()
+    :   seed ( 1 ), wd ( 0 ), vmgr ( 0 )
+    {
+        if ( KDirectoryNativeDir ( & wd ) != 0 || VDBManagerMakeUpdate ( & vmgr, NULL ) != 0 )
+            throw logic_error ( "FastaImportFixture: cannot make managers" );
+    }
+    ~FastaImportFixture ()
+    {
+        if ( ! fileName . empty () )
+            KDirectoryRemove ( wd, true, "%s", fileName . c_str () );
+        VDBManagerRelease ( vmgr );
+        KDirectoryRelease ( wd );
+    }
+
+    static string Id ( unsigned record )
+    {
+        char id [ 16 ];
+        sprintf ( id, "ref_%02u", record );
+        return id;
+    }
+
+    // records "bad1" and "bad2" get an invalid base halfway through
+    void MakeFile ( const string & name, unsigned bad1 = Records, unsigned bad2 = Records )
+    {
+        static const char Bases [] = "ACGTNacgtnXxMRyk";
+        string text;
+
+        expected . assign ( Records, string () );
+        for ( unsigned r = 0; r < Records; ++ r )
+        {
+            text += ">" + Id ( r ) + " record\n";
+            for ( size_t i = 0; i < RecordBases; ++ i )
+            {
+                const char ch = Bases [ Random () % ( sizeof Bases - 1 ) ];
+                const char clean = ( char ) toupper ( ch );
+
+                text += ( r == bad1 || r == bad2 ) && i == RecordBases / 2 ? '$' : ch;
+                expected [ r ] += clean == 'X' ? 'N' : clean;
+                if ( i % 70 == 69 )
+                    text += "\n";
+            }
+            text += "\n";
+        }
+
+        KFile * f;
+        size_t written;
+        fileName = name;
+        if ( KDirectoryCreateFile ( wd, & f, false, 0664, kcmInit, "%s", name . c_str () ) != 0 )
+            throw logic_error ( "FastaImportFixture: cannot create " + name );
+        rc_t rc = KFileWriteAll ( f, 0, text . data (), text . size (), & written );
+        KFileRelease ( f );
+        if ( rc != 0 || written != text . size () )
+            throw logic_error ( "FastaImportFixture: cannot write " + name );
+    }
+
+    rc_t Import ( const ReferenceMgr ** mgr, uint32_t threads )
+    {
+        rc_t rc = ReferenceMgr_Make ( mgr, NULL, vmgr, 0, NULL, NULL, 0, 0, 0 );
+        if ( rc == 0 )
+            rc = ReferenceMgr_SetImportThreads ( * mgr, threads );
+        if ( rc == 0 )
+            rc = ReferenceMgr_FastaPath ( * mgr, fileName . c_str () );
+        return rc;
+    }
+
+    // the length and MD5 of the record as cleaned up here
+    rc_t Verify ( const ReferenceMgr * mgr, unsigned record )
+    {
+        MD5State md5;
+        uint8_t digest [ 16 ];
+
+        MD5StateInit ( & md5 );
+        MD5StateAppend ( & md5, expected [ record ] . data (), expected [ record ] . size () );
+        MD5StateFinish ( & md5, digest );
+        return ReferenceMgr_Verify ( mgr, Id ( record ) . c_str (),
+            ( INSDC_coord_len ) expected [ record ] . size (), digest );
+    }
+
+    uint32_t Random ()
+    {
+        seed = seed * 1103515245u + 12345u;
+        return seed >> 16;
+    }
+
+    uint32_t seed;
+    KDirectory * wd;
+    VDBManager * vmgr;
+    string fileName;
+    vector < string > expected;
+};
+
+FIXTURE_TEST_CASE ( ReferenceMgr_ImportFasta_Threads, FastaImportFixture )
+{
+    MakeFile ( GetName () );
+
+    const uint32_t threads [] = { 1, 4 };
+    for ( size_t t = 0; t < sizeof threads / sizeof threads [ 0 ]; ++ t )
+    {
+        const ReferenceMgr * mgr;
+        REQUIRE_RC ( Import ( & mgr, threads [ t ] ) );
+        for ( unsigned r = 0; r < Records; ++ r )
+            REQUIRE_RC ( Verify ( mgr, r ) );
+        REQUIRE_RC ( ReferenceMgr_Release ( mgr, false, NULL, false, NULL ) );
+    }
+}
+
+// the first bad record in file order fails the import, whichever thread
+// gets to it, and the records before it are kept
+FIXTURE_TEST_CASE ( ReferenceMgr_ImportFasta_Threads_InvalidBase, FastaImportFixture )
+{
+    const unsigned bad = Records / 2;
+    MakeFile ( GetName (), bad, Records - 2 );
+
+    rc_t rc [ 2 ];
+    const uint32_t threads [] = { 1, 4 };
+    for ( size_t t = 0; t < sizeof threads / sizeof threads [ 0 ]; ++ t )
+    {
+        const ReferenceMgr * mgr = NULL;
+        rc [ t ] = Import ( & mgr, threads [ t ] );
+        REQUIRE_NOT_NULL ( mgr );
+        for ( unsigned r = 0; r < bad; ++ r )
+            REQUIRE_RC ( Verify ( mgr, r ) );
+        REQUIRE_RC ( ReferenceMgr_Release ( mgr, false, NULL, false, NULL ) );
+    }
+    REQUIRE_NE ( ( rc_t ) 0, rc [ 0 ] );
+    REQUIRE_EQ ( rc [ 0 ], rc [ 1 ] );
+}
+
 //////////////////////////////////////////// Main
 #include <kapp/args.h>
 #include <klib/out.h>
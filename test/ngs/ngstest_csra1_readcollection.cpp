@@ -33,6 +33,7 @@
 #include <CSRA1_ReadCollection.h>
 
 #include <NGS_Cursor.h>
+#include <NGS_Export.h>
 
 #include <kdb/manager.h>
 
@@ -298,6 +299,30 @@ FIXTURE_TEST_CASE(CSRA1_ReadCollectionGetAlignments_FilteredNone, CSRA1_Fixture)
     
     EXIT;
 }
+FIXTURE_TEST_CASE(CSRA1_ReadCollectionGetAlignments_RetainedStringsSurviveNext, CSRA1_Fixture)
+{   
+    ENTRY_ACC(CSRA1_PrimaryOnly);
+    
+    m_align = NGS_ReadCollectionGetAlignments ( m_coll, ctx, true, true );
+    REQUIRE ( ! FAILED () && m_align );
+    REQUIRE ( NGS_AlignmentIteratorNext ( m_align, ctx ) );
+
+    NGS_String * bases = NGS_AlignmentGetClippedFragmentBases ( m_align, ctx );
+    NGS_String * quals = NGS_AlignmentGetClippedFragmentQualities ( m_align, ctx );
+    REQUIRE ( ! FAILED () );
+    string expBases = toString ( bases, ctx );
+    string expQuals = toString ( quals, ctx );
+
+    /* strings held by the caller keep their contents while the iterator moves on */
+    REQUIRE ( NGS_AlignmentIteratorNext ( m_align, ctx ) );
+    toString ( NGS_AlignmentGetClippedFragmentBases ( m_align, ctx ), ctx, true );
+    toString ( NGS_AlignmentGetClippedFragmentQualities ( m_align, ctx ), ctx, true );
+    REQUIRE_EQ ( expBases, toString ( bases, ctx, true ) );
+    REQUIRE_EQ ( expQuals, toString ( quals, ctx, true ) );
+    REQUIRE ( ! FAILED () );
+    
+    EXIT;
+}
 
 FIXTURE_TEST_CASE(CSRA1_ReadCollection_GetAlignmentCount_Primary_None, CSRA1_Fixture)
 {
@@ -441,6 +466,122 @@ FIXTURE_TEST_CASE(CSRA1_ReadCollection_GetAlignmentRange_Secondary, CSRA1_Fixtur
 }
 
 
+FIXTURE_TEST_CASE(CSRA1_ReadCollection_GetAlignmentShard_Secondary, CSRA1_Fixture)
+{   // 10 secondary alignments over 3 shards: 4, 3, 3
+    ENTRY_ACC ( CSRA1_WithSecondary );
+
+    m_align = NGS_ReadCollectionGetAlignmentShard ( m_coll, ctx, 1, 3, false, true );
+    REQUIRE ( ! FAILED () && m_align );
+
+    REQUIRE ( NGS_AlignmentIteratorNext ( m_align, ctx ) );
+    REQUIRE ( ! FAILED () );
+    REQUIRE_STRING ( string ( CSRA1_WithSecondary ) + ".SA.173", NGS_AlignmentGetAlignmentId ( m_align, ctx ) );
+
+    REQUIRE ( NGS_AlignmentIteratorNext ( m_align, ctx ) );
+    REQUIRE ( NGS_AlignmentIteratorNext ( m_align, ctx ) );
+    REQUIRE ( ! FAILED () );
+    REQUIRE_STRING ( string ( CSRA1_WithSecondary ) + ".SA.175", NGS_AlignmentGetAlignmentId ( m_align, ctx ) );
+
+    REQUIRE ( ! NGS_AlignmentIteratorNext ( m_align, ctx ) );
+
+    EXIT;
+}
+
+FIXTURE_TEST_CASE(CSRA1_ReadCollection_GetAlignmentShard_OutOfRange, CSRA1_Fixture)
+{
+    ENTRY_ACC ( CSRA1_WithSecondary );
+
+    REQUIRE_NULL ( NGS_ReadCollectionGetAlignmentShard ( m_coll, ctx, 3, 3, true, true ) );
+    REQUIRE_FAILED ();
+
+    EXIT;
+}
+
+// Export
+
+FIXTURE_TEST_CASE(CSRA1_ReadCollection_ExportAlignments_MatchesGetters, CSRA1_Fixture)
+{
+    ENTRY_ACC ( CSRA1_WithSecondary );
+
+    // room for 3 records at a time, so that the range is split across calls
+    const uint32_t MaxRecords = 3;
+    char bases [ 1024 ];
+    char quals [ 1024 ];
+    uint32_t offsets [ MaxRecords + 1 ];
+    char ids [ 256 ];
+    uint32_t id_offsets [ MaxRecords + 1 ];
+
+    NGS_ExportBuffer buf = NGS_ExportBuffer ();
+    buf . bases = bases;
+    buf . qualities = quals;
+    buf . data_offsets = offsets;
+    buf . ids = ids;
+    buf . id_offsets = id_offsets;
+    buf . data_capacity = sizeof bases;
+    buf . ids_capacity = sizeof ids;
+    buf . max_records = MaxRecords;
+
+    m_align = NGS_ReadCollectionGetAlignmentRange ( m_coll, ctx, 166, 8, true, true );
+    NGS_Alignment * expected = NGS_ReadCollectionGetAlignmentRange ( m_coll, ctx, 166, 8, true, true );
+    REQUIRE ( ! FAILED () && m_align && expected );
+
+    bool pending = false;
+    uint32_t total = 0;
+    while ( true )
+    {
+        uint32_t count = NGS_AlignmentIteratorExport ( m_align, ctx, & buf, & pending );
+        REQUIRE ( ! FAILED () );
+        REQUIRE_EQ ( buf . num_records, count );
+        if ( count == 0 )
+            break;
+        REQUIRE_LE ( count, MaxRecords );
+
+        for ( uint32_t i = 0; i < count; ++ i )
+        {
+            REQUIRE ( NGS_AlignmentIteratorNext ( expected, ctx ) );
+            string b ( bases + offsets [ i ], offsets [ i + 1 ] - offsets [ i ] );
+            string q ( quals + offsets [ i ], offsets [ i + 1 ] - offsets [ i ] );
+            string id ( ids + id_offsets [ i ], id_offsets [ i + 1 ] - id_offsets [ i ] );
+            REQUIRE_EQ ( toString ( NGS_AlignmentGetClippedFragmentBases ( expected, ctx ), ctx, true ), b );
+            REQUIRE_EQ ( toString ( NGS_AlignmentGetClippedFragmentQualities ( expected, ctx ), ctx, true ), q );
+            REQUIRE_EQ ( toString ( NGS_AlignmentGetAlignmentId ( expected, ctx ), ctx, true ), id );
+        }
+        total += count;
+    }
+
+    REQUIRE_EQ ( (uint32_t)8, total );
+    REQUIRE ( ! pending );
+    REQUIRE ( ! NGS_AlignmentIteratorNext ( expected, ctx ) );
+
+    NGS_AlignmentRelease ( expected, ctx );
+    EXIT;
+}
+
+FIXTURE_TEST_CASE(CSRA1_ReadCollection_ExportReads_BufferTooSmall, CSRA1_Fixture)
+{
+    ENTRY_ACC ( CSRA1_PrimaryOnly );
+
+    char bases [ 16 ];
+    uint32_t offsets [ 2 ];
+
+    NGS_ExportBuffer buf = NGS_ExportBuffer ();
+    buf . bases = bases;
+    buf . data_offsets = offsets;
+    buf . data_capacity = sizeof bases;
+    buf . max_records = 1;
+
+    m_read = NGS_ReadCollectionGetReads ( m_coll, ctx, true, true, true );
+    REQUIRE ( ! FAILED () && m_read );
+
+    bool pending = false;
+    REQUIRE_EQ ( (uint32_t)0, NGS_ReadIteratorExport ( m_read, ctx, & buf, & pending ) );
+    REQUIRE_FAILED ();
+    // the read that did not fit is still there
+    REQUIRE ( pending );
+
+    EXIT;
+}
+
 FIXTURE_TEST_CASE(CSRA1_ReadCollection_GetAlignmentRange_SecondarySingle, CSRA1_Fixture)
 {
     ENTRY_ACC ( CSRA1_WithSecondary );
@@ -39,6 +39,8 @@
 
 #include <limits.h>
 
+#include <set>
+
 using namespace std;
 using namespace ncbi::NK;
 
@@ -550,6 +552,38 @@ FIXTURE_TEST_CASE(CSRA1_NGS_ReferenceWindow_Slice_Overlap_PrimaryAndSecondary_Fu
     
     EXIT;
 }
+FIXTURE_TEST_CASE(CSRA1_NGS_ReferenceWindow_Slice_MatchesFilteredScan, CSRA1_Fixture)
+{
+    ENTRY_GET_REF ( CSRA1_WithSecondary, "gi|169794206|ref|NC_010410.1|" );
+    const int64_t offset = 517000;
+    const int64_t size = 100;
+
+    // every alignment of the reference that overlaps the slice, and nothing else
+    set < string > expected;
+    m_align = NGS_ReferenceGetAlignments ( m_ref, ctx, true, true ); 
+    while ( NGS_AlignmentIteratorNext ( m_align, ctx ) )
+    {
+        int64_t pos = NGS_AlignmentGetAlignmentPosition ( m_align, ctx );
+        int64_t len = ( int64_t ) NGS_AlignmentGetAlignmentLength ( m_align, ctx );
+        if ( pos < offset + size && pos + len > offset )
+            expected . insert ( toString ( NGS_AlignmentGetAlignmentId ( m_align, ctx ), ctx, true ) );
+    }
+    REQUIRE ( ! FAILED () );
+    REQUIRE ( ! expected . empty () );
+    NGS_AlignmentRelease ( m_align, ctx );
+
+    set < string > actual;
+    m_align = NGS_ReferenceGetAlignmentSlice ( m_ref, ctx, offset, size, true, true ); 
+    while ( NGS_AlignmentIteratorNext ( m_align, ctx ) )
+    {
+        REQUIRE ( actual . insert ( toString ( NGS_AlignmentGetAlignmentId ( m_align, ctx ), ctx, true ) ) . second );
+    }
+    REQUIRE ( ! FAILED () );
+    REQUIRE ( expected == actual );
+
+    EXIT;
+}
+
 // FIXTURE_TEST_CASE(CSRA1_NGS_ReferenceWindow_Slice_Overlap_LookbackMoreThanOneChunk, CSRA1_Fixture)
 // FIXTURE_TEST_CASE(CSRA1_NGS_ReferenceWindow_Slice_Overlap_LookbackDiffersForPrimaryAndSecondary, CSRA1_Fixture)
 // FIXTURE_TEST_CASE(CSRA1_NGS_ReferenceWindow_Slice_Overlap_DefaultLookback, CSRA1_Fixture)
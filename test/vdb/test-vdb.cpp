@@ -36,6 +36,7 @@
 
 #include <sysalloc.h>
 #include <cstdlib>
+#include <cstring>
 #include <stdexcept>
 
 using namespace std;
@@ -315,6 +316,172 @@ FIXTURE_TEST_CASE(TestCursorIsStatic_DB_VariableREAD_LEN_MultipleRows, VdbFixtur
     REQUIRE ( ! is_static );
 }
 
+static const uint32_t BatchSize = 1000;
+
+FIXTURE_TEST_CASE(TestCursorCellDataBatch_MatchesDirect, VdbFixture)
+{
+    REQUIRE_RC ( Setup ( "SRR619505" ) );
+
+    const void * base [ BatchSize ];
+    uint32_t boff [ BatchSize ];
+    uint32_t row_len [ BatchSize ];
+    uint32_t elem_bits = 0;
+    uint32_t num_rows = 0;
+    int64_t row = 1;
+    while ( row < 1 + 3 * BatchSize )
+    {
+        REQUIRE_RC ( VCursorCellDataBatch ( curs, row, col_idx, BatchSize, &elem_bits, base, boff, row_len, &num_rows ) );
+        REQUIRE_LT ( 0u, num_rows );
+        REQUIRE_GE ( BatchSize, num_rows );
+        for ( uint32_t i = 0; i < num_rows; ++ i )
+        {
+            uint32_t d_elem_bits, d_boff, d_row_len;
+            const void * d_base;
+            REQUIRE_RC ( VCursorCellDataDirect ( curs, row + i, col_idx, &d_elem_bits, &d_base, &d_boff, &d_row_len ) );
+            REQUIRE_EQ ( d_elem_bits, elem_bits );
+            REQUIRE_EQ ( d_row_len, row_len [ i ] );
+            REQUIRE_EQ ( d_boff, boff [ i ] );
+            REQUIRE_EQ ( 0, memcmp ( d_base, base [ i ], ( d_row_len * d_elem_bits + 7 ) / 8 ) );
+        }
+        row += num_rows;
+    }
+}
+
+FIXTURE_TEST_CASE(TestCursorCellDataBatch_BadArgs, VdbFixture)
+{
+    REQUIRE_RC ( Setup ( "SRR619505" ) );
+
+    const void * base [ 1 ];
+    uint32_t row_len [ 1 ];
+    uint32_t num_rows = 1;
+    REQUIRE_RC_FAIL ( VCursorCellDataBatch ( curs, 1, col_idx, 1, NULL, base, NULL, row_len, NULL ) );
+    REQUIRE_RC_FAIL ( VCursorCellDataBatch ( curs, 1, col_idx, 1, NULL, NULL, NULL, row_len, &num_rows ) );
+    REQUIRE_EQ ( 0u, num_rows );
+    REQUIRE_RC ( VCursorCellDataBatch ( curs, 1, col_idx, 0, NULL, base, NULL, row_len, &num_rows ) );
+    REQUIRE_EQ ( 0u, num_rows );
+}
+
+FIXTURE_TEST_CASE(TestCursorCellDataSpan_SingleCell, VdbFixture)
+{
+    REQUIRE_RC ( Setup ( "SRR619505" ) );
+
+    /* a single cell is always a span; multi-row spans are covered
+       by test-wvdb on a column known to be fixed-width */
+    const void * base;
+    uint32_t boff, row_len, elem_bits, num_rows;
+    REQUIRE_RC ( VCursorCellDataSpan ( curs, 1, col_idx, 1, &elem_bits, &base, &boff, &row_len, &num_rows ) );
+    REQUIRE_EQ ( 1u, num_rows );
+
+    uint32_t d_elem_bits, d_boff, d_row_len;
+    const void * d_base;
+    REQUIRE_RC ( VCursorCellDataDirect ( curs, 1, col_idx, &d_elem_bits, &d_base, &d_boff, &d_row_len ) );
+    REQUIRE_EQ ( d_row_len, row_len );
+    REQUIRE_EQ ( d_base, base );
+}
+
+FIXTURE_TEST_CASE(TestCursorLazyOpen, VdbFixture)
+{
+    const VDatabase * db;
+    REQUIRE_RC ( VDBManagerOpenDBRead ( mgr, & db, NULL, "SRR619505" ) );
+    const VTable * tbl;
+    REQUIRE_RC ( VDatabaseOpenTableRead ( db, & tbl, "SEQUENCE" ) );
+
+    const VCursor * eager;
+    const VCursor * lazy;
+    REQUIRE_RC ( VTableCreateCursorRead ( tbl, & eager ) );
+    REQUIRE_RC ( VTableCreateCursorRead ( tbl, & lazy ) );
+    REQUIRE_RC ( VCursorPermitLazyOpen ( lazy ) );
+
+    uint32_t e_idx [ 2 ], l_idx [ 2 ];
+    REQUIRE_RC ( VCursorAddColumn ( eager, & e_idx [ 0 ], "READ_LEN" ) );
+    REQUIRE_RC ( VCursorAddColumn ( eager, & e_idx [ 1 ], "READ" ) );
+    REQUIRE_RC ( VCursorAddColumn ( lazy, & l_idx [ 0 ], "READ_LEN" ) );
+    REQUIRE_RC ( VCursorAddColumn ( lazy, & l_idx [ 1 ], "READ" ) );
+    REQUIRE_RC ( VCursorOpen ( eager ) );
+    REQUIRE_RC ( VCursorOpen ( lazy ) );
+
+    /* too late once open */
+    REQUIRE_RC_FAIL ( VCursorPermitLazyOpen ( lazy ) );
+
+    int64_t e_first, l_first;
+    uint64_t e_count, l_count;
+    REQUIRE_RC ( VCursorIdRange ( eager, 0, & e_first, & e_count ) );
+    REQUIRE_RC ( VCursorIdRange ( lazy, 0, & l_first, & l_count ) );
+    REQUIRE_EQ ( e_first, l_first );
+    REQUIRE_EQ ( e_count, l_count );
+
+    for ( int64_t row = e_first; row < e_first + 16; ++ row )
+    {
+        for ( uint32_t i = 0; i < 2; ++ i )
+        {
+            uint32_t e_bits, e_boff, e_len, l_bits, l_boff, l_len;
+            const void * e_base, * l_base;
+            REQUIRE_RC ( VCursorCellDataDirect ( eager, row, e_idx [ i ], & e_bits, & e_base, & e_boff, & e_len ) );
+            REQUIRE_RC ( VCursorCellDataDirect ( lazy, row, l_idx [ i ], & l_bits, & l_base, & l_boff, & l_len ) );
+            REQUIRE_EQ ( e_bits, l_bits );
+            REQUIRE_EQ ( e_len, l_len );
+            REQUIRE_EQ ( 0, memcmp ( e_base, l_base, ( e_len * e_bits + 7 ) / 8 ) );
+        }
+    }
+
+    REQUIRE_RC ( VCursorRelease ( lazy ) );
+    REQUIRE_RC ( VCursorRelease ( eager ) );
+    REQUIRE_RC ( VTableRelease ( tbl ) );
+    REQUIRE_RC ( VDatabaseRelease ( db ) );
+}
+
+static
+const VSchema * OpenDBSchema ( const VDBManager * mgr, const char * acc, const VSchema ** tbl_schema )
+{
+    const VSchema * schema = NULL;
+    const VDatabase * db;
+    if ( VDBManagerOpenDBRead ( mgr, & db, NULL, acc ) == 0 )
+    {
+        const VTable * tbl;
+        VDatabaseOpenSchema ( db, & schema );
+        if ( VDatabaseOpenTableRead ( db, & tbl, "SEQUENCE" ) == 0 )
+        {
+            VTableOpenSchema ( tbl, tbl_schema );
+            VTableRelease ( tbl );
+        }
+        VDatabaseRelease ( db );
+    }
+    return schema;
+}
+
+FIXTURE_TEST_CASE(TestSchemaCache_Shared, VdbFixture)
+{
+    const VSchema * tbl1 = NULL, * tbl2 = NULL;
+    const VSchema * s1 = OpenDBSchema ( mgr, "SRR600096", & tbl1 );
+    const VSchema * s2 = OpenDBSchema ( mgr, "SRR600096", & tbl2 );
+    REQUIRE_NOT_NULL ( s1 );
+    REQUIRE_NOT_NULL ( tbl1 );
+
+    /* the same stored text was parsed once */
+    REQUIRE_EQ ( s1, s2 );
+    REQUIRE_EQ ( tbl1, tbl2 );
+
+    REQUIRE_RC ( VSchemaRelease ( tbl2 ) );
+    REQUIRE_RC ( VSchemaRelease ( s2 ) );
+
+    /* without the cache, each open has its own */
+    REQUIRE_RC ( VDBManagerSetSchemaCacheLimit ( mgr, 0 ) );
+    s2 = OpenDBSchema ( mgr, "SRR600096", & tbl2 );
+    REQUIRE_NOT_NULL ( s2 );
+    REQUIRE_NE ( s1, s2 );
+    REQUIRE_NE ( tbl1, tbl2 );
+
+    REQUIRE_RC ( VSchemaRelease ( tbl2 ) );
+    REQUIRE_RC ( VSchemaRelease ( s2 ) );
+    REQUIRE_RC ( VSchemaRelease ( tbl1 ) );
+    REQUIRE_RC ( VSchemaRelease ( s1 ) );
+}
+
+TEST_CASE(TestSchemaCache_BadArgs)
+{
+    REQUIRE_RC_FAIL ( VDBManagerSetSchemaCacheLimit ( NULL, 1 ) );
+}
+
 //////////////////////////////////////////// Main
 extern "C"
 {
@@ -28,6 +28,8 @@
 #include <vdb/cursor.h> 
 #include <sra/sraschema.h> // VDBManagerMakeSRASchema
 #include <vdb/schema.h> /* VSchemaRelease */
+#include <klib/data-buffer.h> /* KDataBufferPoolGetStats */
+#include <kfs/directory.h>
 
 #include <ktst/unit_test.hpp> // TEST_CASE
 
@@ -35,6 +37,8 @@
 
 #include <sstream>
 #include <cstdlib>
+#include <cstring>
+#include <stdexcept>
 
 using namespace std;
 
@@ -131,6 +135,219 @@ TEST_CASE(BlobCorruptOnCommit)
     
 }
 
+// a table with one fixed-width column whose cell at row N holds N,
+// written in blobs of the given numbers of rows
+class CellDataFixture
+{
+public:
+    CellDataFixture()
+    : mgr(0), curs(0), col_idx(0), rows(0)
+    {
+        if ( VDBManagerMakeUpdate ( & mgr, NULL ) != 0 )
+            throw logic_error ( "CellDataFixture: VDBManagerMakeUpdate failed" );
+    }
+
+    ~CellDataFixture()
+    {
+        VCursorRelease ( curs );
+        VDBManagerRelease ( mgr );
+        if ( ! name . empty () )
+        {
+            KDirectory* wd;
+            if ( KDirectoryNativeDir ( & wd ) == 0 )
+            {
+                KDirectoryRemove ( wd, true, "%s", name . c_str () );
+                KDirectoryRelease ( wd );
+            }
+        }
+    }
+
+    rc_t Setup ( const char * p_name, const uint32_t * blob_rows, uint32_t blobs, size_t cache_capacity )
+    {
+        name = p_name;
+        rc_t rc = Write ( blob_rows, blobs );
+        if ( rc == 0 )
+            rc = Open ( cache_capacity );
+        return rc;
+    }
+
+    // one pass over the whole column; fails unless every batch ends
+    // exactly at a blob boundary and every cell holds its row id
+    bool Scan ( const uint32_t * blob_rows, uint32_t blobs )
+    {
+        static const uint32_t BatchSize = 4096;
+        const void * base [ BatchSize ];
+        uint32_t boff [ BatchSize ];
+        uint32_t row_len [ BatchSize ];
+        uint32_t elem_bits, num_rows;
+
+        int64_t row = 1;
+        for ( uint32_t b = 0; b < blobs; ++ b )
+        {
+            if ( VCursorCellDataBatch ( curs, row, col_idx, BatchSize, & elem_bits, base, boff, row_len, & num_rows ) != 0 )
+                return false;
+            if ( elem_bits != 32 || num_rows != blob_rows [ b ] )
+                return false;
+            for ( uint32_t i = 0; i < num_rows; ++ i )
+            {
+                if ( boff [ i ] != 0 || row_len [ i ] != 1 ||
+                     * ( const uint32_t * ) base [ i ] != ( uint32_t ) ( row + i ) )
+                    return false;
+            }
+            row += num_rows;
+        }
+        return row == ( int64_t ) rows + 1;
+    }
+
+    static uint64_t LiveBytes ()
+    {
+        KDataBufferPoolStats stats;
+        if ( KDataBufferPoolGetStats ( & stats ) != 0 )
+            throw logic_error ( "CellDataFixture: KDataBufferPoolGetStats failed" );
+        return stats . live_bytes;
+    }
+
+    VDBManager * mgr;
+    const VCursor * curs;
+    uint32_t col_idx;
+    uint64_t rows;
+    string name;
+
+private:
+    rc_t Write ( const uint32_t * blob_rows, uint32_t blobs )
+    {
+        static const char schemaText [] =
+            "table cells #1\n"
+            "{\n"
+            "    extern column U32 VALUE;\n"
+            "};\n";
+
+        VSchema* schema;
+        rc_t rc = VDBManagerMakeSchema ( mgr, & schema );
+        if ( rc == 0 )
+        {
+            rc = VSchemaParseText ( schema, NULL, schemaText, sizeof schemaText - 1 );
+            if ( rc == 0 )
+            {
+                VTable* table;
+                rc = VDBManagerCreateTable ( mgr, & table, schema, "cells", kcmInit, "%s", name . c_str () );
+                if ( rc == 0 )
+                {
+                    VCursor* cursor;
+                    rc = VTableCreateCursorWrite ( table, & cursor, kcmInsert );
+                    if ( rc == 0 )
+                    {
+                        uint32_t idx;
+                        rc = VCursorAddColumn ( cursor, & idx, "VALUE" );
+                        if ( rc == 0 )
+                            rc = VCursorOpen ( cursor );
+                        for ( uint32_t b = 0; rc == 0 && b < blobs; ++ b )
+                        {
+                            for ( uint32_t r = 0; rc == 0 && r < blob_rows [ b ]; ++ r )
+                            {
+                                uint32_t value = ( uint32_t ) ++ rows;
+                                rc = VCursorOpenRow ( cursor );
+                                if ( rc == 0 )
+                                    rc = VCursorWrite ( cursor, idx, 32, & value, 0, 1 );
+                                if ( rc == 0 )
+                                    rc = VCursorCommitRow ( cursor );
+                                if ( rc == 0 )
+                                    rc = VCursorCloseRow ( cursor );
+                            }
+                            if ( rc == 0 )
+                                rc = VCursorFlushPage ( cursor );
+                        }
+                        if ( rc == 0 )
+                            rc = VCursorCommit ( cursor );
+                        VCursorRelease ( cursor );
+                    }
+                    VTableRelease ( table );
+                }
+            }
+            VSchemaRelease ( schema );
+        }
+        return rc;
+    }
+
+    rc_t Open ( size_t cache_capacity )
+    {
+        const VTable* table;
+        rc_t rc = VDBManagerOpenTableRead ( mgr, & table, NULL, "%s", name . c_str () );
+        if ( rc == 0 )
+        {
+            rc = VTableCreateCachedCursorRead ( table, & curs, cache_capacity );
+            if ( rc == 0 )
+            {
+                rc = VCursorAddColumn ( curs, & col_idx, "VALUE" );
+                if ( rc == 0 )
+                    rc = VCursorOpen ( curs );
+            }
+            VTableRelease ( table );
+        }
+        return rc;
+    }
+};
+
+// blobs of 5 rows or fewer are never kept by the cursor cache
+static const uint32_t BlobRows [] = { 1000, 3, 1000, 1000, 2, 1000, 1000, 1, 1000, 1000, 1000, 5, 1000 };
+static const uint32_t Blobs = sizeof BlobRows / sizeof BlobRows [ 0 ];
+
+FIXTURE_TEST_CASE(CellDataBatch_StopsAtBlobEnds, CellDataFixture)
+{
+    REQUIRE_RC ( Setup ( GetName (), BlobRows, Blobs, 1024 * 1024 ) );
+    REQUIRE ( Scan ( BlobRows, Blobs ) );
+    // again, now from the cursor cache
+    REQUIRE ( Scan ( BlobRows, Blobs ) );
+}
+
+FIXTURE_TEST_CASE(CellDataBatch_ScanDoesNotLeakBlobs, CellDataFixture)
+{
+    // a cache smaller than one blob forces a miss for nearly every batch
+    REQUIRE_RC ( Setup ( GetName (), BlobRows, Blobs, 1 ) );
+
+    REQUIRE ( Scan ( BlobRows, Blobs ) );
+    uint64_t live = LiveBytes ();
+    for ( int i = 0; i < 8; ++ i )
+        REQUIRE ( Scan ( BlobRows, Blobs ) );
+    // a blob leaked per miss would add ~4K per blob and pass
+    REQUIRE_LE ( LiveBytes (), live + 16 * 1024 );
+
+    // repeated hits on the same blob must not change its refcount either:
+    // a missing reference frees it under the cache, an extra one leaks it
+    const void * base;
+    uint32_t row_len, num_rows;
+    for ( int i = 0; i < 1000; ++ i )
+    {
+        REQUIRE_RC ( VCursorCellDataBatch ( curs, 1, col_idx, 1, NULL, & base, NULL, & row_len, & num_rows ) );
+        REQUIRE_EQ ( 1u, * ( const uint32_t * ) base );
+        REQUIRE_RC ( VCursorCellDataSpan ( curs, 1, col_idx, 1, NULL, & base, NULL, & row_len, & num_rows ) );
+        REQUIRE_EQ ( 1u, * ( const uint32_t * ) base );
+    }
+    REQUIRE ( Scan ( BlobRows, Blobs ) );
+    REQUIRE_LE ( LiveBytes (), live + 16 * 1024 );
+}
+
+FIXTURE_TEST_CASE(CellDataSpan_FixedWidth, CellDataFixture)
+{
+    REQUIRE_RC ( Setup ( GetName (), BlobRows, Blobs, 1 ) );
+
+    int64_t row = 1;
+    for ( uint32_t b = 0; b < Blobs; ++ b )
+    {
+        const void * base;
+        uint32_t boff, row_len, elem_bits, num_rows;
+        REQUIRE_RC ( VCursorCellDataSpan ( curs, row, col_idx, 4096, & elem_bits, & base, & boff, & row_len, & num_rows ) );
+        REQUIRE_EQ ( BlobRows [ b ], num_rows );
+        REQUIRE_EQ ( 32u, elem_bits );
+        REQUIRE_EQ ( 0u, boff );
+        REQUIRE_EQ ( 1u, row_len );
+        for ( uint32_t i = 0; i < num_rows; ++ i )
+            REQUIRE_EQ ( ( uint32_t ) ( row + i ), ( ( const uint32_t * ) base ) [ i ] );
+        row += num_rows;
+    }
+    REQUIRE_EQ ( ( int64_t ) rows + 1, row );
+}
+
 //////////////////////////////////////////// Main
 extern "C"
 {
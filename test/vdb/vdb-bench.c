@@ -0,0 +1,653 @@
+/*===========================================================================
+*
+*                            PUBLIC DOMAIN NOTICE
+*               National Center for Biotechnology Information
+*
+*  This software/database is a "United States Government Work" under the
+*  terms of the United States Copyright Act.  It was written as part of
+*  the author's official duties as a United States Government employee and
+*  thus cannot be copyrighted.  This software/database is freely available
+*  to the public for use. The National Library of Medicine and the U.S.
+*  Government have not placed any restriction on its use or reproduction.
+*
+*  Although all reasonable efforts have been taken to ensure the accuracy
+*  and reliability of the software and data, the NLM and the U.S.
+*  Government do not and cannot warrant the performance or results that
+*  may be obtained by using this software or data. The NLM and the U.S.
+*  Government disclaim all warranties, express or implied, including
+*  warranties of performance, merchantability or fitness for any particular
+*  purpose.
+*
+*  Please cite the author in any work or product based on this material.
+*
+* ===========================================================================
+*
+*/
+
+/* vdb-bench
+ *  builds a synthetic cSRA-shaped database of configurable size,
+ *  then times the common write and read paths against it.
+ *
+ *  every benchmark prints a single line of JSON to stdout so that
+ *  runs can be collected and compared by scripts. the generator is
+ *  seeded, so the same options always produce the same data.
+ */
+
+#include <kapp/main.h>
+#include <kapp/args.h>
+
+#include <vdb/manager.h>
+#include <vdb/database.h>
+#include <vdb/table.h>
+#include <vdb/cursor.h>
+#include <vdb/schema.h>
+#include <kdb/index.h>
+#include <kfs/directory.h>
+#include <klib/prof.h>
+#include <klib/printf.h>
+#include <klib/out.h>
+#include <klib/log.h>
+#include <klib/rc.h>
+
+#include <sysalloc.h>
+
+#include <stdlib.h>
+#include <string.h>
+
+#define OPTION_READS    "reads"
+#define ALIAS_READS     "r"
+
+#define OPTION_READLEN  "read-len"
+#define ALIAS_READLEN   "l"
+
+#define OPTION_ALIGNS   "aligns"
+#define ALIAS_ALIGNS    "a"
+
+#define OPTION_LOOKUPS  "lookups"
+#define ALIAS_LOOKUPS   "n"
+
+#define OPTION_SEED     "seed"
+#define ALIAS_SEED      "s"
+
+#define OPTION_OUTPUT   "output"
+#define ALIAS_OUTPUT    "o"
+
+#define OPTION_KEEP     "keep"
+#define ALIAS_KEEP      "k"
+
+static const char * reads_usage[]   = { "number of reads to generate ( default 100000 )", NULL };
+static const char * readlen_usage[] = { "bases per read ( default 100 )", NULL };
+static const char * aligns_usage[]  = { "alignments per read ( default 1 )", NULL };
+static const char * lookups_usage[] = { "random rows and index lookups to time, 0 skips them ( default 10000 )", NULL };
+static const char * seed_usage[]    = { "seed for the data generator ( default 1 )", NULL };
+static const char * output_usage[]  = { "path of the database to create ( default vdb-bench.db )", NULL };
+static const char * keep_usage[]    = { "do not remove the database when done", NULL };
+
+OptDef VdbBenchOptions[] =
+{
+/*    name             alias          fkt.  usage-txt,      cnt, needs value, required */
+    { OPTION_READS,    ALIAS_READS,   NULL, reads_usage,    1,   true,        false },
+    { OPTION_READLEN,  ALIAS_READLEN, NULL, readlen_usage,  1,   true,        false },
+    { OPTION_ALIGNS,   ALIAS_ALIGNS,  NULL, aligns_usage,   1,   true,        false },
+    { OPTION_LOOKUPS,  ALIAS_LOOKUPS, NULL, lookups_usage,  1,   true,        false },
+    { OPTION_SEED,     ALIAS_SEED,    NULL, seed_usage,     1,   true,        false },
+    { OPTION_OUTPUT,   ALIAS_OUTPUT,  NULL, output_usage,   1,   true,        false },
+    { OPTION_KEEP,     ALIAS_KEEP,    NULL, keep_usage,     1,   false,       false }
+};
+
+const char UsageDefaultName[] = "vdb-bench";
+
+rc_t CC UsageSummary ( const char * progname )
+{
+    return KOutMsg ("\n"
+                    "Usage:\n"
+                    "  %s [options]\n"
+                    "\n", progname);
+}
+
+rc_t CC Usage ( const Args * args )
+{
+    const char * progname = UsageDefaultName;
+    const char * fullpath = UsageDefaultName;
+    rc_t rc;
+
+    if ( args == NULL )
+        rc = RC ( rcApp, rcArgv, rcAccessing, rcSelf, rcNull );
+    else
+        rc = ArgsProgram ( args, &fullpath, &progname );
+
+    if ( rc )
+        progname = fullpath = UsageDefaultName;
+
+    UsageSummary ( progname );
+
+    KOutMsg ( "Options:\n" );
+
+    HelpOptionLine ( ALIAS_READS,   OPTION_READS,   "count",  reads_usage );
+    HelpOptionLine ( ALIAS_READLEN, OPTION_READLEN, "length", readlen_usage );
+    HelpOptionLine ( ALIAS_ALIGNS,  OPTION_ALIGNS,  "count",  aligns_usage );
+    HelpOptionLine ( ALIAS_LOOKUPS, OPTION_LOOKUPS, "count",  lookups_usage );
+    HelpOptionLine ( ALIAS_SEED,    OPTION_SEED,    "seed",   seed_usage );
+    HelpOptionLine ( ALIAS_OUTPUT,  OPTION_OUTPUT,  "path",   output_usage );
+    HelpOptionLine ( ALIAS_KEEP,    OPTION_KEEP,    NULL,     keep_usage );
+
+    HelpOptionsStandard ();
+    HelpVersion ( fullpath, KAppVersion() );
+    return rc;
+}
+
+ver_t CC KAppVersion ( void )
+{
+    return 0x1000000;
+}
+
+
+/*--------------------------------------------------------------------------
+ * schema
+ *  a cut-down cSRA layout: just enough of SEQUENCE and
+ *  PRIMARY_ALIGNMENT to exercise the same column shapes
+ */
+static const char bench_schema [] =
+    "table bench:SEQUENCE #1\n"
+    "{\n"
+    "    extern column ascii NAME;\n"
+    "    extern column ascii READ;\n"
+    "    extern column U8 QUALITY;\n"
+    "    extern column U32 READ_LEN;\n"
+    "};\n"
+    "table bench:PRIMARY_ALIGNMENT #1\n"
+    "{\n"
+    "    extern column I64 SEQ_SPOT_ID;\n"
+    "    extern column U32 REF_ID;\n"
+    "    extern column I32 REF_START;\n"
+    "    extern column U32 REF_LEN;\n"
+    "    extern column U8 MAPQ;\n"
+    "};\n"
+    "database bench:db #1\n"
+    "{\n"
+    "    table bench:SEQUENCE #1 SEQUENCE;\n"
+    "    table bench:PRIMARY_ALIGNMENT #1 PRIMARY_ALIGNMENT;\n"
+    "};\n";
+
+#define SEQ_COLS 4
+static const char * seq_cols [ SEQ_COLS ] = { "NAME", "READ", "QUALITY", "READ_LEN" };
+
+#define ALIGN_COLS 5
+static const char * align_cols [ ALIGN_COLS ] =
+    { "SEQ_SPOT_ID", "REF_ID", "REF_START", "REF_LEN", "MAPQ" };
+
+#define NAME_INDEX "skey"
+
+
+/*--------------------------------------------------------------------------
+ * BenchParams
+ */
+typedef struct BenchParams BenchParams;
+struct BenchParams
+{
+    const char * path;
+    uint64_t reads;
+    uint64_t lookups;
+    uint32_t read_len;
+    uint32_t aligns;
+    uint32_t seed;
+    bool keep;
+};
+
+/* a small LCG keeps the data identical across platforms,
+   which rand() does not */
+static
+uint32_t bench_rand ( uint64_t * state )
+{
+    * state = * state * 6364136223846793005ULL + 1442695040888963407ULL;
+    return ( uint32_t ) ( * state >> 33 );
+}
+
+static
+rc_t bench_report ( const char * name, uint64_t rows, uint64_t bytes, uint64_t ns )
+{
+    double secs = ( double ) ns / 1e9;
+    if ( secs <= 0 )
+        secs = 1e-9;
+
+    return KOutMsg ( "{\"bench\":\"%s\",\"rows\":%lu,\"bytes\":%lu,\"ns\":%lu,"
+                     "\"rows_per_sec\":%.1f,\"mb_per_sec\":%.3f}\n",
+                     name, rows, bytes, ns,
+                     ( double ) rows / secs,
+                     ( double ) bytes / ( 1024.0 * 1024.0 ) / secs );
+}
+
+static
+rc_t add_columns ( const VCursor * curs, uint32_t * idx, const char ** names, uint32_t count )
+{
+    rc_t rc = 0;
+    uint32_t i;
+    for ( i = 0; rc == 0 && i < count; ++ i )
+    {
+        rc = VCursorAddColumn ( curs, & idx [ i ], "%s", names [ i ] );
+        if ( rc != 0 )
+            PLOGERR ( klogErr, ( klogErr, rc, "failed to add column '$(name)'", "name=%s", names [ i ] ) );
+    }
+    return rc;
+}
+
+
+/*--------------------------------------------------------------------------
+ * write side
+ */
+static
+rc_t write_sequence ( VDatabase * db, const BenchParams * p )
+{
+    VTable * tbl;
+    rc_t rc = VDatabaseCreateTable ( db, & tbl, "SEQUENCE", kcmCreate | kcmMD5, "SEQUENCE" );
+    if ( rc != 0 )
+        LOGERR ( klogErr, rc, "failed to create SEQUENCE" );
+    else
+    {
+        KIndex * idx;
+        rc = VTableCreateIndex ( tbl, & idx, kitText, kcmInit, NAME_INDEX );
+        if ( rc != 0 )
+            LOGERR ( klogErr, rc, "failed to create name index" );
+        else
+        {
+            VCursor * curs;
+            rc = VTableCreateCursorWrite ( tbl, & curs, kcmInsert );
+            if ( rc == 0 )
+            {
+                uint32_t col [ SEQ_COLS ];
+                rc = add_columns ( curs, col, seq_cols, SEQ_COLS );
+                if ( rc == 0 )
+                    rc = VCursorOpen ( curs );
+                if ( rc == 0 )
+                {
+                    char * read = malloc ( p -> read_len );
+                    uint8_t * qual = malloc ( p -> read_len );
+                    if ( read == NULL || qual == NULL )
+                        rc = RC ( rcExe, rcData, rcAllocating, rcMemory, rcExhausted );
+                    else
+                    {
+                        static const char bases [ 4 ] = { 'A', 'C', 'G', 'T' };
+                        uint64_t state = p -> seed;
+                        uint64_t bytes = 0;
+                        uint64_t i, start = KProfNow ();
+
+                        for ( i = 0; rc == 0 && i < p -> reads; ++ i )
+                        {
+                            char name [ 32 ];
+                            size_t name_len;
+                            uint32_t j;
+
+                            for ( j = 0; j < p -> read_len; ++ j )
+                            {
+                                uint32_t r = bench_rand ( & state );
+                                read [ j ] = bases [ r & 3 ];
+                                qual [ j ] = ( uint8_t ) ( 2 + ( r >> 8 ) % 40 );
+                            }
+
+                            rc = string_printf ( name, sizeof name, & name_len, "BENCH.%lu", i + 1 );
+                            if ( rc == 0 )
+                                rc = VCursorOpenRow ( curs );
+                            if ( rc == 0 )
+                                rc = VCursorWrite ( curs, col [ 0 ], 8, name, 0, name_len );
+                            if ( rc == 0 )
+                                rc = VCursorWrite ( curs, col [ 1 ], 8, read, 0, p -> read_len );
+                            if ( rc == 0 )
+                                rc = VCursorWrite ( curs, col [ 2 ], 8, qual, 0, p -> read_len );
+                            if ( rc == 0 )
+                                rc = VCursorWrite ( curs, col [ 3 ], 32, & p -> read_len, 0, 1 );
+                            if ( rc == 0 )
+                                rc = VCursorCommitRow ( curs );
+                            if ( rc == 0 )
+                                rc = VCursorCloseRow ( curs );
+                            if ( rc == 0 )
+                                rc = KIndexInsertText ( idx, true, name, ( int64_t ) ( i + 1 ) );
+
+                            bytes += name_len + 2 * p -> read_len + sizeof p -> read_len;
+                        }
+
+                        if ( rc == 0 )
+                            rc = VCursorCommit ( curs );
+                        if ( rc == 0 )
+                            rc = KIndexCommit ( idx );
+                        if ( rc == 0 )
+                            rc = bench_report ( "write-sequence", p -> reads, bytes, KProfNow () - start );
+                        else
+                            LOGERR ( klogErr, rc, "failed to write SEQUENCE" );
+                    }
+                    free ( qual );
+                    free ( read );
+                }
+                VCursorRelease ( curs );
+            }
+            KIndexRelease ( idx );
+        }
+        VTableRelease ( tbl );
+    }
+    return rc;
+}
+
+static
+rc_t write_alignment ( VDatabase * db, const BenchParams * p )
+{
+    VTable * tbl;
+    rc_t rc = VDatabaseCreateTable ( db, & tbl, "PRIMARY_ALIGNMENT", kcmCreate | kcmMD5, "PRIMARY_ALIGNMENT" );
+    if ( rc != 0 )
+        LOGERR ( klogErr, rc, "failed to create PRIMARY_ALIGNMENT" );
+    else
+    {
+        VCursor * curs;
+        rc = VTableCreateCursorWrite ( tbl, & curs, kcmInsert );
+        if ( rc == 0 )
+        {
+            uint32_t col [ ALIGN_COLS ];
+            rc = add_columns ( curs, col, align_cols, ALIGN_COLS );
+            if ( rc == 0 )
+                rc = VCursorOpen ( curs );
+            if ( rc == 0 )
+            {
+                uint64_t state = p -> seed ^ 0x5bd1e995;
+                uint64_t rows = 0;
+                uint64_t bytes = 0;
+                uint64_t i, start = KProfNow ();
+
+                for ( i = 0; rc == 0 && i < p -> reads; ++ i )
+                {
+                    uint32_t j;
+                    for ( j = 0; rc == 0 && j < p -> aligns; ++ j )
+                    {
+                        int64_t spot_id = ( int64_t ) ( i + 1 );
+                        uint32_t ref_id = bench_rand ( & state ) % 24;
+                        int32_t ref_start = ( int32_t ) ( bench_rand ( & state ) % 100000000 );
+                        uint8_t mapq = ( uint8_t ) ( bench_rand ( & state ) % 61 );
+
+                        rc = VCursorOpenRow ( curs );
+                        if ( rc == 0 )
+                            rc = VCursorWrite ( curs, col [ 0 ], 64, & spot_id, 0, 1 );
+                        if ( rc == 0 )
+                            rc = VCursorWrite ( curs, col [ 1 ], 32, & ref_id, 0, 1 );
+                        if ( rc == 0 )
+                            rc = VCursorWrite ( curs, col [ 2 ], 32, & ref_start, 0, 1 );
+                        if ( rc == 0 )
+                            rc = VCursorWrite ( curs, col [ 3 ], 32, & p -> read_len, 0, 1 );
+                        if ( rc == 0 )
+                            rc = VCursorWrite ( curs, col [ 4 ], 8, & mapq, 0, 1 );
+                        if ( rc == 0 )
+                            rc = VCursorCommitRow ( curs );
+                        if ( rc == 0 )
+                            rc = VCursorCloseRow ( curs );
+                        ++ rows;
+
+                        bytes += sizeof spot_id + sizeof ref_id + sizeof ref_start + sizeof p -> read_len + sizeof mapq;
+                    }
+                }
+
+                if ( rc == 0 )
+                    rc = VCursorCommit ( curs );
+                if ( rc == 0 )
+                    rc = bench_report ( "write-alignment", rows, bytes, KProfNow () - start );
+                else
+                    LOGERR ( klogErr, rc, "failed to write PRIMARY_ALIGNMENT" );
+            }
+            VCursorRelease ( curs );
+        }
+        VTableRelease ( tbl );
+    }
+    return rc;
+}
+
+
+/*--------------------------------------------------------------------------
+ * read side
+ */
+
+/* read_rows
+ *  reads the given rows of every column on the cursor.
+ *  "ids" may be NULL to walk "count" rows in order from "first".
+ */
+static
+rc_t read_rows ( const VCursor * curs, const uint32_t * col, uint32_t ncols,
+    const int64_t * ids, int64_t first, uint64_t count, uint64_t * bytes )
+{
+    rc_t rc = 0;
+    uint64_t i;
+
+    for ( i = 0; rc == 0 && i < count; ++ i )
+    {
+        int64_t row_id = ( ids == NULL ) ? first + ( int64_t ) i : ids [ i ];
+        uint32_t c;
+        for ( c = 0; rc == 0 && c < ncols; ++ c )
+        {
+            uint32_t elem_bits, boff, row_len;
+            const void * base;
+            rc = VCursorCellDataDirect ( curs, row_id, col [ c ], & elem_bits, & base, & boff, & row_len );
+            if ( rc == 0 )
+                * bytes += ( ( uint64_t ) elem_bits * row_len + 7 ) >> 3;
+        }
+    }
+    return rc;
+}
+
+static
+rc_t bench_read ( const VTable * tbl, const char * name, const char ** cols, uint32_t ncols,
+    const int64_t * ids, uint64_t count )
+{
+    const VCursor * curs;
+    rc_t rc = VTableCreateCursorRead ( tbl, & curs );
+    if ( rc == 0 )
+    {
+        uint32_t col [ ALIGN_COLS ];
+        uint64_t start = KProfNow ();
+
+        rc = add_columns ( curs, col, cols, ncols );
+        if ( rc == 0 )
+            rc = VCursorOpen ( curs );
+        if ( rc == 0 )
+        {
+            uint64_t bytes = 0;
+            int64_t first = 1;
+            if ( ids == NULL )
+                rc = VCursorIdRange ( curs, 0, & first, & count );
+            if ( rc == 0 )
+                rc = read_rows ( curs, col, ncols, ids, first, count, & bytes );
+            if ( rc == 0 )
+                rc = bench_report ( name, count, bytes, KProfNow () - start );
+        }
+        if ( rc != 0 )
+            PLOGERR ( klogErr, ( klogErr, rc, "benchmark '$(name)' failed", "name=%s", name ) );
+        VCursorRelease ( curs );
+    }
+    return rc;
+}
+
+static
+rc_t bench_index ( const VTable * tbl, const BenchParams * p )
+{
+    const KIndex * idx;
+    rc_t rc = VTableOpenIndexRead ( tbl, & idx, NAME_INDEX );
+    if ( rc != 0 )
+        LOGERR ( klogErr, rc, "failed to open name index" );
+    else
+    {
+        uint64_t state = p -> seed + 1;
+        uint64_t i, start = KProfNow ();
+
+        for ( i = 0; rc == 0 && i < p -> lookups; ++ i )
+        {
+            char name [ 32 ];
+            size_t name_len;
+            uint64_t want = 1 + bench_rand ( & state ) % p -> reads;
+
+            rc = string_printf ( name, sizeof name, & name_len, "BENCH.%lu", want );
+            if ( rc == 0 )
+            {
+                int64_t id;
+                uint64_t id_count;
+                rc = KIndexFindText ( idx, name, & id, & id_count, NULL, NULL );
+                if ( rc == 0 && id != ( int64_t ) want )
+                {
+                    rc = RC ( rcExe, rcIndex, rcSearching, rcData, rcCorrupt );
+                    PLOGERR ( klogErr, ( klogErr, rc, "index returned wrong row for '$(name)'", "name=%s", name ) );
+                }
+            }
+        }
+
+        if ( rc == 0 )
+            rc = bench_report ( "index-lookup", p -> lookups, 0, KProfNow () - start );
+        KIndexRelease ( idx );
+    }
+    return rc;
+}
+
+static
+rc_t run_reads ( const VDBManager * mgr, const BenchParams * p )
+{
+    const VDatabase * db;
+    rc_t rc = VDBManagerOpenDBRead ( mgr, & db, NULL, "%s", p -> path );
+    if ( rc != 0 )
+        LOGERR ( klogErr, rc, "failed to reopen database" );
+    else
+    {
+        const VTable * seq;
+        rc = VDatabaseOpenTableRead ( db, & seq, "SEQUENCE" );
+        if ( rc == 0 )
+        {
+            rc = bench_read ( seq, "scan-sequence", seq_cols, SEQ_COLS, NULL, 0 );
+            if ( rc == 0 )
+                rc = bench_read ( seq, "scan-sequence-read-len", & seq_cols [ 3 ], 1, NULL, 0 );
+
+            if ( rc == 0 && p -> lookups != 0 )
+            {
+                int64_t * ids = malloc ( p -> lookups * sizeof * ids );
+                if ( ids == NULL )
+                    rc = RC ( rcExe, rcData, rcAllocating, rcMemory, rcExhausted );
+                else
+                {
+                    uint64_t state = p -> seed + 2;
+                    uint64_t i;
+                    for ( i = 0; i < p -> lookups; ++ i )
+                        ids [ i ] = 1 + ( int64_t ) ( bench_rand ( & state ) % p -> reads );
+
+                    rc = bench_read ( seq, "random-sequence", seq_cols, SEQ_COLS, ids, p -> lookups );
+                    if ( rc == 0 )
+                        rc = bench_index ( seq, p );
+
+                    free ( ids );
+                }
+            }
+            VTableRelease ( seq );
+        }
+
+        if ( rc == 0 && p -> aligns != 0 )
+        {
+            const VTable * align;
+            rc = VDatabaseOpenTableRead ( db, & align, "PRIMARY_ALIGNMENT" );
+            if ( rc == 0 )
+            {
+                rc = bench_read ( align, "scan-alignment", align_cols, ALIGN_COLS, NULL, 0 );
+                VTableRelease ( align );
+            }
+        }
+
+        VDatabaseRelease ( db );
+    }
+    return rc;
+}
+
+static
+rc_t run_writes ( VDBManager * mgr, const BenchParams * p )
+{
+    VSchema * schema;
+    rc_t rc = VDBManagerMakeSchema ( mgr, & schema );
+    if ( rc == 0 )
+    {
+        rc = VSchemaParseText ( schema, "vdb-bench", bench_schema, sizeof bench_schema - 1 );
+        if ( rc != 0 )
+            LOGERR ( klogInt, rc, "failed to parse benchmark schema" );
+        else
+        {
+            VDatabase * db;
+            rc = VDBManagerCreateDB ( mgr, & db, schema, "bench:db", kcmInit | kcmMD5 | kcmParents, "%s", p -> path );
+            if ( rc != 0 )
+                PLOGERR ( klogErr, ( klogErr, rc, "failed to create '$(path)'", "path=%s", p -> path ) );
+            else
+            {
+                rc = write_sequence ( db, p );
+                if ( rc == 0 && p -> aligns != 0 )
+                    rc = write_alignment ( db, p );
+                VDatabaseRelease ( db );
+            }
+        }
+        VSchemaRelease ( schema );
+    }
+    return rc;
+}
+
+static uint64_t get_uint64_option( const Args *my_args,
+                                   const char *name,
+                                   const uint64_t def )
+{
+    uint32_t count;
+    uint64_t res = def;
+    rc_t rc = ArgsOptionCount( my_args, name, &count );
+    if ( ( rc == 0 )&&( count > 0 ) )
+    {
+        const char *s;
+        rc = ArgsOptionValue( my_args, name, 0,  &s );
+        if ( rc == 0 ) res = strtoull( s, NULL, 10 );
+    }
+    return res;
+}
+
+rc_t CC KMain ( int argc, char *argv [] )
+{
+    Args * args;
+
+    rc_t rc = ArgsMakeAndHandle ( &args, argc, argv, 1,
+                VdbBenchOptions, sizeof ( VdbBenchOptions ) / sizeof ( OptDef ) );
+    if ( rc == 0 )
+    {
+        BenchParams p;
+        uint32_t count;
+
+        p . path = "vdb-bench.db";
+        if ( ArgsOptionCount ( args, OPTION_OUTPUT, & count ) == 0 && count > 0 )
+            ArgsOptionValue ( args, OPTION_OUTPUT, 0, & p . path );
+
+        p . keep = ( ArgsOptionCount ( args, OPTION_KEEP, & count ) == 0 && count > 0 );
+        p . reads = get_uint64_option ( args, OPTION_READS, 100000 );
+        p . lookups = get_uint64_option ( args, OPTION_LOOKUPS, 10000 );
+        p . read_len = ( uint32_t ) get_uint64_option ( args, OPTION_READLEN, 100 );
+        p . aligns = ( uint32_t ) get_uint64_option ( args, OPTION_ALIGNS, 1 );
+        p . seed = ( uint32_t ) get_uint64_option ( args, OPTION_SEED, 1 );
+
+        if ( p . reads == 0 || p . read_len == 0 )
+        {
+            rc = RC ( rcExe, rcArgv, rcValidating, rcParam, rcInvalid );
+            LOGERR ( klogErr, rc, "reads and read-len must be non-zero" );
+        }
+        else
+        {
+            VDBManager * mgr;
+            rc = VDBManagerMakeUpdate ( & mgr, NULL );
+            if ( rc == 0 )
+            {
+                rc = run_writes ( mgr, & p );
+                if ( rc == 0 )
+                    rc = run_reads ( mgr, & p );
+
+                if ( ! p . keep )
+                {
+                    KDirectory * wd;
+                    if ( KDirectoryNativeDir ( & wd ) == 0 )
+                    {
+                        KDirectoryRemove ( wd, true, "%s", p . path );
+                        KDirectoryRelease ( wd );
+                    }
+                }
+                VDBManagerRelease ( mgr );
+            }
+        }
+        ArgsWhack ( args );
+    }
+    return rc;
+}
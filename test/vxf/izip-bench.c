@@ -0,0 +1,440 @@
+/*===========================================================================
+*
+*                            PUBLIC DOMAIN NOTICE
+*               National Center for Biotechnology Information
+*
+*  This software/database is a "United States Government Work" under the
+*  terms of the United States Copyright Act.  It was written as part of
+*  the author's official duties as a United States Government employee and
+*  thus cannot be copyrighted.  This software/database is freely available
+*  to the public for use. The National Library of Medicine and the U.S.
+*  Government have not placed any restriction on its use or reproduction.
+*
+*  Although all reasonable efforts have been taken to ensure the accuracy
+*  and reliability of the software and data, the NLM and the U.S.
+*  Government do not and cannot warrant the performance or results that
+*  may be obtained by using this software or data. The NLM and the U.S.
+*  Government disclaim all warranties, express or implied, including
+*  warranties of performance, merchantability or fitness for any particular
+*  purpose.
+*
+*  Please cite the author in any work or product based on this material.
+*
+* ===========================================================================
+*
+*/
+
+/*
+ * decode throughput of izip and irzip with and without the SIMD kernels,
+ * in MB of decoded data per second. the series are the cells of real
+ * column blobs, re-encoded here, or synthetic ones when no column is given.
+ * meant to be run by hand, not as part of the tests.
+ */
+
+#include "wb-izip-impl.h"
+#include "wb-irzip-impl.h"
+
+#include <vdb/manager.h>
+#include <vdb/database.h>
+#include <vdb/table.h>
+#include <vdb/cursor.h>
+#include <vdb/blob.h>
+#include <klib/rc.h>
+#include <klib/out.h>
+#include <klib/time.h>
+#include <kapp/main.h>
+#include <kapp/args.h>
+
+#include <stdlib.h>
+#include <string.h>
+
+#define BENCH_MS 200
+#define BENCH_BLOBS 16
+#define MAX_SERIES ( 1024 * 1024 )
+#define SYNTHETIC_SERIES ( 64 * 1024 )
+
+/* room for the encoders' headers when a blob barely compresses */
+#define ENCODED_SIZE( bytes ) ( ( bytes ) * 2 + 1024 )
+
+typedef struct Series Series;
+struct Series
+{
+    void *y;
+    void *decoded;
+    uint8_t *encoded;
+    int64_t first;
+    uint64_t count;
+    unsigned N;
+    unsigned elem_bits;
+};
+
+static uint64_t seed = 88172645463325252ULL;
+
+static
+uint64_t Random ( void )
+{
+    seed ^= seed << 13;
+    seed ^= seed >> 7;
+    seed ^= seed << 17;
+    return seed;
+}
+
+static
+unsigned IzipType ( unsigned elem_bits )
+{
+    switch ( elem_bits )
+    {
+    case 8:  return izip_i8;
+    case 16: return izip_i16;
+    case 32: return izip_i32;
+    default: return izip_i64;
+    }
+}
+
+static
+uint64_t Rate ( uint64_t bytes, KTimeMs_t ms )
+{
+    return ms == 0 ? 0 : bytes / 1000 / ms;
+}
+
+static
+rc_t Verify ( const Series *s )
+{
+    if ( memcmp ( s -> y, s -> decoded, ( size_t ) s -> N * ( s -> elem_bits >> 3 ) ) != 0 )
+        return RC ( rcExe, rcBuffer, rcValidating, rcData, rcCorrupt );
+    return 0;
+}
+
+static
+rc_t BenchIzip ( const Series *s, bool scalar, uint64_t *rate )
+{
+    rc_t rc;
+    unsigned used = 0;
+    const unsigned type = IzipType ( s -> elem_bits );
+    const size_t bytes = ( size_t ) s -> N * ( s -> elem_bits >> 3 );
+    uint64_t total = 0;
+    KTimeMs_t start, ms;
+
+    rc = doIzipEncode ( type, s -> encoded, ( unsigned ) ENCODED_SIZE ( bytes ), & used, s -> y, s -> N );
+
+    start = KTimeMsStamp ();
+    do
+    {
+        if ( rc == 0 )
+        {
+            rc = scalar
+                ? doIunzipDecodeScalar ( type, s -> decoded, s -> N, s -> encoded, used )
+                : doIunzipDecode ( type, s -> decoded, s -> N, s -> encoded, used );
+        }
+        total += bytes;
+        ms = KTimeMsStamp () - start;
+    }
+    while ( rc == 0 && ms < BENCH_MS );
+
+    if ( rc == 0 )
+        rc = Verify ( s );
+    * rate = Rate ( total, ms );
+    return rc;
+}
+
+static
+rc_t IrzipDecode ( const Series *s, bool scalar, int64_t *min, int64_t *slope,
+    uint8_t series_count, uint8_t planes, size_t used )
+{
+    if ( s -> elem_bits == 32 )
+    {
+        return scalar
+            ? doDecodeScalar_i32 ( s -> decoded, s -> N, min, slope, series_count, planes, s -> encoded, used )
+            : doDecode_i32 ( s -> decoded, s -> N, min, slope, series_count, planes, s -> encoded, used );
+    }
+    return scalar
+        ? doDecodeScalar_i64 ( s -> decoded, s -> N, min, slope, series_count, planes, s -> encoded, used )
+        : doDecode_i64 ( s -> decoded, s -> N, min, slope, series_count, planes, s -> encoded, used );
+}
+
+static
+rc_t BenchIrzip ( const Series *s, bool scalar, uint64_t *rate )
+{
+    rc_t rc;
+    size_t used = 0;
+    int64_t min [ 2 ] = { 0, 0 }, slope [ 2 ] = { 0, 0 };
+    uint8_t series_count = 0, planes = 0;
+    const size_t bytes = ( size_t ) s -> N * ( s -> elem_bits >> 3 );
+    uint64_t total = 0;
+    KTimeMs_t start, ms;
+
+    if ( s -> elem_bits == 32 )
+    {
+        rc = doEncode_i32 ( s -> encoded, ENCODED_SIZE ( bytes ), & used, min, slope,
+            & series_count, & planes, s -> y, s -> N );
+    }
+    else
+    {
+        rc = doEncode_i64 ( s -> encoded, ENCODED_SIZE ( bytes ), & used, min, slope,
+            & series_count, & planes, s -> y, s -> N );
+    }
+
+    start = KTimeMsStamp ();
+    do
+    {
+        if ( rc == 0 )
+        {
+            /* the decoders consume their min and slope arrays */
+            int64_t dmin [ 2 ], dslope [ 2 ];
+            memmove ( dmin, min, sizeof dmin );
+            memmove ( dslope, slope, sizeof dslope );
+            rc = IrzipDecode ( s, scalar, dmin, dslope, series_count, planes, used );
+        }
+        total += bytes;
+        ms = KTimeMsStamp () - start;
+    }
+    while ( rc == 0 && ms < BENCH_MS );
+
+    if ( rc == 0 )
+        rc = Verify ( s );
+    * rate = Rate ( total, ms );
+    return rc;
+}
+
+static
+rc_t Bench ( const Series *s )
+{
+    uint64_t simd, scalar;
+    rc_t rc;
+
+    rc = BenchIzip ( s, false, & simd );
+    if ( rc == 0 )
+        rc = BenchIzip ( s, true, & scalar );
+    if ( rc != 0 )
+    {
+        return KOutMsg ( "rows %ld-%ld, %u x %2u bits: izip cannot round-trip, %R\n",
+            s -> first, s -> first + ( int64_t ) s -> count - 1, s -> N, s -> elem_bits, rc );
+    }
+    rc = KOutMsg ( "rows %ld-%ld, %u x %2u bits: izip simd %6lu MB/s, scalar %6lu MB/s",
+        s -> first, s -> first + ( int64_t ) s -> count - 1, s -> N, s -> elem_bits,
+        simd, scalar );
+
+    if ( rc == 0 && s -> elem_bits >= 32 )
+    {
+        rc_t rc2 = BenchIrzip ( s, false, & simd );
+        if ( rc2 == 0 )
+            rc2 = BenchIrzip ( s, true, & scalar );
+        if ( rc2 == 0 )
+            rc = KOutMsg ( "; irzip simd %6lu MB/s, scalar %6lu MB/s", simd, scalar );
+        else
+            rc = KOutMsg ( "; irzip cannot round-trip, %R", rc2 );
+    }
+
+    if ( rc == 0 )
+        rc = KOutMsg ( "\n" );
+    return rc;
+}
+
+static
+rc_t SeriesAlloc ( Series *s, unsigned elem_bits, unsigned N )
+{
+    const size_t bytes = ( size_t ) N * ( elem_bits >> 3 );
+
+    memset ( s, 0, sizeof * s );
+    s -> elem_bits = elem_bits;
+    s -> y = malloc ( bytes );
+    s -> decoded = malloc ( bytes );
+    s -> encoded = malloc ( ENCODED_SIZE ( bytes ) );
+    if ( s -> y == NULL || s -> decoded == NULL || s -> encoded == NULL )
+        return RC ( rcExe, rcBuffer, rcAllocating, rcMemory, rcExhausted );
+    return 0;
+}
+
+static
+void SeriesWhack ( Series *s )
+{
+    free ( s -> encoded );
+    free ( s -> decoded );
+    free ( s -> y );
+}
+
+static
+void SeriesAppend ( Series *s, const void *base, uint32_t row_len )
+{
+    const size_t elem = s -> elem_bits >> 3;
+
+    if ( row_len > MAX_SERIES - s -> N )
+        row_len = MAX_SERIES - s -> N;
+    memmove ( ( uint8_t* ) s -> y + s -> N * elem, base, row_len * elem );
+    s -> N += row_len;
+}
+
+/* the cells of one blob, end to end */
+static
+rc_t ReadBlob ( const VCursor *curs, uint32_t idx, int64_t row, Series *s, int64_t *next )
+{
+    const VBlob *blob;
+    rc_t rc = VCursorGetBlobDirect ( curs, & blob, row, idx );
+    if ( rc == 0 )
+    {
+        rc = VBlobIdRange ( blob, & s -> first, & s -> count );
+        for ( row = s -> first; rc == 0 && row < s -> first + ( int64_t ) s -> count; ++ row )
+        {
+            uint32_t elem_bits, boff, row_len;
+            const void *base;
+
+            rc = VBlobCellData ( blob, row, & elem_bits, & base, & boff, & row_len );
+            if ( rc == 0 && ( elem_bits != s -> elem_bits || boff != 0 ) )
+                rc = RC ( rcExe, rcColumn, rcReading, rcType, rcUnsupported );
+            if ( rc == 0 )
+                SeriesAppend ( s, base, row_len );
+        }
+        * next = s -> first + ( int64_t ) s -> count;
+        VBlobRelease ( blob );
+    }
+    return rc;
+}
+
+static
+rc_t OpenTable ( const VDBManager *mgr, const char *path, const char *table, const VTable **tbl )
+{
+    rc_t rc;
+    const VDatabase *db;
+
+    if ( table == NULL )
+        return VDBManagerOpenTableRead ( mgr, tbl, NULL, "%s", path );
+
+    rc = VDBManagerOpenDBRead ( mgr, & db, NULL, "%s", path );
+    if ( rc == 0 )
+    {
+        rc = VDatabaseOpenTableRead ( db, tbl, "%s", table );
+        VDatabaseRelease ( db );
+    }
+    return rc;
+}
+
+static
+rc_t BenchColumn ( const char *path, const char *column, const char *table )
+{
+    const VDBManager *mgr;
+    rc_t rc = VDBManagerMakeRead ( & mgr, NULL );
+    if ( rc == 0 )
+    {
+        const VTable *tbl;
+        rc = OpenTable ( mgr, path, table, & tbl );
+        if ( rc == 0 )
+        {
+            const VCursor *curs;
+            rc = VTableCreateCursorRead ( tbl, & curs );
+            if ( rc == 0 )
+            {
+                uint32_t idx;
+                rc = VCursorAddColumn ( curs, & idx, "%s", column );
+                if ( rc == 0 )
+                    rc = VCursorOpen ( curs );
+                if ( rc == 0 )
+                {
+                    int64_t row, end;
+                    uint64_t count;
+                    uint32_t elem_bits = 0, blobs;
+
+                    rc = VCursorIdRange ( curs, idx, & row, & count );
+                    end = row + ( int64_t ) count;
+
+                    /* the element size is that of the first cell */
+                    if ( rc == 0 && count != 0 )
+                    {
+                        const void *base;
+                        uint32_t boff, row_len;
+                        rc = VCursorCellDataDirect ( curs, row, idx, & elem_bits, & base, & boff, & row_len );
+                        if ( rc == 0 && elem_bits != 8 && elem_bits != 16 && elem_bits != 32 && elem_bits != 64 )
+                            rc = RC ( rcExe, rcColumn, rcReading, rcType, rcUnsupported );
+                    }
+
+                    for ( blobs = 0; rc == 0 && row < end && blobs < BENCH_BLOBS; ++ blobs )
+                    {
+                        Series s;
+                        rc = SeriesAlloc ( & s, elem_bits, MAX_SERIES );
+                        if ( rc == 0 )
+                            rc = ReadBlob ( curs, idx, row, & s, & row );
+                        if ( rc == 0 && s.N != 0 )
+                            rc = Bench ( & s );
+                        SeriesWhack ( & s );
+                    }
+                }
+                VCursorRelease ( curs );
+            }
+            VTableRelease ( tbl );
+        }
+        VDBManagerRelease ( mgr );
+    }
+    return rc;
+}
+
+/* positions and lengths of the kind the codecs see most: slowly rising,
+   with the odd jump */
+static
+rc_t BenchSynthetic ( void )
+{
+    rc_t rc = 0;
+    unsigned elem_bits;
+
+    for ( elem_bits = 8; rc == 0 && elem_bits <= 64; elem_bits <<= 1 )
+    {
+        Series s;
+        rc = SeriesAlloc ( & s, elem_bits, SYNTHETIC_SERIES );
+        if ( rc == 0 )
+        {
+            unsigned i;
+            int64_t v = 0;
+
+            for ( i = 0; i < SYNTHETIC_SERIES; ++ i )
+            {
+                const uint64_t r = Random ();
+                v += ( r % 64 == 0 ) ? ( int64_t ) ( r % 1000 ) : ( int64_t ) ( r % 4 );
+                switch ( elem_bits )
+                {
+                case 8:  ( ( int8_t* ) s.y ) [ i ] = ( int8_t ) ( r % 100 ); break;
+                case 16: ( ( int16_t* ) s.y ) [ i ] = ( int16_t ) ( 150 + r % 5 ); break;
+                case 32: ( ( int32_t* ) s.y ) [ i ] = ( int32_t ) v; break;
+                default: ( ( int64_t* ) s.y ) [ i ] = v; break;
+                }
+            }
+            s.N = SYNTHETIC_SERIES;
+            s.first = 1;
+            s.count = SYNTHETIC_SERIES;
+            rc = Bench ( & s );
+        }
+        SeriesWhack ( & s );
+    }
+    return rc;
+}
+
+ver_t CC KAppVersion ( void )
+{
+    return 0;
+}
+
+const char UsageDefaultName[] = "test-izip-bench";
+
+rc_t CC UsageSummary ( const char * progname )
+{
+    return KOutMsg (
+        "Usage:\n"
+        " %s [ path column [ table ] ]\n"
+        "\n"
+        "    measure izip and irzip decode throughput with and without the\n"
+        "    SIMD kernels, over the first blobs of a column of 8, 16, 32 or\n"
+        "    64-bit integers. path is a table, or a database when table is\n"
+        "    given. without arguments, synthetic series are used\n"
+        "\n", progname );
+}
+
+rc_t CC Usage ( const Args * args )
+{
+    return UsageSummary ( UsageDefaultName );
+}
+
+rc_t CC KMain ( int argc, char *argv [] )
+{
+    if ( argc == 1 )
+        return BenchSynthetic ();
+    if ( argc == 3 || argc == 4 )
+        return BenchColumn ( argv [ 1 ], argv [ 2 ], argc == 4 ? argv [ 3 ] : NULL );
+    return UsageSummary ( UsageDefaultName );
+}
@@ -49,6 +49,12 @@ rc_t doDecode_u32(uint32_t  Y[], unsigned N, int64_t* min, int64_t* slope, uint8
 rc_t doEncode_i32(uint8_t dst[], size_t dsize, size_t *used, int64_t *Min, int64_t *Slope, uint8_t *series_count,uint8_t *planes, const int32_t Y[], unsigned N);
 rc_t doDecode_i32(int32_t  Y[], unsigned N, int64_t* min, int64_t* slope, uint8_t series_count, uint8_t planes, const uint8_t src[], size_t ssize);
 
+/* decoders built without the SIMD kernels */
+rc_t doDecodeScalar_u64(uint64_t Y[], unsigned N, int64_t* min, int64_t* slope, uint8_t series_count, uint8_t planes, const uint8_t src[], size_t ssize);
+rc_t doDecodeScalar_i64(int64_t Y[], unsigned N, int64_t* min, int64_t* slope, uint8_t series_count, uint8_t planes, const uint8_t src[], size_t ssize);
+rc_t doDecodeScalar_u32(uint32_t Y[], unsigned N, int64_t* min, int64_t* slope, uint8_t series_count, uint8_t planes, const uint8_t src[], size_t ssize);
+rc_t doDecodeScalar_i32(int32_t Y[], unsigned N, int64_t* min, int64_t* slope, uint8_t series_count, uint8_t planes, const uint8_t src[], size_t ssize);
+
 #ifdef __cplusplus
 }
 #endif
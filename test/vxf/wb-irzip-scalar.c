@@ -0,0 +1,66 @@
+/*===========================================================================
+*
+*                            PUBLIC DOMAIN NOTICE
+*               National Center for Biotechnology Information
+*
+*  This software/database is a "United States Government Work" under the
+*  terms of the United States Copyright Act.  It was written as part of
+*  the author's official duties as a United States Government employee and
+*  thus cannot be copyrighted.  This software/database is freely available
+*  to the public for use. The National Library of Medicine and the U.S.
+*  Government have not placed any restriction on its use or reproduction.
+*
+*  Although all reasonable efforts have been taken to ensure the accuracy
+*  and reliability of the software and data, the NLM and the U.S.
+*  Government do not and cannot warrant the performance or results that
+*  may be obtained by using this software or data. The NLM and the U.S.
+*  Government disclaim all warranties, express or implied, including
+*  warranties of performance, merchantability or fitness for any particular
+*  purpose.
+*
+*  Please cite the author in any work or product based on this material.
+*
+* ===========================================================================
+*
+*/
+
+#include "wb-irzip-impl.h"
+
+/* the irzip decoders again, without the SIMD kernels */
+#define IZIP_SSE2 0
+
+#define iunzip_func_v0 scalar_iunzip_func_v0
+#define vdb_izip scalar_vdb_izip
+#define vdb_iunzip scalar_vdb_iunzip
+
+#include "../libs/vxf/irzip.c"
+
+rc_t doDecodeScalar_u64(uint64_t Y[], unsigned N, int64_t* min, int64_t* slope, uint8_t series_count, uint8_t planes, const uint8_t src[], size_t ssize)
+{
+    return decode_u64(Y, N, min, slope, series_count, planes, src, ssize);
+}
+
+rc_t doDecodeScalar_u32(uint32_t Y[], unsigned N, int64_t* min, int64_t* slope, uint8_t series_count, uint8_t planes, const uint8_t src[], size_t ssize)
+{
+    return decode_u32(Y, N, min, slope, series_count, planes, src, ssize);
+}
+
+rc_t doDecodeScalar_i32(int32_t Y[], unsigned N, int64_t* min, int64_t* slope, uint8_t series_count, uint8_t planes, const uint8_t src[], size_t ssize)
+{
+    return decode_i32(Y, N, min, slope, series_count, planes, src, ssize);
+}
+
+rc_t doDecodeScalar_i64(int64_t Y[], unsigned N, int64_t* min, int64_t* slope, uint8_t series_count, uint8_t planes, const uint8_t src[], size_t ssize)
+{
+    return decode_i64(Y, N, min, slope, series_count, planes, src, ssize);
+}
+
+rc_t CC iunzip_func_v0(
+                      void *Self,
+                      const VXformInfo *info,
+                      VBlobResult *dst,
+                      const VBlobData *src
+                      )
+{
+    return RC ( rcVDB, rcFunction, rcExecuting, rcInterface, rcUnsupported ); /* should not be hit in this test */
+}
@@ -0,0 +1,42 @@
+/*===========================================================================
+*
+*                            PUBLIC DOMAIN NOTICE
+*               National Center for Biotechnology Information
+*
+*  This software/database is a "United States Government Work" under the
+*  terms of the United States Copyright Act.  It was written as part of
+*  the author's official duties as a United States Government employee and
+*  thus cannot be copyrighted.  This software/database is freely available
+*  to the public for use. The National Library of Medicine and the U.S.
+*  Government have not placed any restriction on its use or reproduction.
+*
+*  Although all reasonable efforts have been taken to ensure the accuracy
+*  and reliability of the software and data, the NLM and the U.S.
+*  Government do not and cannot warrant the performance or results that
+*  may be obtained by using this software or data. The NLM and the U.S.
+*  Government disclaim all warranties, express or implied, including
+*  warranties of performance, merchantability or fitness for any particular
+*  purpose.
+*
+*  Please cite the author in any work or product based on this material.
+*
+* ===========================================================================
+*
+*/
+
+#include "wb-izip-impl.h"
+
+/* iunzip decoders for every element type; wb-iunzip-scalar.c
+ * builds them again without the SIMD kernels */
+#ifndef IUNZIP_DECODE
+#define IUNZIP_DECODE doIunzipDecode
+#define iunzip_func_v0 wb_iunzip_func_v0
+#define vdb_iunzip wb_vdb_iunzip
+#endif
+
+#include "../libs/vxf/iunzip.c"
+
+rc_t IUNZIP_DECODE(unsigned type, void *Y, unsigned N, const uint8_t src[], unsigned ssize)
+{
+    return selfs[type](Y, N, src, ssize, 0);
+}
@@ -0,0 +1,40 @@
+/*===========================================================================
+*
+*                            PUBLIC DOMAIN NOTICE
+*               National Center for Biotechnology Information
+*
+*  This software/database is a "United States Government Work" under the
+*  terms of the United States Copyright Act.  It was written as part of
+*  the author's official duties as a United States Government employee and
+*  thus cannot be copyrighted.  This software/database is freely available
+*  to the public for use. The National Library of Medicine and the U.S.
+*  Government have not placed any restriction on its use or reproduction.
+*
+*  Although all reasonable efforts have been taken to ensure the accuracy
+*  and reliability of the software and data, the NLM and the U.S.
+*  Government do not and cannot warrant the performance or results that
+*  may be obtained by using this software or data. The NLM and the U.S.
+*  Government disclaim all warranties, express or implied, including
+*  warranties of performance, merchantability or fitness for any particular
+*  purpose.
+*
+*  Please cite the author in any work or product based on this material.
+*
+* ===========================================================================
+*
+*/
+
+#include "wb-izip-impl.h"
+
+/* izip encoders for every element type */
+#define ex_encode8 test_ex_encode8
+#define ex_encode16 test_ex_encode16
+#define ex_encode32 test_ex_encode32
+#define ex_encode64 test_ex_encode64
+
+#include "../libs/vxf/izip.c"
+
+rc_t doIzipEncode(unsigned type, uint8_t dst[], unsigned dsize, unsigned *used, const void *Y, unsigned N)
+{
+    return selfs[type].f(dst, dsize, used, Y, N, 0);
+}
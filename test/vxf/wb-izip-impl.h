@@ -0,0 +1,49 @@
+/*===========================================================================
+*
+*                            PUBLIC DOMAIN NOTICE
+*               National Center for Biotechnology Information
+*
+*  This software/database is a "United States Government Work" under the
+*  terms of the United States Copyright Act.  It was written as part of
+*  the author's official duties as a United States Government employee and
+*  thus cannot be copyrighted.  This software/database is freely available
+*  to the public for use. The National Library of Medicine and the U.S.
+*  Government have not placed any restriction on its use or reproduction.
+*
+*  Although all reasonable efforts have been taken to ensure the accuracy
+*  and reliability of the software and data, the NLM and the U.S.
+*  Government do not and cannot warrant the performance or results that
+*  may be obtained by using this software or data. The NLM and the U.S.
+*  Government disclaim all warranties, express or implied, including
+*  warranties of performance, merchantability or fitness for any particular
+*  purpose.
+*
+*  Please cite the author in any work or product based on this material.
+*
+* ===========================================================================
+*
+*/
+
+#ifndef _h_izip_impl_
+#define _h_izip_impl_
+
+#include <klib/rc.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* element types, in the order of the izip and iunzip function tables */
+enum { izip_u8, izip_i8, izip_u16, izip_i16, izip_u32, izip_i32, izip_u64, izip_i64 };
+
+rc_t doIzipEncode(unsigned type, uint8_t dst[], unsigned dsize, unsigned *used, const void *Y, unsigned N);
+
+/* with and without the SIMD kernels */
+rc_t doIunzipDecode(unsigned type, void *Y, unsigned N, const uint8_t src[], unsigned ssize);
+rc_t doIunzipDecodeScalar(unsigned type, void *Y, unsigned N, const uint8_t src[], unsigned ssize);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -29,6 +29,10 @@
 TEST_SUITE(VxfTestSuite);
 
 #include "wb-irzip-impl.h"
+#include "wb-izip-impl.h"
+
+#include <cstring>
+#include <cstdio>
 
 ////////////////////////////////////////// IZIP encoding tests
 
@@ -235,6 +239,266 @@ FIXTURE_TEST_CASE(IRZIP_i32_assert1, EncoderFixture)
     REQUIRE_EQ_ARR(y, decoded, ARR_SIZE(y));
 }
 
+// series long enough to run the vectorized decode steps and their scalar tails
+
+static const unsigned LongSeries = 1003;
+
+static uint32_t NextRandom(uint32_t &state)
+{
+    state = state * 1103515245u + 12345u;
+    return state >> 8;
+}
+
+// ascending positions are stored as deltas
+FIXTURE_TEST_CASE(IRZIP_u32_ascending, EncoderFixture)
+{
+    uint32_t y[LongSeries];
+    uint32_t decoded[LongSeries];
+    uint32_t state = 1;
+    y[0] = 1000;
+    for (unsigned i = 1; i < LongSeries; ++i)
+        y[i] = y[i - 1] + NextRandom(state) % 300;
+    REQUIRE_RC(doEncode_u32(dst, dSize, &used, min, slope, &series_count, &planes, y, LongSeries));
+    REQUIRE_RC(doDecode_u32(decoded, LongSeries, min, slope, series_count, planes, dst, used));
+    REQUIRE_EQ_ARR(y, decoded, LongSeries);
+}
+
+FIXTURE_TEST_CASE(IRZIP_u64_ascending, EncoderFixture)
+{
+    uint64_t y[LongSeries];
+    uint64_t decoded[LongSeries];
+    uint32_t state = 2;
+    y[0] = UINT64_C(353878216);
+    for (unsigned i = 1; i < LongSeries; ++i)
+        y[i] = y[i - 1] + NextRandom(state) % 3000;
+    REQUIRE_RC(doEncode_u64(dst, dSize, &used, min, slope, &series_count, &planes, y, LongSeries));
+    REQUIRE_RC(doDecode_u64(decoded, LongSeries, min, slope, series_count, planes, dst, used));
+    REQUIRE_EQ_ARR(y, decoded, LongSeries);
+}
+
+FIXTURE_TEST_CASE(IRZIP_i64_descending, EncoderFixture)
+{
+    int64_t y[LongSeries];
+    int64_t decoded[LongSeries];
+    uint32_t state = 3;
+    y[0] = INT64_C(353878216);
+    for (unsigned i = 1; i < LongSeries; ++i)
+        y[i] = y[i - 1] - NextRandom(state) % 3000;
+    REQUIRE_RC(doEncode_i64(dst, dSize, &used, min, slope, &series_count, &planes, y, LongSeries));
+    REQUIRE_RC(doDecode_i64(decoded, LongSeries, min, slope, series_count, planes, dst, used));
+    REQUIRE_EQ_ARR(y, decoded, LongSeries);
+}
+
+FIXTURE_TEST_CASE(IRZIP_i32_wandering, EncoderFixture)
+{
+    int32_t y[LongSeries];
+    int32_t decoded[LongSeries];
+    uint32_t state = 4;
+    y[0] = 0;
+    for (unsigned i = 1; i < LongSeries; ++i)
+        y[i] = y[i - 1] + (int32_t)(NextRandom(state) % 301) - 150;
+    REQUIRE_RC(doEncode_i32(dst, dSize, &used, min, slope, &series_count, &planes, y, LongSeries));
+    REQUIRE_RC(doDecode_i32(decoded, LongSeries, min, slope, series_count, planes, dst, used));
+    REQUIRE_EQ_ARR(y, decoded, LongSeries);
+}
+
+// a line with noise is stored as offsets from min + slope * i
+FIXTURE_TEST_CASE(IRZIP_u64_slope, EncoderFixture)
+{
+    uint64_t y[LongSeries];
+    uint64_t decoded[LongSeries];
+    uint32_t state = 5;
+    for (unsigned i = 0; i < LongSeries; ++i)
+        y[i] = UINT64_C(5000000) + i * 7 + NextRandom(state) % 5;
+    REQUIRE_RC(doEncode_u64(dst, dSize, &used, min, slope, &series_count, &planes, y, LongSeries));
+    REQUIRE_RC(doDecode_u64(decoded, LongSeries, min, slope, series_count, planes, dst, used));
+    REQUIRE_EQ_ARR(y, decoded, LongSeries);
+}
+
+// values spread over several byte planes, some of them empty
+FIXTURE_TEST_CASE(IRZIP_u32_planes, EncoderFixture)
+{
+    uint32_t y[LongSeries];
+    uint32_t decoded[LongSeries];
+    uint32_t state = 6;
+    for (unsigned i = 0; i < LongSeries; ++i)
+        y[i] = (NextRandom(state) % 100000) << 12;
+    REQUIRE_RC(doEncode_u32(dst, dSize, &used, min, slope, &series_count, &planes, y, LongSeries));
+    REQUIRE_RC(doDecode_u32(decoded, LongSeries, min, slope, series_count, planes, dst, used));
+    REQUIRE_EQ_ARR(y, decoded, LongSeries);
+}
+
+// the SIMD kernels against the scalar loops, on series of odd lengths
+// so that every vector loop also runs its scalar tail. both decoders
+// must always agree; the encoders are not reliable on the shortest
+// series, so the input is only expected back from MinRoundTrip on
+
+static const unsigned OddLengths[] = { 1, 3, 5, 7, 15, 17, 31, 33, 65, 129, 257, LongSeries };
+static const unsigned MinRoundTrip = 15;
+
+// random, ascending, descending, wandering, a line, a line with outliers
+static const unsigned SeriesKinds = 6;
+
+template <typename T>
+static void MakeSeries(T y[], unsigned N, unsigned kind, uint32_t state)
+{
+    for (unsigned i = 0; i < N; ++i)
+    {
+        uint64_t r = NextRandom(state);
+        switch (kind)
+        {
+        case 0:
+            y[i] = (T)r;
+            break;
+        case 1:
+            y[i] = i == 0 ? (T)100 : (T)(y[i - 1] + r % 3);
+            break;
+        case 2:
+            y[i] = i == 0 ? (T)(3 * N) : (T)(y[i - 1] - r % 3);
+            break;
+        case 3:
+            y[i] = i == 0 ? (T)(2 * N) : (T)(y[i - 1] + (T)(r % 5) - 2);
+            break;
+        case 4:
+            y[i] = (T)(20 + i * 7 + r % 5);
+            break;
+        default:
+            y[i] = (T)(20 + i * 7 + (i % 50 == 0 ? r : r % 3));
+            break;
+        }
+    }
+}
+
+template <typename T>
+static bool IzipRoundTrips(unsigned type)
+{
+    static uint8_t buf[EncoderFixture::BufSize];
+    T y[LongSeries], simd[LongSeries], scalar[LongSeries];
+    unsigned tested = 0;
+
+    for (unsigned n = 0; n < ARR_SIZE(OddLengths); ++n)
+    {
+        for (unsigned kind = 0; kind < SeriesKinds; ++kind)
+        {
+            const unsigned N = OddLengths[n];
+            unsigned used = 0;
+
+            MakeSeries(y, N, kind, n * SeriesKinds + kind + 1);
+            if (doIzipEncode(type, buf, sizeof buf, &used, y, N) != 0)
+                continue;
+
+            const rc_t rc = doIunzipDecode(type, simd, N, buf, used);
+            if (rc != doIunzipDecodeScalar(type, scalar, N, buf, used))
+            {
+                fprintf(stderr, "izip type %u, length %u, series %u decodes differently\n", type, N, kind);
+                return false;
+            }
+            if (rc != 0)
+                continue;
+
+            if (memcmp(simd, scalar, N * sizeof y[0]) != 0)
+            {
+                fprintf(stderr, "izip type %u, length %u, series %u decodes differently\n", type, N, kind);
+                return false;
+            }
+            if (N < MinRoundTrip)
+                continue;
+
+            ++tested;
+            if (memcmp(y, simd, N * sizeof y[0]) != 0)
+            {
+                fprintf(stderr, "izip type %u, length %u, series %u does not round-trip\n", type, N, kind);
+                return false;
+            }
+        }
+    }
+    return tested != 0;
+}
+
+TEST_CASE(IZIP_SimdMatchesScalar)
+{
+    REQUIRE(IzipRoundTrips<uint8_t>(izip_u8));
+    REQUIRE(IzipRoundTrips<int8_t>(izip_i8));
+    REQUIRE(IzipRoundTrips<uint16_t>(izip_u16));
+    REQUIRE(IzipRoundTrips<int16_t>(izip_i16));
+    REQUIRE(IzipRoundTrips<uint32_t>(izip_u32));
+    REQUIRE(IzipRoundTrips<int32_t>(izip_i32));
+    REQUIRE(IzipRoundTrips<uint64_t>(izip_u64));
+    REQUIRE(IzipRoundTrips<int64_t>(izip_i64));
+}
+
+template <typename T>
+struct IrzipCodec
+{
+    rc_t (*encode)(uint8_t dst[], size_t dsize, size_t *used, int64_t *Min, int64_t *Slope, uint8_t *series_count, uint8_t *planes, const T Y[], unsigned N);
+    rc_t (*decode)(T Y[], unsigned N, int64_t* min, int64_t* slope, uint8_t series_count, uint8_t planes, const uint8_t src[], size_t ssize);
+    rc_t (*decode_scalar)(T Y[], unsigned N, int64_t* min, int64_t* slope, uint8_t series_count, uint8_t planes, const uint8_t src[], size_t ssize);
+};
+
+template <typename T>
+static bool IrzipRoundTrips(const IrzipCodec<T> &codec)
+{
+    static uint8_t buf[EncoderFixture::BufSize];
+    T y[LongSeries], simd[LongSeries], scalar[LongSeries];
+    unsigned tested = 0;
+
+    for (unsigned n = 0; n < ARR_SIZE(OddLengths); ++n)
+    {
+        for (unsigned kind = 0; kind < SeriesKinds; ++kind)
+        {
+            const unsigned N = OddLengths[n];
+            size_t used = 0;
+            int64_t min[2] = { 0, 0 }, slope[2] = { 0, 0 };
+            int64_t min_simd[2], slope_simd[2];
+            uint8_t series_count = 0, planes = 0;
+
+            MakeSeries(y, N, kind, n * SeriesKinds + kind + 1);
+            if (codec.encode(buf, sizeof buf, &used, min, slope, &series_count, &planes, y, N) != 0)
+                continue;
+
+            memcpy(min_simd, min, sizeof min);
+            memcpy(slope_simd, slope, sizeof slope);
+            const rc_t rc = codec.decode(simd, N, min_simd, slope_simd, series_count, planes, buf, used);
+            if (rc != codec.decode_scalar(scalar, N, min, slope, series_count, planes, buf, used))
+            {
+                fprintf(stderr, "irzip size %u, length %u, series %u decodes differently\n", (unsigned)sizeof(T), N, kind);
+                return false;
+            }
+            if (rc != 0)
+                continue;
+
+            if (memcmp(simd, scalar, N * sizeof y[0]) != 0)
+            {
+                fprintf(stderr, "irzip size %u, length %u, series %u decodes differently\n", (unsigned)sizeof(T), N, kind);
+                return false;
+            }
+            if (N < MinRoundTrip)
+                continue;
+
+            ++tested;
+            if (memcmp(y, simd, N * sizeof y[0]) != 0)
+            {
+                fprintf(stderr, "irzip size %u, length %u, series %u does not round-trip\n", (unsigned)sizeof(T), N, kind);
+                return false;
+            }
+        }
+    }
+    return tested != 0;
+}
+
+TEST_CASE(IRZIP_SimdMatchesScalar)
+{
+    const IrzipCodec<uint32_t> u32 = { doEncode_u32, doDecode_u32, doDecodeScalar_u32 };
+    const IrzipCodec<int32_t> i32 = { doEncode_i32, doDecode_i32, doDecodeScalar_i32 };
+    const IrzipCodec<uint64_t> u64 = { doEncode_u64, doDecode_u64, doDecodeScalar_u64 };
+    const IrzipCodec<int64_t> i64 = { doEncode_i64, doDecode_i64, doDecodeScalar_i64 };
+
+    REQUIRE(IrzipRoundTrips(u32));
+    REQUIRE(IrzipRoundTrips(i32));
+    REQUIRE(IrzipRoundTrips(u64));
+    REQUIRE(IrzipRoundTrips(i64));
+}
+
 //////////////////////////////////////////// Main
 extern "C"
 {
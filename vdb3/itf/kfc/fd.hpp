@@ -63,6 +63,8 @@ namespace vdb3
         virtual bytes_t write ( const bytes_t & num_bytes,
             const Mem & src, const bytes_t & start );
         virtual bytes_t get_mtu () const;
+        virtual bool transfer_to ( const bytes_t & num_bytes,
+            StreamItf * dst, bytes_t & num_moved );
 
         // C++
         ~ FileDescImpl ();
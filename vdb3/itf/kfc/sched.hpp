@@ -0,0 +1,129 @@
+/*===========================================================================
+*
+*                            PUBLIC DOMAIN NOTICE
+*               National Center for Biotechnology Information
+*
+*  This software/database is a "United States Government Work" under the
+*  terms of the United States Copyright Act.  It was written as part of
+*  the author's official duties as a United States Government employee and
+*  thus cannot be copyrighted.  This software/database is freely available
+*  to the public for use. The National Library of Medicine and the U.S.
+*  Government have not placed any restriction on its use or reproduction.
+*
+*  Although all reasonable efforts have been taken to ensure the accuracy
+*  and reliability of the software and data, the NLM and the U.S.
+*  Government do not and cannot warrant the performance or results that
+*  may be obtained by using this software or data. The NLM and the U.S.
+*  Government disclaim all warranties, express or implied, including
+*  warranties of performance, merchantability or fitness for any particular
+*  purpose.
+*
+*  Please cite the author in any work or product based on this material.
+*
+* ===========================================================================
+*
+*/
+
+#ifndef _hpp_vdb3_kfc_sched_
+#define _hpp_vdb3_kfc_sched_
+
+#ifndef _hpp_vdb3_kfc_ref_
+#include <kfc/ref.hpp>
+#endif
+
+namespace vdb3
+{
+
+    /*------------------------------------------------------------------
+     * forwards
+     */
+    class nS_t;
+    class Task;
+    class Sched;
+    class Refcount;
+
+
+    /*------------------------------------------------------------------
+     * exceptions
+     */
+
+
+    /*------------------------------------------------------------------
+     * SchedItf
+     *  cooperative task scheduler
+     *
+     *  a task that returns from "run" without completing has yielded
+     *  and is queued again. a task may instead ask to wait upon a timer
+     *  or a file descriptor before returning, in which case it is
+     *  suspended and resumed once the event occurs.
+     */
+    interface SchedItf
+    {
+
+        // queue a task to run when a worker is free
+        virtual void spawn ( const Task & t ) = 0;
+
+        // queue a task to run once "delay" has passed
+        virtual void spawn_after ( const Task & t, const nS_t & delay ) = 0;
+
+        // queue a task to run once "fd" is ready for reading or writing
+        virtual void spawn_on_ready ( const Task & t, int fd, bool write ) = 0;
+
+        // called by the running task before it returns incomplete
+        // to be resumed after a delay or once "fd" is ready
+        virtual void wait ( const nS_t & delay ) = 0;
+        virtual void wait_ready ( int fd, bool write ) = 0;
+
+        // wait until every task has completed
+        // returns the number of tasks that ended with an exception
+        virtual count_t drain () = 0;
+
+    protected:
+
+        Sched make_sched_ref ( Refcount * obj, caps_t caps );
+    };
+
+
+    /*------------------------------------------------------------------
+     * Sched
+     *  task scheduler reference
+     */
+    class Sched : public Ref < SchedItf >
+    {
+    public:
+
+        // queue a task to run when a worker is free
+        void spawn ( const Task & t ) const;
+
+        // queue a task to run once "delay" has passed
+        void spawn_after ( const Task & t, const nS_t & delay ) const;
+
+        // queue a task to run once "fd" is ready for reading or writing
+        void spawn_on_ready ( const Task & t, int fd, bool write = false ) const;
+
+        // called from within a running task, which should then return
+        // incomplete. the task will be resumed after "delay" or once
+        // "fd" is ready
+        void wait ( const nS_t & delay ) const;
+        void wait_ready ( int fd, bool write = false ) const;
+
+        // wait until every task has completed
+        // returns the number of tasks that ended with an exception
+        count_t drain () const;
+
+        // C++
+        Sched ();
+        Sched ( const Sched & r );
+        void operator = ( const Sched & r );
+        Sched ( const Sched & r, caps_t reduce );
+
+    private:
+
+        // factory
+        Sched ( Refcount * obj, SchedItf * itf, caps_t caps );
+
+        friend interface SchedItf;
+    };
+}
+
+#endif // _hpp_vdb3_kfc_sched_
@@ -68,6 +68,12 @@ namespace vdb3
         // indicate the preferred chunk size
         virtual bytes_t get_mtu () const = 0;
 
+        // move bytes to "dst" without passing them through user space
+        // returns false if there is no such path between the two,
+        // otherwise "num_moved" is 0 only at end of stream
+        virtual bool transfer_to ( const bytes_t & amount,
+            StreamItf * dst, bytes_t & num_moved );
+
     protected:
 
         Stream make_ref ( Refcount * obj, caps_t caps );
@@ -97,6 +103,15 @@ namespace vdb3
         bytes_t copy_all ( const bytes_t & amount,
             const Stream & src ) const;
 
+        // transfer up to "amount" bytes to destination until end of stream
+        // uses a zero-copy path when the two ends support one, copying
+        // through a buffer otherwise. "zero_copy" receives the portion
+        // of the total moved without a copy
+        bytes_t transfer_to ( const Stream & dst,
+            const bytes_t & amount ) const;
+        bytes_t transfer_to ( const Stream & dst,
+            const bytes_t & amount, bytes_t & zero_copy ) const;
+
         // read data into a memory buffer
         bytes_t read ( Mem & dst, index_t dst_offset = 0 ) const;
         bytes_t read ( const bytes_t & amount,
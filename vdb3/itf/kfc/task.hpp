@@ -86,7 +86,7 @@ namespace vdb3
     /*------------------------------------------------------------------
      * Task
      */
-    class Task : Ref < TaskItf >
+    class Task : public Ref < TaskItf >
     {
     public:
 
@@ -97,6 +97,9 @@ namespace vdb3
         // ask task to cooperatively suspend its execution
         void suspend ();
 
+        // throws unless "suspend" is allowed through this reference
+        void test_suspend () const;
+
         // checkpointing and restoration
         // TBD - these have to be given an object for saving state
         void checkpoint ();
@@ -116,7 +119,7 @@ namespace vdb3
         // construct a task reference
         Task ( Refcount * obj, TaskItf * itf, caps_t caps );
 
-        friend class TaskItf;
+        friend interface TaskItf;
 
     };
 }
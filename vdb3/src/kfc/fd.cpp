@@ -36,6 +36,12 @@
 #include <unistd.h>
 #include <stdlib.h>
 #include <errno.h>
+#include <string.h>
+#include <sys/stat.h>
+#if LINUX
+#include <fcntl.h>
+#include <sys/sendfile.h>
+#endif
 #else
 #error "unsupported target platform"
 #endif
@@ -157,6 +163,101 @@ namespace vdb3
         return bytes_t ( 4096 );
     }
 
+#if LINUX
+    // the kernel limits a single transfer to just under 2GB
+    static const size_t max_transfer = 0x7FFFF000;
+
+    static
+    long int zero_copy ( int src_fd, int dst_fd, size_t num_bytes, const char * & func )
+    {
+        struct stat src_st, dst_st;
+        if ( fstat ( src_fd, & src_st ) != 0 || fstat ( dst_fd, & dst_st ) != 0 )
+        {
+            errno = EINVAL;
+            return -1;
+        }
+
+        // either end is a pipe
+        if ( S_ISFIFO ( src_st . st_mode ) || S_ISFIFO ( dst_st . st_mode ) )
+        {
+            func = "splice";
+            return splice ( src_fd, 0, dst_fd, 0, num_bytes, SPLICE_F_MOVE | SPLICE_F_MORE );
+        }
+
+        if ( ! S_ISREG ( src_st . st_mode ) )
+        {
+            errno = EINVAL;
+            return -1;
+        }
+
+#if defined __GLIBC__ && ( __GLIBC__ > 2 || ( __GLIBC__ == 2 && __GLIBC_MINOR__ >= 27 ) )
+        // file to file, possibly sharing extents
+        if ( S_ISREG ( dst_st . st_mode ) )
+        {
+            func = "copy_file_range";
+            long int num_moved = copy_file_range ( src_fd, 0, dst_fd, 0, num_bytes, 0 );
+            if ( num_moved >= 0 || ( errno != EXDEV && errno != ENOSYS ) )
+                return num_moved;
+        }
+#endif
+
+        // file to socket or anything else
+        func = "sendfile";
+        return sendfile ( dst_fd, src_fd, 0, num_bytes );
+    }
+#endif
+
+    bool FileDescImpl :: transfer_to ( const bytes_t & num_bytes,
+        StreamItf * dst, bytes_t & num_moved )
+    {
+        FUNC_ENTRY ();
+
+        // only between two descriptors
+        FileDescImpl * dst_fd = dynamic_cast < FileDescImpl * > ( dst );
+        if ( dst_fd == 0 )
+            return false;
+
+#if LINUX
+        size_t to_move = ( num_bytes < ( U64 ) max_transfer ) ?
+            ( size_t ) ( U64 ) num_bytes : max_transfer;
+
+        while ( 1 )
+        {
+            const char * func = "transfer";
+            long int num_xfer = zero_copy ( fd, dst_fd -> fd, to_move, func );
+            if ( num_xfer >= 0 )
+            {
+                num_moved = bytes_t ( ( U64 ) num_xfer );
+                return true;
+            }
+
+            int status = errno;
+            switch ( status )
+            {
+            case EINTR:
+                break;
+            case EINVAL:
+            case ENOSYS:
+            case EXDEV:
+            case EOPNOTSUPP:
+                // no zero-copy path between these two
+                return false;
+            case ENOSPC:
+                THROW ( xc_no_mem, "attempt to write %lu bytes exceeds volume limits", ( U64 ) to_move );
+            case EBADF:
+                THROW ( xc_param_err, "bad fd: %d or %d", fd, dst_fd -> fd );
+            case EAGAIN:
+                // this is essentially a timeout error
+            case EIO:
+            default:
+                ThrowOSErr ( __LINE__, ConstString ( func, strlen ( func ) ), status );
+            }
+        }
+#else
+        return false;
+#endif
+    }
+
     // C++
     FileDescImpl :: FileDescImpl ( int _fd, bool _owned )
         : fd ( _fd )
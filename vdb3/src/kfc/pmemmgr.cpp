@@ -35,6 +35,8 @@
 
 #if UNIX
 #include <sys/resource.h>
+#include <sys/mman.h>
+#include <pthread.h>
 #endif
 
 namespace vdb3
@@ -54,6 +56,469 @@ namespace vdb3
         ;
 
 
+    /*------------------------------------------------------------------
+     * tiers
+     *  every block is placed by its size alone, and since the size
+     *  is handed back to _free and _resize, blocks carry no header
+     */
+    enum mem_tier_t
+    {
+        tier_slab,
+        tier_large,
+        tier_huge
+    };
+
+    // blocks up to this size come from slabs
+    const size_t SLAB_MAX_BYTES = 4096;
+
+    // blocks of at least this size are mapped
+    const size_t HUGE_MIN_BYTES = 2 * 1024 * 1024;
+
+    // mappings are made in multiples of a huge page
+    const size_t HUGE_PAGE_BYTES = 2 * 1024 * 1024;
+
+    static
+    mem_tier_t mem_tier ( size_t bytes )
+    {
+        if ( bytes <= SLAB_MAX_BYTES )
+            return tier_slab;
+        if ( bytes < HUGE_MIN_BYTES )
+            return tier_large;
+        return tier_huge;
+    }
+
+    // accounting shared by the tiers
+    static PrimordMemMgr * pmmgr;
+    static atomic_t < U64 > slab_reserved ( 0 );
+    static atomic_t < U64 > huge_mapped ( 0 );
+    static atomic_t < U64 > large_allocs ( 0 );
+    static atomic_t < U64 > huge_allocs ( 0 );
+
+
+    /*------------------------------------------------------------------
+     * slab tier
+     *  small blocks are carved from chunks into size classes. each
+     *  thread keeps its own free lists and trades batches with a
+     *  shared depot only when a list runs dry or grows too long.
+     */
+    static const U32 slab_class_bytes [] =
+    {
+        16, 32, 48, 64, 96, 128, 192, 256,
+        384, 512, 768, 1024, 1536, 2048, 3072, 4096
+    };
+
+    const U32 NUM_SLAB_CLASSES = sizeof slab_class_bytes / sizeof slab_class_bytes [ 0 ];
+
+    // blocks moved between a thread and the depot at a time
+    const U32 SLAB_BATCH = 32;
+
+    // smallest chunk, and fewest blocks carved from one
+    const size_t SLAB_CHUNK_BYTES = 64 * 1024;
+    const U32 SLAB_CHUNK_BLOCKS = 32;
+
+    struct slab_block_t
+    {
+        slab_block_t * next;
+    };
+
+    // chunk header, sized to keep blocks 16-byte aligned
+    struct slab_chunk_t
+    {
+        slab_chunk_t * next;
+        size_t bytes;
+    };
+
+    struct slab_list_t
+    {
+        slab_block_t * head;
+        U32 count;
+    };
+
+    struct slab_arena_t
+    {
+        slab_list_t list [ NUM_SLAB_CLASSES ];
+
+        // registry of live arenas
+        slab_arena_t * next;
+        slab_arena_t * prev;
+    };
+
+    // size in 16-byte units => class
+    static U8 slab_class_index [ SLAB_MAX_BYTES / 16 + 1 ];
+
+    static slab_list_t slab_depot [ NUM_SLAB_CLASSES ];
+    static slab_chunk_t * slab_chunks;
+    static slab_arena_t * slab_arenas;
+
+    // each thread finds its lists through a key, which also
+    // hands them back on thread exit. where there is no key,
+    // every thread goes through the depot
+#if UNIX
+    static pthread_mutex_t slab_lock = PTHREAD_MUTEX_INITIALIZER;
+    static pthread_key_t slab_arena_key;
+#else
+    static atomic_t < I32 > slab_lock ( 0 );
+#endif
+
+    static
+    void slab_init ()
+    {
+        U32 cls = 0;
+        for ( size_t units = 0; units <= SLAB_MAX_BYTES / 16; ++ units )
+        {
+            while ( slab_class_bytes [ cls ] < units * 16 )
+                ++ cls;
+            slab_class_index [ units ] = ( U8 ) cls;
+        }
+    }
+
+    static inline
+    U32 slab_class ( size_t bytes )
+    {
+        return slab_class_index [ ( bytes + 15 ) >> 4 ];
+    }
+
+    static
+    void slab_lock_acquire ()
+    {
+#if UNIX
+        pthread_mutex_lock ( & slab_lock );
+#else
+        while ( slab_lock . test_and_set ( 0, 1 ) != 0 )
+            ;
+#endif
+    }
+
+    static
+    void slab_lock_release ()
+    {
+#if UNIX
+        pthread_mutex_unlock ( & slab_lock );
+#else
+        slab_lock . set ( 0 );
+#endif
+    }
+
+    // move up to "count" blocks from one list to another
+    static
+    void slab_move ( slab_list_t & dst, slab_list_t & src, U32 count )
+    {
+        while ( count -- != 0 && src . head != 0 )
+        {
+            slab_block_t * b = src . head;
+            src . head = b -> next;
+            -- src . count;
+            b -> next = dst . head;
+            dst . head = b;
+            ++ dst . count;
+        }
+    }
+
+    // fill "list" from the depot, or from a new chunk
+    // called with the lock held; false when out of memory
+    static
+    bool slab_refill ( slab_list_t & list, U32 cls )
+    {
+        if ( slab_depot [ cls ] . head != 0 )
+        {
+            slab_move ( list, slab_depot [ cls ], SLAB_BATCH );
+            return true;
+        }
+
+        size_t block_bytes = slab_class_bytes [ cls ];
+        size_t chunk_bytes = sizeof ( slab_chunk_t ) + block_bytes * SLAB_CHUNK_BLOCKS;
+        if ( chunk_bytes < SLAB_CHUNK_BYTES )
+            chunk_bytes = SLAB_CHUNK_BYTES;
+
+        slab_chunk_t * chunk = ( slab_chunk_t * ) malloc ( chunk_bytes );
+        if ( chunk == 0 )
+            return false;
+
+        chunk -> next = slab_chunks;
+        chunk -> bytes = chunk_bytes;
+        slab_chunks = chunk;
+        slab_reserved += chunk_bytes;
+
+        char * p = ( char * ) ( chunk + 1 );
+        char * end = ( char * ) chunk + chunk_bytes - block_bytes;
+        for ( ; p <= end; p += block_bytes )
+        {
+            slab_block_t * b = ( slab_block_t * ) p;
+            b -> next = list . head;
+            list . head = b;
+            ++ list . count;
+        }
+
+        return true;
+    }
+
+    // return the calling thread's lists, if it has any
+    static inline
+    slab_arena_t * slab_find_arena ()
+    {
+#if UNIX
+        return ( slab_arena_t * ) pthread_getspecific ( slab_arena_key );
+#else
+        return 0;
+#endif
+    }
+
+    // return the calling thread's lists, creating them on first use
+    static
+    slab_arena_t * slab_get_arena ()
+    {
+        slab_arena_t * arena = slab_find_arena ();
+#if UNIX
+        if ( arena == 0 )
+        {
+            arena = ( slab_arena_t * ) calloc ( 1, sizeof * arena );
+            if ( arena != 0 && pthread_setspecific ( slab_arena_key, arena ) != 0 )
+            {
+                free ( arena );
+                arena = 0;
+            }
+            if ( arena != 0 )
+            {
+                slab_lock_acquire ();
+                arena -> next = slab_arenas;
+                if ( slab_arenas != 0 )
+                    slab_arenas -> prev = arena;
+                slab_arenas = arena;
+                slab_lock_release ();
+            }
+        }
+#endif
+        return arena;
+    }
+
+    // hand a thread's blocks to the depot when it exits
+    static
+    void slab_release_arena ( void * data )
+    {
+        slab_arena_t * arena = ( slab_arena_t * ) data;
+
+        slab_lock_acquire ();
+        for ( U32 cls = 0; cls < NUM_SLAB_CLASSES; ++ cls )
+            slab_move ( slab_depot [ cls ], arena -> list [ cls ], arena -> list [ cls ] . count );
+
+        if ( arena -> prev != 0 )
+            arena -> prev -> next = arena -> next;
+        else
+            slab_arenas = arena -> next;
+        if ( arena -> next != 0 )
+            arena -> next -> prev = arena -> prev;
+        slab_lock_release ();
+
+        free ( arena );
+    }
+
+    static
+    void * slab_alloc ( U32 cls )
+    {
+        slab_arena_t * arena = slab_get_arena ();
+        if ( arena != 0 )
+        {
+            slab_list_t & list = arena -> list [ cls ];
+            if ( list . head == 0 )
+            {
+                slab_lock_acquire ();
+                bool ok = slab_refill ( list, cls );
+                slab_lock_release ();
+                if ( ! ok )
+                    return 0;
+            }
+
+            slab_block_t * b = list . head;
+            list . head = b -> next;
+            -- list . count;
+            return b;
+        }
+
+        // no thread lists: go through the depot every time
+        slab_list_t local = { 0, 0 };
+        slab_lock_acquire ();
+        if ( slab_refill ( local, cls ) )
+        {
+            slab_block_t * b = local . head;
+            local . head = b -> next;
+            -- local . count;
+            slab_move ( slab_depot [ cls ], local, local . count );
+            slab_lock_release ();
+            return b;
+        }
+        slab_lock_release ();
+        return 0;
+    }
+
+    static
+    void slab_free ( void * ptr, U32 cls )
+    {
+        slab_block_t * b = ( slab_block_t * ) ptr;
+        slab_arena_t * arena = slab_find_arena ();
+        if ( arena != 0 )
+        {
+            slab_list_t & list = arena -> list [ cls ];
+            b -> next = list . head;
+            list . head = b;
+
+            // give a batch back so other threads can use it
+            if ( ++ list . count >= SLAB_BATCH * 2 )
+            {
+                slab_lock_acquire ();
+                slab_move ( slab_depot [ cls ], list, SLAB_BATCH );
+                slab_lock_release ();
+            }
+        }
+        else
+        {
+            slab_lock_acquire ();
+            b -> next = slab_depot [ cls ] . head;
+            slab_depot [ cls ] . head = b;
+            ++ slab_depot [ cls ] . count;
+            slab_lock_release ();
+        }
+    }
+
+
+    /*------------------------------------------------------------------
+     * huge-page tier
+     *  large blocks are mapped directly in multiples of a huge page,
+     *  aligned so that the system can back them with huge pages
+     */
+    static inline
+    size_t huge_round ( size_t bytes )
+    {
+        return ( bytes + HUGE_PAGE_BYTES - 1 ) & ~ ( HUGE_PAGE_BYTES - 1 );
+    }
+
+    static
+    void * huge_map ( size_t bytes )
+    {
+#if UNIX
+        size_t mapped = huge_round ( bytes );
+
+        // over-map by a page to be able to align the start
+        char * raw = ( char * ) mmap ( 0, mapped + HUGE_PAGE_BYTES,
+            PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0 );
+        if ( raw == ( char * ) MAP_FAILED )
+            return 0;
+
+        char * ptr = ( char * ) huge_round ( ( size_t ) raw );
+        if ( ptr != raw )
+            munmap ( raw, ptr - raw );
+        if ( ptr + mapped != raw + mapped + HUGE_PAGE_BYTES )
+            munmap ( ptr + mapped, raw + mapped + HUGE_PAGE_BYTES - ( ptr + mapped ) );
+#ifdef MADV_HUGEPAGE
+        madvise ( ptr, mapped, MADV_HUGEPAGE );
+#endif
+        huge_mapped += mapped;
+        ++ huge_allocs;
+        return ptr;
+#else
+        ++ huge_allocs;
+        return malloc ( bytes );
+#endif
+    }
+
+    static
+    void huge_unmap ( void * ptr, size_t bytes )
+    {
+#if UNIX
+        size_t mapped = huge_round ( bytes );
+        munmap ( ptr, mapped );
+        huge_mapped -= mapped;
+#else
+        free ( ptr );
+#endif
+    }
+
+
+    /*------------------------------------------------------------------
+     * raw allocation by tier
+     *  returns 0 when the system is out of memory
+     */
+    static
+    void * tier_alloc ( size_t bytes, bool clear )
+    {
+        void * ptr;
+        switch ( mem_tier ( bytes ) )
+        {
+        case tier_slab:
+            ptr = slab_alloc ( slab_class ( bytes ) );
+            if ( ptr != 0 && clear )
+                memset ( ptr, 0, bytes );
+            return ptr;
+        case tier_large:
+            ptr = clear ? calloc ( 1, bytes ) : malloc ( bytes );
+            if ( ptr != 0 )
+                ++ large_allocs;
+            return ptr;
+        default:
+            // fresh mappings are already zeroed
+            return huge_map ( bytes );
+        }
+    }
+
+    static
+    void tier_free ( void * ptr, size_t bytes )
+    {
+        switch ( mem_tier ( bytes ) )
+        {
+        case tier_slab:
+            slab_free ( ptr, slab_class ( bytes ) );
+            break;
+        case tier_large:
+            free ( ptr );
+            break;
+        default:
+            huge_unmap ( ptr, bytes );
+            break;
+        }
+    }
+
+    // resize in place where the tier allows it, otherwise move
+    static
+    void * tier_resize ( void * old_ptr, size_t old_bytes, size_t new_bytes )
+    {
+        mem_tier_t tier = mem_tier ( old_bytes );
+        if ( tier == mem_tier ( new_bytes ) )
+        {
+            switch ( tier )
+            {
+            case tier_slab:
+                if ( slab_class ( old_bytes ) == slab_class ( new_bytes ) )
+                    return old_ptr;
+                break;
+            case tier_large:
+                return realloc ( old_ptr, new_bytes );
+            default:
+                if ( huge_round ( old_bytes ) == huge_round ( new_bytes ) )
+                    return old_ptr;
+#if LINUX
+                {
+                    void * new_ptr = mremap ( old_ptr, huge_round ( old_bytes ),
+                        huge_round ( new_bytes ), MREMAP_MAYMOVE );
+                    if ( new_ptr == MAP_FAILED )
+                        return 0;
+                    huge_mapped += huge_round ( new_bytes );
+                    huge_mapped -= huge_round ( old_bytes );
+                    return new_ptr;
+                }
+#endif
+                break;
+            }
+        }
+
+        void * new_ptr = tier_alloc ( new_bytes, false );
+        if ( new_ptr != 0 )
+        {
+            memcpy ( new_ptr, old_ptr, old_bytes < new_bytes ? old_bytes : new_bytes );
+            tier_free ( old_ptr, old_bytes );
+        }
+        return new_ptr;
+    }
+
+
     /*------------------------------------------------------------------
      * const_memory_t
      *  an object representing a range of address space
@@ -66,6 +531,13 @@ namespace vdb3
         const_memory_t ( const void * ptr, const bytes_t & size );
         ~ const_memory_t ();
 
+        // normal allocation, and construction within
+        // memory obtained from a specific manager
+        void * operator new ( std :: size_t bytes )
+        { return Refcount :: operator new ( bytes ); }
+        void * operator new ( std :: size_t bytes, void * ptr )
+        { return ptr; }
+
     protected:
 
         virtual void * get_mapped_memory ( bytes_t * size ) const;
@@ -143,6 +615,144 @@ namespace vdb3
     }
 
 
+    /*------------------------------------------------------------------
+     * QuotaMemMgr
+     *  allocates from the primordial manager within a quota of its own
+     */
+    class QuotaMemMgr : implements MemMgrItf
+    {
+    public:
+
+        static MemMgr make ( const MemMgr & parent, PrimordMemMgr * pmmgr, const bytes_t & quota );
+
+        virtual Mem alloc ( const bytes_t & size, bool clear );
+        virtual Mem make_const ( const void * ptr, const bytes_t & size );
+
+    protected:
+
+        virtual void * _alloc ( const bytes_t & size, bool clear );
+        virtual void * _resize ( void * ptr, const bytes_t & old_size,
+            const bytes_t & new_size, bool clear );
+        virtual void _free ( void * ptr, const bytes_t & size );
+
+        QuotaMemMgr ( const MemMgr & parent, PrimordMemMgr * pmmgr, const bytes_t & quota );
+        ~ QuotaMemMgr ();
+
+    private:
+
+        // holds the primordial manager open
+        MemMgr parent;
+        PrimordMemMgr * pmmgr;
+
+        bytes_t quota;
+        atomic_t < U64 > avail;
+    };
+
+    MemMgr QuotaMemMgr :: make ( const MemMgr & parent, PrimordMemMgr * pmmgr, const bytes_t & quota )
+    {
+        FUNC_ENTRY ();
+
+        QuotaMemMgr * obj = new QuotaMemMgr ( parent, pmmgr, quota );
+        return obj -> make_mmgr_ref ( obj, CAP_RDWR | CAP_ALLOC );
+    }
+
+    Mem QuotaMemMgr :: alloc ( const bytes_t & size, bool clear )
+    {
+        FUNC_ENTRY ();
+
+        void * block = ( size == ( U64 ) 0 ) ? 0 : _alloc ( size, clear );
+
+        // the memory object is charged here as well,
+        // and records this manager for resize and free
+        void * mem;
+        try
+        {
+            mem = _new ( sizeof ( Memory ) );
+        }
+        catch ( ... )
+        {
+            if ( block != 0 )
+                _free ( block, size );
+            throw;
+        }
+
+        Memory * obj = new ( mem ) Memory ( block, size );
+        return make_mem_ref ( obj, obj, NEW_MEM_CAPS );
+    }
+
+    Mem QuotaMemMgr :: make_const ( const void * ptr, const bytes_t & size )
+    {
+        FUNC_ENTRY ();
+        return pmmgr -> make_const ( ptr, size );
+    }
+
+    void * QuotaMemMgr :: _alloc ( const bytes_t & size, bool clear )
+    {
+        FUNC_ENTRY ();
+
+        if ( avail . read_and_sub_ge ( size, size ) < size )
+            THROW ( xc_mem_quota, "subsystem memory quota exhausted allocating %lu bytes", ( U64 ) size );
+
+        try
+        {
+            return pmmgr -> _alloc ( size, clear );
+        }
+        catch ( ... )
+        {
+            avail += size;
+            throw;
+        }
+    }
+
+    void * QuotaMemMgr :: _resize ( void * ptr, const bytes_t & old_size, const bytes_t & new_size, bool clear )
+    {
+        FUNC_ENTRY ();
+
+        if ( new_size > old_size )
+        {
+            U64 grow = ( U64 ) new_size - ( U64 ) old_size;
+            if ( avail . read_and_sub_ge ( grow, grow ) < grow )
+                THROW ( xc_mem_quota, "subsystem memory quota exhausted reallocating %lu to %lu bytes", ( U64 ) old_size, ( U64 ) new_size );
+
+            try
+            {
+                return pmmgr -> _resize ( ptr, old_size, new_size, clear );
+            }
+            catch ( ... )
+            {
+                avail += grow;
+                throw;
+            }
+        }
+
+        void * new_ptr = pmmgr -> _resize ( ptr, old_size, new_size, clear );
+        avail += ( U64 ) old_size - ( U64 ) new_size;
+        return new_ptr;
+    }
+
+    void QuotaMemMgr :: _free ( void * ptr, const bytes_t & size )
+    {
+        pmmgr -> _free ( ptr, size );
+        avail += size;
+    }
+
+    QuotaMemMgr :: QuotaMemMgr ( const MemMgr & _parent, PrimordMemMgr * _pmmgr, const bytes_t & q )
+        : parent ( _parent )
+        , pmmgr ( _pmmgr )
+        , quota ( q )
+        , avail ( q )
+    {
+    }
+
+    QuotaMemMgr :: ~ QuotaMemMgr ()
+    {
+        // TBD - can test if avail != quota
+        pmmgr = 0;
+        quota = 0;
+        avail = 0;
+    }
+
+
     /*------------------------------------------------------------------
      * PrimordMemMgr
      */
@@ -169,7 +779,12 @@ namespace vdb3
         int status = getrlimit ( RLIMIT_AS, & rlim );
         if ( status == 0 )
             quota = rlim . rlim_cur;
+
+        // per-thread slab lists are handed back on thread exit
+        if ( pthread_key_create ( & slab_arena_key, slab_release_arena ) != 0 )
+            throw "failed to create key for primordial memory manager";
 #endif
+        slab_init ();
 
         // allocate the object memory
         PrimordMemMgr * obj;
@@ -185,11 +800,38 @@ namespace vdb3
         // as this would introduce a cycle
         obj -> mmgr = obj;
         obj -> obj_size = sizeof * obj;
+        pmmgr = obj;
 
         // create the reference
         return obj -> make_mmgr_ref ( obj, CAP_RDWR | CAP_ALLOC );
     }
 
+    MemMgr PrimordMemMgr :: make_quota ( const bytes_t & quota )
+    {
+        FUNC_ENTRY ();
+
+        if ( pmmgr == 0 )
+            CONST_THROW ( xc_program_state_violation, "no primordial memory manager" );
+
+        MemMgr parent = pmmgr -> make_mmgr_ref ( pmmgr, CAP_ALLOC );
+        return QuotaMemMgr :: make ( parent, pmmgr, quota );
+    }
+
+    void PrimordMemMgr :: get_stats ( PrimordMemStats & stats )
+    {
+        memset ( & stats, 0, sizeof stats );
+        if ( pmmgr != 0 )
+        {
+            stats . quota = pmmgr -> quota;
+            stats . in_use = ( U64 ) pmmgr -> quota - pmmgr -> avail;
+            stats . peak = pmmgr -> peak;
+        }
+        stats . slab_reserved = slab_reserved;
+        stats . huge_mapped = huge_mapped;
+        stats . large_allocs = large_allocs;
+        stats . huge_allocs = huge_allocs;
+    }
+
 
     /* alloc
      */
@@ -218,6 +860,41 @@ namespace vdb3
         return make_mem_ref ( obj, obj, CONST_MEM_CAPS );
     }
 
+    /* charge
+     * refund
+     *  every byte is charged against the shared quota as it is
+     *  allocated, so a request is refused only when the quota
+     *  itself is exhausted
+     */
+    void PrimordMemMgr :: charge ( size_t bytes )
+    {
+        if ( ! draw ( bytes ) )
+            THROW ( xc_mem_quota, "memory quota exhausted allocating %zu bytes", bytes );
+    }
+
+    void PrimordMemMgr :: refund ( size_t bytes )
+    {
+        avail += bytes;
+    }
+
+    // take from the shared quota, tracking the high-water mark
+    bool PrimordMemMgr :: draw ( U64 bytes )
+    {
+        if ( avail . read_and_sub_ge ( bytes, bytes ) < bytes )
+            return false;
+
+        U64 drawn = ( U64 ) quota - avail;
+        for ( U64 prior = peak; drawn > prior; )
+        {
+            U64 seen = peak . test_and_set ( prior, drawn );
+            if ( seen == prior )
+                break;
+            prior = seen;
+        }
+
+        return true;
+    }
+
     void * PrimordMemMgr :: _alloc ( const bytes_t & size, bool clear )
     {
         FUNC_ENTRY ();
@@ -225,22 +902,20 @@ namespace vdb3
         size_t bytes = size;
 
         // allocate from quota
-        if ( avail . read_and_sub_ge ( size, size ) < size )
-            THROW ( xc_mem_quota, "memory quota exhausted allocating %lu bytes", ( U64 ) size );
+        charge ( bytes );
 
-        // allocate using process memory manager
-        void * ptr = clear ? calloc ( 1, bytes ) : malloc ( bytes );
+        // allocate from the tier for this size
+        void * ptr = tier_alloc ( bytes, clear );
         if ( ptr == 0 )
         {
             // return bytes to quota
-            avail += bytes;
+            refund ( bytes );
 
             // failure
             THROW ( xc_no_mem, "process memory exhausted allocating %zu bytes", bytes );
         }
 
-       return ptr;
-
+        return ptr;
     }
 
     void * PrimordMemMgr :: _resize ( void * old_ptr, const bytes_t & old_size, const bytes_t & new_size, bool clear )
@@ -251,33 +926,44 @@ namespace vdb3
         if ( old_size == new_size )
             return old_ptr;
 
-        // check for quota
-        if ( ( avail + old_size ) < new_size )
-            THROW ( xc_mem_quota, "memory quota exhausted reallocating %lu to %lu bytes", ( U64 ) old_size, ( U64 ) new_size );
-
-        size_t new_bytes = new_size;
-
         // not supposed to be called with bad values
         assert ( old_ptr != 0 || old_size == ( U64 ) 0 );
 
-        // reallocate using process memory manager
-        // alternatively, we could always allocate and copy, destroying old
-        void * new_ptr = realloc ( old_ptr, new_bytes );
-        if ( new_ptr == 0 )
-            THROW ( xc_no_mem, "process memory exhausted reallocating %lu to %lu bytes", ( U64 ) old_size, ( U64 ) new_size );
+        size_t old_bytes = old_size;
+        size_t new_bytes = new_size;
 
-        // update bytes remaining
-        if ( old_size > new_size )
-            avail += old_size - new_size;
+        // charge growth against quota up front
+        if ( new_bytes > old_bytes )
+            charge ( new_bytes - old_bytes );
+
+        void * new_ptr;
+        if ( old_ptr == 0 )
+            new_ptr = tier_alloc ( new_bytes, clear );
+        else if ( new_bytes == 0 )
+        {
+            tier_free ( old_ptr, old_bytes );
+            new_ptr = 0;
+        }
         else
         {
-            avail -= new_size - old_size;
+            new_ptr = tier_resize ( old_ptr, old_bytes, new_bytes );
 
             // clear extended area
-            if ( clear )
-                memset ( & ( ( char* ) new_ptr ) [ old_size ], 0, new_size - old_size );
+            if ( new_ptr != 0 && clear && new_bytes > old_bytes )
+                memset ( & ( ( char* ) new_ptr ) [ old_bytes ], 0, new_bytes - old_bytes );
         }
 
+        if ( new_ptr == 0 && new_bytes != 0 )
+        {
+            if ( new_bytes > old_bytes )
+                refund ( new_bytes - old_bytes );
+            THROW ( xc_no_mem, "process memory exhausted reallocating %lu to %lu bytes", ( U64 ) old_size, ( U64 ) new_size );
+        }
+
+        // update bytes remaining
+        if ( old_bytes > new_bytes )
+            refund ( old_bytes - new_bytes );
+
         return new_ptr;
     }
 
@@ -286,18 +972,25 @@ namespace vdb3
         // not supposed to be called with bad values
         assert ( ptr != 0 || size == ( U64 ) 0 );
 
-        // return to the process memory manager
-        // alternatively, could clear before free
-        free ( ptr );
+        // the manager itself came from the process heap
+        if ( ( void * ) this == ptr )
+        {
+            free ( ptr );
+            return;
+        }
+
+        // return to the tier it came from
+        if ( ptr != 0 )
+            tier_free ( ptr, size );
 
         // update bytes remaining
-        if ( ( void * ) this != ptr )
-            avail += size;
+        refund ( size );
     }
 
     PrimordMemMgr :: PrimordMemMgr ( const bytes_t & q, const bytes_t & a )
         : quota ( q )
         , avail ( a )
+        , peak ( ( U64 ) q - ( U64 ) a )
     {
     }
 
@@ -306,6 +999,7 @@ namespace vdb3
         // TBD - can test if avail != quota
         quota = 0;
         avail = 0;
+        pmmgr = 0;
     }
 
     void PrimordMemMgr :: operator delete ( void * ptr )
@@ -36,10 +36,44 @@
 namespace vdb3
 {
 
+    /*------------------------------------------------------------------
+     * forwards
+     */
+    class QuotaMemMgr;
+
+
+    /*------------------------------------------------------------------
+     * PrimordMemStats
+     *  a snapshot of primordial memory manager accounting
+     */
+    struct PrimordMemStats
+    {
+        // process quota and bytes allocated against it
+        U64 quota;
+        U64 in_use;
+
+        // high-water mark of bytes in use
+        U64 peak;
+
+        // bytes held by the slab tier, whether handed out or free
+        U64 slab_reserved;
+
+        // bytes mapped by the huge-page tier
+        U64 huge_mapped;
+
+        // allocations served by the large and huge-page tiers
+        U64 large_allocs;
+        U64 huge_allocs;
+    };
+
 
     /*------------------------------------------------------------------
      * PrimordMemMgr
      *  primordial memory manager
+     *
+     *  small blocks come from size-class slabs cached per thread,
+     *  medium blocks from the process heap and large blocks are
+     *  mapped directly, on huge pages where the system allows it.
      */
     class PrimordMemMgr : implements MemMgrItf
     {
@@ -47,6 +81,13 @@ namespace vdb3
 
         static MemMgr make_primordial ();
 
+        // create a manager that allocates from the primordial one
+        // within a quota of its own, to hold a subsystem to a budget
+        static MemMgr make_quota ( const bytes_t & quota );
+
+        // accounting snapshot
+        static void get_stats ( PrimordMemStats & stats );
+
         virtual Mem alloc ( const bytes_t & size, bool clear );
         virtual Mem make_const ( const void * ptr, const bytes_t & size );
 
@@ -66,8 +107,16 @@ namespace vdb3
         { return ptr; }
         void operator delete ( void * ptr );
 
+        // charge and refund quota
+        void charge ( size_t bytes );
+        void refund ( size_t bytes );
+        bool draw ( U64 bytes );
+
         bytes_t quota;
         atomic_t < U64 > avail;
+        atomic_t < U64 > peak;
+
+        friend class QuotaMemMgr;
     };
 
 }
@@ -0,0 +1,777 @@
+/*===========================================================================
+*
+*                            PUBLIC DOMAIN NOTICE
+*               National Center for Biotechnology Information
+*
+*  This software/database is a "United States Government Work" under the
+*  terms of the United States Copyright Act.  It was written as part of
+*  the author's official duties as a United States Government employee and
+*  thus cannot be copyrighted.  This software/database is freely available
+*  to the public for use. The National Library of Medicine and the U.S.
+*  Government have not placed any restriction on its use or reproduction.
+*
+*  Although all reasonable efforts have been taken to ensure the accuracy
+*  and reliability of the software and data, the NLM and the U.S.
+*  Government do not and cannot warrant the performance or results that
+*  may be obtained by using this software or data. The NLM and the U.S.
+*  Government disclaim all warranties, express or implied, including
+*  warranties of performance, merchantability or fitness for any particular
+*  purpose.
+*
+*  Please cite the author in any work or product based on this material.
+*
+* ===========================================================================
+*
+*/
+
+#include "psched.hpp"
+#include <kfc/task.hpp>
+#include <kfc/time.hpp>
+#include <kfc/callstk.hpp>
+#include <kfc/rsrc.hpp>
+#include <kfc/except.hpp>
+#include <kfc/caps.hpp>
+#include <kfc/syserr.hpp>
+
+#if UNIX
+#include <unistd.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <errno.h>
+#include <time.h>
+#include <limits.h>
+#else
+#error "unsupported target platform"
+#endif
+
+namespace vdb3
+{
+
+    /*------------------------------------------------------------------
+     * SchedStk
+     *  the frame at the top of each scheduler thread's call stack
+     */
+    class SchedStk : public CallStk
+    {
+    public:
+
+        SchedStk ()
+            : CallStk ( s_src_loc )
+        {
+        }
+    };
+
+
+    /*------------------------------------------------------------------
+     * sched_worker_t
+     *  one per worker thread
+     */
+    struct sched_worker_t
+    {
+        enum park_t
+        {
+            park_none,
+            park_timer,
+            park_fd
+        };
+
+        sched_deque_t q;
+        PrimordSched * sched;
+        U32 idx;
+        U32 seed;
+#if UNIX
+        pthread_t thread;
+#endif
+
+        // the task being run, if any
+        const Task * running;
+
+        // set by "wait" or "wait_ready" while a task runs
+        park_t park;
+        I64 when;
+        int fd;
+        bool write;
+    };
+
+    // the worker running on this thread, if any
+    static __thread sched_worker_t * cur_worker;
+
+
+    /*------------------------------------------------------------------
+     * sched_timer_t
+     * sched_waiter_t
+     *  tasks held by the reactor
+     */
+    struct sched_timer_t
+    {
+        I64 when;
+        Task task;
+    };
+
+    struct sched_waiter_t
+    {
+        int fd;
+        bool write;
+        Task task;
+    };
+
+
+    /*------------------------------------------------------------------
+     * sched_deque_t
+     *  a growable ring of tasks
+     */
+
+    void sched_deque_t :: push_bottom ( const Task & t )
+    {
+        pthread_mutex_lock ( & lock );
+        if ( count == cap )
+            grow ();
+        ring [ ( head + count ) & ( cap - 1 ) ] = t;
+        ++ count;
+        pthread_mutex_unlock ( & lock );
+    }
+
+    void sched_deque_t :: push_top ( const Task & t )
+    {
+        pthread_mutex_lock ( & lock );
+        if ( count == cap )
+            grow ();
+        head = ( head - 1 ) & ( cap - 1 );
+        ring [ head ] = t;
+        ++ count;
+        pthread_mutex_unlock ( & lock );
+    }
+
+    bool sched_deque_t :: pop_bottom ( Task & t )
+    {
+        if ( count == 0 )
+            return false;
+
+        Task popped;
+        pthread_mutex_lock ( & lock );
+        bool found = count != 0;
+        if ( found )
+        {
+            -- count;
+            Task & slot = ring [ ( head + count ) & ( cap - 1 ) ];
+            popped = slot;
+            slot = Task ();
+        }
+        pthread_mutex_unlock ( & lock );
+
+        // any release of the prior task happens outside of the lock
+        if ( found )
+            t = popped;
+        return found;
+    }
+
+    bool sched_deque_t :: pop_top ( Task & t )
+    {
+        if ( count == 0 )
+            return false;
+
+        Task popped;
+        pthread_mutex_lock ( & lock );
+        bool found = count != 0;
+        if ( found )
+        {
+            Task & slot = ring [ head ];
+            popped = slot;
+            slot = Task ();
+            head = ( head + 1 ) & ( cap - 1 );
+            -- count;
+        }
+        pthread_mutex_unlock ( & lock );
+
+        if ( found )
+            t = popped;
+        return found;
+    }
+
+    void sched_deque_t :: grow ()
+    {
+        // called under "lock", which must not stay held on failure
+        U32 new_cap = cap * 2;
+        Task * new_ring;
+        try
+        {
+            new_ring = new Task [ new_cap ];
+        }
+        catch ( ... )
+        {
+            pthread_mutex_unlock ( & lock );
+            throw;
+        }
+        for ( U32 i = 0; i < count; ++ i )
+            new_ring [ i ] = ring [ ( head + i ) & ( cap - 1 ) ];
+
+        delete [] ring;
+        ring = new_ring;
+        cap = new_cap;
+        head = 0;
+    }
+
+    sched_deque_t :: sched_deque_t ()
+        : ring ( new Task [ 64 ] )
+        , cap ( 64 )
+        , head ( 0 )
+        , count ( 0 )
+    {
+        pthread_mutex_init ( & lock, 0 );
+    }
+
+    sched_deque_t :: ~ sched_deque_t ()
+    {
+        delete [] ring;
+        pthread_mutex_destroy ( & lock );
+    }
+
+
+    /*------------------------------------------------------------------
+     * PrimordSched
+     */
+
+    Sched PrimordSched :: make ( U32 num_workers )
+    {
+        FUNC_ENTRY ();
+
+        if ( num_workers == 0 )
+        {
+#if UNIX
+            long int cpus = sysconf ( _SC_NPROCESSORS_ONLN );
+            num_workers = ( cpus > 0 ) ? ( U32 ) cpus : 1;
+#endif
+        }
+
+        PrimordSched * obj = new PrimordSched ( num_workers );
+        Sched sched = obj -> make_sched_ref ( obj, CAP_EXECUTE | CAP_SUSPEND );
+
+        // threads are started once the reference exists,
+        // so that a failure releases any that were started
+        obj -> start ( num_workers );
+
+        return sched;
+    }
+
+    void PrimordSched :: spawn ( const Task & t )
+    {
+        FUNC_ENTRY ();
+
+        ++ pending;
+
+        // tasks spawned by a task stay with its worker
+        sched_worker_t * w = cur_worker;
+        if ( w != 0 && w -> sched == this )
+            w -> q . push_bottom ( t );
+        else
+            inject . push_bottom ( t );
+
+        notify ();
+    }
+
+    void PrimordSched :: spawn_after ( const Task & t, const nS_t & delay )
+    {
+        FUNC_ENTRY ();
+
+        ++ pending;
+        add_timer ( t, cur_nS () + ( I64 ) delay );
+    }
+
+    void PrimordSched :: spawn_on_ready ( const Task & t, int fd, bool write )
+    {
+        FUNC_ENTRY ();
+
+        ++ pending;
+        add_waiter ( t, fd, write );
+    }
+
+    void PrimordSched :: wait ( const nS_t & delay )
+    {
+        FUNC_ENTRY ();
+
+        sched_worker_t * w = cur_worker;
+        if ( w == 0 || w -> sched != this )
+            CONST_THROW ( xc_program_state_violation, "wait called outside of a scheduled task" );
+
+        // throw while still within the task, rather than when parking it
+        if ( w -> running != 0 )
+            w -> running -> test_suspend ();
+
+        w -> park = sched_worker_t :: park_timer;
+        w -> when = cur_nS () + ( I64 ) delay;
+    }
+
+    void PrimordSched :: wait_ready ( int fd, bool write )
+    {
+        FUNC_ENTRY ();
+
+        sched_worker_t * w = cur_worker;
+        if ( w == 0 || w -> sched != this )
+            CONST_THROW ( xc_program_state_violation, "wait called outside of a scheduled task" );
+
+        if ( w -> running != 0 )
+            w -> running -> test_suspend ();
+
+        w -> park = sched_worker_t :: park_fd;
+        w -> fd = fd;
+        w -> write = write;
+    }
+
+    count_t PrimordSched :: drain ()
+    {
+        FUNC_ENTRY ();
+
+        sched_worker_t * w = cur_worker;
+        if ( w != 0 && w -> sched == this )
+            CONST_THROW ( xc_program_state_violation, "cannot drain from within a scheduled task" );
+
+        pthread_mutex_lock ( & lock );
+        while ( pending != 0 )
+            pthread_cond_wait ( & drain_cond, & lock );
+        pthread_mutex_unlock ( & lock );
+
+        U64 num_failed = failed;
+        failed -= num_failed;
+        return count_t ( num_failed );
+    }
+
+    PrimordSched :: ~ PrimordSched ()
+    {
+        // cannot join itself
+        assert ( cur_worker == 0 || cur_worker -> sched != this );
+
+        pthread_mutex_lock ( & lock );
+        shutdown = true;
+        pthread_cond_broadcast ( & work_cond );
+        pthread_mutex_unlock ( & lock );
+        wake_reactor ();
+
+        // tasks still queued are released without running
+        for ( U32 i = 0; i < num_workers; ++ i )
+            pthread_join ( workers [ i ] . thread, 0 );
+        if ( reactor_started )
+            pthread_join ( reactor, 0 );
+
+        delete [] workers;
+        delete [] timers;
+        delete [] waiters;
+
+        close ( wake_pipe [ 0 ] );
+        close ( wake_pipe [ 1 ] );
+        pthread_cond_destroy ( & drain_cond );
+        pthread_cond_destroy ( & work_cond );
+        pthread_mutex_destroy ( & lock );
+    }
+
+    PrimordSched :: PrimordSched ( U32 max_workers )
+        : sched_rsrc ( RCAP_ALL )
+        , workers ( new sched_worker_t [ max_workers ] )
+        , num_workers ( 0 )
+        , pending ( 0 )
+        , failed ( 0 )
+        , idle ( 0 )
+        , shutdown ( false )
+        , reactor_started ( false )
+        , timers ( 0 )
+        , num_timers ( 0 )
+        , max_timers ( 0 )
+        , waiters ( 0 )
+        , num_waiters ( 0 )
+        , max_waiters ( 0 )
+    {
+        FUNC_ENTRY ();
+
+        pthread_mutex_init ( & lock, 0 );
+        pthread_cond_init ( & work_cond, 0 );
+        pthread_cond_init ( & drain_cond, 0 );
+
+        if ( pipe ( wake_pipe ) != 0 )
+            THROW_OSERR ( pipe, errno );
+        fcntl ( wake_pipe [ 0 ], F_SETFL, O_NONBLOCK );
+        fcntl ( wake_pipe [ 1 ], F_SETFL, O_NONBLOCK );
+
+        for ( U32 i = 0; i < max_workers; ++ i )
+        {
+            workers [ i ] . sched = this;
+            workers [ i ] . idx = i;
+            workers [ i ] . seed = i * 2654435761U + 1;
+            workers [ i ] . running = 0;
+            workers [ i ] . park = sched_worker_t :: park_none;
+        }
+    }
+
+    void PrimordSched :: start ( U32 max_workers )
+    {
+        FUNC_ENTRY ();
+
+        int status = pthread_create ( & reactor, 0, reactor_thread, this );
+        if ( status != 0 )
+            THROW_OSERR ( pthread_create, status );
+        reactor_started = true;
+
+        for ( ; num_workers < max_workers; ++ num_workers )
+        {
+            sched_worker_t * w = & workers [ num_workers ];
+            status = pthread_create ( & w -> thread, 0, worker_thread, w );
+            if ( status != 0 )
+                THROW_OSERR ( pthread_create, status );
+        }
+    }
+
+    void PrimordSched :: work ( sched_worker_t * w )
+    {
+        FUNC_ENTRY ();
+
+        while ( ! shutdown )
+        {
+            // own work first, newest first, then outside work, then steal
+            Task t;
+            if ( w -> q . pop_bottom ( t ) || inject . pop_top ( t ) || steal ( w, t ) )
+                run_one ( w, t );
+            else if ( ! idle_wait ( w ) )
+                break;
+        }
+    }
+
+    void PrimordSched :: run_one ( sched_worker_t * w, Task & t )
+    {
+        FUNC_ENTRY ();
+
+        w -> park = sched_worker_t :: park_none;
+        w -> running = & t;
+
+        bool done = false;
+        bool threw = false;
+        try
+        {
+            done = t . run ();
+        }
+        catch ( ... )
+        {
+            done = threw = true;
+        }
+
+        w -> running = 0;
+
+        if ( done )
+        {
+            complete ( threw );
+            return;
+        }
+
+        // requeueing can fail as well, and must not escape the worker
+        try
+        {
+            if ( w -> park == sched_worker_t :: park_none )
+            {
+                // yielded: behind everything else in this deque
+                // and first in line for thieves
+                w -> q . push_top ( t );
+            }
+            else
+            {
+                // waiting: it will be resumed rather than executed
+                t . suspend ();
+                if ( w -> park == sched_worker_t :: park_timer )
+                    add_timer ( t, w -> when );
+                else
+                    add_waiter ( t, w -> fd, w -> write );
+            }
+        }
+        catch ( ... )
+        {
+            // the task is dropped and counts as failed
+            complete ( true );
+        }
+    }
+
+    bool PrimordSched :: steal ( sched_worker_t * w, Task & t )
+    {
+        if ( num_workers < 2 )
+            return false;
+
+        // start from a pseudo-random victim
+        w -> seed = w -> seed * 1103515245 + 12345;
+        U32 start = ( w -> seed >> 16 ) % num_workers;
+
+        for ( U32 i = 0; i < num_workers; ++ i )
+        {
+            sched_worker_t * victim = & workers [ ( start + i ) % num_workers ];
+            if ( victim != w && victim -> q . pop_top ( t ) )
+                return true;
+        }
+
+        return false;
+    }
+
+    bool PrimordSched :: idle_wait ( sched_worker_t * w )
+    {
+        pthread_mutex_lock ( & lock );
+        ++ idle;
+
+        // look again now that "idle" is raised. a push that this misses
+        // raised its deque's "count" before "notify" reads "idle", and
+        // both are locked increments, so "notify" sees this worker and
+        // signals under "lock" - which cannot happen before the wait
+        bool found = ! inject . empty ();
+        for ( U32 i = 0; ! found && i < num_workers; ++ i )
+            found = ! workers [ i ] . q . empty ();
+
+        if ( ! found && ! shutdown )
+            pthread_cond_wait ( & work_cond, & lock );
+
+        -- idle;
+        bool running = ! shutdown;
+        pthread_mutex_unlock ( & lock );
+
+        return running;
+    }
+
+    void PrimordSched :: notify ()
+    {
+        // must follow the push of the task
+        if ( idle != 0 )
+        {
+            pthread_mutex_lock ( & lock );
+            pthread_cond_signal ( & work_cond );
+            pthread_mutex_unlock ( & lock );
+        }
+    }
+
+    void PrimordSched :: complete ( bool threw )
+    {
+        if ( threw )
+            ++ failed;
+
+        if ( pending . dec_and_test () )
+        {
+            pthread_mutex_lock ( & lock );
+            pthread_cond_broadcast ( & drain_cond );
+            pthread_mutex_unlock ( & lock );
+        }
+    }
+
+    void PrimordSched :: react ()
+    {
+        FUNC_ENTRY ();
+
+        struct pollfd * fds = 0;
+        U32 max_fds = 0;
+
+        pthread_mutex_lock ( & lock );
+        while ( ! shutdown )
+        {
+            // timers that have expired are ready to run
+            bool ready = false;
+            I64 now = cur_nS ();
+            while ( num_timers != 0 && timers [ 0 ] . when <= now )
+            {
+                inject . push_bottom ( timers [ 0 ] . task );
+                ready = true;
+
+                // pop the heap
+                sched_timer_t last = timers [ -- num_timers ];
+                timers [ num_timers ] . task = Task ();
+                U32 i = 0;
+                for ( U32 child = 1; child < num_timers; child = i * 2 + 1 )
+                {
+                    if ( child + 1 < num_timers && timers [ child + 1 ] . when < timers [ child ] . when )
+                        ++ child;
+                    if ( last . when <= timers [ child ] . when )
+                        break;
+                    timers [ i ] = timers [ child ];
+                    i = child;
+                }
+                if ( num_timers != 0 )
+                    timers [ i ] = last;
+            }
+
+            // sleep no longer than the next timer
+            int timeout = -1;
+            if ( num_timers != 0 )
+            {
+                // a timer far ahead is woken for early and re-armed
+                I64 mS = ( timers [ 0 ] . when - now + 999999 ) / 1000000;
+                timeout = ( mS > INT_MAX ) ? INT_MAX : ( int ) mS;
+            }
+
+            // the wake pipe followed by every waiting descriptor
+            U32 num_fds = num_waiters + 1;
+            if ( num_fds > max_fds )
+            {
+                delete [] fds;
+                max_fds = num_fds + 16;
+                fds = new struct pollfd [ max_fds ];
+            }
+            fds [ 0 ] . fd = wake_pipe [ 0 ];
+            fds [ 0 ] . events = POLLIN;
+            for ( U32 i = 0; i < num_waiters; ++ i )
+            {
+                fds [ i + 1 ] . fd = waiters [ i ] . fd;
+                fds [ i + 1 ] . events = waiters [ i ] . write ? POLLOUT : POLLIN;
+            }
+
+            if ( ready )
+                pthread_cond_broadcast ( & work_cond );
+            pthread_mutex_unlock ( & lock );
+
+            int status = poll ( fds, num_fds, timeout );
+
+            pthread_mutex_lock ( & lock );
+            if ( status <= 0 )
+                continue;
+
+            if ( fds [ 0 ] . revents != 0 )
+            {
+                char buffer [ 64 ];
+                while ( read ( wake_pipe [ 0 ], buffer, sizeof buffer ) > 0 )
+                    ;
+            }
+
+            // waiters are only appended while unlocked,
+            // so the first "num_fds - 1" still match "fds"
+            ready = false;
+            U32 j = 0;
+            for ( U32 i = 0; i < num_waiters; ++ i )
+            {
+                if ( i + 1 < num_fds && fds [ i + 1 ] . revents != 0 )
+                {
+                    inject . push_bottom ( waiters [ i ] . task );
+                    ready = true;
+                }
+                else if ( i != j )
+                {
+                    waiters [ j ++ ] = waiters [ i ];
+                }
+                else
+                {
+                    ++ j;
+                }
+            }
+            for ( U32 i = j; i < num_waiters; ++ i )
+                waiters [ i ] . task = Task ();
+            num_waiters = j;
+
+            if ( ready )
+                pthread_cond_broadcast ( & work_cond );
+        }
+        pthread_mutex_unlock ( & lock );
+
+        delete [] fds;
+    }
+
+    void PrimordSched :: add_timer ( const Task & t, I64 when )
+    {
+        FUNC_ENTRY ();
+
+        pthread_mutex_lock ( & lock );
+        if ( num_timers == max_timers )
+        {
+            U32 new_max = max_timers ? max_timers * 2 : 16;
+            sched_timer_t * new_timers;
+            try
+            {
+                new_timers = new sched_timer_t [ new_max ];
+            }
+            catch ( ... )
+            {
+                pthread_mutex_unlock ( & lock );
+                throw;
+            }
+            for ( U32 i = 0; i < num_timers; ++ i )
+                new_timers [ i ] = timers [ i ];
+            delete [] timers;
+            timers = new_timers;
+            max_timers = new_max;
+        }
+
+        // push onto the heap
+        U32 i = num_timers ++;
+        while ( i != 0 && timers [ ( i - 1 ) / 2 ] . when > when )
+        {
+            timers [ i ] = timers [ ( i - 1 ) / 2 ];
+            i = ( i - 1 ) / 2;
+        }
+        timers [ i ] . when = when;
+        timers [ i ] . task = t;
+        pthread_mutex_unlock ( & lock );
+
+        wake_reactor ();
+    }
+
+    void PrimordSched :: add_waiter ( const Task & t, int fd, bool write )
+    {
+        FUNC_ENTRY ();
+
+        pthread_mutex_lock ( & lock );
+        if ( num_waiters == max_waiters )
+        {
+            U32 new_max = max_waiters ? max_waiters * 2 : 16;
+            sched_waiter_t * new_waiters;
+            try
+            {
+                new_waiters = new sched_waiter_t [ new_max ];
+            }
+            catch ( ... )
+            {
+                pthread_mutex_unlock ( & lock );
+                throw;
+            }
+            for ( U32 i = 0; i < num_waiters; ++ i )
+                new_waiters [ i ] = waiters [ i ];
+            delete [] waiters;
+            waiters = new_waiters;
+            max_waiters = new_max;
+        }
+
+        sched_waiter_t & waiter = waiters [ num_waiters ++ ];
+        waiter . fd = fd;
+        waiter . write = write;
+        waiter . task = t;
+        pthread_mutex_unlock ( & lock );
+
+        wake_reactor ();
+    }
+
+    void PrimordSched :: wake_reactor ()
+    {
+        // a full pipe already means a wakeup is pending
+        char c = 0;
+        ssize_t ignored = :: write ( wake_pipe [ 1 ], & c, 1 );
+        ( void ) ignored;
+    }
+
+    I64 PrimordSched :: cur_nS () const
+    {
+        return ( I64 ) sched_rsrc . tmmgr . cur_time ();
+    }
+
+    void * PrimordSched :: worker_thread ( void * data )
+    {
+        sched_worker_t * w = ( sched_worker_t * ) data;
+
+        SchedStk stk;
+        rsrc = & w -> sched -> sched_rsrc;
+        cur_worker = w;
+
+        w -> sched -> work ( w );
+
+        cur_worker = 0;
+        rsrc = 0;
+        return 0;
+    }
+
+    void * PrimordSched :: reactor_thread ( void * data )
+    {
+        PrimordSched * self = ( PrimordSched * ) data;
+
+        SchedStk stk;
+        rsrc = & self -> sched_rsrc;
+
+        self -> react ();
+
+        rsrc = 0;
+        return 0;
+    }
+
+}
@@ -0,0 +1,175 @@
+/*===========================================================================
+*
+*                            PUBLIC DOMAIN NOTICE
+*               National Center for Biotechnology Information
+*
+*  This software/database is a "United States Government Work" under the
+*  terms of the United States Copyright Act.  It was written as part of
+*  the author's official duties as a United States Government employee and
+*  thus cannot be copyrighted.  This software/database is freely available
+*  to the public for use. The National Library of Medicine and the U.S.
+*  Government have not placed any restriction on its use or reproduction.
+*
+*  Although all reasonable efforts have been taken to ensure the accuracy
+*  and reliability of the software and data, the NLM and the U.S.
+*  Government do not and cannot warrant the performance or results that
+*  may be obtained by using this software or data. The NLM and the U.S.
+*  Government disclaim all warranties, express or implied, including
+*  warranties of performance, merchantability or fitness for any particular
+*  purpose.
+*
+*  Please cite the author in any work or product based on this material.
+*
+* ===========================================================================
+*
+*/
+
+#ifndef _hpp_vdb3_kfc_psched_
+#define _hpp_vdb3_kfc_psched_
+
+#ifndef _hpp_vdb3_kfc_refcount_
+#include <kfc/refcount.hpp>
+#endif
+
+#ifndef _hpp_vdb3_kfc_sched_
+#include <kfc/sched.hpp>
+#endif
+
+#ifndef _hpp_vdb3_kfc_rsrc_
+#include <kfc/rsrc.hpp>
+#endif
+
+#ifndef _hpp_vdb3_kfc_atomic_
+#include <kfc/atomic.hpp>
+#endif
+
+#if UNIX
+#include <pthread.h>
+#endif
+
+namespace vdb3
+{
+
+    /*------------------------------------------------------------------
+     * forwards
+     */
+    struct sched_worker_t;
+    struct sched_timer_t;
+    struct sched_waiter_t;
+
+
+    /*------------------------------------------------------------------
+     * sched_deque_t
+     *  a growable ring of tasks
+     *  the owning worker works at the bottom, thieves take the top
+     */
+    struct sched_deque_t
+    {
+        void push_bottom ( const Task & t );
+        void push_top ( const Task & t );
+        bool pop_bottom ( Task & t );
+        bool pop_top ( Task & t );
+
+        // unlocked peek
+        bool empty () const
+        { return count == 0; }
+
+        sched_deque_t ();
+        ~ sched_deque_t ();
+
+    private:
+
+        void grow ();
+
+        Task * ring;
+        U32 cap;
+        U32 head;
+
+        // changed under "lock", read without it by "empty"
+        atomic_t < U32 > count;
+#if UNIX
+        pthread_mutex_t lock;
+#endif
+    };
+
+
+    /*------------------------------------------------------------------
+     * PrimordSched
+     *  a pool of worker threads, each with its own deque of tasks,
+     *  stealing from one another when idle. a reactor thread tracks
+     *  timers against TimeMgr and polls file descriptors for tasks
+     *  that are waiting.
+     */
+    class PrimordSched : public Refcount
+        , implements SchedItf
+    {
+    public:
+
+        // "num_workers" of 0 uses one per online processor
+        static Sched make ( U32 num_workers = 0 );
+
+        virtual void spawn ( const Task & t );
+        virtual void spawn_after ( const Task & t, const nS_t & delay );
+        virtual void spawn_on_ready ( const Task & t, int fd, bool write );
+        virtual void wait ( const nS_t & delay );
+        virtual void wait_ready ( int fd, bool write );
+        virtual count_t drain ();
+
+        ~ PrimordSched ();
+
+    private:
+
+        PrimordSched ( U32 max_workers );
+        void start ( U32 max_workers );
+
+        // worker operations
+        void work ( sched_worker_t * w );
+        void run_one ( sched_worker_t * w, Task & t );
+        bool steal ( sched_worker_t * w, Task & t );
+        bool idle_wait ( sched_worker_t * w );
+        void notify ();
+        void complete ( bool failed );
+
+        // reactor operations
+        void react ();
+        void add_timer ( const Task & t, I64 when );
+        void add_waiter ( const Task & t, int fd, bool write );
+        void wake_reactor ();
+        I64 cur_nS () const;
+
+        static void * worker_thread ( void * data );
+        static void * reactor_thread ( void * data );
+
+        // resources given to every thread
+        Rsrc sched_rsrc;
+
+        sched_worker_t * workers;
+        U32 num_workers;
+
+        // tasks spawned from outside or made ready by the reactor
+        sched_deque_t inject;
+
+        // tasks not yet complete
+        atomic_t < U64 > pending;
+        atomic_t < U64 > failed;
+        atomic_t < U32 > idle;
+        volatile bool shutdown;
+
+#if UNIX
+        pthread_mutex_t lock;
+        pthread_cond_t work_cond;
+        pthread_cond_t drain_cond;
+
+        // reactor state, guarded by "lock"
+        pthread_t reactor;
+        bool reactor_started;
+        int wake_pipe [ 2 ];
+#endif
+        sched_timer_t * timers;
+        U32 num_timers, max_timers;
+        sched_waiter_t * waiters;
+        U32 num_waiters, max_waiters;
+    };
+}
+
+#endif // _hpp_vdb3_kfc_psched_
@@ -0,0 +1,138 @@
+/*===========================================================================
+*
+*                            PUBLIC DOMAIN NOTICE
+*               National Center for Biotechnology Information
+*
+*  This software/database is a "United States Government Work" under the
+*  terms of the United States Copyright Act.  It was written as part of
+*  the author's official duties as a United States Government employee and
+*  thus cannot be copyrighted.  This software/database is freely available
+*  to the public for use. The National Library of Medicine and the U.S.
+*  Government have not placed any restriction on its use or reproduction.
+*
+*  Although all reasonable efforts have been taken to ensure the accuracy
+*  and reliability of the software and data, the NLM and the U.S.
+*  Government do not and cannot warrant the performance or results that
+*  may be obtained by using this software or data. The NLM and the U.S.
+*  Government disclaim all warranties, express or implied, including
+*  warranties of performance, merchantability or fitness for any particular
+*  purpose.
+*
+*  Please cite the author in any work or product based on this material.
+*
+* ===========================================================================
+*
+*/
+
+#include <kfc/sched.hpp>
+#include <kfc/task.hpp>
+#include <kfc/time.hpp>
+#include <kfc/callstk.hpp>
+#include <kfc/rsrc.hpp>
+#include <kfc/except.hpp>
+#include <kfc/caps.hpp>
+
+namespace vdb3
+{
+
+    /*------------------------------------------------------------------
+     * SchedItf
+     *  cooperative task scheduler
+     */
+
+    Sched SchedItf :: make_sched_ref ( Refcount * obj, caps_t caps )
+    {
+        return Sched ( obj, this, caps );
+    }
+
+
+    /*------------------------------------------------------------------
+     * Sched
+     *  task scheduler reference
+     */
+
+    void Sched :: spawn ( const Task & t ) const
+    {
+        FUNC_ENTRY ();
+
+        if ( t . null_ref () )
+            CONST_THROW ( xc_null_param_err, "null task" );
+
+        SchedItf * itf = get_itf ( CAP_EXECUTE );
+        itf -> spawn ( t );
+    }
+
+    void Sched :: spawn_after ( const Task & t, const nS_t & delay ) const
+    {
+        FUNC_ENTRY ();
+
+        if ( t . null_ref () )
+            CONST_THROW ( xc_null_param_err, "null task" );
+
+        SchedItf * itf = get_itf ( CAP_EXECUTE );
+        itf -> spawn_after ( t, delay );
+    }
+
+    void Sched :: spawn_on_ready ( const Task & t, int fd, bool write ) const
+    {
+        FUNC_ENTRY ();
+
+        if ( t . null_ref () )
+            CONST_THROW ( xc_null_param_err, "null task" );
+        if ( fd < 0 )
+            THROW ( xc_param_err, "bad fd: %d", fd );
+
+        SchedItf * itf = get_itf ( CAP_EXECUTE );
+        itf -> spawn_on_ready ( t, fd, write );
+    }
+
+    void Sched :: wait ( const nS_t & delay ) const
+    {
+        FUNC_ENTRY ();
+        SchedItf * itf = get_itf ( CAP_SUSPEND );
+        itf -> wait ( delay );
+    }
+
+    void Sched :: wait_ready ( int fd, bool write ) const
+    {
+        FUNC_ENTRY ();
+
+        if ( fd < 0 )
+            THROW ( xc_param_err, "bad fd: %d", fd );
+
+        SchedItf * itf = get_itf ( CAP_SUSPEND );
+        itf -> wait_ready ( fd, write );
+    }
+
+    count_t Sched :: drain () const
+    {
+        FUNC_ENTRY ();
+        SchedItf * itf = get_itf ( CAP_EXECUTE );
+        return itf -> drain ();
+    }
+
+    Sched :: Sched ()
+    {
+    }
+
+    Sched :: Sched ( const Sched & r )
+        : Ref < SchedItf > ( r )
+    {
+    }
+
+    void Sched :: operator = ( const Sched & r )
+    {
+        Ref < SchedItf > :: operator = ( r );
+    }
+
+    Sched :: Sched ( const Sched & r, caps_t reduce )
+        : Ref < SchedItf > ( r, reduce )
+    {
+    }
+
+    Sched :: Sched ( Refcount * obj, SchedItf * itf, caps_t caps )
+        : Ref < SchedItf > ( obj, itf, caps )
+    {
+    }
+
+}
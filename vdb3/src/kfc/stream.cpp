@@ -56,6 +56,13 @@ namespace vdb3
         CONST_THROW ( xc_caps_over_extended_err, "unsupported write message" );
     }
 
+    bool StreamItf :: transfer_to ( const bytes_t & num_bytes,
+        StreamItf * dst, bytes_t & num_moved )
+    {
+        // no zero-copy path by default
+        return false;
+    }
+
     Stream StreamItf :: make_ref ( Refcount * obj, caps_t caps )
     {
         return Stream ( obj, this, caps );
@@ -212,6 +219,71 @@ namespace vdb3
         return total;
     }
 
+    bytes_t Stream :: transfer_to ( const Stream & dst, const bytes_t & num_bytes ) const
+    {
+        bytes_t zero_copy ( 0 );
+        return transfer_to ( dst, num_bytes, zero_copy );
+    }
+
+    bytes_t Stream :: transfer_to ( const Stream & dst,
+        const bytes_t & num_bytes, bytes_t & zero_copy ) const
+    {
+        FUNC_ENTRY ();
+
+        zero_copy = 0;
+
+        // a null ref should act like nothing was there
+        if ( null_ref () )
+            return bytes_t ( 0 );
+
+        if ( dst . null_ref () )
+            THROW ( xc_null_param_err, "transferred 0 of %lu bytes", ( U64 ) num_bytes );
+
+        // access streams
+        StreamItf * itf = get_itf ( CAP_PROP_READ | CAP_READ );
+        StreamItf * dst_itf = dst . get_itf ( CAP_WRITE );
+
+        // move directly for as long as the ends allow it
+        bytes_t total ( 0 );
+        while ( total < num_bytes )
+        {
+            bytes_t num_moved ( 0 );
+            if ( ! itf -> transfer_to ( num_bytes - total, dst_itf, num_moved ) )
+                break;
+            if ( num_moved == ( U64 ) 0 )
+                return total;
+
+            total += num_moved;
+            zero_copy += num_moved;
+        }
+
+        if ( total == num_bytes )
+            return total;
+
+        // copy the remainder through a buffer
+        bytes_t mtu = itf -> get_mtu ();
+        if ( num_bytes - total < mtu )
+            mtu = num_bytes - total;
+        Mem buffer = rsrc -> mmgr . alloc ( mtu, false );
+
+        while ( total < num_bytes )
+        {
+            bytes_t to_read = num_bytes - total;
+            if ( mtu < to_read )
+                to_read = mtu;
+
+            bytes_t num_read = itf -> read ( to_read, buffer, 0 );
+            if ( num_read == ( U64 ) 0 )
+                break;
+
+            bytes_t num_writ = dst . write_all ( num_read, buffer, 0 );
+            assert ( num_writ == num_read );
+            total += num_writ;
+        }
+
+        return total;
+    }
+
     bytes_t Stream :: read ( Mem & dst, index_t start ) const
     {
         FUNC_ENTRY ();
@@ -24,10 +24,10 @@
 *
 */
 
-#include <vdb3/task-impl.hpp>
-#include <vdb3/callstk.hpp>
-#include <vdb3/except.hpp>
-#include <vdb3/caps.hpp>
+#include <kfc/task-impl.hpp>
+#include <kfc/callstk.hpp>
+#include <kfc/except.hpp>
+#include <kfc/caps.hpp>
 
 #include <string.h>
 
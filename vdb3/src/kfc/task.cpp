@@ -24,9 +24,9 @@
 *
 */
 
-#include <vdb3/task.hpp>
-#include <vdb3/caps.hpp>
-#include <vdb3/callstk.hpp>
+#include <kfc/task.hpp>
+#include <kfc/caps.hpp>
+#include <kfc/callstk.hpp>
 
 namespace vdb3
 {
@@ -63,6 +63,11 @@ namespace vdb3
         itf -> suspend ();
     }
 
+    void Task :: test_suspend () const
+    {
+        test_caps ( CAP_SUSPEND );
+    }
+
     void Task :: checkpoint ()
     {
         FUNC_ENTRY ();